@@ -0,0 +1,261 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is a small benchmark harness. A benchmark is a setup, an operation and a 
+	teardown over a caller-owned context. Each repetition runs the setup untimed, times
+	one call of the operation (which does ops units of work) and runs the teardown.
+	The first few repetitions are warmup and are thrown away, and the rest are reported
+	as nanoseconds per unit of work (min, median, p99 and mean) in one CSV line each.
+	
+	It also holds the report the simulators print when they are run in bench mode.
+*/
+
+#include "bench.h"
+#include <sys/resource.h>
+
+
+int bench_compare (const void * a, const void * b) {
+	double x = *(const double *) a, y = *(const double *) b;
+	return (x > y) - (x < y);
+}
+
+
+/*
+ * Returns a monotonic timestamp in nanoseconds.
+ */
+double bench_now () {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+/*
+ * Fills in the defaults and reads "reps" and "warmup" from argv[1] and argv[2] when 
+ * they are given. Results go to out.
+ */
+void bench_config_init (BenchConfig config, int argc, char * argv[], FILE * out) {
+	config->reps = BENCH_DEFAULT_REPS;
+	config->warmup = BENCH_DEFAULT_WARMUP;
+	config->out = out;
+	if (argc > 1 && atoi(argv[1]) > 0) {
+		config->reps = atoi(argv[1]);
+	}
+	if (argc > 2 && atoi(argv[2]) >= 0) {
+		config->warmup = atoi(argv[2]);
+	}
+}
+
+
+/*
+ * Runs the benchmark as described above and prints its result line. setup and 
+ * teardown may be NULL.
+ *
+ * Return: the per-op timings of the measured repetitions.
+ */
+bench_result_s bench_run (BenchConfig config, const char * name, const char * variant, int ops, 
+		BenchFn setup, BenchFn op, BenchFn teardown, void * ctx) {
+	bench_result_s result;
+	double * samples = (double *) malloc(sizeof(double) * config->reps);
+	double start = 0;
+	
+	for (int r = 0; r < config->warmup + config->reps; r++) {
+		if (setup) {
+			setup(ctx);
+		}
+		start = bench_now();
+		op(ctx);
+		if (r >= config->warmup) {
+			samples[r - config->warmup] = (bench_now() - start) / ops;
+		}
+		if (teardown) {
+			teardown(ctx);
+		}
+	}
+	
+	result = bench_summarize(name, variant, ops, samples, config->reps);
+	free(samples);
+	
+	bench_print(config, &result);
+	
+	return result;
+}
+
+
+/*
+ * Sorts the samples and works out their min, median, p99, mean and max.
+ */
+bench_result_s bench_summarize (const char * name, const char * variant, int ops, double * samples, int count) {
+	bench_result_s result = {name, variant, ops, count, 0, 0, 0, 0, 0};
+	double total = 0;
+	
+	if (count <= 0) {
+		return result;
+	}
+	for (int r = 0; r < count; r++) {
+		total += samples[r];
+	}
+	result.p99 = bench_percentile(samples, count, 0.99);
+	result.min = samples[0];
+	result.median = samples[count / 2];
+	result.mean = total / count;
+	result.max = samples[count - 1];
+	
+	return result;
+}
+
+
+/*
+ * Prints the CSV column names.
+ */
+void bench_print_header (BenchConfig config) {
+	fprintf(config->out, "benchmark,variant,ops,reps,min_ns,median_ns,p99_ns,mean_ns\n");
+	fflush(config->out);
+}
+
+
+void bench_print (BenchConfig config, bench_result_s * result) {
+	fprintf(config->out, "%s,%s,%d,%d,%.2f,%.2f,%.2f,%.2f\n", result->name, result->variant, 
+		result->ops, result->reps, result->min, result->median, result->p99, result->mean);
+	fflush(config->out);
+}
+
+
+/*
+ * Returns the process's peak resident set size in KB.
+ */
+long bench_peak_rss () {
+	struct rusage usage;
+	
+	if (getrusage(RUSAGE_SELF, &usage)) {
+		return -1;
+	}
+	
+	return usage.ru_maxrss;
+}
+
+
+/*
+ * Sorts the samples and returns the value at the given fraction (0.99 for p99).
+ */
+double bench_percentile (double * samples, int count, double fraction) {
+	if (count <= 0) {
+		return 0;
+	}
+	qsort(samples, count, sizeof(double), bench_compare);
+	
+	return samples[(int) (count * fraction) < count ? (int) (count * fraction) : count - 1];
+}
+
+
+/*
+ * Prints the column names for bench_print_sim.
+ */
+void bench_print_sim_header (FILE * out) {
+	fprintf(out, "simulator,policy,seed,iterations,wall_s,iterations_per_s,dispatches,dispatches_per_s,"
+		"scheduler_locks_per_iteration,peak_rss_kb\n");
+	fflush(out);
+}
+
+
+/*
+ * Prints one simulator run as a CSV line, with the rates worked out from the totals.
+ */
+void bench_print_sim (FILE * out, bench_sim_result_s * result) {
+	double seconds = result->wall_ns / 1e9;
+	
+	fprintf(out, "%s,%s,%u,%lu,%.4f,%.0f,%lu,%.0f,%.3f,%ld\n", result->simulator, result->policy, 
+		result->seed, result->iterations, seconds, result->iterations / seconds, result->dispatches, 
+		result->dispatches / seconds, result->iterations ? (double) result->schedulerLocks / result->iterations : 0.0,
+		result->peakRSS);
+	fflush(out);
+}
+
+
+void bench_print_scale_header (FILE * out) {
+	fprintf(out, "threads,devices,rep,iterations,wall_s,iterations_per_s,io_completions,io_per_s,ns_per_io,"
+		"dispatches_per_s,scheduler_contention_pct,wake_p50_us,wake_p99_us\n");
+	fflush(out);
+}
+
+
+void bench_print_scale (FILE * out, bench_scale_point_s * point) {
+	double seconds = point->sim.wall_ns / 1e9;
+	
+	fprintf(out, "%d,%d,%d,%lu,%.4f,%.0f,%lu,%.0f,%.0f,%.0f,%.2f,%.2f,%.2f\n", point->threads, point->devices, 
+		point->rep, point->sim.iterations, seconds, point->sim.iterations / seconds, point->ioCompletions, 
+		point->ioCompletions / seconds, point->ioCompletions ? point->sim.wall_ns / point->ioCompletions : 0.0,
+		point->sim.dispatches / seconds,
+		point->sim.schedulerLocks ? 100.0 * point->schedulerContended / point->sim.schedulerLocks : 0.0,
+		point->wakeP50 / 1e3, point->wakeP99 / 1e3);
+	fflush(out);
+}
+
+
+/*
+ * Prints each thread count's median wall time per I/O completion with the spread
+ * of its runs, then where it was lowest and the first step that didn't gain. A step
+ * gains when its median is at least BENCH_FLAT_GAIN lower than the one before and
+ * its slowest run beat that one's fastest, and the lowest point is only called the
+ * peak when its spread is clear of every other's.
+ */
+void bench_print_scale_summary (FILE * out, bench_scale_spread_s spreads[], int count) {
+	int best = 0, flat = -1, overlapping = 0;
+	bench_result_s * cost = NULL, * before = NULL;
+	
+	for (int i = 0; i < count; i++) {
+		cost = &spreads[i].nsPerIO;
+		fprintf(out, "# %d threads/devices: median %.0f ns per I/O completion, spread %.0f-%.0f over %d runs\n",
+			spreads[i].threads, cost->median, cost->min, cost->max, cost->reps);
+		if (cost->median < spreads[best].nsPerIO.median) {
+			best = i;
+		}
+		before = i ? &spreads[i - 1].nsPerIO : NULL;
+		if (before && flat < 0 && (cost->median > before->median * (1 - BENCH_FLAT_GAIN) || cost->max >= before->min)) {
+			flat = i;
+		}
+	}
+	if (!count) {
+		fprintf(out, "# no run finished with an I/O completion to normalise by\n");
+		fflush(out);
+		return;
+	}
+	
+	for (int i = 0; i < count; i++) {
+		if (i != best && spreads[i].nsPerIO.min <= spreads[best].nsPerIO.max) {
+			overlapping++;
+		}
+	}
+	if (overlapping) {
+		fprintf(out, "# the lowest cost per I/O completion was at %d threads/devices, but within the spread of %d other thread counts, so no peak is claimed\n", 
+			spreads[best].threads, overlapping);
+	} else {
+		fprintf(out, "# I/O throughput peaked at %d threads/devices, clear of every other thread count's spread\n", 
+			spreads[best].threads);
+	}
+	if (flat >= 0) {
+		fprintf(out, "# scaling flattened at %d threads/devices (no gain of %.0f%% clear of the spread over %d)\n", 
+			spreads[flat].threads, BENCH_FLAT_GAIN * 100, spreads[flat - 1].threads);
+	} else {
+		fprintf(out, "# scaling did not flatten up to %d threads/devices\n", spreads[count - 1].threads);
+	}
+	fflush(out);
+}
+
+
+void bench_print_whatif_header (FILE * out) {
+	fprintf(out, "variant,policy,seed,forked_at,iterations,wall_s,dispatches,io_completions,"
+		"pcbs_created,pcbs_live,deadlocks,page_faults,fault_rate,access_ns,"
+		"admission_stalls,fragmentation,deferred,rejected,dispatch_latency\n");
+}
+
+
+void bench_print_whatif (FILE * out, bench_whatif_s * result) {
+	fprintf(out, "\"%s\",%s,%u,%u,%lu,%.4f,%lu,%lu,%d,%d,%d,%llu,%.6f,%.1f,%lu,%.4f,%lu,%lu,%.2f\n", result->variant, result->sim.policy,
+		result->sim.seed, result->forkedAt, result->sim.iterations, result->sim.wall_ns / 1e9,
+		result->sim.dispatches, result->ioCompletions, result->created,
+		result->live, result->deadlocks, result->pageFaults, result->faultRate, result->accessNs,
+		result->admissionStalls, result->fragmentation, result->deferred, result->rejected, result->dispatchLatency);
+	fflush(out);
+}
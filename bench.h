@@ -0,0 +1,173 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is a small benchmark harness. A benchmark is a setup, an operation and a 
+	teardown over a caller-owned context. Each repetition runs the setup untimed, times
+	one call of the operation (which does ops units of work) and runs the teardown.
+	The first few repetitions are warmup and are thrown away, and the rest are reported
+	as nanoseconds per unit of work (min, median, p99 and mean) in one CSV line each.
+	
+	It also holds the report the simulators print when they are run in bench mode.
+*/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_DEFAULT_WARMUP 5
+#define BENCH_DEFAULT_REPS 50
+#define BENCH_SIM_ITERATIONS 100000
+#define BENCH_SIM_SEED 1
+#define BENCH_MAX_SAMPLES 65536
+#define BENCH_FLAT_GAIN 0.05 // a step that gains less than this is where scaling has flattened
+#define BENCH_SCALE_WARMUP 1
+#define BENCH_SCALE_REPS 5 // runs per thread count, a fresh simulator each
+#define BENCH_VARIANT_LENGTH 64
+
+
+typedef void (*BenchFn) (void * ctx);
+
+typedef struct bench_result {
+	const char * name;
+	const char * variant; // the occupancy pattern, load factor, etc. being measured
+	int ops; // units of work per repetition
+	int reps;
+	double min;
+	double median;
+	double p99;
+	double mean;
+	double max;
+} bench_result_s;
+
+typedef struct bench_config {
+	int warmup;
+	int reps;
+	FILE * out; // where results are written, kept apart from any trace output
+} bench_config_s;
+
+typedef bench_config_s * BenchConfig;
+
+/* The end-to-end numbers for one seeded simulator run. */
+typedef struct bench_sim_result {
+	const char * simulator;
+	const char * policy;
+	unsigned int seed;
+	unsigned long iterations;
+	double wall_ns;
+	unsigned long dispatches; // PCBs moved into running
+	unsigned long schedulerLocks; // schedulerMutex acquisitions, 0 without threads
+	long peakRSS; // in KB
+} bench_sim_result_s;
+
+/* One run of a thread-scaling benchmark. */
+typedef struct bench_scale_point {
+	int threads; // interrupt-servicing threads
+	int devices; // simulated I/O devices
+	int rep; // which of the runs with this many threads it was
+	bench_sim_result_s sim;
+	unsigned long ioCompletions;
+	unsigned long schedulerContended; // schedulerMutex acquisitions that had to wait
+	double wakeP50; // ns from an I/O completion to the PCB being back in the ready set
+	double wakeP99;
+} bench_scale_point_s;
+
+/* The spread of one thread count's runs, in wall time per I/O completion. */
+typedef struct bench_scale_spread {
+	int threads; // and as many simulated I/O devices
+	bench_result_s nsPerIO;
+} bench_scale_spread_s;
+
+/* The outcome of one what-if child, run on from the same forked state as the others. */
+typedef struct bench_whatif {
+	char variant[BENCH_VARIANT_LENGTH]; // the parameters the child changed
+	unsigned int forkedAt; // the iteration every child started from
+	bench_sim_result_s sim; // everything but the seed counts from the fork
+	unsigned long ioCompletions;
+	int created; // PCBs made since the fork
+	int live; // PCBs that hadn't been freed when the child stopped
+	int deadlocks;
+	unsigned long long pageFaults; // since the fork, 0 when the child ran without virtual memory
+	double faultRate;
+	double accessNs; // the effective memory access time
+	unsigned long admissionStalls; // arrivals turned away since the fork because physical memory was full
+	double fragmentation; // the physical memory's external fragmentation when the child stopped
+	unsigned long deferred; // PCBs admission control held back when they arrived, since the fork
+	unsigned long rejected; // and turned away because its queue was full
+	double dispatchLatency; // mean iterations from joining the ready set to being dispatched, since the fork
+} bench_whatif_s;
+
+
+/*
+ * Returns a monotonic timestamp in nanoseconds.
+ */
+double bench_now ();
+
+/*
+ * Fills in the defaults and reads "reps" and "warmup" from argv[1] and argv[2] when 
+ * they are given. Results go to out.
+ */
+void bench_config_init (BenchConfig config, int argc, char * argv[], FILE * out);
+
+/*
+ * Runs the benchmark as described above and prints its result line. setup and 
+ * teardown may be NULL.
+ *
+ * Return: the per-op timings of the measured repetitions.
+ */
+bench_result_s bench_run (BenchConfig config, const char * name, const char * variant, int ops, 
+		BenchFn setup, BenchFn op, BenchFn teardown, void * ctx);
+
+/*
+ * Sorts the samples and works out their min, median, p99, mean and max.
+ */
+bench_result_s bench_summarize (const char * name, const char * variant, int ops, double * samples, int count);
+
+/*
+ * Prints the CSV column names.
+ */
+void bench_print_header (BenchConfig config);
+
+void bench_print (BenchConfig config, bench_result_s * result);
+
+/*
+ * Returns the process's peak resident set size in KB.
+ */
+long bench_peak_rss ();
+
+/*
+ * Sorts the samples and returns the value at the given fraction (0.99 for p99).
+ */
+double bench_percentile (double * samples, int count, double fraction);
+
+/*
+ * Prints the column names for bench_print_sim.
+ */
+void bench_print_sim_header (FILE * out);
+
+/*
+ * Prints one simulator run as a CSV line, with the rates worked out from the totals.
+ */
+void bench_print_sim (FILE * out, bench_sim_result_s * result);
+
+void bench_print_scale_header (FILE * out);
+
+void bench_print_scale (FILE * out, bench_scale_point_s * point);
+
+/*
+ * Prints each thread count's median wall time per I/O completion with the spread
+ * of its runs, then where it was lowest and the first step that didn't gain. A step
+ * gains when its median is at least BENCH_FLAT_GAIN lower than the one before and
+ * its slowest run beat that one's fastest, and the lowest point is only called the
+ * peak when its spread is clear of every other's.
+ */
+void bench_print_scale_summary (FILE * out, bench_scale_spread_s spreads[], int count);
+
+void bench_print_whatif_header (FILE * out);
+
+void bench_print_whatif (FILE * out, bench_whatif_s * result);
+
+#endif
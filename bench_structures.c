@@ -0,0 +1,369 @@
+// data structure microbenchmarks
+// compile with: gcc -O2 bench_structures.c bench.c priority_queue.c fifo_queue.c mutex_map.c pcb.c threads.c id_alloc.c phys_mem.c -lpthread
+// usage: ./a.out [reps] [warmup] > results.csv
+// times the ready queues, the mutex map, PCB creation and the physical memory's
+// allocators with the bench.h harness.
+// the data structures' own traces are turned off while they run.
+
+#include "bench.h"
+#include "priority_queue.h"
+#include "mutex_map.h"
+#include "phys_mem.h"
+
+#define BENCH_MAX_PCBS 4096
+#define BENCH_MAX_REMOVES 256
+#define BENCH_MEMORY_UNITS (1 << 18)
+#define BENCH_MAX_BLOCKS 16384
+
+
+enum bench_pattern {
+	PATTERN_TOP, // everything at priority 0
+	PATTERN_UNIFORM, // spread evenly over every priority
+	PATTERN_BOTTOM // everything at the lowest priority, so dequeue scans every level
+};
+
+typedef struct bench_ctx {
+	PriorityQueue pq;
+	ReadyQueue q;
+	MutexMap map;
+	PCB pcbs[BENCH_MAX_PCBS];
+	Mutex mutexes[MAX_INIT_BUCKETS];
+	int order[BENCH_MAX_PCBS];
+	int n;
+	enum bench_pattern pattern;
+	PhysMem pm;
+	int policy;
+	int load; // percent of the physical memory in use before timing
+	unsigned int blocks[BENCH_MAX_BLOCKS];
+	unsigned int footprints[BENCH_MAX_BLOCKS];
+	int live;
+} bench_ctx_s;
+
+typedef bench_ctx_s * BenchCtx;
+
+const char * patternNames[] = {"top", "uniform", "bottom"};
+volatile unsigned long benchSink; // keeps lookups from being optimized out
+
+
+/*
+	Gives the first n PCBs priorities that follow the context's pattern and shuffles
+	the order they are removed in.
+*/
+void preparePCBs (BenchCtx ctx) {
+	for (int i = 0; i < ctx->n; i++) {
+		if (ctx->pattern == PATTERN_TOP) {
+			PCB_assign_priority(ctx->pcbs[i], 0);
+		} else if (ctx->pattern == PATTERN_UNIFORM) {
+			PCB_assign_priority(ctx->pcbs[i], i % NUM_PRIORITIES);
+		} else {
+			PCB_assign_priority(ctx->pcbs[i], NUM_PRIORITIES - 1);
+		}
+		ctx->order[i] = i;
+	}
+	for (int i = ctx->n - 1; i > 0; i--) {
+		int j = rand() % (i + 1);
+		int tmp = ctx->order[i];
+		ctx->order[i] = ctx->order[j];
+		ctx->order[j] = tmp;
+	}
+}
+
+
+void pqSetupEmpty (void * arg) {
+	BenchCtx ctx = (BenchCtx) arg;
+	ctx->pq = pq_create();
+}
+
+void pqSetupFull (void * arg) {
+	BenchCtx ctx = (BenchCtx) arg;
+	ctx->pq = pq_create();
+	for (int i = 0; i < ctx->n; i++) {
+		pq_enqueue(ctx->pq, ctx->pcbs[i]);
+	}
+}
+
+void pqTeardown (void * arg) {
+	BenchCtx ctx = (BenchCtx) arg;
+	while (pq_dequeue(ctx->pq)); //the PCBs belong to the context, not the queue
+	pq_destroy(ctx->pq);
+}
+
+void pqEnqueue (void * arg) {
+	BenchCtx ctx = (BenchCtx) arg;
+	for (int i = 0; i < ctx->n; i++) {
+		pq_enqueue(ctx->pq, ctx->pcbs[i]);
+	}
+}
+
+void pqDequeue (void * arg) {
+	BenchCtx ctx = (BenchCtx) arg;
+	for (int i = 0; i < ctx->n; i++) {
+		benchSink += (unsigned long) pq_dequeue(ctx->pq);
+	}
+}
+
+/* The scheduler's pattern: take the head and put it back, with n PCBs resident. */
+void pqCycle (void * arg) {
+	BenchCtx ctx = (BenchCtx) arg;
+	for (int i = 0; i < ctx->n; i++) {
+		pq_enqueue(ctx->pq, pq_dequeue(ctx->pq));
+	}
+}
+
+void pqRemoveMatching (void * arg) {
+	BenchCtx ctx = (BenchCtx) arg;
+	int removes = ctx->n < BENCH_MAX_REMOVES ? ctx->n : BENCH_MAX_REMOVES;
+	for (int i = 0; i < removes; i++) {
+		pq_enqueue(ctx->pq, pq_remove_matching_pcb(ctx->pq, ctx->pcbs[ctx->order[i]]));
+	}
+}
+
+
+void qSetupEmpty (void * arg) {
+	BenchCtx ctx = (BenchCtx) arg;
+	ctx->q = q_create();
+}
+
+void qSetupFull (void * arg) {
+	BenchCtx ctx = (BenchCtx) arg;
+	ctx->q = q_create();
+	for (int i = 0; i < ctx->n; i++) {
+		q_enqueue(ctx->q, ctx->pcbs[i]);
+	}
+}
+
+void qTeardown (void * arg) {
+	BenchCtx ctx = (BenchCtx) arg;
+	while (q_dequeue(ctx->q));
+	q_destroy(ctx->q);
+}
+
+void qEnqueue (void * arg) {
+	BenchCtx ctx = (BenchCtx) arg;
+	for (int i = 0; i < ctx->n; i++) {
+		q_enqueue(ctx->q, ctx->pcbs[i]);
+	}
+}
+
+void qDequeue (void * arg) {
+	BenchCtx ctx = (BenchCtx) arg;
+	for (int i = 0; i < ctx->n; i++) {
+		benchSink += (unsigned long) q_dequeue(ctx->q);
+	}
+}
+
+
+/*
+	Makes n mutexes with random, distinct mids so they collide in the map the way
+	they would after the scheduler has been running for a while.
+*/
+void mapMakeMutexes (BenchCtx ctx) {
+	for (int i = 0; i < ctx->n; i++) {
+		ctx->mutexes[i] = mutex_create();
+		ctx->mutexes[i]->mid = ctx->order[i];
+	}
+}
+
+void mapSetupEmpty (void * arg) {
+	BenchCtx ctx = (BenchCtx) arg;
+	ctx->map = create_mutx_map();
+	mapMakeMutexes(ctx);
+}
+
+void mapSetupFull (void * arg) {
+	BenchCtx ctx = (BenchCtx) arg;
+	mapSetupEmpty(arg);
+	for (int i = 0; i < ctx->n; i++) {
+		add_to_mutx_map(ctx->map, ctx->mutexes[i], ctx->mutexes[i]->mid);
+	}
+}
+
+void mapTeardown (void * arg) {
+	BenchCtx ctx = (BenchCtx) arg;
+	mutex_map_destroy(ctx->map);
+}
+
+void mapAdd (void * arg) {
+	BenchCtx ctx = (BenchCtx) arg;
+	for (int i = 0; i < ctx->n; i++) {
+		add_to_mutx_map(ctx->map, ctx->mutexes[i], ctx->mutexes[i]->mid);
+	}
+}
+
+void mapGet (void * arg) {
+	BenchCtx ctx = (BenchCtx) arg;
+	for (int i = 0; i < ctx->n; i++) {
+		benchSink += (unsigned long) get_mutx(ctx->map, ctx->mutexes[(i * 7) % ctx->n]->mid);
+	}
+}
+
+/* Removed newest first, remove_from_mutx_map can't probe past a slot that was emptied. */
+void mapRemove (void * arg) {
+	BenchCtx ctx = (BenchCtx) arg;
+	for (int i = ctx->n - 1; i >= 0; i--) {
+		remove_from_mutx_map(ctx->map, ctx->mutexes[i]->mid);
+	}
+}
+
+
+void pcbCreate (void * arg) {
+	BenchCtx ctx = (BenchCtx) arg;
+	for (int i = 0; i < ctx->n; i++) {
+		ctx->pcbs[i] = PCB_create();
+	}
+}
+
+void pcbDestroyAll (void * arg) {
+	BenchCtx ctx = (BenchCtx) arg;
+	for (int i = 0; i < ctx->n; i++) {
+		PCB_destroy(ctx->pcbs[i]);
+	}
+}
+
+
+/*
+	A footprint drawn from the random value the way PCB_create draws them.
+*/
+unsigned int benchFootprint (unsigned int r) {
+	unsigned int units = MIN_FOOTPRINT << (r % FOOTPRINT_DOUBLINGS);
+	return units + (r / FOOTPRINT_DOUBLINGS) % units;
+}
+
+/*
+	Frees the live block at index j and allocates one of a new footprint in its 
+	place, or drops it from the live blocks if the new one doesn't fit.
+*/
+void pmReplace (BenchCtx ctx, int j, unsigned int r) {
+	pm_free(ctx->pm, ctx->blocks[j], ctx->footprints[j]);
+	ctx->footprints[j] = benchFootprint(r);
+	ctx->blocks[j] = pm_alloc(ctx->pm, ctx->footprints[j]);
+	if (ctx->blocks[j] == PM_NONE) {
+		ctx->live--;
+		ctx->blocks[j] = ctx->blocks[ctx->live];
+		ctx->footprints[j] = ctx->footprints[ctx->live];
+	}
+}
+
+/*
+	Fills the physical memory to the context's load and then churns it for a while,
+	so the free blocks are as fragmented as a long run would leave them.
+*/
+void pmSetup (void * arg) {
+	BenchCtx ctx = (BenchCtx) arg;
+	unsigned int target = (unsigned int) ((unsigned long long) BENCH_MEMORY_UNITS * ctx->load / 100);
+	
+	ctx->pm = pm_create(ctx->policy, BENCH_MEMORY_UNITS);
+	ctx->live = 0;
+	for (int i = 0; i < BENCH_MEMORY_UNITS / 16; i++) {
+		if (ctx->pm->stats.usedUnits < target && ctx->live < BENCH_MAX_BLOCKS) {
+			ctx->footprints[ctx->live] = benchFootprint(rand());
+			ctx->blocks[ctx->live] = pm_alloc(ctx->pm, ctx->footprints[ctx->live]);
+			if (ctx->blocks[ctx->live] != PM_NONE) {
+				ctx->live++;
+			}
+		} else if (ctx->live) {
+			pmReplace(ctx, rand() % ctx->live, rand());
+		}
+	}
+	for (int i = 0; i < ctx->n; i++) {
+		ctx->order[i] = rand();
+	}
+}
+
+void pmTeardown (void * arg) {
+	BenchCtx ctx = (BenchCtx) arg;
+	pm_destroy(ctx->pm);
+}
+
+void pmChurn (void * arg) { //one free and one allocation per op
+	BenchCtx ctx = (BenchCtx) arg;
+	for (int i = 0; i < ctx->n && ctx->live; i++) {
+		pmReplace(ctx, ctx->order[i] % ctx->live, ctx->order[(i + 1) % ctx->n]);
+	}
+}
+
+
+/*
+	Picks n distinct random mids for the map benchmarks.
+*/
+void prepareMids (BenchCtx ctx) {
+	for (int i = 0; i < ctx->n; i++) {
+		int unique = 0;
+		while (!unique) {
+			ctx->order[i] = 1 + rand() % (MAX_INIT_BUCKETS * 50);
+			unique = 1;
+			for (int j = 0; j < i; j++) {
+				if (ctx->order[j] == ctx->order[i]) {
+					unique = 0;
+				}
+			}
+		}
+	}
+}
+
+
+int main (int argc, char * argv[]) {
+	static bench_ctx_s ctx;
+	bench_config_s config;
+	int sizes[] = {16, 256, BENCH_MAX_PCBS};
+	int loads[] = {25, 50, 75, 90};
+	char variant[64];
+	
+	traceEnabled = 0;
+	srand(1);
+	bench_config_init(&config, argc, argv, stdout);
+	bench_print_header(&config);
+	
+	for (int i = 0; i < BENCH_MAX_PCBS; i++) {
+		ctx.pcbs[i] = PCB_create();
+	}
+	
+	for (int s = 0; s < (int) (sizeof(sizes) / sizeof(sizes[0])); s++) {
+		ctx.n = sizes[s];
+		for (int p = PATTERN_TOP; p <= PATTERN_BOTTOM; p++) {
+			ctx.pattern = p;
+			preparePCBs(&ctx);
+			sprintf(variant, "%s/%d", patternNames[p], ctx.n);
+			bench_run(&config, "pq_enqueue", variant, ctx.n, pqSetupEmpty, pqEnqueue, pqTeardown, &ctx);
+			bench_run(&config, "pq_dequeue", variant, ctx.n, pqSetupFull, pqDequeue, pqTeardown, &ctx);
+			bench_run(&config, "pq_cycle", variant, ctx.n, pqSetupFull, pqCycle, pqTeardown, &ctx);
+			bench_run(&config, "pq_remove_matching_pcb", variant, 
+				ctx.n < BENCH_MAX_REMOVES ? ctx.n : BENCH_MAX_REMOVES, pqSetupFull, pqRemoveMatching, pqTeardown, &ctx);
+		}
+		
+		sprintf(variant, "%d", ctx.n);
+		bench_run(&config, "q_enqueue", variant, ctx.n, qSetupEmpty, qEnqueue, qTeardown, &ctx);
+		bench_run(&config, "q_dequeue", variant, ctx.n, qSetupFull, qDequeue, qTeardown, &ctx);
+	}
+	
+	for (int l = 0; l < (int) (sizeof(loads) / sizeof(loads[0])); l++) {
+		ctx.n = MAX_INIT_BUCKETS * loads[l] / 100;
+		prepareMids(&ctx);
+		sprintf(variant, "load%d", loads[l]);
+		bench_run(&config, "add_to_mutx_map", variant, ctx.n, mapSetupEmpty, mapAdd, mapTeardown, &ctx);
+		bench_run(&config, "get_mutx", variant, ctx.n, mapSetupFull, mapGet, mapTeardown, &ctx);
+		bench_run(&config, "remove_from_mutx_map", variant, ctx.n, mapSetupFull, mapRemove, mapTeardown, &ctx);
+	}
+	
+	for (int i = 0; i < BENCH_MAX_PCBS; i++) {
+		PCB_destroy(ctx.pcbs[i]);
+	}
+	for (int s = 0; s < (int) (sizeof(sizes) / sizeof(sizes[0])); s++) {
+		ctx.n = sizes[s];
+		sprintf(variant, "%d", ctx.n);
+		bench_run(&config, "PCB_create", variant, ctx.n, NULL, pcbCreate, pcbDestroyAll, &ctx);
+		bench_run(&config, "PCB_destroy", variant, ctx.n, pcbCreate, pcbDestroyAll, NULL, &ctx);
+	}
+	
+	ctx.n = BENCH_MAX_PCBS;
+	for (int p = 0; p < PM_POLICY_COUNT; p++) {
+		ctx.policy = p;
+		for (int l = 0; l < (int) (sizeof(loads) / sizeof(loads[0])); l++) {
+			ctx.load = loads[l];
+			sprintf(variant, "%s/load%d", pmPolicyNames[p], loads[l]);
+			bench_run(&config, "pm_churn", variant, ctx.n, pmSetup, pmChurn, pmTeardown, &ctx);
+		}
+	}
+	
+	return 0;
+}
@@ -0,0 +1,70 @@
+// trap-PC matcher benchmark
+// compile with: gcc -O2 -march=native bench_trap_match.c trap_match.c pcb.c id_alloc.c phys_mem.c threads.c -lpthread
+// times trap_match_arrays against trap_match_arrays_scalar over the eight
+// trap arrays for a few array lengths and checks both give the same masks
+
+#include "trap_match.h"
+#include <time.h>
+
+#define BENCH_MAX_COUNT 64
+#define BENCH_PCS 4096
+#define BENCH_ROUNDS 200
+
+
+double benchNow () {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+double benchRun (unsigned int (*match) (const unsigned int **, int, unsigned int), 
+		const unsigned int * arrays[], int count, unsigned int * pcs, unsigned int * sink) {
+	double start = benchNow();
+	unsigned int acc = 0;
+	
+	for (int r = 0; r < BENCH_ROUNDS; r++) {
+		for (int i = 0; i < BENCH_PCS; i++) {
+			acc += match(arrays, count, pcs[i]);
+		}
+	}
+	*sink += acc;
+	
+	return (benchNow() - start) * 1e9 / ((double) BENCH_ROUNDS * BENCH_PCS);
+}
+
+
+int main () {
+	static unsigned int traps[TRAP_ARRAY_COUNT][BENCH_MAX_COUNT];
+	const unsigned int * arrays[TRAP_ARRAY_COUNT];
+	unsigned int pcs[BENCH_PCS];
+	unsigned int sink = 0;
+	int counts[] = {4, 16, 64};
+	
+	srand(1);
+	for (int a = 0; a < TRAP_ARRAY_COUNT; a++) {
+		for (int i = 0; i < BENCH_MAX_COUNT; i++) {
+			traps[a][i] = rand() % MAX_PC_RANGE;
+		}
+		arrays[a] = traps[a];
+	}
+	for (int i = 0; i < BENCH_PCS; i++) {
+		pcs[i] = rand() % MAX_PC_RANGE;
+	}
+	
+	printf("trap_match isa: %s\r\n", trap_match_isa());
+	printf("count,simd_ns,scalar_ns,speedup\r\n");
+	for (int c = 0; c < (int) (sizeof(counts) / sizeof(counts[0])); c++) {
+		for (int i = 0; i < BENCH_PCS; i++) {
+			if (trap_match_arrays(arrays, counts[c], pcs[i]) != trap_match_arrays_scalar(arrays, counts[c], pcs[i])) {
+				printf("mismatch at count %d pc %u\r\n", counts[c], pcs[i]);
+				return 1;
+			}
+		}
+		double simd = benchRun(trap_match_arrays, arrays, counts[c], pcs, &sink);
+		double scalar = benchRun(trap_match_arrays_scalar, arrays, counts[c], pcs, &sink);
+		printf("%d,%.2f,%.2f,%.2f\r\n", counts[c], simd, scalar, scalar / simd);
+	}
+	
+	return sink == 0xFFFFFFFF;
+}
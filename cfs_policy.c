@@ -0,0 +1,197 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	The completely fair policy. Every PCB accumulates a virtual runtime, which is the
+	time it has run scaled down by its weight, and the PCB with the smallest vruntime
+	always runs next. A PCB's priority is used as its nice value, so lower priority
+	numbers get a larger weight and a larger share of the CPU. The ready PCBs are kept
+	in a red-black tree ordered by vruntime.
+*/
+
+#include "cfs_policy.h"
+
+/* Weights for nice values 0 to 15, each step is about 25% less CPU. */
+const unsigned int cfsWeights[NUM_PRIORITIES] = {
+	1024, 820, 655, 526, 423, 335, 272, 215,
+	172, 137, 110, 87, 70, 56, 45, 36
+};
+
+typedef struct cfs_data {
+	RBTree tree;
+	unsigned long long min_vruntime; // never moves backwards
+	unsigned long long total_weight; // sum of the weights in the tree
+} cfs_data_s;
+
+typedef cfs_data_s * CFSData;
+
+
+unsigned int cfs_weight (PCB pcb) {
+	return cfsWeights[pcb->priority < NUM_PRIORITIES ? pcb->priority : NUM_PRIORITIES - 1];
+}
+
+
+/*
+	Adds the time the PCB has run since it was dispatched to its vruntime, scaled by
+	its weight. Does nothing if the PCB isn't running.
+*/
+void cfs_charge (SchedPolicy policy, PCB pcb) {
+	unsigned long long ran = 0;
+
+	if (pcb->exec_start != (unsigned int) -1) {
+		if (policy->clock > pcb->exec_start) {
+			ran = policy->clock - pcb->exec_start;
+		}
+		pcb->run_time += ran;
+		pcb->vruntime += (ran << CFS_VRUNTIME_SHIFT) * CFS_NICE_0_WEIGHT / cfs_weight(pcb);
+		pcb->exec_start = -1;
+	}
+}
+
+
+/*
+	A PCB coming off the CPU is charged for the time it ran. Any other PCB, new or
+	woken from I/O, is moved up to min_vruntime less a small credit, so one that slept
+	for a long time can't starve the rest while it catches up.
+*/
+void cfs_enqueue (SchedPolicy policy, PCB pcb) {
+	CFSData cfs = (CFSData) policy->data;
+	unsigned long long floor = 0;
+
+	if (pcb->exec_start != (unsigned int) -1) {
+		cfs_charge(policy, pcb);
+	} else {
+		floor = (unsigned long long) CFS_WAKEUP_CREDIT << CFS_VRUNTIME_SHIFT;
+		floor = cfs->min_vruntime > floor ? cfs->min_vruntime - floor : 0;
+		if (pcb->vruntime < floor) {
+			pcb->vruntime = floor;
+		}
+	}
+
+	if (rbt_insert(cfs->tree, pcb)) {
+		cfs->total_weight += cfs_weight(pcb);
+	} else {
+		trace("\t\t\tCFS COULDN'T ALLOCATE A NODE FOR P%d\t\t\t\r\n", pcb->pid);
+	}
+}
+
+
+PCB cfs_pick_next (SchedPolicy policy) {
+	CFSData cfs = (CFSData) policy->data;
+	PCB pcb = rbt_pop_min(cfs->tree);
+
+	if (pcb) {
+		cfs->total_weight -= cfs_weight(pcb);
+		if (pcb->vruntime > cfs->min_vruntime) {
+			cfs->min_vruntime = pcb->vruntime;
+		}
+		pcb->exec_start = policy->clock;
+	}
+
+	return pcb;
+}
+
+
+PCB cfs_peek (SchedPolicy policy) {
+	return rbt_peek_min(((CFSData) policy->data)->tree);
+}
+
+
+PCB cfs_remove (SchedPolicy policy, PCB pcb) {
+	CFSData cfs = (CFSData) policy->data;
+	PCB found = rbt_remove(cfs->tree, pcb);
+
+	if (found) {
+		cfs->total_weight -= cfs_weight(found);
+	}
+
+	return found;
+}
+
+
+/*
+	The running PCB gets its weighted share of CFS_SCHED_LATENCY, counting itself 
+	along with everything still waiting, but never less than CFS_MIN_GRANULARITY.
+*/
+unsigned int cfs_quantum (SchedPolicy policy, PCB pcb) {
+	CFSData cfs = (CFSData) policy->data;
+	unsigned int weight = cfs_weight(pcb);
+	unsigned long long slice = (unsigned long long) CFS_SCHED_LATENCY * weight / (cfs->total_weight + weight);
+
+	return slice < CFS_MIN_GRANULARITY ? CFS_MIN_GRANULARITY : (unsigned int) slice;
+}
+
+
+void cfs_on_block (SchedPolicy policy, PCB pcb) {
+	cfs_charge(policy, pcb);
+}
+
+
+int cfs_count (SchedPolicy policy) {
+	return ((CFSData) policy->data)->tree->size;
+}
+
+
+void cfs_print (SchedPolicy policy) {
+	CFSData cfs = (CFSData) policy->data;
+
+	trace("min_vruntime: %llu, total weight: %llu\r\n", cfs->min_vruntime, cfs->total_weight);
+	trace("Q:Count=%d: ", cfs->tree->size);
+	toStringRBTree(cfs->tree);
+}
+
+
+void cfs_checkpoint (SchedPolicy policy, Checkpoint ckpt) {
+	CFSData cfs = (CFSData) policy->data;
+
+	ckpt_value(ckpt, cfs->min_vruntime);
+	ckpt_value(ckpt, cfs->total_weight);
+	ckpt_rb_tree(cfs->tree, ckpt);
+}
+
+
+void cfs_destroy (SchedPolicy policy) {
+	CFSData cfs = (CFSData) policy->data;
+
+	rbt_destroy(cfs->tree);
+	free(cfs);
+	policy->data = NULL;
+}
+
+
+/*
+ * Creates a CFS policy backed by a red-black tree.
+ *
+ * Return: the new policy, NULL on failure.
+ */
+SchedPolicy cfs_policy_create () {
+	SchedPolicy policy = policy_alloc("cfs");
+	CFSData cfs = NULL;
+
+	if (policy != NULL) {
+		cfs = (CFSData) malloc(sizeof(struct cfs_data));
+		if (cfs != NULL) {
+			cfs->tree = rbt_create();
+		}
+		if (cfs == NULL || cfs->tree == NULL) {
+			free(cfs);
+			free(policy);
+			return NULL;
+		}
+		cfs->min_vruntime = 0;
+		cfs->total_weight = 0;
+		policy->data = cfs;
+		policy->enqueue = cfs_enqueue;
+		policy->pick_next = cfs_pick_next;
+		policy->peek = cfs_peek;
+		policy->remove = cfs_remove;
+		policy->quantum = cfs_quantum;
+		policy->on_block = cfs_on_block;
+		policy->count = cfs_count;
+		policy->print = cfs_print;
+		policy->checkpoint = cfs_checkpoint;
+		policy->destroy = cfs_destroy;
+	}
+
+	return policy;
+}
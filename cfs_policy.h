@@ -0,0 +1,32 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	The completely fair policy. Every PCB accumulates a virtual runtime, which is the
+	time it has run scaled down by its weight, and the PCB with the smallest vruntime
+	always runs next. A PCB's priority is used as its nice value, so lower priority
+	numbers get a larger weight and a larger share of the CPU. The ready PCBs are kept
+	in a red-black tree ordered by vruntime.
+*/
+
+#ifndef CFS_POLICY_H
+#define CFS_POLICY_H
+
+#include "sched_policy.h"
+#include "rb_tree.h"
+
+#define CFS_NICE_0_WEIGHT 1024
+#define CFS_VRUNTIME_SHIFT 10 // vruntime is kept in 1/1024ths of an iteration
+#define CFS_SCHED_LATENCY 48 // every ready PCB should run once in this many iterations
+#define CFS_MIN_GRANULARITY 4 // the shortest slice a PCB is given
+#define CFS_WAKEUP_CREDIT (CFS_SCHED_LATENCY / 2) // how far behind min_vruntime a woken PCB may start
+
+
+/*
+ * Creates a CFS policy backed by a red-black tree.
+ *
+ * Return: the new policy, NULL on failure.
+ */
+SchedPolicy cfs_policy_create ();
+
+#endif
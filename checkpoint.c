@@ -0,0 +1,591 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is the file format for simulator checkpoints. A Checkpoint is either being
+	written or being loaded, and every structure that is part of the simulator's state
+	has one checkpoint function that handles both directions: scalars are passed to
+	ckpt_value, which writes or reads them in place, and containers are walked by the
+	ckpt_ functions here, which write their contents in order and rebuild them from
+	that order when loading. The containers themselves know nothing of checkpoints, so
+	each still links on its own. PCBs are
+	saved once in the PCB table and everything else refers to them by their slot, which
+	restoring gives back to each PCB, so the restored table hands out the same slots.
+	Nothing is padded or aligned, and pointers are never written.
+*/
+
+#include "checkpoint.h"
+
+
+/*
+ * Opens a checkpoint file for writing, or for loading if loading is set, and checks
+ * or writes the magic number.
+ *
+ * Return: the checkpoint, NULL if the file couldn't be opened or isn't a checkpoint.
+ */
+Checkpoint ckpt_open (const char * path, int loading) {
+	Checkpoint ckpt = (Checkpoint) malloc(sizeof(struct checkpoint));
+	char magic[sizeof(CKPT_MAGIC)] = CKPT_MAGIC;
+
+	if (ckpt == NULL) {
+		return NULL;
+	}
+	ckpt->loading = loading;
+	ckpt->failed = 0;
+	ckpt->file = fopen(path, loading ? "rb" : "wb");
+	if (ckpt->file == NULL) {
+		free(ckpt);
+		return NULL;
+	}
+
+	ckpt_bytes(ckpt, magic, sizeof(magic));
+	if (ckpt->failed || memcmp(magic, CKPT_MAGIC, sizeof(magic))) {
+		fclose(ckpt->file);
+		free(ckpt);
+		return NULL;
+	}
+
+	return ckpt;
+}
+
+
+/*
+ * Closes the file and frees the checkpoint.
+ *
+ * Return: 1 if every read or write succeeded, 0 otherwise.
+ */
+int ckpt_close (Checkpoint ckpt) {
+	int ok = !ckpt->failed;
+
+	if (fclose(ckpt->file)) {
+		ok = 0;
+	}
+	free(ckpt);
+
+	return ok;
+}
+
+
+void ckpt_bytes (Checkpoint ckpt, void * data, size_t size) {
+	size_t done = 0;
+
+	if (ckpt->failed || !size) {
+		return;
+	}
+	if (ckpt->loading) {
+		done = fread(data, size, 1, ckpt->file);
+	} else {
+		done = fwrite(data, size, 1, ckpt->file);
+	}
+	if (done != 1) {
+		ckpt_fail(ckpt, ckpt->loading ? "checkpoint is truncated" : "couldn't write checkpoint");
+	}
+}
+
+
+void ckpt_fail (Checkpoint ckpt, const char * reason) {
+	if (!ckpt->failed) {
+		fprintf(stderr, "%s\r\n", reason);
+	}
+	ckpt->failed = 1;
+}
+
+
+/*
+ * Writes or reads a string. When loading, the string is allocated and the caller
+ * frees it.
+ */
+void ckpt_string (Checkpoint ckpt, char ** string) {
+	unsigned int length = 0;
+
+	if (!ckpt->loading) {
+		length = strlen(*string);
+		ckpt_value(ckpt, length);
+		ckpt_bytes(ckpt, *string, length);
+		return;
+	}
+
+	*string = NULL;
+	ckpt_value(ckpt, length);
+	if (ckpt->failed) {
+		return;
+	}
+	*string = (char *) malloc(length + 1);
+	if (*string == NULL) {
+		ckpt_fail(ckpt, "out of memory reading checkpoint");
+		return;
+	}
+	ckpt_bytes(ckpt, *string, length);
+	(*string)[length] = '\0';
+}
+
+
+/*
+ * Writes or reads a PCB as a reference to its slot in the PCB table. A PCB that
+ * isn't in the table is written as NULL.
+ */
+void ckpt_pcb_ref (Checkpoint ckpt, PCB * pcb) {
+	int slot = CKPT_NONE;
+
+	if (!ckpt->loading) {
+		//compared by address only, so a stale pointer to a freed PCB is never read
+		for (int i = 0; *pcb && pcbTable && i < pcbTable->used; i++) {
+			if (pcbTable->pcbs[i] == *pcb) {
+				slot = i;
+				break;
+			}
+		}
+		ckpt_value(ckpt, slot);
+		return;
+	}
+
+	*pcb = NULL;
+	ckpt_value(ckpt, slot);
+	if (ckpt->failed || slot == CKPT_NONE) {
+		return;
+	}
+	if (slot < 0 || !pcbTable || slot >= pcbTable->used || !pcbTable->pcbs[slot]) {
+		ckpt_fail(ckpt, "checkpoint refers to a PCB that isn't in it");
+		return;
+	}
+	*pcb = pcbTable->pcbs[slot];
+}
+
+
+/*
+	Writes or reads every field of a PCB and its context except the pointers.
+*/
+void ckpt_pcb (Checkpoint ckpt, PCB pcb) {
+	ckpt_value(ckpt, pcb->pid);
+	ckpt_value(ckpt, pcb->state);
+	ckpt_value(ckpt, pcb->role);
+	ckpt_value(ckpt, pcb->parent);
+	ckpt_value(ckpt, pcb->priority);
+	ckpt_value(ckpt, pcb->size);
+	ckpt_value(ckpt, pcb->channel_no);
+	ckpt_value(ckpt, pcb->max_pc);
+	ckpt_value(ckpt, pcb->creation);
+	ckpt_value(ckpt, pcb->termination);
+	ckpt_value(ckpt, pcb->terminate);
+	ckpt_value(ckpt, pcb->term_count);
+	ckpt_value(ckpt, pcb->blocked_timer);
+	ckpt_value(ckpt, pcb->io_done_at);
+	ckpt_value(ckpt, pcb->vruntime);
+	ckpt_value(ckpt, pcb->exec_start);
+	ckpt_value(ckpt, pcb->run_time);
+	ckpt_value(ckpt, pcb->tickets);
+	ckpt_value(ckpt, pcb->pass);
+	ckpt_value(ckpt, pcb->ready_index);
+	ckpt_value(ckpt, pcb->ready_at);
+	ckpt_value(ckpt, pcb->location);
+	ckpt_value(ckpt, pcb->fault_page);
+	ckpt_value(ckpt, pcb->footprint);
+	ckpt_value(ckpt, pcb->phys_block);
+	ckpt_value(ckpt, pcb->time_slice);
+	ckpt_value(ckpt, pcb->sleep_avg);
+	ckpt_value(ckpt, pcb->sleep_start);
+	ckpt_value(ckpt, pcb->rt_period);
+	ckpt_value(ckpt, pcb->rt_budget);
+	ckpt_value(ckpt, pcb->rt_used);
+	ckpt_value(ckpt, pcb->rt_deadline);
+	ckpt_value(ckpt, pcb->lock_pc);
+	ckpt_value(ckpt, pcb->unlock_pc);
+	ckpt_value(ckpt, pcb->signal_pc);
+	ckpt_value(ckpt, pcb->wait_pc);
+	ckpt_value(ckpt, pcb->io_1_traps);
+	ckpt_value(ckpt, pcb->io_2_traps);
+	ckpt_value(ckpt, pcb->lockR1);
+	ckpt_value(ckpt, pcb->lockR2);
+	ckpt_value(ckpt, pcb->unlockR1);
+	ckpt_value(ckpt, pcb->unlockR2);
+	ckpt_value(ckpt, pcb->wait_cond);
+	ckpt_value(ckpt, pcb->signal_cond);
+	ckpt_value(ckpt, pcb->mutex_R1_id);
+	ckpt_value(ckpt, pcb->mutex_R2_id);
+	ckpt_value(ckpt, pcb->isProducer);
+	ckpt_value(ckpt, pcb->isConsumer);
+	ckpt_value(ckpt, *pcb->context);
+}
+
+
+/*
+ * Writes a Mutex with its PCBs as references, or reads one back into a newly created
+ * Mutex. Every Mutex lives in exactly one place, so it is saved where it lives.
+ */
+void ckpt_mutex (Checkpoint ckpt, Mutex * mutex) {
+	unsigned int nextMID = global_largest_MID;
+	
+	if (ckpt->loading) {
+		*mutex = mutex_create();
+		global_largest_MID = nextMID; //the counter is restored on its own, creating doesn't count
+	}
+	ckpt_value(ckpt, (*mutex)->mid);
+	ckpt_value(ckpt, (*mutex)->isLocked);
+	ckpt_pcb_ref(ckpt, &(*mutex)->pcb1);
+	ckpt_pcb_ref(ckpt, &(*mutex)->pcb2);
+	ckpt_pcb_ref(ckpt, &(*mutex)->hasLock);
+	ckpt_pcb_ref(ckpt, &(*mutex)->blocked);
+	ckpt_value(ckpt, (*mutex)->condVar->signal);
+}
+
+
+/*
+	Allocates a zeroed PCB and context to load a checkpointed PCB into.
+*/
+PCB ckpt_alloc_pcb () {
+	PCB pcb = (PCB) calloc(1, sizeof(struct pcb));
+
+	if (pcb != NULL) {
+		pcb->context = (CPU_context_p) calloc(1, sizeof(struct cpu_context));
+		if (pcb->context == NULL) {
+			free(pcb);
+			pcb = NULL;
+		}
+	}
+
+	return pcb;
+}
+
+
+/*
+ * Writes every live PCB in the table along with the table's free slot stack, or
+ * reads them back, creating each PCB in its original slot. Must be loaded into an
+ * empty table and before anything that refers to a PCB.
+ */
+void ckpt_pcb_table (Checkpoint ckpt) {
+	int used = pcbTable ? pcbTable->used : 0;
+	int freeCount = pcbTable ? pcbTable->freeCount : 0;
+	int live = pcbTable ? pcbTable->live : 0;
+	int slot = 0;
+	PCB pcb = NULL;
+
+	ckpt_value(ckpt, used);
+	ckpt_value(ckpt, freeCount);
+	ckpt_value(ckpt, live);
+	if (ckpt->failed) {
+		return;
+	}
+
+	if (!ckpt->loading) {
+		ckpt_bytes(ckpt, pcbTable ? pcbTable->freeSlots : NULL, freeCount * sizeof(int));
+		for (int i = 0; i < used; i++) {
+			if (pcbTable->pcbs[i]) {
+				ckpt_value(ckpt, i);
+				ckpt_pcb(ckpt, pcbTable->pcbs[i]);
+			}
+		}
+		return;
+	}
+
+	if ((pcbTable && pcbTable->live) || used < 0 || freeCount < 0 || live < 0
+			|| freeCount > used || live > used || !pt_reserve(used)) {
+		ckpt_fail(ckpt, "couldn't restore the PCB table");
+		return;
+	}
+	ckpt_bytes(ckpt, pcbTable->freeSlots, freeCount * sizeof(int));
+	for (int i = 0; i < live && !ckpt->failed; i++) {
+		ckpt_value(ckpt, slot);
+		if (ckpt->failed) {
+			break;
+		}
+		if (slot < 0 || slot >= used || pcbTable->pcbs[slot] || !(pcb = ckpt_alloc_pcb())) {
+			ckpt_fail(ckpt, "couldn't restore a PCB");
+			break;
+		}
+		ckpt_pcb(ckpt, pcb);
+		if (!ckpt->failed && !PCB_restore_PID(pcb)) {
+			ckpt_fail(ckpt, "couldn't restore a PCB's PID, two PCBs have it or memory ran out");
+			free(pcb->context);
+			free(pcb);
+			break;
+		}
+		pt_place(pcb, slot);
+	}
+	pcbTable->used = used;
+	pcbTable->freeCount = freeCount;
+}
+
+
+/*
+ * Writes the queue's PCBs in order along with when each was enqueued, or reads them
+ * back into an empty queue.
+ */
+void ckpt_queue (ReadyQueue FIFOq, Checkpoint ckpt) {
+	ReadyQueueNode curr = FIFOq->first_node;
+	unsigned int size = FIFOq->size;
+	PCB pcb = NULL;
+	
+	ckpt_value(ckpt, FIFOq->quantum_size);
+	ckpt_value(ckpt, size);
+	if (!ckpt->loading) {
+		while (curr) {
+			ckpt_pcb_ref(ckpt, &curr->pcb);
+			ckpt_value(ckpt, curr->enqueued);
+			curr = curr->next;
+		}
+		return;
+	}
+	
+	for (unsigned int i = 0; i < size && !ckpt->failed; i++) {
+		ckpt_pcb_ref(ckpt, &pcb);
+		if (!pcb || !q_enqueue(FIFOq, pcb)) {
+			ckpt_fail(ckpt, "couldn't restore a queue");
+			break;
+		}
+		ckpt_value(ckpt, FIFOq->last_node->enqueued);
+	}
+}
+
+
+/*
+ * Writes the Mutexes in a queue of Mutexes in order, or reads them back into an 
+ * empty queue.
+ */
+void ckpt_mutex_queue (ReadyQueue FIFOq, Checkpoint ckpt) {
+	ReadyQueueNode curr = FIFOq->first_node;
+	unsigned int size = FIFOq->size;
+	Mutex mutex = NULL;
+	
+	ckpt_value(ckpt, size);
+	if (!ckpt->loading) {
+		while (curr) {
+			ckpt_mutex(ckpt, &curr->mutex);
+			curr = curr->next;
+		}
+		return;
+	}
+	
+	for (unsigned int i = 0; i < size && !ckpt->failed; i++) {
+		ckpt_mutex(ckpt, &mutex);
+		if (!q_enqueue_m(FIFOq, mutex)) {
+			mutex_destroy(mutex);
+			ckpt_fail(ckpt, "couldn't restore a queue of Mutexes");
+		}
+	}
+}
+
+
+/*
+ * Writes or reads the clock and every level in order.
+ */
+void ckpt_priority_queue(PriorityQueue PQ, Checkpoint ckpt) {
+	ckpt_value(ckpt, PQ->clock);
+	for (int i = 0; i < NUM_PRIORITIES; i++) {
+		ckpt_queue(PQ->queues[i], ckpt);
+	}
+}
+
+
+/*
+ * Writes every bucket, its collision flag and the Mutex in it, or reads them back
+ * into an empty map so every Mutex ends up in the bucket it was in.
+ */
+void ckpt_mutex_map (MutexMap theMap, Checkpoint ckpt) {
+	int count = 0, bucket = 0;
+	
+	ckpt_value(ckpt, theMap->curr_map_size);
+	ckpt_value(ckpt, theMap->hadCol);
+	for (int i = 0; i < MAX_INIT_BUCKETS; i++) {
+		count += theMap->map[i] != NULL;
+	}
+	ckpt_value(ckpt, count);
+	if (!ckpt->loading) {
+		for (int i = 0; i < MAX_INIT_BUCKETS; i++) {
+			if (theMap->map[i]) {
+				ckpt_value(ckpt, i);
+				ckpt_mutex(ckpt, &theMap->map[i]);
+			}
+		}
+		return;
+	}
+	
+	for (int i = 0; i < count && !ckpt->failed; i++) {
+		ckpt_value(ckpt, bucket);
+		if (ckpt->failed || bucket < 0 || bucket >= MAX_INIT_BUCKETS || theMap->map[bucket]) {
+			ckpt_fail(ckpt, "couldn't restore the Mutex map");
+			break;
+		}
+		ckpt_mutex(ckpt, &theMap->map[bucket]);
+	}
+}
+
+
+/*
+ * Writes the clock and every scheduled event with the level and slot it sits in, or
+ * reads them back into an empty wheel. Events that share a deadline fire in the order
+ * their slots happen to hold them, so the layout is restored exactly rather than by
+ * scheduling the events again. marked is the one event the caller keeps a pointer to
+ * (the quantum), it is pointed at the restored copy when loading.
+ */
+void ckpt_timer_wheel (TimerWheel wheel, Checkpoint ckpt, TimerEvent * marked) {
+	unsigned int count = wheel->count;
+	TimerEvent event = NULL;
+	int isMarked = 0, level = 0, slot = 0;
+
+	ckpt_value(ckpt, wheel->now);
+	ckpt_value(ckpt, wheel->next);
+	ckpt_value(ckpt, count);
+	if (!ckpt->loading) {
+		for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+			for (slot = 0; slot < TIMER_WHEEL_SLOTS; slot++) {
+				for (event = wheel->slots[level][slot]; event; event = event->next) {
+					isMarked = event == *marked;
+					ckpt_value(ckpt, level);
+					ckpt_value(ckpt, slot);
+					ckpt_value(ckpt, event->deadline);
+					ckpt_value(ckpt, event->type);
+					ckpt_pcb_ref(ckpt, &event->pcb);
+					ckpt_value(ckpt, isMarked);
+				}
+			}
+		}
+		return;
+	}
+
+	*marked = NULL;
+	if (wheel->count) {
+		ckpt_fail(ckpt, "couldn't restore the timer wheel");
+		return;
+	}
+	for (unsigned int i = 0; i < count && !ckpt->failed; i++) {
+		event = (TimerEvent) malloc(sizeof(struct timer_event));
+		if (event == NULL) {
+			ckpt_fail(ckpt, "out of memory restoring the timer wheel");
+			break;
+		}
+		ckpt_value(ckpt, level);
+		ckpt_value(ckpt, slot);
+		ckpt_value(ckpt, event->deadline);
+		ckpt_value(ckpt, event->type);
+		ckpt_pcb_ref(ckpt, &event->pcb);
+		ckpt_value(ckpt, isMarked);
+		if (ckpt->failed || level < 0 || level >= TIMER_WHEEL_LEVELS || slot < 0 || slot >= TIMER_WHEEL_SLOTS) {
+			ckpt_fail(ckpt, "couldn't restore the timer wheel");
+			free(event);
+			break;
+		}
+		tw_link(wheel, event, level, slot);
+		wheel->levelCount[level]++;
+		wheel->count++;
+		if (isMarked) {
+			*marked = event;
+		}
+	}
+}
+
+
+/*
+ * Writes the PCBs in key order, or reads them back into an empty tree. Keys are 
+ * unique, so the rebuilt tree gives the same order even if its shape differs.
+ */
+void ckpt_rb_tree (RBTree tree, Checkpoint ckpt) {
+	RBNode curr = tree->leftmost;
+	int size = tree->size;
+	PCB pcb = NULL;
+
+	ckpt_value(ckpt, size);
+	if (!ckpt->loading) {
+		while (curr) {
+			ckpt_pcb_ref(ckpt, &curr->pcb);
+			curr = rbt_successor(curr);
+		}
+		return;
+	}
+
+	for (int i = 0; i < size && !ckpt->failed; i++) {
+		ckpt_pcb_ref(ckpt, &pcb);
+		if (!pcb || !rbt_insert(tree, pcb)) {
+			ckpt_fail(ckpt, "couldn't restore a red-black tree");
+		}
+	}
+}
+
+
+/*
+ * Writes the PCBs in array order, or reads them back into an empty heap. Pushing a
+ * valid heap back in array order moves nothing, so the layout is the same.
+ */
+void ckpt_pcb_heap (PCBHeap heap, Checkpoint ckpt) {
+	int size = heap->size;
+	PCB pcb = NULL;
+
+	ckpt_value(ckpt, size);
+	if (!ckpt->loading) {
+		for (int i = 0; i < size; i++) {
+			ckpt_pcb_ref(ckpt, &heap->pcbs[i]);
+		}
+		return;
+	}
+
+	for (int i = 0; i < size && !ckpt->failed; i++) {
+		ckpt_pcb_ref(ckpt, &pcb);
+		if (!pcb || !heap_push(heap, pcb)) {
+			ckpt_fail(ckpt, "couldn't restore a heap");
+		}
+	}
+}
+
+
+/*
+ * Writes every slot handed out so far with its PCB and weight, and the free slot
+ * stack, or reads them back into an empty tree. The slots decide which PCB holds 
+ * which ticket, so they are restored exactly.
+ */
+void ckpt_fenwick_tree (FenwickTree tree, Checkpoint ckpt) {
+	int used = tree->used, freeCount = tree->freeCount;
+	PCB pcb = NULL;
+	unsigned int weight = 0;
+	
+	ckpt_value(ckpt, used);
+	ckpt_value(ckpt, freeCount);
+	if (!ckpt->loading) {
+		for (int i = 0; i < used; i++) {
+			ckpt_pcb_ref(ckpt, &tree->pcbs[i]);
+			ckpt_value(ckpt, tree->weights[i]);
+		}
+		ckpt_bytes(ckpt, tree->freeSlots, freeCount * sizeof(int));
+		return;
+	}
+	
+	if (tree->used || used < 0 || freeCount < 0 || freeCount > used) {
+		ckpt_fail(ckpt, "couldn't restore a Fenwick tree");
+		return;
+	}
+	while (tree->capacity < used) {
+		if (!ft_grow(tree)) {
+			ckpt_fail(ckpt, "couldn't restore a Fenwick tree");
+			return;
+		}
+	}
+	for (int i = 0; i < used && !ckpt->failed; i++) {
+		ckpt_pcb_ref(ckpt, &pcb);
+		ckpt_value(ckpt, weight);
+		if (pcb) {
+			tree->pcbs[i] = pcb;
+			tree->weights[i] = weight;
+			ft_add(tree, i, weight);
+			tree->total += weight;
+			tree->size++;
+			pcb->ready_index = i;
+		}
+	}
+	tree->used = used;
+	ckpt_bytes(ckpt, tree->freeSlots, freeCount * sizeof(int));
+	tree->freeCount = freeCount;
+}
+
+
+/*
+ * Writes or reads the whole memory. Must be loaded into a newly created memory with
+ * the same policy and size.
+ */
+void ckpt_phys_mem (PhysMem pm, Checkpoint ckpt) {
+	ckpt_value(ckpt, pm->heads);
+	ckpt_value(ckpt, pm->nonEmpty);
+	ckpt_value(ckpt, pm->stats);
+	ckpt_bytes(ckpt, pm->next, sizeof(unsigned int) * pm->units);
+	ckpt_bytes(ckpt, pm->prev, sizeof(unsigned int) * pm->units);
+	ckpt_bytes(ckpt, pm->size, sizeof(unsigned int) * pm->units);
+	ckpt_bytes(ckpt, pm->tail, sizeof(unsigned int) * pm->units);
+	ckpt_bytes(ckpt, pm->state, pm->units);
+}
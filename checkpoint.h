@@ -0,0 +1,145 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is the file format for simulator checkpoints. A Checkpoint is either being
+	written or being loaded, and every structure that is part of the simulator's state
+	has one checkpoint function that handles both directions: scalars are passed to
+	ckpt_value, which writes or reads them in place, and containers are walked by the
+	ckpt_ functions here, which write their contents in order and rebuild them from
+	that order when loading. The containers themselves know nothing of checkpoints, so
+	each still links on its own. PCBs are
+	saved once in the PCB table and everything else refers to them by their slot, which
+	restoring gives back to each PCB, so the restored table hands out the same slots.
+	Nothing is padded or aligned, and pointers are never written.
+*/
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "pcb.h"
+#include "fifo_queue.h"
+#include "priority_queue.h"
+#include "mutex_map.h"
+#include "timer_wheel.h"
+#include "rb_tree.h"
+#include "pcb_heap.h"
+#include "fenwick_tree.h"
+#include "phys_mem.h"
+
+#define CKPT_MAGIC "SIMCKPT6"
+#define CKPT_NONE -1 // the reference written for a NULL PCB or Mutex
+
+/* Writes or reads a scalar lvalue in place. */
+#define ckpt_value(ckpt, value) ckpt_bytes(ckpt, &(value), sizeof(value))
+
+
+typedef struct checkpoint {
+	FILE * file;
+	int loading; // 1 when a checkpoint is being read back, 0 when one is being written
+	int failed; // set by the first short read or write, everything after that is skipped
+} checkpoint_s;
+
+typedef checkpoint_s * Checkpoint;
+
+
+/*
+ * Opens a checkpoint file for writing, or for loading if loading is set, and checks
+ * or writes the magic number.
+ *
+ * Return: the checkpoint, NULL if the file couldn't be opened or isn't a checkpoint.
+ */
+Checkpoint ckpt_open (const char * path, int loading);
+
+/*
+ * Closes the file and frees the checkpoint.
+ *
+ * Return: 1 if every read or write succeeded, 0 otherwise.
+ */
+int ckpt_close (Checkpoint ckpt);
+
+void ckpt_bytes (Checkpoint ckpt, void * data, size_t size);
+
+/*
+ * Writes or reads a string. When loading, the string is allocated and the caller
+ * frees it.
+ */
+void ckpt_string (Checkpoint ckpt, char ** string);
+
+/*
+ * Writes or reads a PCB as a reference to its slot in the PCB table. A PCB that
+ * isn't in the table is written as NULL.
+ */
+void ckpt_pcb_ref (Checkpoint ckpt, PCB * pcb);
+
+/*
+ * Writes a Mutex with its PCBs as references, or reads one back into a newly created
+ * Mutex. Every Mutex lives in exactly one place, so it is saved where it lives.
+ */
+void ckpt_mutex (Checkpoint ckpt, Mutex * mutex);
+
+/*
+ * Writes every live PCB in the table along with the table's free slot stack, or
+ * reads them back, creating each PCB in its original slot. Must be loaded into an
+ * empty table and before anything that refers to a PCB.
+ */
+void ckpt_pcb_table (Checkpoint ckpt);
+
+void ckpt_fail (Checkpoint ckpt, const char * reason);
+
+/*
+ * Writes the queue's PCBs in order along with when each was enqueued, or reads them
+ * back into an empty queue.
+ */
+void ckpt_queue (ReadyQueue FIFOq, Checkpoint ckpt);
+
+/*
+ * Writes the Mutexes in a queue of Mutexes in order, or reads them back into an 
+ * empty queue.
+ */
+void ckpt_mutex_queue (ReadyQueue FIFOq, Checkpoint ckpt);
+
+/*
+ * Writes or reads the clock and every level in order.
+ */
+void ckpt_priority_queue(PriorityQueue PQ, Checkpoint ckpt);
+
+/*
+ * Writes every bucket, its collision flag and the Mutex in it, or reads them back
+ * into an empty map so every Mutex ends up in the bucket it was in.
+ */
+void ckpt_mutex_map (MutexMap theMap, Checkpoint ckpt);
+
+/*
+ * Writes the clock and every scheduled event with the level and slot it sits in, or
+ * reads them back into an empty wheel. marked is the one event the caller keeps a 
+ * pointer to (the quantum), it is pointed at the restored copy when loading.
+ */
+void ckpt_timer_wheel (TimerWheel wheel, Checkpoint ckpt, TimerEvent * marked);
+
+/*
+ * Writes the PCBs in key order, or reads them back into an empty tree. Keys are 
+ * unique, so the rebuilt tree gives the same order even if its shape differs.
+ */
+void ckpt_rb_tree (RBTree tree, Checkpoint ckpt);
+
+/*
+ * Writes the PCBs in array order, or reads them back into an empty heap. Pushing a
+ * valid heap back in array order moves nothing, so the layout is the same.
+ */
+void ckpt_pcb_heap (PCBHeap heap, Checkpoint ckpt);
+
+/*
+ * Writes every slot handed out so far with its PCB and weight, and the free slot
+ * stack, or reads them back into an empty tree. The slots decide which PCB holds 
+ * which ticket, so they are restored exactly.
+ */
+void ckpt_fenwick_tree (FenwickTree tree, Checkpoint ckpt);
+
+/*
+ * Writes or reads the whole memory. Must be loaded into a newly created memory with
+ * the same policy and size.
+ */
+void ckpt_phys_mem (PhysMem pm, Checkpoint ckpt);
+
+#endif
@@ -20,73 +20,73 @@ void main()
 	//Mutex curr_test_mutx = 
 	testScheduler->running->context->pc = testScheduler->running->lockR1[0];
 	
-	int result = useMutex(testScheduler);
+	int result = useMutex(testScheduler, runningTraps(testScheduler));
 	printf("Result: %d\n", result);
 	
-	pq_enqueue(testScheduler->ready, testScheduler->running);
+	policy_enqueue(testScheduler->ready, testScheduler->running);
 	dispatcher(testScheduler);
 	printf("\n=================\nBasic locking test - can PCB2 acquire the lock when PCB1 has already locked it?\n");
 	
 	testScheduler->running->context->pc = testScheduler->running->lockR1[0];
-	result = useMutex(testScheduler);
+	result = useMutex(testScheduler, runningTraps(testScheduler));
 	printf("Result: %d\n", result);
 	printSchedulerState(testScheduler);
 
 	testScheduler->running->context->pc = testScheduler->running->unlockR1[0];
-	useMutex(testScheduler);
+	useMutex(testScheduler, runningTraps(testScheduler));
 	printf("\n=================\nBasic locking test - can PCB2 unlock the lock when PCB1 owns it?\n");
 	
 	testScheduler->running->context->pc = testScheduler->running->lockR1[0];
-	useMutex(testScheduler);
-	pq_enqueue(testScheduler->ready, testScheduler->running);
+	useMutex(testScheduler, runningTraps(testScheduler));
+	policy_enqueue(testScheduler->ready, testScheduler->running);
 	dispatcher(testScheduler);
 	testScheduler->running->context->pc = testScheduler->running->unlockR1[0];
-	useMutex(testScheduler);
+	useMutex(testScheduler, runningTraps(testScheduler));
 
 	printf("\n=================\nDeadlock test - PCB1 takes both mutexes\n");
 	testScheduler->running->context->pc = testScheduler->running->lockR1[0];
-	useMutex(testScheduler);
+	useMutex(testScheduler, runningTraps(testScheduler));
 	testScheduler->running->context->pc = testScheduler->running->lockR2[0];
-	useMutex(testScheduler);
-	pq_enqueue(testScheduler->ready, testScheduler->running);
+	useMutex(testScheduler, runningTraps(testScheduler));
+	policy_enqueue(testScheduler->ready, testScheduler->running);
 	dispatcher(testScheduler);
 
 	//testScheduler->running->context->pc = testScheduler->running->lockR1[0];
-//	useMutex(testScheduler);
+//	useMutex(testScheduler, runningTraps(testScheduler));
 	deadlockMonitor(testScheduler);
 	printSchedulerState(testScheduler);
 	
-	pq_enqueue(testScheduler->ready, testScheduler->running);
+	policy_enqueue(testScheduler->ready, testScheduler->running);
 	dispatcher(testScheduler);
 	testScheduler->running->context->pc = testScheduler->running->unlockR1[0];
-	useMutex(testScheduler);
+	useMutex(testScheduler, runningTraps(testScheduler));
 	printf("\n=================\nDeadlock test - PBC1 takes Mutex2, PCB2 takes Mutex1\n");
-	pq_enqueue(testScheduler->ready, testScheduler->running);
+	policy_enqueue(testScheduler->ready, testScheduler->running);
 	dispatcher(testScheduler);
 	//printSchedulerState(testScheduler);
 	testScheduler->running->context->pc = testScheduler->running->lockR1[0];
-	useMutex(testScheduler);
+	useMutex(testScheduler, runningTraps(testScheduler));
 	deadlockMonitor(testScheduler);
 
 	testScheduler->running->context->pc = testScheduler->running->unlockR1[0];
-	useMutex(testScheduler);
-	pq_enqueue(testScheduler->ready, testScheduler->running);
+	useMutex(testScheduler, runningTraps(testScheduler));
+	policy_enqueue(testScheduler->ready, testScheduler->running);
 	dispatcher(testScheduler);
 
 	testScheduler->running->context->pc = testScheduler->running->unlockR2[0];
-	useMutex(testScheduler);
+	useMutex(testScheduler, runningTraps(testScheduler));
 	
 	printf("\n=================\nDeadlock test - PCB1 takes Mutex1, PCB2 takes Mutex2\n");
 	
 	testScheduler->running->context->pc = testScheduler->running->lockR1[0];
-	useMutex(testScheduler);
+	useMutex(testScheduler, runningTraps(testScheduler));
 
-	pq_enqueue(testScheduler->ready, testScheduler->running);
+	policy_enqueue(testScheduler->ready, testScheduler->running);
 	dispatcher(testScheduler);
 	testScheduler->running->context->pc = testScheduler->running->lockR2[0];
-	useMutex(testScheduler);
+	useMutex(testScheduler, runningTraps(testScheduler));
 
-	pq_enqueue(testScheduler->ready, testScheduler->running);
+	policy_enqueue(testScheduler->ready, testScheduler->running);
 	dispatcher(testScheduler);
 	deadlockMonitor(testScheduler);
 	
@@ -224,28 +224,20 @@ int TEST_makePCBList (Scheduler theScheduler, int deadlock) {
 			nextPCB->state = STATE_READY;
 			//printf("\r\n");
 			printf("enqueuing P%d into MLFQ from makePCBList\n", nextPCB->pid);
-			pq_enqueue(theScheduler->ready, nextPCB);
+			policy_enqueue(theScheduler->ready, nextPCB);
 			printf("printing scheduler state from makePCBList\n");
-			for (int i = 0; i < NUM_PRIORITIES; i++) {
-				printf("Q[%d]: ", i);
-				ReadyQueueNode tmp = theScheduler->ready->queues[i]->first_node;
-				while (tmp) {
-					printf("P%d->", tmp->pcb->pid);
-					tmp = tmp->next;
-				}
-				printf("*\n");
-			}
+			toStringPolicy(theScheduler->ready);
 			/*pthread_mutex_lock(&printMutex);
-			toStringPriorityQueue(theScheduler->ready);
+			toStringPolicy(theScheduler->ready);
 			pthread_mutex_unlock(&printMutex);*/
 			printf("end printing in makePCBList\n");
 		}
 		//printf("\r\n");
 		
-		//toStringPriorityQueue(theScheduler->ready);
+		//toStringPolicy(theScheduler->ready);
 		if (theScheduler->isNew) {
 			printf("Scheduler is empty!\n");
-			theScheduler->running = pq_dequeue(theScheduler->ready);
+			theScheduler->running = policy_pick_next(theScheduler->ready);
 			printf("Dequeuing to run\n");
 			toStringPCB(theScheduler->running, 0);
 			if (theScheduler->running) {
@@ -0,0 +1,354 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	The earliest deadline first real-time class. PCBs with an rt_period are real-time,
+	each period they are given rt_budget iterations and must use them before the
+	period ends. Ready real-time PCBs sit in a binary heap by deadline and always run
+	ahead of everything in the MLFQ, which schedules the rest. A real-time PCB is
+	only given a quantum as long as its remaining budget, so the timer interrupt
+	preempts it when it overruns, and it is then throttled until its next period.
+	The class keeps the deadline miss ratio and a histogram of how late jobs finish.
+*/
+
+#include "edf_policy.h"
+#include "mlfq_policy.h"
+
+typedef struct edf_data {
+	PCBHeap ready; // runnable real-time PCBs by deadline
+	PCBHeap throttled; // real-time PCBs out of budget, by the start of their next period
+	SchedPolicy background; // the MLFQ for everything that isn't real-time
+	unsigned long long jobs;
+	unsigned long long misses;
+	unsigned long long tardiness[EDF_TARDINESS_BUCKETS];
+} edf_data_s;
+
+typedef edf_data_s * EDFData;
+
+
+int edf_before (PCB a, PCB b) {
+	if (a->rt_deadline != b->rt_deadline) {
+		return a->rt_deadline < b->rt_deadline;
+	}
+	return a->pid < b->pid;
+}
+
+
+/*
+	Hands the background policy the current time before it is used.
+*/
+SchedPolicy edf_background (SchedPolicy policy) {
+	SchedPolicy background = ((EDFData) policy->data)->background;
+	
+	background->clock = policy->clock;
+	
+	return background;
+}
+
+
+/*
+	Records a finished or abandoned job that was late by the given number of iterations.
+*/
+void edf_record (EDFData edf, unsigned int late) {
+	int bucket = 0;
+	
+	edf->jobs++;
+	if (late) {
+		edf->misses++;
+		while (bucket < EDF_TARDINESS_BUCKETS - 1 && late >> bucket) {
+			bucket++;
+		}
+	}
+	edf->tardiness[bucket]++;
+}
+
+
+/*
+	Starts a new job for the PCB in the period containing now. A job that was still
+	unfinished when its period ended is counted as a miss, late by however long it
+	has been since the deadline.
+*/
+void edf_new_period (EDFData edf, PCB pcb, unsigned int now) {
+	if (pcb->rt_deadline == 0) { //first job
+		pcb->rt_deadline = now + pcb->rt_period;
+	} else {
+		if (pcb->rt_used < pcb->rt_budget) {
+			edf_record(edf, now - pcb->rt_deadline + 1);
+		}
+		pcb->rt_deadline += ((now - pcb->rt_deadline) / pcb->rt_period + 1) * pcb->rt_period;
+	}
+	pcb->rt_used = 0;
+}
+
+
+/*
+	Charges the running PCB for the iterations it ran in this period. If that uses
+	up the budget the job is done, and it counts as a miss if it finished after the
+	deadline.
+*/
+void edf_charge (SchedPolicy policy, PCB pcb) {
+	EDFData edf = (EDFData) policy->data;
+	unsigned int ran = 0;
+	
+	if (pcb->exec_start == (unsigned int) -1) {
+		return;
+	}
+	if (policy->clock > pcb->exec_start) {
+		ran = policy->clock - pcb->exec_start;
+	}
+	pcb->run_time += ran;
+	pcb->exec_start = -1;
+	
+	if (pcb->rt_used < pcb->rt_budget) {
+		pcb->rt_used += ran;
+		if (pcb->rt_used >= pcb->rt_budget) {
+			pcb->rt_used = pcb->rt_budget;
+			edf_record(edf, policy->clock > pcb->rt_deadline ? policy->clock - pcb->rt_deadline : 0);
+		}
+	}
+}
+
+
+/*
+	Moves throttled PCBs whose next period has started back into the ready heap.
+*/
+void edf_release (SchedPolicy policy) {
+	EDFData edf = (EDFData) policy->data;
+	PCB pcb = heap_peek(edf->throttled);
+	
+	while (pcb && pcb->rt_deadline <= policy->clock) {
+		heap_pop(edf->throttled);
+		edf_new_period(edf, pcb, policy->clock);
+		heap_push(edf->ready, pcb);
+		pcb = heap_peek(edf->throttled);
+	}
+}
+
+
+/*
+	A real-time PCB coming off the CPU is charged for its run, and one whose period
+	has ended starts the next. If its budget for this period is used up it is
+	throttled, otherwise it goes into the ready heap by deadline. Everything else
+	goes to the MLFQ.
+*/
+void edf_enqueue (SchedPolicy policy, PCB pcb) {
+	EDFData edf = (EDFData) policy->data;
+	int pushed = 0;
+	
+	if (!pcb->rt_period) {
+		policy_enqueue(edf_background(policy), pcb);
+		return;
+	}
+	
+	edf_charge(policy, pcb);
+	if (pcb->rt_deadline == 0 || policy->clock >= pcb->rt_deadline) {
+		edf_new_period(edf, pcb, policy->clock);
+	}
+	
+	if (pcb->rt_used >= pcb->rt_budget) {
+		trace("P%d used its real-time budget, throttled until %d\r\n", pcb->pid, pcb->rt_deadline);
+		pushed = heap_push(edf->throttled, pcb);
+	} else {
+		pushed = heap_push(edf->ready, pcb);
+	}
+	if (!pushed) {
+		trace("\t\t\tEDF COULDN'T GROW FOR P%d\t\t\t\r\n", pcb->pid);
+	}
+}
+
+
+PCB edf_peek (SchedPolicy policy) {
+	EDFData edf = (EDFData) policy->data;
+	
+	edf_release(policy);
+	if (!heap_is_empty(edf->ready)) {
+		return heap_peek(edf->ready);
+	}
+	
+	return policy_peek(edf_background(policy));
+}
+
+
+PCB edf_pick_next (SchedPolicy policy) {
+	EDFData edf = (EDFData) policy->data;
+	PCB pcb = NULL;
+	
+	edf_release(policy);
+	if (!heap_is_empty(edf->ready)) {
+		pcb = heap_pop(edf->ready);
+		pcb->exec_start = policy->clock;
+	} else {
+		pcb = policy_pick_next(edf_background(policy));
+	}
+	
+	return pcb;
+}
+
+
+PCB edf_remove (SchedPolicy policy, PCB pcb) {
+	EDFData edf = (EDFData) policy->data;
+	PCB found = NULL;
+	
+	if (pcb->rt_period) {
+		found = heap_remove(edf->ready, pcb);
+		if (!found) {
+			found = heap_remove(edf->throttled, pcb);
+		}
+	} else {
+		found = policy_remove(edf_background(policy), pcb);
+	}
+	
+	return found;
+}
+
+
+/*
+	A real-time PCB may run for what is left of its budget, so going over it 
+	triggers the timer interrupt.
+*/
+unsigned int edf_quantum (SchedPolicy policy, PCB pcb) {
+	if (pcb->rt_period) {
+		return pcb->rt_used < pcb->rt_budget ? pcb->rt_budget - pcb->rt_used : 1;
+	}
+	
+	return policy_quantum(edf_background(policy), pcb);
+}
+
+
+void edf_on_tick (SchedPolicy policy, PCB pcb) {
+	if (!pcb->rt_period) {
+		policy_on_tick(edf_background(policy), pcb);
+	}
+}
+
+
+void edf_on_block (SchedPolicy policy, PCB pcb) {
+	if (pcb->rt_period) {
+		edf_charge(policy, pcb);
+	} else {
+		policy_on_block(edf_background(policy), pcb);
+	}
+}
+
+
+void edf_on_wake (SchedPolicy policy, PCB pcb) {
+	if (!pcb->rt_period) {
+		policy_on_wake(edf_background(policy), pcb);
+	}
+}
+
+
+void edf_on_boost (SchedPolicy policy) {
+	edf_release(policy);
+	policy_on_boost(edf_background(policy));
+}
+
+
+int edf_count (SchedPolicy policy) {
+	EDFData edf = (EDFData) policy->data;
+	
+	return edf->ready->size + edf->throttled->size + policy_count(edf->background);
+}
+
+
+/*
+	Prints the real-time PCBs, the deadline statistics and then the MLFQ.
+*/
+void edf_print (SchedPolicy policy) {
+	EDFData edf = (EDFData) policy->data;
+	unsigned int low = 0;
+	
+	trace("Real-time Q:Count=%d: ", edf->ready->size);
+	for (int i = 0; i < edf->ready->size; i++) {
+		trace("P%d(d%d) -> ", edf->ready->pcbs[i]->pid, edf->ready->pcbs[i]->rt_deadline);
+	}
+	trace("*\r\nThrottled Q:Count=%d: ", edf->throttled->size);
+	for (int i = 0; i < edf->throttled->size; i++) {
+		trace("P%d(r%d) -> ", edf->throttled->pcbs[i]->pid, edf->throttled->pcbs[i]->rt_deadline);
+	}
+	trace("*\r\n");
+	
+	trace("Deadline misses: %llu of %llu jobs (%.2f%%)\r\n", edf->misses, edf->jobs, 
+		edf->jobs ? (double) edf->misses / edf->jobs * 100 : 0.0);
+	trace("Tardiness: on time: %llu", edf->tardiness[0]);
+	for (int i = 1; i < EDF_TARDINESS_BUCKETS; i++) {
+		low = 1u << (i - 1);
+		if (i < EDF_TARDINESS_BUCKETS - 1) {
+			trace(", %u-%u: %llu", low, (low << 1) - 1, edf->tardiness[i]);
+		} else {
+			trace(", %u+: %llu", low, edf->tardiness[i]);
+		}
+	}
+	trace("\r\n");
+	
+	toStringPolicy(edf->background);
+}
+
+
+void edf_checkpoint (SchedPolicy policy, Checkpoint ckpt) {
+	EDFData edf = (EDFData) policy->data;
+	
+	ckpt_pcb_heap(edf->ready, ckpt);
+	ckpt_pcb_heap(edf->throttled, ckpt);
+	policy_checkpoint(edf->background, ckpt);
+	ckpt_value(ckpt, edf->jobs);
+	ckpt_value(ckpt, edf->misses);
+	ckpt_value(ckpt, edf->tardiness);
+}
+
+
+void edf_destroy (SchedPolicy policy) {
+	EDFData edf = (EDFData) policy->data;
+	
+	heap_destroy(edf->ready);
+	heap_destroy(edf->throttled);
+	policy_destroy(edf->background);
+	free(edf);
+	policy->data = NULL;
+}
+
+
+/*
+ * Creates an EDF real-time class that runs ahead of an MLFQ.
+ *
+ * Return: the new policy, NULL on failure.
+ */
+SchedPolicy edf_policy_create () {
+	SchedPolicy policy = policy_alloc("edf");
+	EDFData edf = NULL;
+	
+	if (policy != NULL) {
+		edf = (EDFData) calloc(1, sizeof(struct edf_data));
+		if (edf != NULL) {
+			edf->ready = heap_create(edf_before);
+			edf->throttled = heap_create(edf_before);
+			edf->background = mlfq_policy_create();
+		}
+		if (edf == NULL || !edf->ready || !edf->throttled || !edf->background) {
+			if (edf) {
+				heap_destroy(edf->ready);
+				heap_destroy(edf->throttled);
+				policy_destroy(edf->background);
+			}
+			free(edf);
+			free(policy);
+			return NULL;
+		}
+		policy->data = edf;
+		policy->enqueue = edf_enqueue;
+		policy->pick_next = edf_pick_next;
+		policy->peek = edf_peek;
+		policy->remove = edf_remove;
+		policy->quantum = edf_quantum;
+		policy->on_tick = edf_on_tick;
+		policy->on_block = edf_on_block;
+		policy->on_wake = edf_on_wake;
+		policy->on_boost = edf_on_boost;
+		policy->count = edf_count;
+		policy->print = edf_print;
+		policy->checkpoint = edf_checkpoint;
+		policy->destroy = edf_destroy;
+	}
+	
+	return policy;
+}
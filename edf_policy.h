@@ -0,0 +1,30 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	The earliest deadline first real-time class. PCBs with an rt_period are real-time,
+	each period they are given rt_budget iterations and must use them before the
+	period ends. Ready real-time PCBs sit in a binary heap by deadline and always run
+	ahead of everything in the MLFQ, which schedules the rest. A real-time PCB is
+	only given a quantum as long as its remaining budget, so the timer interrupt
+	preempts it when it overruns, and it is then throttled until its next period.
+	The class keeps the deadline miss ratio and a histogram of how late jobs finish.
+*/
+
+#ifndef EDF_POLICY_H
+#define EDF_POLICY_H
+
+#include "sched_policy.h"
+#include "pcb_heap.h"
+
+#define EDF_TARDINESS_BUCKETS 12 // bucket 0 is on time, bucket i is [2^(i-1), 2^i) late
+
+
+/*
+ * Creates an EDF real-time class that runs ahead of an MLFQ.
+ *
+ * Return: the new policy, NULL on failure.
+ */
+SchedPolicy edf_policy_create ();
+
+#endif
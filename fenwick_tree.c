@@ -0,0 +1,203 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is a Fenwick (binary indexed) tree of PCBs weighted by their ticket counts.
+	Each PCB takes a slot, and the tree keeps prefix sums of the weights so a ticket
+	number can be mapped to the PCB holding it in O(log n), which is how a lottery
+	winner is drawn. Inserting and removing are also O(log n), and freed slots are
+	reused. Each PCB's ready_index is the slot it sits in.
+*/
+
+#include "fenwick_tree.h"
+
+
+/*
+	Adds delta to the weight of the given slot (0-based).
+*/
+void ft_add (FenwickTree tree, int slot, long long delta) {
+	for (int i = slot + 1; i <= tree->capacity; i += i & -i) {
+		tree->sums[i] += delta;
+	}
+}
+
+
+/*
+	Doubles the number of slots and rebuilds the sums over the larger range.
+*/
+int ft_grow (FenwickTree tree) {
+	int capacity = tree->capacity * 2;
+	unsigned long long * sums = (unsigned long long *) realloc(tree->sums, sizeof(unsigned long long) * (capacity + 1));
+	unsigned int * weights = NULL;
+	PCB * pcbs = NULL;
+	int * freeSlots = NULL;
+	
+	if (sums) {
+		tree->sums = sums;
+	}
+	weights = (unsigned int *) realloc(tree->weights, sizeof(unsigned int) * capacity);
+	if (weights) {
+		tree->weights = weights;
+	}
+	pcbs = (PCB *) realloc(tree->pcbs, sizeof(PCB) * capacity);
+	if (pcbs) {
+		tree->pcbs = pcbs;
+	}
+	freeSlots = (int *) realloc(tree->freeSlots, sizeof(int) * capacity);
+	if (freeSlots) {
+		tree->freeSlots = freeSlots;
+	}
+	if (!sums || !weights || !pcbs || !freeSlots) {
+		return 0;
+	}
+	
+	for (int i = tree->capacity; i < capacity; i++) {
+		tree->weights[i] = 0;
+		tree->pcbs[i] = NULL;
+	}
+	tree->capacity = capacity;
+	
+	for (int i = 1; i <= capacity; i++) { //linear time build
+		tree->sums[i] = tree->weights[i - 1];
+	}
+	for (int i = 1; i <= capacity; i++) {
+		int parent = i + (i & -i);
+		if (parent <= capacity) {
+			tree->sums[parent] += tree->sums[i];
+		}
+	}
+	
+	return 1;
+}
+
+
+/*
+ * Creates an empty tree.
+ *
+ * Return: A new tree on success, NULL on failure.
+ */
+FenwickTree ft_create () {
+	FenwickTree tree = (FenwickTree) malloc(sizeof(struct fenwick_tree));
+	
+	if (tree != NULL) {
+		tree->sums = (unsigned long long *) calloc(FENWICK_INITIAL_CAPACITY + 1, sizeof(unsigned long long));
+		tree->weights = (unsigned int *) calloc(FENWICK_INITIAL_CAPACITY, sizeof(unsigned int));
+		tree->pcbs = (PCB *) calloc(FENWICK_INITIAL_CAPACITY, sizeof(PCB));
+		tree->freeSlots = (int *) malloc(sizeof(int) * FENWICK_INITIAL_CAPACITY);
+		if (!tree->sums || !tree->weights || !tree->pcbs || !tree->freeSlots) {
+			free(tree->sums);
+			free(tree->weights);
+			free(tree->pcbs);
+			free(tree->freeSlots);
+			free(tree);
+			return NULL;
+		}
+		tree->freeCount = 0;
+		tree->used = 0;
+		tree->capacity = FENWICK_INITIAL_CAPACITY;
+		tree->size = 0;
+		tree->total = 0;
+	}
+	
+	return tree;
+}
+
+
+/*
+ * Destroys the tree and every PCB still in it.
+ */
+void ft_destroy (FenwickTree tree) {
+	if (tree) {
+		for (int i = 0; i < tree->used; i++) {
+			if (tree->pcbs[i]) {
+				PCB_destroy(tree->pcbs[i]);
+			}
+		}
+		free(tree->sums);
+		free(tree->weights);
+		free(tree->pcbs);
+		free(tree->freeSlots);
+		free(tree);
+	}
+}
+
+
+/*
+ * Puts the PCB into a free slot with the given weight, which must be at least 1.
+ *
+ * Return: 1 on success, 0 if the tree couldn't grow.
+ */
+int ft_insert (FenwickTree tree, PCB pcb, unsigned int weight) {
+	int slot = 0;
+	
+	if (tree->freeCount) {
+		slot = tree->freeSlots[--tree->freeCount];
+	} else {
+		if (tree->used == tree->capacity && !ft_grow(tree)) {
+			return 0;
+		}
+		slot = tree->used++;
+	}
+	
+	tree->pcbs[slot] = pcb;
+	tree->weights[slot] = weight;
+	ft_add(tree, slot, weight);
+	tree->total += weight;
+	tree->size++;
+	pcb->ready_index = slot;
+	
+	return 1;
+}
+
+
+/*
+ * Removes the given PCB from its slot.
+ *
+ * Return: the PCB, or NULL if it wasn't in this tree.
+ */
+PCB ft_remove (FenwickTree tree, PCB pcb) {
+	int slot = pcb->ready_index;
+	
+	if (slot < 0 || slot >= tree->used || tree->pcbs[slot] != pcb) {
+		return NULL;
+	}
+	
+	ft_add(tree, slot, -(long long) tree->weights[slot]);
+	tree->total -= tree->weights[slot];
+	tree->weights[slot] = 0;
+	tree->pcbs[slot] = NULL;
+	tree->freeSlots[tree->freeCount++] = slot;
+	tree->size--;
+	pcb->ready_index = -1;
+	
+	return pcb;
+}
+
+
+/*
+ * Finds the PCB holding the given ticket, where tickets are numbered from 0 to
+ * total - 1 across the slots in order.
+ *
+ * Return: the PCB, or NULL if ticket is not less than the total.
+ */
+PCB ft_find (FenwickTree tree, unsigned long long ticket) {
+	int pos = 0;
+	
+	if (ticket >= tree->total) {
+		return NULL;
+	}
+	
+	for (int step = tree->capacity; step > 0; step >>= 1) {
+		if (pos + step <= tree->capacity && tree->sums[pos + step] <= ticket) {
+			pos += step;
+			ticket -= tree->sums[pos];
+		}
+	}
+	
+	return tree->pcbs[pos]; //pos is the number of slots before the winner
+}
+
+
+char ft_is_empty (FenwickTree tree) {
+	return tree->size == 0;
+}
@@ -0,0 +1,83 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is a Fenwick (binary indexed) tree of PCBs weighted by their ticket counts.
+	Each PCB takes a slot, and the tree keeps prefix sums of the weights so a ticket
+	number can be mapped to the PCB holding it in O(log n), which is how a lottery
+	winner is drawn. Inserting and removing are also O(log n), and freed slots are
+	reused. Each PCB's ready_index is the slot it sits in.
+*/
+
+#ifndef FENWICK_TREE_H
+#define FENWICK_TREE_H
+
+#include "pcb.h"
+
+#define FENWICK_INITIAL_CAPACITY 64
+
+
+typedef struct fenwick_tree {
+	unsigned long long * sums; // 1-based Fenwick sums over the slot weights
+	unsigned int * weights;
+	PCB * pcbs; // NULL for a free slot
+	int * freeSlots; // stack of slots that were used and then freed
+	int freeCount;
+	int used; // slots at or above this have never been handed out
+	int capacity; // always a power of two
+	int size;
+	unsigned long long total;
+} fenwick_tree_s;
+
+typedef fenwick_tree_s * FenwickTree;
+
+
+/*
+ * Creates an empty tree.
+ *
+ * Return: A new tree on success, NULL on failure.
+ */
+FenwickTree ft_create ();
+
+/*
+ * Destroys the tree and every PCB still in it.
+ */
+void ft_destroy (FenwickTree tree);
+
+/*
+ * Puts the PCB into a free slot with the given weight, which must be at least 1.
+ *
+ * Return: 1 on success, 0 if the tree couldn't grow.
+ */
+int ft_insert (FenwickTree tree, PCB pcb, unsigned int weight);
+
+/*
+ * Removes the given PCB from its slot.
+ *
+ * Return: the PCB, or NULL if it wasn't in this tree.
+ */
+PCB ft_remove (FenwickTree tree, PCB pcb);
+
+/*
+ * Finds the PCB holding the given ticket, where tickets are numbered from 0 to
+ * total - 1 across the slots in order.
+ *
+ * Return: the PCB, or NULL if ticket is not less than the total.
+ */
+PCB ft_find (FenwickTree tree, unsigned long long ticket);
+
+char ft_is_empty (FenwickTree tree);
+
+/*
+ * Adds delta to the weight of the given slot (0-based).
+ */
+void ft_add (FenwickTree tree, int slot, long long delta);
+
+/*
+ * Doubles the number of slots.
+ *
+ * Return: 1 on success, 0 if memory ran out.
+ */
+int ft_grow (FenwickTree tree);
+
+#endif
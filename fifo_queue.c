@@ -45,7 +45,7 @@ void q_destroy(/* in-out */ ReadyQueue FIFOq) {
 		if (last->pcb) {
 			PCB_destroy(last->pcb);
 		} else {
-			printf("pcb was null\n");
+			trace("pcb was null\n");
 		}
         free(last);
 		last = NULL;
@@ -122,7 +122,12 @@ int q_enqueue(/* in */ ReadyQueue FIFOq, /* in */ PCB pcb) {
     ReadyQueueNode new_node = (ReadyQueueNode) malloc(sizeof(struct node));
     if (new_node != NULL && pcb != NULL) {
         new_node->pcb = pcb;
+		new_node->mutex = NULL;
         new_node->next = NULL;
+		new_node->prev = FIFOq->last_node;
+		new_node->queue = FIFOq;
+		new_node->enqueued = 0;
+		pcb->node = new_node;
         if (FIFOq->last_node != NULL) {
 			FIFOq->last_node->next = new_node;
 			FIFOq->last_node = FIFOq->last_node->next;
@@ -150,7 +155,12 @@ int q_enqueue_m(/* in */ ReadyQueue FIFOq, /* in */ Mutex mutex) {
 
     if (new_node != NULL && mutex != NULL) {
         new_node->mutex = mutex;
+		new_node->pcb = NULL;
         new_node->next = NULL;
+		new_node->prev = FIFOq->last_node;
+		new_node->queue = FIFOq;
+		new_node->enqueued = 0;
+		mutex->node = new_node;
 
         if (FIFOq->last_node != NULL) {
 			FIFOq->last_node->next = new_node;
@@ -174,10 +184,10 @@ int q_enqueue_m(/* in */ ReadyQueue FIFOq, /* in */ Mutex mutex) {
 void printMutexList (ReadyQueue mutexes) {
 	ReadyQueueNode curr = mutexes->first_node;
 	while (curr) {
-		printf("m%d->", curr->mutex->mid);
+		trace("m%d->", curr->mutex->mid);
 		curr = curr->next;
 		if (!curr) {
-			printf("*\n");
+			trace("*\n");
 		}
 	}
 }
@@ -200,9 +210,14 @@ PCB q_dequeue(/* in-out */ ReadyQueue FIFOq) {
         /* If the user has dequeued the final node, set the last node to null. */
         if (FIFOq->first_node == NULL) {
             FIFOq->last_node = NULL;
-        }
+        } else {
+			FIFOq->first_node->prev = NULL;
+		}
 
         ret_pcb = ret_node->pcb;
+		if (ret_pcb->node == ret_node) {
+			ret_pcb->node = NULL;
+		}
 
         free(ret_node);
     }
@@ -212,22 +227,69 @@ PCB q_dequeue(/* in-out */ ReadyQueue FIFOq) {
 
 
 /*
-	Searches through the queue to check if it contains the given PCB. Not used very often
-	so it limits inefficiencies.
+	Unlinks a node from its queue and frees it.
 */
+void q_unlink (ReadyQueue FIFOq, ReadyQueueNode node) {
+	if (node->prev) {
+		node->prev->next = node->next;
+	} else {
+		FIFOq->first_node = node->next;
+	}
+	if (node->next) {
+		node->next->prev = node->prev;
+	} else {
+		FIFOq->last_node = node->prev;
+	}
+	FIFOq->size--;
+	free(node);
+}
+
+
+/*
+ * Moves every node of from onto the end of to, in order, leaving from empty.
+ */
+void q_concat (ReadyQueue to, ReadyQueue from) {
+	for (ReadyQueueNode curr = from->first_node; curr; curr = curr->next) {
+		curr->queue = to;
+	}
+	if (from->first_node == NULL) {
+		return;
+	}
+	from->first_node->prev = to->last_node;
+	if (to->last_node) {
+		to->last_node->next = from->first_node;
+	} else {
+		to->first_node = from->first_node;
+	}
+	to->last_node = from->last_node;
+	to->size += from->size;
+	from->first_node = NULL;
+	from->last_node = NULL;
+	from->size = 0;
+}
+
+
+/*
+ * Checks if the PCB is in the queue, in constant time.
+ */
 int q_contains (ReadyQueue FIFOq, PCB pcb) {
-	ReadyQueueNode curr = FIFOq->first_node;
-	
-	int isFound = 0;
-	while (curr) {
-		if (curr->pcb == pcb) {
-			isFound = 1;
-			break;
-		}
-		curr = curr->next;
+	return pcb->node && pcb->node->queue == FIFOq && pcb->node->pcb == pcb;
+}
+
+
+/*
+ * Removes the given PCB from wherever it is in the queue, in constant time.
+ *
+ * Return: the PCB, or NULL if it wasn't in the queue.
+ */
+PCB q_remove (ReadyQueue FIFOq, PCB pcb) {
+	if (!q_contains(FIFOq, pcb)) {
+		return NULL;
 	}
+	q_unlink(FIFOq, pcb->node);
+	pcb->node = NULL;
 	
-	return isFound;
+	return pcb;
 }
 
 
@@ -249,9 +311,14 @@ Mutex q_dequeue_m(/* in-out */ ReadyQueue FIFOq) {
         /* If the user has dequeued the final node, set the last node to null. */
         if (FIFOq->first_node == NULL) {
             FIFOq->last_node = NULL;
-        }
+        } else {
+			FIFOq->first_node->prev = NULL;
+		}
 
         ret_mutex = ret_node->mutex;
+		if (ret_mutex->node == ret_node) {
+			ret_mutex->node = NULL;
+		}
 
         free(ret_node);
     }
@@ -283,21 +350,10 @@ Mutex q_find_mutex (ReadyQueue queue, PCB pcb) { //CHANGE NAME TO q_find_mutex_f
 
 
 /*
-	Same as q_contains but with Mutexes.
-*/
+ * Checks if the Mutex is in the queue, in constant time.
+ */
 int q_contains_mutex (ReadyQueue queue, Mutex toFind) {
-	int mutexFound = 0;
-	ReadyQueueNode curr = queue->first_node;
-	while (curr) {
-		if (curr->mutex == toFind) { //if the mutex is the same
-			mutexFound = 1;
-			break;
-		}
-		
-		curr = curr->next;
-	}
-	
-	return mutexFound;
+	return toFind->node && toFind->node->queue == queue && toFind->node->mutex == toFind;
 }
 
 
@@ -310,19 +366,19 @@ int q_contains_mutex (ReadyQueue queue, Mutex toFind) {
  void toStringReadyQueueNode(ReadyQueueNode theNode, int isMutex) {
 	 if (!isMutex) {
 		if (theNode->pcb) {
-			printf("P%d",theNode->pcb->pid);
+			trace("P%d",theNode->pcb->pid);
 		} else {
-			printf("toStringReadyQueueNode PCB was NULL!!!\n");
+			trace("toStringReadyQueueNode PCB was NULL!!!\n");
 		}
 	 } else {
 		if (theNode->mutex) {
-			printf("M%d",theNode->mutex->mid);
+			trace("M%d",theNode->mutex->mid);
 		}
 	}
     if(theNode->next != 0) {
-        printf(" -> ");
+        trace(" -> ");
     } else {
-        printf(" -> *");
+        trace(" -> *");
     }
 }
 
@@ -332,14 +388,14 @@ int q_contains_mutex (ReadyQueue queue, Mutex toFind) {
 */
 void toStringReadyQueue(ReadyQueue theQueue) {
     if(theQueue->first_node == 0) {
-        printf("\r\n");
+        trace("\r\n");
     } else {
         ReadyQueueNode temp = theQueue->first_node;
         while(temp != 0) {
             toStringReadyQueueNode(temp, 0);
             temp = temp->next;
         }
-		printf("\r\n");
+		trace("\r\n");
     }
 }
 
@@ -349,14 +405,14 @@ void toStringReadyQueue(ReadyQueue theQueue) {
 */
 void toStringReadyQueueMutexes(ReadyQueue theQueue) {
     if(theQueue->first_node == 0) {
-        printf("\r\n");
+        trace("\r\n");
     } else {
         ReadyQueueNode temp = theQueue->first_node;
         while(temp != 0) {
             toStringReadyQueueNode(temp, 1);
             temp = temp->next;
         }
-		printf("\r\n");
+		trace("\r\n");
     }
 }
 
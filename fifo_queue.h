@@ -12,11 +12,18 @@
 /* primarily for sprintf */
 #include <stdio.h>
 
-/* A node used in a fifo queue to store data, and the next node. */
+/* 
+	A node used in a fifo queue to store data, and the nodes on either side. The PCB
+	or Mutex in the node points back at it, so it can be found and unlinked without
+	walking the queue.
+*/
 typedef struct node {
     struct node * next;
+    struct node * prev;
+	struct fifo_queue * queue; // the queue the node is in
     PCB pcb;
 	Mutex mutex;
+	unsigned int enqueued; // when the node joined its queue, used for aging
 } Node_s;
 
 typedef Node_s * ReadyQueueNode;
@@ -107,10 +114,28 @@ Mutex q_find_mutex (ReadyQueue queue, PCB pcb);
 PCB q_peek(ReadyQueue FIFOq);
 
 
+/*
+ * Moves every node of from onto the end of to, in order, leaving from empty.
+ */
+void q_concat (ReadyQueue to, ReadyQueue from);
+
+/*
+ * Checks if the Mutex is in the queue, in constant time.
+ */
 int q_contains_mutex (ReadyQueue queue, Mutex toFind);
 
+/*
+ * Checks if the PCB is in the queue, in constant time.
+ */
 int q_contains (ReadyQueue FIFOq, PCB pcb);
 
+/*
+ * Removes the given PCB from wherever it is in the queue, in constant time.
+ *
+ * Return: the PCB, or NULL if it wasn't in the queue.
+ */
+PCB q_remove (ReadyQueue FIFOq, PCB pcb);
+
 /*
  * Creates and returns an output string representation of the FIFO queue.
  *
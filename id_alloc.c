@@ -0,0 +1,174 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is an allocator for small integer IDs that always hands out the lowest free
+	one, so IDs are reused as soon as they are freed and stay as dense as the number
+	of IDs held at once. See id_alloc.h for how the bitmap is laid out.
+*/
+
+#include "id_alloc.h"
+
+#define IDA_FULL (~0ULL)
+#define IDA_MAX_WORDS (1u << 25) // keeps every ID below IDA_NONE
+
+
+/*
+	Resizes the bitmap to the given number of level 0 words, a power of two at least
+	as large as now. Every level is allocated before anything is changed, so running
+	out of memory leaves the bitmap as it was. The levels above 0 are then rebuilt,
+	with the bits past the end of the level below set so they are never walked into.
+*/
+int ida_resize (IdAlloc ida, unsigned int words) {
+	unsigned int sizes[IDA_MAX_LEVELS];
+	unsigned long long * grown = NULL;
+	int levelCount = 1;
+	unsigned int below = 0;
+
+	if (words > IDA_MAX_WORDS) {
+		return 0;
+	}
+	sizes[0] = words;
+	while (sizes[levelCount - 1] > 1) {
+		sizes[levelCount] = (sizes[levelCount - 1] + 63) / 64;
+		levelCount++;
+	}
+	for (int level = 0; level < levelCount; level++) {
+		grown = (unsigned long long *) realloc(ida->levels[level], sizeof(unsigned long long) * sizes[level]);
+		if (grown == NULL) {
+			return 0;
+		}
+		ida->levels[level] = grown;
+	}
+
+	memset(ida->levels[0] + ida->words[0], 0, sizeof(unsigned long long) * (words - ida->words[0]));
+	for (int level = 0; level < levelCount; level++) {
+		ida->words[level] = sizes[level];
+	}
+	ida->levelCount = levelCount;
+	for (int level = 1; level < levelCount; level++) {
+		below = ida->words[level - 1];
+		memset(ida->levels[level], 0, sizeof(unsigned long long) * ida->words[level]);
+		for (unsigned int i = 0; i < ida->words[level] * 64; i++) {
+			if (i >= below || ida->levels[level - 1][i] == IDA_FULL) {
+				ida->levels[level][i / 64] |= 1ULL << (i % 64);
+			}
+		}
+	}
+
+	return 1;
+}
+
+
+/*
+	Sets the ID's bit, and the bit above each word it fills.
+*/
+void ida_set (IdAlloc ida, unsigned int id) {
+	unsigned int index = id;
+
+	for (int level = 0; level < ida->levelCount; level++) {
+		ida->levels[level][index / 64] |= 1ULL << (index % 64);
+		if (ida->levels[level][index / 64] != IDA_FULL) {
+			break;
+		}
+		index /= 64;
+	}
+	ida->used++;
+	if (id >= ida->limit) {
+		ida->limit = id + 1;
+	}
+}
+
+
+/*
+ * Creates an allocator with every ID free.
+ *
+ * Return: the allocator, NULL if memory ran out.
+ */
+IdAlloc ida_create () {
+	IdAlloc ida = (IdAlloc) calloc(1, sizeof(struct id_alloc));
+
+	if (ida != NULL && !ida_resize(ida, IDA_INITIAL_WORDS)) {
+		ida_destroy(ida);
+		ida = NULL;
+	}
+
+	return ida;
+}
+
+
+void ida_destroy (IdAlloc ida) {
+	if (ida) {
+		for (int level = 0; level < IDA_MAX_LEVELS; level++) {
+			free(ida->levels[level]);
+		}
+		free(ida);
+	}
+}
+
+
+/*
+ * Takes the lowest free ID.
+ *
+ * Return: the ID, IDA_NONE if memory ran out growing the bitmap.
+ */
+unsigned int ida_alloc (IdAlloc ida) {
+	unsigned int index = 0;
+
+	if (ida->levels[ida->levelCount - 1][0] == IDA_FULL && !ida_resize(ida, ida->words[0] * 2)) {
+		return IDA_NONE;
+	}
+	for (int level = ida->levelCount - 1; level >= 0; level--) {
+		index = index * 64 + __builtin_ctzll(~ida->levels[level][index]);
+	}
+	ida_set(ida, index);
+
+	return index;
+}
+
+
+/*
+ * Takes the given ID, used to put back the IDs of restored objects.
+ *
+ * Return: 1 on success, 0 if it was already taken or memory ran out.
+ */
+int ida_mark (IdAlloc ida, unsigned int id) {
+	unsigned int words = ida->words[0];
+
+	while (id / 64 >= words && words <= IDA_MAX_WORDS) {
+		words *= 2;
+	}
+	if (words != ida->words[0] && !ida_resize(ida, words)) {
+		return 0;
+	}
+	if (ida->levels[0][id / 64] & (1ULL << (id % 64))) {
+		return 0;
+	}
+	ida_set(ida, id);
+
+	return 1;
+}
+
+
+/*
+ * Frees the given ID so the next ida_alloc can hand it out. Freeing an ID that
+ * isn't taken does nothing.
+ */
+void ida_free (IdAlloc ida, unsigned int id) {
+	unsigned long long bit = 1ULL << (id % 64);
+	int wasFull = 0;
+
+	if (id / 64 >= ida->words[0] || !(ida->levels[0][id / 64] & bit)) {
+		return;
+	}
+	for (int level = 0; level < ida->levelCount; level++) {
+		bit = 1ULL << (id % 64);
+		wasFull = ida->levels[level][id / 64] == IDA_FULL;
+		ida->levels[level][id / 64] &= ~bit;
+		if (!wasFull) {
+			break;
+		}
+		id /= 64;
+	}
+	ida->used--;
+}
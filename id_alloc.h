@@ -0,0 +1,65 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is an allocator for small integer IDs that always hands out the lowest free
+	one, so IDs are reused as soon as they are freed and stay as dense as the number
+	of IDs held at once. It is a hierarchical bitmap: level 0 has a bit per ID, set
+	while the ID is taken, and each bit of a level above is set while the 64 bit word
+	below it is full. Allocating walks down from the single top word to the first
+	word with a clear bit, so both allocating and freeing are O(log64 n). The bitmap
+	doubles when every ID is taken. It has no lock of its own, callers guard it.
+*/
+
+#ifndef ID_ALLOC_H
+#define ID_ALLOC_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#define IDA_INITIAL_WORDS 4 // level 0 words to start with, 256 IDs
+#define IDA_MAX_LEVELS 6 // 64^6 IDs is more than an unsigned int can hold
+#define IDA_NONE ((unsigned int) -1) // returned when no ID could be allocated
+
+
+typedef struct id_alloc {
+	unsigned long long * levels[IDA_MAX_LEVELS]; // levels[0] is the IDs, the last one a single word
+	unsigned int words[IDA_MAX_LEVELS]; // words in each level
+	int levelCount;
+	unsigned int used; // IDs taken right now
+	unsigned int limit; // one past the largest ID ever taken
+} id_alloc_s;
+
+typedef id_alloc_s * IdAlloc;
+
+
+/*
+ * Creates an allocator with every ID free.
+ *
+ * Return: the allocator, NULL if memory ran out.
+ */
+IdAlloc ida_create ();
+
+void ida_destroy (IdAlloc ida);
+
+/*
+ * Takes the lowest free ID.
+ *
+ * Return: the ID, IDA_NONE if memory ran out growing the bitmap.
+ */
+unsigned int ida_alloc (IdAlloc ida);
+
+/*
+ * Takes the given ID, used to put back the IDs of restored objects.
+ *
+ * Return: 1 on success, 0 if it was already taken or memory ran out.
+ */
+int ida_mark (IdAlloc ida, unsigned int id);
+
+/*
+ * Frees the given ID so the next ida_alloc can hand it out. Freeing an ID that
+ * isn't taken does nothing.
+ */
+void ida_free (IdAlloc ida, unsigned int id);
+
+#endif
@@ -0,0 +1,141 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is a bounded lock-free multi-producer multi-consumer FIFO of PCBs, the array
+	based queue with per cell sequence counters. Each cell's sequence number says 
+	whether it is free for the producer whose ticket matches it or full for the 
+	matching consumer, so threads only ever race on a single compare and swap of the
+	head or tail position and never block each other. The capacity is rounded up to
+	a power of two.
+*/
+
+#include "lf_queue.h"
+
+
+/*
+ * Creates an empty queue holding at least capacity PCBs.
+ *
+ * Return: A new queue on success, NULL on failure.
+ */
+LFQueue lfq_create (size_t capacity) {
+	LFQueue queue = (LFQueue) malloc(sizeof(struct lf_queue));
+	size_t size = 2;
+	
+	while (size < capacity) {
+		size <<= 1;
+	}
+	
+	if (queue != NULL) {
+		queue->cells = (lfq_cell_s *) malloc(sizeof(lfq_cell_s) * size);
+		if (queue->cells == NULL) {
+			free(queue);
+			return NULL;
+		}
+		for (size_t i = 0; i < size; i++) {
+			atomic_init(&queue->cells[i].sequence, i);
+			queue->cells[i].pcb = NULL;
+		}
+		queue->mask = size - 1;
+		atomic_init(&queue->tail, 0);
+		atomic_init(&queue->head, 0);
+	}
+	
+	return queue;
+}
+
+
+/*
+ * Destroys the queue and every PCB still in it. No other thread may be using it.
+ */
+void lfq_destroy (LFQueue queue) {
+	PCB pcb = NULL;
+	
+	if (queue) {
+		while ((pcb = lfq_dequeue(queue))) {
+			PCB_destroy(pcb);
+		}
+		free(queue->cells);
+		free(queue);
+	}
+}
+
+
+/*
+ * Adds the PCB to the back of the queue. Safe to call from any thread.
+ *
+ * Return: 1 on success, 0 if the queue is full.
+ */
+int lfq_enqueue (LFQueue queue, PCB pcb) {
+	lfq_cell_s * cell = NULL;
+	size_t pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+	size_t seq = 0;
+	intptr_t diff = 0;
+	
+	for (;;) {
+		cell = &queue->cells[pos & queue->mask];
+		seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+		diff = (intptr_t) seq - (intptr_t) pos;
+		if (diff == 0) { //the cell is free for this position, try to claim it
+			if (atomic_compare_exchange_weak_explicit(&queue->tail, &pos, pos + 1, 
+					memory_order_relaxed, memory_order_relaxed)) {
+				break;
+			}
+		} else if (diff < 0) { //the cell still holds a PCB from one lap ago, we're full
+			return 0;
+		} else { //another producer took this position, catch up
+			pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+		}
+	}
+	
+	cell->pcb = pcb;
+	atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+	
+	return 1;
+}
+
+
+/*
+ * Removes the PCB at the front of the queue. Safe to call from any thread.
+ *
+ * Return: the PCB, NULL if the queue is empty.
+ */
+PCB lfq_dequeue (LFQueue queue) {
+	lfq_cell_s * cell = NULL;
+	size_t pos = atomic_load_explicit(&queue->head, memory_order_relaxed);
+	size_t seq = 0;
+	intptr_t diff = 0;
+	PCB pcb = NULL;
+	
+	for (;;) {
+		cell = &queue->cells[pos & queue->mask];
+		seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+		diff = (intptr_t) seq - (intptr_t) (pos + 1);
+		if (diff == 0) { //the cell is full for this position, try to claim it
+			if (atomic_compare_exchange_weak_explicit(&queue->head, &pos, pos + 1, 
+					memory_order_relaxed, memory_order_relaxed)) {
+				break;
+			}
+		} else if (diff < 0) { //nothing has been written here yet, we're empty
+			return NULL;
+		} else { //another consumer took this position, catch up
+			pos = atomic_load_explicit(&queue->head, memory_order_relaxed);
+		}
+	}
+	
+	pcb = cell->pcb;
+	atomic_store_explicit(&cell->sequence, pos + queue->mask + 1, memory_order_release);
+	
+	return pcb;
+}
+
+
+/*
+ * Returns how many PCBs are in the queue. Only exact when no other thread is using it.
+ */
+size_t lfq_size (LFQueue queue) {
+	size_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+	size_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+	
+	return tail > head ? tail - head : 0;
+}
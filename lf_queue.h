@@ -0,0 +1,72 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is a bounded lock-free multi-producer multi-consumer FIFO of PCBs, the array
+	based queue with per cell sequence counters. Each cell's sequence number says 
+	whether it is free for the producer whose ticket matches it or full for the 
+	matching consumer, so threads only ever race on a single compare and swap of the
+	head or tail position and never block each other. The capacity is rounded up to
+	a power of two.
+*/
+
+#ifndef LF_QUEUE_H
+#define LF_QUEUE_H
+
+#include "pcb.h"
+#include <stdatomic.h>
+#include <stdint.h>
+
+#define LFQ_CACHE_LINE 64
+
+
+typedef struct lfq_cell {
+	atomic_size_t sequence;
+	PCB pcb;
+} lfq_cell_s;
+
+typedef struct lf_queue {
+	lfq_cell_s * cells;
+	size_t mask;
+	char pad0[LFQ_CACHE_LINE]; // keeps producers and consumers off each other's cache line
+	atomic_size_t tail; // next position to enqueue at
+	char pad1[LFQ_CACHE_LINE];
+	atomic_size_t head; // next position to dequeue from
+	char pad2[LFQ_CACHE_LINE];
+} lf_queue_s;
+
+typedef lf_queue_s * LFQueue;
+
+
+/*
+ * Creates an empty queue holding at least capacity PCBs.
+ *
+ * Return: A new queue on success, NULL on failure.
+ */
+LFQueue lfq_create (size_t capacity);
+
+/*
+ * Destroys the queue and every PCB still in it. No other thread may be using it.
+ */
+void lfq_destroy (LFQueue queue);
+
+/*
+ * Adds the PCB to the back of the queue. Safe to call from any thread.
+ *
+ * Return: 1 on success, 0 if the queue is full.
+ */
+int lfq_enqueue (LFQueue queue, PCB pcb);
+
+/*
+ * Removes the PCB at the front of the queue. Safe to call from any thread.
+ *
+ * Return: the PCB, NULL if the queue is empty.
+ */
+PCB lfq_dequeue (LFQueue queue);
+
+/*
+ * Returns how many PCBs are in the queue. Only exact when no other thread is using it.
+ */
+size_t lfq_size (LFQueue queue);
+
+#endif
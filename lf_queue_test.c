@@ -0,0 +1,149 @@
+// lock-free queue testing file
+// for testing purposes only
+
+#include "lf_queue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#define PRODUCERS 4
+#define CONSUMERS 4
+#define PER_PRODUCER 200000
+#define SMALL_CAPACITY 64 // small enough that producers keep finding it full and consumers empty
+
+/*
+	The queue only moves the pointers around, so each item is a made up PCB that
+	encodes its producer and sequence number and is never dereferenced. The queue is
+	always empty by the time it's destroyed, so lfq_destroy never frees one.
+*/
+#define ITEM(producer, seq) ((PCB) (uintptr_t) ((producer) * PER_PRODUCER + (seq) + 1))
+#define ITEM_PRODUCER(item) ((int) (((uintptr_t) (item) - 1) / PER_PRODUCER))
+#define ITEM_SEQ(item) ((int) (((uintptr_t) (item) - 1) % PER_PRODUCER))
+
+LFQueue queue;
+atomic_int seen[PRODUCERS * PER_PRODUCER];
+atomic_int consumed;
+atomic_int orderErrors;
+atomic_long fullCount;
+atomic_long emptyCount;
+
+int failures = 0;
+
+
+void check (int passed, const char * what) {
+	if (passed) {
+		printf("Success: %s\n", what);
+	} else {
+		printf("Fail: %s\n", what);
+		failures++;
+	}
+}
+
+
+void * producer (void * arg) {
+	int id = (int) (intptr_t) arg;
+
+	for (int i = 0; i < PER_PRODUCER; i++) {
+		while (!lfq_enqueue(queue, ITEM(id, i))) {
+			atomic_fetch_add(&fullCount, 1);
+			sched_yield();
+		}
+	}
+
+	return NULL;
+}
+
+
+/*
+	Takes items until every producer's have all been taken. A single consumer has to
+	see each producer's items in the order they were enqueued.
+*/
+void * consumer (void * arg) {
+	int last[PRODUCERS];
+	PCB item = NULL;
+
+	for (int i = 0; i < PRODUCERS; i++) {
+		last[i] = -1;
+	}
+	while (atomic_load(&consumed) < PRODUCERS * PER_PRODUCER) {
+		item = lfq_dequeue(queue);
+		if (item == NULL) {
+			atomic_fetch_add(&emptyCount, 1);
+			sched_yield();
+			continue;
+		}
+		if (ITEM_SEQ(item) <= last[ITEM_PRODUCER(item)]) {
+			atomic_fetch_add(&orderErrors, 1);
+		}
+		last[ITEM_PRODUCER(item)] = ITEM_SEQ(item);
+		atomic_fetch_add(&seen[(uintptr_t) item - 1], 1);
+		atomic_fetch_add(&consumed, 1);
+	}
+
+	return NULL;
+}
+
+
+int main () {
+	pthread_t producers[PRODUCERS];
+	pthread_t consumers[CONSUMERS];
+	int result = 0, missing = 0, duplicated = 0;
+
+	setvbuf(stdout, NULL, _IONBF, 0);
+	printf("Beginning testing...\n");
+
+	printf("\n-------------------------\nSingle thread test - fill a queue, then empty it\n");
+	queue = lfq_create(5);
+	check(queue != NULL && queue->mask == 7, "capacity 5 is rounded up to 8");
+	check(lfq_dequeue(queue) == NULL, "a new queue is empty");
+	for (int i = 0; i < 8; i++) {
+		result += lfq_enqueue(queue, ITEM(0, i));
+	}
+	check(result == 8, "8 enqueues fit");
+	check(!lfq_enqueue(queue, ITEM(0, 8)), "the 9th enqueue reports the queue full");
+	check(lfq_size(queue) == 8, "size is 8");
+	result = 1;
+	for (int i = 0; i < 8; i++) {
+		result &= lfq_dequeue(queue) == ITEM(0, i);
+	}
+	check(result, "the 8 come out in the order they went in");
+	check(lfq_dequeue(queue) == NULL, "dequeue on the emptied queue returns NULL");
+	check(lfq_size(queue) == 0, "size is 0");
+	check(lfq_enqueue(queue, ITEM(0, 8)) && lfq_dequeue(queue) == ITEM(0, 8), "it still works once the positions wrap");
+	lfq_destroy(queue);
+
+	printf("\n-------------------------\nConcurrency test - %d producers and %d consumers, %d items each\n",
+		PRODUCERS, CONSUMERS, PER_PRODUCER);
+	queue = lfq_create(SMALL_CAPACITY);
+	for (int i = 0; i < CONSUMERS; i++) {
+		pthread_create(&consumers[i], NULL, consumer, NULL);
+	}
+	for (int i = 0; i < PRODUCERS; i++) {
+		pthread_create(&producers[i], NULL, producer, (void *) (intptr_t) i);
+	}
+	for (int i = 0; i < PRODUCERS; i++) {
+		pthread_join(producers[i], NULL);
+	}
+	for (int i = 0; i < CONSUMERS; i++) {
+		pthread_join(consumers[i], NULL);
+	}
+
+	for (int i = 0; i < PRODUCERS * PER_PRODUCER; i++) {
+		if (seen[i] == 0) {
+			missing++;
+		} else if (seen[i] > 1) {
+			duplicated++;
+		}
+	}
+	printf("full: %ld times, empty: %ld times\n", atomic_load(&fullCount), atomic_load(&emptyCount));
+	check(atomic_load(&consumed) == PRODUCERS * PER_PRODUCER, "as many items came out as went in");
+	check(missing == 0, "no item was lost");
+	check(duplicated == 0, "no item came out twice");
+	check(atomic_load(&orderErrors) == 0, "each consumer saw every producer's items in order");
+	check(lfq_dequeue(queue) == NULL && lfq_size(queue) == 0, "the queue is empty afterwards");
+	lfq_destroy(queue);
+
+	printf("\n%s, %d failed\n", failures ? "FAILED" : "PASSED", failures);
+
+	return failures != 0;
+}
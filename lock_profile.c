@@ -0,0 +1,274 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is an instrumented wrapper around a pthread mutex. Every acquisition goes
+	through lp_lock, which counts it, notes whether it had to wait, and times how long
+	it waited and (in lp_unlock) how long it was held. Wait and hold times go into
+	power of two histograms, and the holds are also totalled per call site so the
+	report can name the critical sections worth shrinking. Everything except the wait
+	itself is recorded while the mutex is held, so the profile needs no locking of
+	its own.
+	
+	Reading the clock around every lock and unlock is not free. Build with
+	-DSIM_NO_LOCK_PROFILE to keep only the acquisition and contention counts.
+*/
+
+#include "lock_profile.h"
+
+
+/*
+	The monotonic clock in nanoseconds.
+*/
+unsigned long lp_now () {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (unsigned long) now.tv_sec * 1000000000ul + now.tv_nsec;
+}
+
+
+/*
+	Returns the histogram bucket for a time: the number of bits it takes, so bucket i
+	holds times below 2^i ns.
+*/
+int lp_bucket (unsigned long ns) {
+	int bucket = 0;
+
+	while (ns && bucket < LOCK_PROFILE_BUCKETS - 1) {
+		ns >>= 1;
+		bucket++;
+	}
+
+	return bucket;
+}
+
+
+/*
+	Returns the upper bound of the bucket the given fraction of the histogram's
+	samples falls in, 0 if it is empty.
+*/
+unsigned long lp_histogram_percentile (unsigned long histogram[], double fraction) {
+	unsigned long seen = 0, total = 0, target = 0;
+
+	for (int i = 0; i < LOCK_PROFILE_BUCKETS; i++) {
+		total += histogram[i];
+	}
+	target = (unsigned long) (total * fraction);
+	if (!total) {
+		return 0;
+	}
+	if (target >= total) {
+		target = total - 1;
+	}
+	for (int i = 0; i < LOCK_PROFILE_BUCKETS; i++) {
+		seen += histogram[i];
+		if (seen > target) {
+			return i ? 1ul << i : 0;
+		}
+	}
+
+	return 1ul << (LOCK_PROFILE_BUCKETS - 1);
+}
+
+
+/*
+	Finds the call site's entry, adding it if there is room. Only called by the holder.
+*/
+lock_site_s * lp_find_site (LockProfile profile, const char * function, int line) {
+	lock_site_s * site = NULL;
+
+	for (int i = 0; i < profile->siteCount; i++) {
+		if (profile->sites[i].line == line && profile->sites[i].function == function) {
+			return &profile->sites[i];
+		}
+	}
+	if (profile->siteCount < LOCK_PROFILE_SITES) {
+		site = &profile->sites[profile->siteCount++];
+		site->function = function;
+		site->line = line;
+	}
+
+	return site;
+}
+
+
+/*
+	Starts a hold. Called right after the mutex has been acquired.
+*/
+void lp_begin_hold (LockProfile profile, const char * function, int line, unsigned long now) {
+	profile->holder = lp_find_site(profile, function, line);
+	if (!profile->holder) {
+		profile->untrackedHolds++;
+	}
+	profile->acquiredAt = now;
+}
+
+
+/*
+	Ends the current hold. Called right before the mutex is released.
+*/
+void lp_end_hold (LockProfile profile) {
+	unsigned long held = lp_now() - profile->acquiredAt;
+	lock_site_s * site = profile->holder;
+
+	profile->totalHold += held;
+	profile->holdHistogram[lp_bucket(held)]++;
+	if (site) {
+		site->holds++;
+		site->totalHold += held;
+		if (held > site->longestHold) {
+			site->longestHold = held;
+		}
+	}
+	profile->holder = NULL;
+}
+
+
+/*
+ * Resets the profile and attaches it to the mutex. Doesn't initialise the mutex.
+ */
+void lp_init (LockProfile profile, const char * name, pthread_mutex_t * mutex) {
+	memset(profile, 0, sizeof(lock_profile_s));
+	profile->name = name;
+	profile->mutex = mutex;
+}
+
+
+/*
+ * Locks the profiled mutex on behalf of the given call site.
+ */
+void lp_lock (LockProfile profile, const char * function, int line) {
+	unsigned long start = 0, now = 0;
+
+#ifdef SIM_NO_LOCK_PROFILE
+	if (pthread_mutex_trylock(profile->mutex)) {
+		pthread_mutex_lock(profile->mutex);
+		profile->contended++;
+	}
+	profile->acquisitions++;
+#else
+	if (pthread_mutex_trylock(profile->mutex)) {
+		start = lp_now();
+		pthread_mutex_lock(profile->mutex);
+		now = lp_now();
+		profile->contended++;
+		profile->totalWait += now - start;
+		profile->waitHistogram[lp_bucket(now - start)]++;
+	} else {
+		now = lp_now();
+		profile->waitHistogram[0]++;
+	}
+	profile->acquisitions++;
+	lp_begin_hold(profile, function, line, now);
+#endif
+}
+
+
+void lp_unlock (LockProfile profile) {
+#ifndef SIM_NO_LOCK_PROFILE
+	lp_end_hold(profile);
+#endif
+	pthread_mutex_unlock(profile->mutex);
+}
+
+
+/*
+ * Waits on the condition variable with the profiled mutex. The time spent asleep is
+ * not counted as holding the mutex, and waking up starts a new hold at the call site.
+ *
+ * Return: the result of pthread_cond_wait.
+ */
+int lp_cond_wait (LockProfile profile, pthread_cond_t * cond, const char * function, int line) {
+	int result = 0;
+
+#ifdef SIM_NO_LOCK_PROFILE
+	result = pthread_cond_wait(cond, profile->mutex);
+#else
+	lp_end_hold(profile);
+	result = pthread_cond_wait(cond, profile->mutex);
+	lp_begin_hold(profile, function, line, lp_now());
+#endif
+
+	return result;
+}
+
+
+/*
+	Prints the non-empty buckets of a histogram on one line.
+*/
+void lp_print_histogram (FILE * out, const char * label, unsigned long histogram[]) {
+	fprintf(out, "    %s:", label);
+	for (int i = 0; i < LOCK_PROFILE_BUCKETS; i++) {
+		if (histogram[i]) {
+			if (i == 0) {
+				fprintf(out, " 0ns:%lu", histogram[i]);
+			} else if (i == LOCK_PROFILE_BUCKETS - 1) {
+				fprintf(out, " >=%luns:%lu", 1ul << (i - 1), histogram[i]);
+			} else {
+				fprintf(out, " <%luns:%lu", 1ul << i, histogram[i]);
+			}
+		}
+	}
+	fprintf(out, "\r\n");
+}
+
+
+/*
+ * Prints one summary line per profile followed by its wait and hold histograms and
+ * the call sites with the longest holds.
+ */
+void lp_report (FILE * out, lock_profile_s profiles[], int count) {
+	LockProfile profile = NULL;
+	lock_site_s * top[LOCK_PROFILE_TOP_SITES];
+	int topCount = 0, pos = 0;
+
+	fprintf(out, "\r\nLOCK PROFILE (percentiles are histogram bucket bounds)\r\n");
+	fprintf(out, "%-14s %12s %12s %7s %12s %10s %10s %12s %10s %10s\r\n", "lock", "acquisitions",
+		"contended", "pct", "wait_ms", "wait_p50", "wait_p99", "hold_ms", "hold_p50", "hold_p99");
+	for (int i = 0; i < count; i++) {
+		profile = &profiles[i];
+		fprintf(out, "%-14s %12lu %12lu %6.2f%% %12.3f %8luns %8luns %12.3f %8luns %8luns\r\n",
+			profile->name, profile->acquisitions, profile->contended,
+			profile->acquisitions ? 100.0 * profile->contended / profile->acquisitions : 0.0,
+			profile->totalWait / 1e6,
+			lp_histogram_percentile(profile->waitHistogram, 0.50),
+			lp_histogram_percentile(profile->waitHistogram, 0.99),
+			profile->totalHold / 1e6,
+			lp_histogram_percentile(profile->holdHistogram, 0.50),
+			lp_histogram_percentile(profile->holdHistogram, 0.99));
+	}
+
+	for (int i = 0; i < count; i++) {
+		profile = &profiles[i];
+		if (!profile->acquisitions) {
+			continue;
+		}
+		fprintf(out, "\r\n  %s\r\n", profile->name);
+		lp_print_histogram(out, "wait", profile->waitHistogram);
+		lp_print_histogram(out, "hold", profile->holdHistogram);
+
+		topCount = 0; //insertion sort of the sites with the longest single hold
+		for (int s = 0; s < profile->siteCount; s++) {
+			pos = topCount < LOCK_PROFILE_TOP_SITES ? topCount++ : LOCK_PROFILE_TOP_SITES;
+			while (pos > 0 && top[pos - 1]->longestHold < profile->sites[s].longestHold) {
+				if (pos < LOCK_PROFILE_TOP_SITES) {
+					top[pos] = top[pos - 1];
+				}
+				pos--;
+			}
+			if (pos < LOCK_PROFILE_TOP_SITES) {
+				top[pos] = &profile->sites[s];
+			}
+		}
+		for (int s = 0; s < topCount; s++) {
+			fprintf(out, "    longest hold %luns at %s:%d (%lu holds, %.3fms total)\r\n",
+				top[s]->longestHold, top[s]->function, top[s]->line,
+				top[s]->holds, top[s]->totalHold / 1e6);
+		}
+		if (profile->untrackedHolds) {
+			fprintf(out, "    %lu holds from untracked sites\r\n", profile->untrackedHolds);
+		}
+	}
+}
@@ -0,0 +1,82 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is an instrumented wrapper around a pthread mutex. Every acquisition goes
+	through lp_lock, which counts it, notes whether it had to wait, and times how long
+	it waited and (in lp_unlock) how long it was held. Wait and hold times go into
+	power of two histograms, and the holds are also totalled per call site so the
+	report can name the critical sections worth shrinking. Everything except the wait
+	itself is recorded while the mutex is held, so the profile needs no locking of
+	its own. -DSIM_NO_LOCK_PROFILE leaves only the acquisition and contention counts.
+*/
+
+#ifndef LOCK_PROFILE_H
+#define LOCK_PROFILE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#define LOCK_PROFILE_BUCKETS 32 // bucket i holds times below 2^i ns, the last one everything longer
+#define LOCK_PROFILE_SITES 32
+#define LOCK_PROFILE_TOP_SITES 3
+
+
+/* The holds taken from one place in the code. */
+typedef struct lock_site {
+	const char * function;
+	int line;
+	unsigned long holds;
+	unsigned long totalHold; // ns
+	unsigned long longestHold; // ns
+} lock_site_s;
+
+typedef struct lock_profile {
+	const char * name;
+	pthread_mutex_t * mutex;
+	unsigned long acquisitions;
+	unsigned long contended; // acquisitions that found the mutex already held
+	unsigned long totalWait; // ns
+	unsigned long totalHold; // ns
+	unsigned long waitHistogram[LOCK_PROFILE_BUCKETS];
+	unsigned long holdHistogram[LOCK_PROFILE_BUCKETS];
+	lock_site_s sites[LOCK_PROFILE_SITES];
+	int siteCount;
+	unsigned long untrackedHolds; // holds from sites past LOCK_PROFILE_SITES
+	unsigned long acquiredAt; // when the current holder got it
+	lock_site_s * holder; // the current holder's site, NULL if untracked
+} lock_profile_s;
+
+typedef lock_profile_s * LockProfile;
+
+
+/*
+ * Resets the profile and attaches it to the mutex. Doesn't initialise the mutex.
+ */
+void lp_init (LockProfile profile, const char * name, pthread_mutex_t * mutex);
+
+/*
+ * Locks the profiled mutex on behalf of the given call site.
+ */
+void lp_lock (LockProfile profile, const char * function, int line);
+
+void lp_unlock (LockProfile profile);
+
+/*
+ * Waits on the condition variable with the profiled mutex. The time spent asleep is
+ * not counted as holding the mutex, and waking up starts a new hold at the call site.
+ *
+ * Return: the result of pthread_cond_wait.
+ */
+int lp_cond_wait (LockProfile profile, pthread_cond_t * cond, const char * function, int line);
+
+/*
+ * Prints one summary line per profile followed by its wait and hold histograms and
+ * the call sites with the longest holds.
+ */
+void lp_report (FILE * out, lock_profile_s profiles[], int count);
+
+#endif
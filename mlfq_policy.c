@@ -0,0 +1,129 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	The multi-level feedback queue policy. Ready PCBs sit in one FIFO ReadyQueue per
+	priority level, a PCB that uses its whole quantum drops a level, and PCBs that
+	wait too long at a level are aged back up.
+*/
+
+#include "mlfq_policy.h"
+
+
+void mlfq_enqueue (SchedPolicy policy, PCB pcb) {
+	PriorityQueue PQ = (PriorityQueue) policy->data;
+	
+	pq_set_clock(PQ, policy->clock);
+	pq_enqueue(PQ, pcb);
+}
+
+
+PCB mlfq_pick_next (SchedPolicy policy) {
+	return pq_dequeue((PriorityQueue) policy->data);
+}
+
+
+PCB mlfq_peek (SchedPolicy policy) {
+	return pq_peek((PriorityQueue) policy->data);
+}
+
+
+PCB mlfq_remove (SchedPolicy policy, PCB pcb) {
+	return pq_remove_matching_pcb((PriorityQueue) policy->data, pcb);
+}
+
+
+/*
+	A PCB runs for the quantum size of the level it is on.
+*/
+unsigned int mlfq_quantum (SchedPolicy policy, PCB pcb) {
+	PriorityQueue PQ = (PriorityQueue) policy->data;
+	
+	return PQ->queues[pcb->priority]->quantum_size;
+}
+
+
+/*
+	A PCB that used up its quantum is demoted one level. The lowest level is the
+	floor, a PCB there stays there until aging moves it back up.
+*/
+void mlfq_on_tick (SchedPolicy policy, PCB pcb) {
+	if (pcb->priority < NUM_PRIORITIES - 1) {
+		PCB_assign_priority(pcb, pcb->priority + 1);
+	}
+}
+
+
+/*
+	Promotes the PCBs that have waited at their level for AGING_THRESHOLD iterations,
+	at most AGING_BUDGET of them per call.
+*/
+void mlfq_on_boost (SchedPolicy policy) {
+	PriorityQueue PQ = (PriorityQueue) policy->data;
+	int promoted = 0;
+	
+	pq_set_clock(PQ, policy->clock);
+	promoted = pq_age(PQ, AGING_THRESHOLD, AGING_BUDGET);
+	if (promoted) {
+		trace("\r\nAGING MLFQ: promoted %d PCBs\r\n", promoted);
+	}
+}
+
+
+int mlfq_count (SchedPolicy policy) {
+	PriorityQueue PQ = (PriorityQueue) policy->data;
+	int count = 0;
+	
+	for (int i = 0; i < NUM_PRIORITIES; i++) {
+		count += PQ->queues[i]->size;
+	}
+	
+	return count;
+}
+
+
+void mlfq_print (SchedPolicy policy) {
+	toStringPriorityQueue((PriorityQueue) policy->data);
+}
+
+
+void mlfq_checkpoint (SchedPolicy policy, Checkpoint ckpt) {
+	ckpt_priority_queue((PriorityQueue) policy->data, ckpt);
+}
+
+
+void mlfq_destroy (SchedPolicy policy) {
+	pq_destroy((PriorityQueue) policy->data);
+	policy->data = NULL;
+}
+
+
+/*
+ * Creates an MLFQ policy backed by a PriorityQueue.
+ *
+ * Return: the new policy, NULL on failure.
+ */
+SchedPolicy mlfq_policy_create () {
+	SchedPolicy policy = policy_alloc("mlfq");
+	
+	if (policy != NULL) {
+		policy->data = pq_create();
+		if (policy->data == NULL) {
+			free(policy);
+			return NULL;
+		}
+		policy->enqueue = mlfq_enqueue;
+		policy->pick_next = mlfq_pick_next;
+		policy->peek = mlfq_peek;
+		policy->remove = mlfq_remove;
+		policy->quantum = mlfq_quantum;
+		policy->on_tick = mlfq_on_tick;
+		policy->on_boost = mlfq_on_boost;
+		policy->count = mlfq_count;
+		policy->print = mlfq_print;
+		policy->checkpoint = mlfq_checkpoint;
+		policy->destroy = mlfq_destroy;
+	}
+	
+	return policy;
+}
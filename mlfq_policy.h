@@ -0,0 +1,27 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	The multi-level feedback queue policy. Ready PCBs sit in one FIFO ReadyQueue per
+	priority level, a PCB that uses its whole quantum drops a level, and PCBs that
+	wait too long at a level are aged back up.
+*/
+
+#ifndef MLFQ_POLICY_H
+#define MLFQ_POLICY_H
+
+#include "sched_policy.h"
+#include "priority_queue.h"
+
+#define AGING_THRESHOLD 2000
+#define AGING_BUDGET 4
+
+
+/*
+ * Creates an MLFQ policy backed by a PriorityQueue.
+ *
+ * Return: the new policy, NULL on failure.
+ */
+SchedPolicy mlfq_policy_create ();
+
+#endif
@@ -35,12 +35,16 @@ int add_to_mutx_map(MutexMap theMap, Mutex theMutex, int theKey)
 		return 1;
 	}
 	int key = findKey(theKey, theMap->curr_map_size);
-	printf("Attempting to insert in location %d.\r\n", key);
+	trace("Attempting to insert in location %d.\r\n", key);
 	if(theMap->map[key] != NULL)
 	{
 		int tmp = key; // If we hit here, we need to resolve a hash collision
-		printf("--Insertion collision!--\r\n");
+		trace("--Insertion collision!--\r\n");
 		tmp++;
+		if (tmp >= theMap->curr_map_size)
+		{
+			tmp = 0;
+		}
 		while(theMap->map[tmp] != NULL)
 		{
 			if(tmp == key)
@@ -57,7 +61,7 @@ int add_to_mutx_map(MutexMap theMap, Mutex theMutex, int theKey)
 		theMap->hadCol[key] = 1;
 	}
 	theMap->map[key] = theMutex;
-	printf("Inserting at location %d.\r\n", key);
+	trace("Inserting at location %d.\r\n", key);
 	return 0;
 }
 
@@ -69,21 +73,25 @@ int remove_from_mutx_map(MutexMap theMap, int theKey)
 		return 1; // Missing value
 	}
 	int key = findKey(theKey, theMap->curr_map_size);
-	printf("Starting point pid: %d, looking for: %d\r\n", theMap->map[key]->mid, theKey);
 	if (theMap->map[key] != NULL)
 	{
+		trace("Starting point pid: %d, looking for: %d\r\n", theMap->map[key]->mid, theKey);
 		if((theMap->map[key]->mid != theKey) 
 			&& (theMap->map[key]->mid != theKey))
 		{
 			int tmp = key; // If we hit here, we had a hash collision in the past 
 						   // and need to find where our mutex got placed
-			printf("--Delete collision!--\r\n");
+			trace("--Delete collision!--\r\n");
 			
 			
 			//printf("Obtained pid: %d, looking for: %d\n", theMap->map[tmp]->pcb1->pid, theKey->pid);
 			//printf("before tmp = %d\n", tmp);
 			//printf("before tmp + 1 = %d\n", tmp + 1);
 			tmp++;
+			if (tmp >= theMap->curr_map_size)
+			{
+				tmp = 0;
+			}
 			//printf("after tmp = %d\n", tmp);
 			//printf("Moving in...\n");
 			//printf("pointer in location of tmp: %d", theMap->map[tmp]);
@@ -109,7 +117,7 @@ int remove_from_mutx_map(MutexMap theMap, int theKey)
 				//printf("passed\n");
 				/*if(theMap->map[tmp] == NULL || tmp == key)
 				{
-					printf("Not found\n");
+					trace("Not found\n");
 					return 2; // Object does not exist
 				}*/
 				//printf("passed\n");
@@ -121,7 +129,7 @@ int remove_from_mutx_map(MutexMap theMap, int theKey)
 					if (tmp >= theMap->curr_map_size)
 					{
 						tmp = 0;
-						printf("in here\n");
+						trace("in here\n");
 					}
 					//printf("tmp: %d\n", tmp);
 					//printf("next loop\n");
@@ -131,19 +139,20 @@ int remove_from_mutx_map(MutexMap theMap, int theKey)
 					//printf("theKey->parent: %d\n", theKey->parent);
 					if(tmp == key)
 					{
-						printf("Not found\r\n");
+						trace("Not found\r\n");
 						return 2; // Object does not exist
 					}
 				}
 				while(theMap->map[tmp] == NULL);
 			}
 			key = tmp;
-			printf("here\n");
+			trace("here\n");
 		}
 		Mutex toFree = theMap->map[key];
-		printf("Removing from location %d.\r\nObtained pid: %d, looking for: %d\r\n", key, toFree->mid, theKey);
+		trace("Removing from location %d.\r\nObtained pid: %d, looking for: %d\r\n", key, toFree->mid, theKey);
 		mutex_destroy(toFree);
 		theMap->map[key] = NULL;
+		theMap->hadCol[key] = 1; //keys that probed past this bucket have to keep probing
 			
 		return 0;
 	}
@@ -188,13 +197,17 @@ Mutex take_n_remove_from_mutx_map(MutexMap theMap, int theKey)
 		key = tmp;
 				
 	}
-	printf("Attempting to remove M%d from location %d.\n", theKey, key);
+	trace("Attempting to remove M%d from location %d.\n", theKey, key);
 	if((theMap->map[key]->mid != theKey))
 	{
 		int tmp = key; // If we hit here, we had a hash collision in the past 
 					   // and need to find where our mutex got placed
 		tmp++;
-		printf("Delete and Remove collision!\r\n");
+		if (tmp >= theMap->curr_map_size)
+		{
+			tmp = 0;
+		}
+		trace("Delete and Remove collision!\r\n");
 		while(theMap->map[tmp] == NULL)
 		{
 			if(tmp == key)
@@ -233,6 +246,7 @@ Mutex take_n_remove_from_mutx_map(MutexMap theMap, int theKey)
 	Mutex toFree = theMap->map[key];
 	//mutex_destroy(toFree);
 	theMap->map[key] = NULL;
+	theMap->hadCol[key] = 1; //keys that probed past this bucket have to keep probing
 	//toStringMutexMap(theMap);
 	return toFree;
 }
@@ -250,7 +264,7 @@ Mutex get_mutx(MutexMap theMap, int theKey)
 	if (theMap->map[key] == NULL && theMap->hadCol[key] == 0)
 	{
 		//toStringMutexMap(theMap);
-		printf("Trying to get key %d from theKey %d, but found NULL in map\r\n", key, theKey);
+		trace("Trying to get key %d from theKey %d, but found NULL in map\r\n", key, theKey);
 		// printf("in here2\n");
 		return NULL;
 	}
@@ -277,17 +291,21 @@ Mutex get_mutx(MutexMap theMap, int theKey)
 				
 	}
 	//toStringMutexMap(theMap);
-	printf("Searching for mutex with key: %d.\r\n", key);
+	trace("Searching for mutex with key: %d.\r\n", key);
 	
 	if((theMap->map[key]->mid != theKey))
 	{
 		int tmp = key; // If we hit here, we had a hash collision in the past 
 					   // and need to find where our mutex got placed
 		tmp++;
-		printf("--Search collision!--\r\n");
+		if (tmp >= theMap->curr_map_size)
+		{
+			tmp = 0;
+		}
+		trace("--Search collision!--\r\n");
 		/*toStringMutexMap(theMap);
-		printf("Trying to find P%d\n", theKey->pid);
-		printf("tmp: %d\n", tmp);*/
+		trace("Trying to find P%d\n", theKey->pid);
+		trace("tmp: %d\n", tmp);*/
 		//printf("Want: %d, have: %d, also have: %d vs %d\n", theKey->pid, theMap->map[tmp]->pcb1->pid, theMap->map[tmp]->pcb2->parent, theKey->parent);
 		while(theMap->map[tmp] == NULL)
 		{
@@ -323,9 +341,9 @@ Mutex get_mutx(MutexMap theMap, int theKey)
 	}
 	Mutex toFree = theMap->map[key];
 	if (toFree) {
-		printf("returning M%d\r\n", toFree->mid);
+		trace("returning M%d\r\n", toFree->mid);
 	} else {
-		printf("return NULL\r\n");
+		trace("return NULL\r\n");
 	}
 	//mutex_destroy(toFree);
 	//theMap->map[key] = NULL;
@@ -348,15 +366,15 @@ int findKey(int theKey, int mapSize)
 
 
 void toStringMutexMap (MutexMap theMap) {
-	printf("MutexMap\r\n");
+	trace("MutexMap\r\n");
 	for (int i = 0; i < MAX_INIT_BUCKETS; i++) {
 		if (theMap->map[i]) {
-			printf("map[%d]->pcb: M%d\r\n", i, theMap->map[i]->mid);
+			trace("map[%d]->pcb: M%d\r\n", i, theMap->map[i]->mid);
 		} else {
-			printf("map[%d]->pcb: *\r\n", i);
+			trace("map[%d]->pcb: *\r\n", i);
 		}
 	}
-	printf("Total MutexMap size: %d\r\n", theMap->curr_map_size);
+	trace("Total MutexMap size: %d\r\n", theMap->curr_map_size);
 }
 
 
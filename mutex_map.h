@@ -73,6 +73,4 @@ Mutex get_mutx(MutexMap theMap, int thekey);
 
 void mutex_map_destroy (MutexMap theMap);
 
-
-
 #endif
@@ -0,0 +1,378 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	The O(1) policy, modeled on the classic Linux scheduler. There are two priority
+	arrays, each one FIFO ReadyQueue per level plus a bitmap of the non-empty levels,
+	so the next PCB is found with a single bit scan. PCBs that use up their slice
+	move to the expired array, and once the active array runs dry the two are swapped
+	by pointer, which starts a new epoch without walking any queue. PCBs that spend a
+	lot of time blocked in I/O earn a priority bonus and stay in the active array,
+	unless the expired array has been waiting long enough to be starving.
+*/
+
+#include "o1_policy.h"
+
+typedef struct prio_array {
+	ReadyQueue queues[NUM_PRIORITIES];
+	unsigned int bitmap; // bit i is set when queues[i] is not empty
+	int size;
+	int id; // which of the two arrays this is, kept in ready_index
+} prio_array_s;
+
+typedef prio_array_s * PrioArray;
+
+typedef struct o1_data {
+	prio_array_s arrays[2];
+	PrioArray active;
+	PrioArray expired;
+	unsigned int expired_since; // when the first PCB expired this epoch, -1 if none has
+	unsigned int epochs;
+} o1_data_s;
+
+typedef o1_data_s * O1Data;
+
+
+unsigned int o1_bonus (PCB pcb) {
+	return pcb->sleep_avg * O1_MAX_BONUS / O1_MAX_SLEEP_AVG;
+}
+
+
+/*
+	The level a PCB is queued at: its static priority moved up by its sleep bonus, or
+	down if it hardly ever sleeps.
+*/
+int o1_effective_priority (PCB pcb) {
+	int prio = (int) pcb->priority + O1_MAX_BONUS / 2 - (int) o1_bonus(pcb);
+	
+	if (prio < 0) {
+		prio = 0;
+	} else if (prio > NUM_PRIORITIES - 1) {
+		prio = NUM_PRIORITIES - 1;
+	}
+	
+	return prio;
+}
+
+
+/*
+	Higher static priorities get longer slices.
+*/
+unsigned int o1_timeslice (PCB pcb) {
+	int prio = pcb->priority < NUM_PRIORITIES ? pcb->priority : NUM_PRIORITIES - 1;
+	
+	return O1_MIN_TIMESLICE + O1_TIMESLICE_STEP * (NUM_PRIORITIES - 1 - prio);
+}
+
+
+void o1_array_push (PrioArray array, PCB pcb) {
+	int prio = o1_effective_priority(pcb);
+	
+	if (q_enqueue(array->queues[prio], pcb)) {
+		array->bitmap |= 1u << prio;
+		array->size++;
+		pcb->ready_index = array->id * NUM_PRIORITIES + prio;
+	} else {
+		trace("\t\t\tO(1) COULDN'T ENQUEUE P%d\t\t\t\r\n", pcb->pid);
+	}
+}
+
+
+PCB o1_array_pop (PrioArray array) {
+	int prio = 0;
+	PCB pcb = NULL;
+	
+	if (array->bitmap) {
+		prio = __builtin_ctz(array->bitmap);
+		pcb = q_dequeue(array->queues[prio]);
+		if (q_is_empty(array->queues[prio])) {
+			array->bitmap &= ~(1u << prio);
+		}
+		array->size--;
+		pcb->ready_index = -1;
+	}
+	
+	return pcb;
+}
+
+
+/*
+	Swaps the arrays if the active one is empty, which starts the next epoch.
+*/
+void o1_maybe_swap (O1Data o1) {
+	PrioArray temp = NULL;
+	
+	if (!o1->active->size && o1->expired->size) {
+		temp = o1->active;
+		o1->active = o1->expired;
+		o1->expired = temp;
+		o1->expired_since = -1;
+		o1->epochs++;
+	}
+}
+
+
+/*
+	Takes the iterations the PCB ran off its slice and its sleep average. Does 
+	nothing if it isn't running.
+	
+	Return: 1 if the PCB was running, 0 otherwise.
+*/
+int o1_charge (SchedPolicy policy, PCB pcb) {
+	unsigned int ran = 0;
+	
+	if (pcb->exec_start == (unsigned int) -1) {
+		return 0;
+	}
+	if (policy->clock > pcb->exec_start) {
+		ran = policy->clock - pcb->exec_start;
+	}
+	pcb->run_time += ran;
+	pcb->time_slice -= ran < pcb->time_slice ? ran : pcb->time_slice;
+	pcb->sleep_avg -= ran < pcb->sleep_avg ? ran : pcb->sleep_avg;
+	pcb->exec_start = -1;
+	
+	return 1;
+}
+
+
+/*
+	A PCB that used up its slice gets a new one and goes to the expired array, unless 
+	it is interactive and the expired array isn't starving. Everything else, new PCBs,
+	woken PCBs and ones that gave up the CPU early, goes to the active array.
+*/
+void o1_enqueue (SchedPolicy policy, PCB pcb) {
+	O1Data o1 = (O1Data) policy->data;
+	int expired = 0, starving = 0;
+	
+	if (o1_charge(policy, pcb) && !pcb->time_slice) {
+		starving = o1->expired_since != (unsigned int) -1 
+			&& policy->clock - o1->expired_since >= O1_STARVATION_LIMIT;
+		expired = o1_bonus(pcb) < O1_INTERACTIVE_BONUS || starving;
+	}
+	if (!pcb->time_slice) {
+		pcb->time_slice = o1_timeslice(pcb);
+	}
+	
+	if (expired) {
+		if (!o1->expired->size) {
+			o1->expired_since = policy->clock;
+		}
+		o1_array_push(o1->expired, pcb);
+	} else {
+		o1_array_push(o1->active, pcb);
+	}
+}
+
+
+PCB o1_pick_next (SchedPolicy policy) {
+	O1Data o1 = (O1Data) policy->data;
+	PCB pcb = NULL;
+	
+	o1_maybe_swap(o1);
+	pcb = o1_array_pop(o1->active);
+	if (pcb) {
+		pcb->exec_start = policy->clock;
+	}
+	
+	return pcb;
+}
+
+
+PCB o1_peek (SchedPolicy policy) {
+	O1Data o1 = (O1Data) policy->data;
+	
+	o1_maybe_swap(o1);
+	if (!o1->active->bitmap) {
+		return NULL;
+	}
+	
+	return q_peek(o1->active->queues[__builtin_ctz(o1->active->bitmap)]);
+}
+
+
+/*
+	The PCB's ready_index says which array and level it is in, so only that one 
+	queue is searched.
+*/
+PCB o1_remove (SchedPolicy policy, PCB pcb) {
+	O1Data o1 = (O1Data) policy->data;
+	PrioArray array = NULL;
+	int prio = 0;
+	
+	if (pcb->ready_index < 0 || pcb->ready_index >= 2 * NUM_PRIORITIES) {
+		return NULL;
+	}
+	array = &o1->arrays[pcb->ready_index / NUM_PRIORITIES];
+	prio = pcb->ready_index % NUM_PRIORITIES;
+	if (!q_remove(array->queues[prio], pcb)) {
+		return NULL;
+	}
+	if (q_is_empty(array->queues[prio])) {
+		array->bitmap &= ~(1u << prio);
+	}
+	array->size--;
+	pcb->ready_index = -1;
+	if (array == o1->expired && !array->size) {
+		o1->expired_since = -1;
+	}
+	
+	return pcb;
+}
+
+
+unsigned int o1_quantum (SchedPolicy policy, PCB pcb) {
+	return pcb->time_slice ? pcb->time_slice : 1;
+}
+
+
+/*
+	The PCB ran out its slice. It is still marked as running, so enqueue charges it
+	and decides which array it goes to.
+*/
+void o1_on_tick (SchedPolicy policy, PCB pcb) {
+	pcb->time_slice = 0;
+}
+
+
+void o1_on_block (SchedPolicy policy, PCB pcb) {
+	o1_charge(policy, pcb);
+	pcb->sleep_start = policy->clock;
+}
+
+
+/*
+	Time spent blocked is credited to the sleep average, which is what the 
+	interactivity bonus is based on.
+*/
+void o1_on_wake (SchedPolicy policy, PCB pcb) {
+	unsigned int slept = policy->clock > pcb->sleep_start ? policy->clock - pcb->sleep_start : 0;
+	
+	pcb->sleep_avg += slept;
+	if (pcb->sleep_avg > O1_MAX_SLEEP_AVG) {
+		pcb->sleep_avg = O1_MAX_SLEEP_AVG;
+	}
+}
+
+
+int o1_count (SchedPolicy policy) {
+	O1Data o1 = (O1Data) policy->data;
+	
+	return o1->active->size + o1->expired->size;
+}
+
+
+void o1_print_array (const char * name, PrioArray array) {
+	trace("%s array, bitmap: %04x, Count=%d\r\n", name, array->bitmap, array->size);
+	for (int i = 0; i < NUM_PRIORITIES; i++) {
+		if (array->bitmap & (1u << i)) {
+			trace("Q%2d: ", i);
+			toStringReadyQueue(array->queues[i]);
+		}
+	}
+}
+
+
+void o1_print (SchedPolicy policy) {
+	O1Data o1 = (O1Data) policy->data;
+	
+	trace("Epoch %d\r\n", o1->epochs);
+	o1_print_array("Active", o1->active);
+	o1_print_array("Expired", o1->expired);
+}
+
+
+/*
+	Writes both arrays and which of them is active, or reads them back.
+*/
+void o1_checkpoint (SchedPolicy policy, Checkpoint ckpt) {
+	O1Data o1 = (O1Data) policy->data;
+	PrioArray array = NULL;
+	int active = o1->active == &o1->arrays[1];
+	
+	for (int a = 0; a < 2; a++) {
+		array = &o1->arrays[a];
+		for (int i = 0; i < NUM_PRIORITIES; i++) {
+			ckpt_queue(array->queues[i], ckpt);
+		}
+		ckpt_value(ckpt, array->bitmap);
+		ckpt_value(ckpt, array->size);
+	}
+	ckpt_value(ckpt, active);
+	ckpt_value(ckpt, o1->expired_since);
+	ckpt_value(ckpt, o1->epochs);
+	if (ckpt->loading) {
+		o1->active = &o1->arrays[active != 0];
+		o1->expired = &o1->arrays[active == 0];
+	}
+}
+
+
+void o1_destroy (SchedPolicy policy) {
+	O1Data o1 = (O1Data) policy->data;
+	
+	for (int a = 0; a < 2; a++) {
+		for (int i = 0; i < NUM_PRIORITIES; i++) {
+			q_destroy(o1->arrays[a].queues[i]);
+		}
+	}
+	free(o1);
+	policy->data = NULL;
+}
+
+
+/*
+ * Creates an O(1) policy with active and expired priority arrays.
+ *
+ * Return: the new policy, NULL on failure.
+ */
+SchedPolicy o1_policy_create () {
+	SchedPolicy policy = policy_alloc("o1");
+	O1Data o1 = NULL;
+	int failed = 0;
+	
+	if (policy != NULL) {
+		o1 = (O1Data) calloc(1, sizeof(struct o1_data));
+		if (o1 == NULL) {
+			free(policy);
+			return NULL;
+		}
+		for (int a = 0; a < 2; a++) {
+			o1->arrays[a].id = a;
+			for (int i = 0; i < NUM_PRIORITIES; i++) {
+				o1->arrays[a].queues[i] = q_create();
+				failed |= o1->arrays[a].queues[i] == NULL;
+			}
+		}
+		if (failed) {
+			for (int a = 0; a < 2; a++) {
+				for (int i = 0; i < NUM_PRIORITIES; i++) {
+					if (o1->arrays[a].queues[i]) {
+						q_destroy(o1->arrays[a].queues[i]);
+					}
+				}
+			}
+			free(o1);
+			free(policy);
+			return NULL;
+		}
+		o1->active = &o1->arrays[0];
+		o1->expired = &o1->arrays[1];
+		o1->expired_since = -1;
+		policy->data = o1;
+		policy->enqueue = o1_enqueue;
+		policy->pick_next = o1_pick_next;
+		policy->peek = o1_peek;
+		policy->remove = o1_remove;
+		policy->quantum = o1_quantum;
+		policy->on_tick = o1_on_tick;
+		policy->on_block = o1_on_block;
+		policy->on_wake = o1_on_wake;
+		policy->count = o1_count;
+		policy->print = o1_print;
+		policy->checkpoint = o1_checkpoint;
+		policy->destroy = o1_destroy;
+	}
+	
+	return policy;
+}
@@ -0,0 +1,35 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	The O(1) policy, modeled on the classic Linux scheduler. There are two priority
+	arrays, each one FIFO ReadyQueue per level plus a bitmap of the non-empty levels,
+	so the next PCB is found with a single bit scan. PCBs that use up their slice
+	move to the expired array, and once the active array runs dry the two are swapped
+	by pointer, which starts a new epoch without walking any queue. PCBs that spend a
+	lot of time blocked in I/O earn a priority bonus and stay in the active array,
+	unless the expired array has been waiting long enough to be starving.
+*/
+
+#ifndef O1_POLICY_H
+#define O1_POLICY_H
+
+#include "sched_policy.h"
+#include "fifo_queue.h"
+
+#define O1_MIN_TIMESLICE 5
+#define O1_TIMESLICE_STEP 5 // extra iterations of slice per priority level above the lowest
+#define O1_MAX_BONUS 4 // the dynamic priority moves at most half this up or down
+#define O1_MAX_SLEEP_AVG 1000
+#define O1_INTERACTIVE_BONUS 3 // PCBs with at least this bonus go back to the active array
+#define O1_STARVATION_LIMIT 500 // once the expired array has waited this long, nobody skips it
+
+
+/*
+ * Creates an O(1) policy with active and expired priority arrays.
+ *
+ * Return: the new policy, NULL on failure.
+ */
+SchedPolicy o1_policy_create ();
+
+#endif
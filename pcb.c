@@ -3,21 +3,93 @@
 	Authors: Connor Lundberg, Jasmine Dacones, Jacob Ackerman
  */
 
+#include <pthread.h>
 #include "pcb.h"
+#include "id_alloc.h"
+#include "phys_mem.h"
 
-int global_largest_PID = 0;
+PCBTable pcbTable = NULL;
+unsigned int simRandState = 1;
+int traceEnabled = 1;
+
+/*
+	PIDs come from a lowest-free bitmap, so a PID is reused as soon as its PCB is
+	destroyed and the PIDs in use stay below the most PCBs ever alive at once. The
+	index maps each PID to its PCB. Both are guarded by their own lock, so any thread
+	may create, destroy or look up a PCB without holding the scheduler's locks.
+*/
+IdAlloc pidAlloc = NULL;
+PCB * pidIndex = NULL;
+unsigned int pidIndexCapacity = 0;
+pthread_mutex_t pidLock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+	Destroyed PCBs keep their context and go back to this pool instead of to free, 
+	up to PCB_POOL_CAPACITY of them, and PCB_create takes from it first. PCBs are 
+	destroyed on the reclaimer thread while others are created on osLoop's, so the
+	pool has its own lock too.
+*/
+PCB pcbPool[PCB_POOL_CAPACITY];
+int pcbPoolCount = 0;
+pthread_mutex_t poolLock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+	The physical memory PCB_create gives footprints from, NULL for none. PCBs are 
+	destroyed on the reclaimer thread too, so it has its own lock as well.
+*/
+PhysMem pcbMemory = NULL;
+pthread_mutex_t memoryLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+/*
+ * Returns the next number from the simulators' random sequence, like rand.
+ */
+int sim_rand() {
+	return rand_r(&simRandState);
+}
+
+
+/*
+ * Restarts the simulators' random sequence from the given seed, like srand.
+ */
+void sim_srand(unsigned int seed) {
+	simRandState = seed;
+}
 
 /*
  * Helper function to iniialize PCB data.
  */
 void initialize_data(/* in-out */ PCB pcb) {
+	pcb->slot = -1;
 	pcb->pid = 0;
 	pcb->parent = -1;
 	PCB_assign_priority(pcb, 0);
 	pcb->size = 0;
 	pcb->channel_no = 0;
-	pcb->state = 0;
+	pcb->state = STATE_NEW;
 	pcb->blocked_timer = -1;
+	pcb->io_done_at = 0;
+	pcb->vruntime = 0;
+	pcb->exec_start = -1;
+	pcb->run_time = 0;
+	pcb->tickets = 0;
+	pcb->pass = 0;
+	pcb->ready_index = -1;
+	pcb->ready_at = 0;
+	pcb->location = LOC_NONE;
+	pcb->node = NULL;
+	pcb->page_table = NULL;
+	pcb->page_count = 0;
+	pcb->fault_page = -1;
+	pcb->footprint = 0;
+	pcb->phys_block = PM_NONE;
+	pcb->time_slice = 0;
+	pcb->sleep_avg = 0;
+	pcb->sleep_start = 0;
+	pcb->rt_period = 0;
+	pcb->rt_budget = 0;
+	pcb->rt_used = 0;
+	pcb->rt_deadline = 0;
 
 	pcb->mem = NULL;
 
@@ -35,7 +107,7 @@ void initialize_data(/* in-out */ PCB pcb) {
 	pcb->max_pc = makeMaxPC();
 	pcb->creation = 0;
 	pcb->termination = 0;
-	pcb->terminate = rand() % MAX_TERM_COUNT;
+	pcb->terminate = sim_rand() % MAX_TERM_COUNT;
 	if (pcb->terminate == 0) {
 		pcb->terminate++;
 	}
@@ -54,7 +126,7 @@ void initialize_data(/* in-out */ PCB pcb) {
 		- 12.5% will be Shared Resource
 */
 enum pcb_type chooseRole () {
-	int num = rand() % ROLE_PERCENTAGE_MAX_RANGE;
+	int num = sim_rand() % ROLE_PERCENTAGE_MAX_RANGE;
 	enum pcb_type newRole;
 	
 	if (num <= COMP_ROLE_MAX_RANGE) {
@@ -79,8 +151,6 @@ enum pcb_type chooseRole () {
 	within the given shared mutex will be set.
 */
 void initialize_pcb_type (PCB pcb, int isFirst, Mutex sharedMutexR1, Mutex sharedMutexR2) {
-	int lock = 0, unlock = 0, signal = 0, wait = 0;
-	
 	if (isFirst) {
 		pcb->role = chooseRole();
 	} else {
@@ -111,7 +181,7 @@ void initialize_pcb_type (PCB pcb, int isFirst, Mutex sharedMutexR1, Mutex share
 			break;
 		case PAIR:
 			if (isFirst) {
-				if ((rand() % 100) > 49) { //this decides if it's producer or consumer
+				if ((sim_rand() % 100) > 49) { //this decides if it's producer or consumer
 					pcb->isProducer = 1;
 				} else {
 					pcb->isConsumer = 1;
@@ -127,6 +197,10 @@ void initialize_pcb_type (PCB pcb, int isFirst, Mutex sharedMutexR1, Mutex share
 				sharedMutexR1->pcb2 = pcb;
 				sharedMutexR2->pcb2 = pcb;
 			}
+			if (pcb->isProducer) {
+				pcb->rt_period = RT_PERIOD;
+				pcb->rt_budget = RT_BUDGET;
+			}
 			pcb->mutex_R1_id = sharedMutexR1->mid;
 			pcb->mutex_R2_id = sharedMutexR2->mid;
 			break;
@@ -151,9 +225,9 @@ void initialize_pcb_type (PCB pcb, int isFirst, Mutex sharedMutexR1, Mutex share
 */
 void printPCLocations (unsigned int pcLocs[]) {
 	for (int i = 0; i < TRAP_COUNT; i++) {
-		printf("%d ", pcLocs[i]);
+		trace("%d ", pcLocs[i]);
 	}
-	printf("\r\n");
+	trace("\r\n");
 }
 
 
@@ -167,7 +241,7 @@ void printPCLocations (unsigned int pcLocs[]) {
 void populateIOTraps (PCB pcb, int ioTrapType) {
 	unsigned int newRand = 0;
 	for (int i = 0; i < TRAP_COUNT; i++) {
-		newRand = rand() % pcb->max_pc;
+		newRand = sim_rand() % pcb->max_pc;
 		while (ioTrapContains(newRand, pcb->io_1_traps) || ioTrapContains(newRand, pcb->io_2_traps)) {
 			newRand++;
 		}
@@ -247,24 +321,148 @@ int ioTrapContains (unsigned int newRand, unsigned int ioTraps[]) {
 	and returned.
 */
 unsigned int makeMaxPC () {
-	unsigned int maxPC = rand() % LARGEST_PC_POSSIBLE;
-	if (maxPC < SMALLEST_PC_POSSIBLE) maxPC += ((rand() % SMALLEST_PC_POSSIBLE) + SMALLEST_PC_POSSIBLE);
+	unsigned int maxPC = sim_rand() % LARGEST_PC_POSSIBLE;
+	if (maxPC < SMALLEST_PC_POSSIBLE) maxPC += ((sim_rand() % SMALLEST_PC_POSSIBLE) + SMALLEST_PC_POSSIBLE);
 	return maxPC;
 }
 
 
 /*
- * Allocate a PCB and a context for that PCB.
+	Takes a PCB from the pool, cleared as if it was just allocated, or NULL if the
+	pool is empty.
+*/
+PCB pcb_pool_take() {
+	PCB pcb = NULL;
+	CPU_context_p context = NULL;
+	
+	pthread_mutex_lock(&poolLock);
+	if (pcbPoolCount) {
+		pcb = pcbPool[--pcbPoolCount];
+	}
+	pthread_mutex_unlock(&poolLock);
+	if (pcb) {
+		context = pcb->context;
+		memset(pcb, 0, sizeof(struct pcb));
+		memset(context, 0, sizeof(struct cpu_context));
+		pcb->context = context;
+	}
+	
+	return pcb;
+}
+
+
+/*
+	Puts a destroyed PCB back in the pool, or frees it if the pool is full.
+*/
+void pcb_pool_put(PCB pcb) {
+	int kept = 0;
+	
+	pthread_mutex_lock(&poolLock);
+	if (pcb->context && pcbPoolCount < PCB_POOL_CAPACITY) {
+		pcbPool[pcbPoolCount++] = pcb;
+		kept = 1;
+	}
+	pthread_mutex_unlock(&poolLock);
+	if (!kept) {
+		free(pcb->context);
+		free(pcb);
+	}
+}
+
+
+/*
+ * Frees every PCB kept in the pool.
+ */
+void PCB_pool_drain() {
+	pthread_mutex_lock(&poolLock);
+	while (pcbPoolCount) {
+		pcbPoolCount--;
+		free(pcbPool[pcbPoolCount]->context);
+		free(pcbPool[pcbPoolCount]);
+	}
+	pthread_mutex_unlock(&poolLock);
+}
+
+
+/*
+ * Makes PCB_create give every PCB a footprint from the physical memory, NULL for
+ * none. The footprints of the live PCBs are moved into it, in table order, and one
+ * that doesn't fit is left holding none.
+ */
+void PCB_use_memory(PhysMem memory) {
+	PCB pcb = NULL;
+	
+	pthread_mutex_lock(&memoryLock);
+	pcbMemory = memory;
+	for (int slot = 0; pcbTable && slot < pcbTable->used; slot++) {
+		pcb = pcbTable->pcbs[slot];
+		if (pcb) {
+			pcb->phys_block = memory && pcb->footprint ? pm_alloc(memory, pcb->footprint) : PM_NONE;
+		}
+	}
+	pthread_mutex_unlock(&memoryLock);
+}
+
+
+/*
+ * Frees the PCB's physical memory. Called by PCB_destroy, and safe to call twice.
+ */
+void PCB_release_memory(PCB pcb) {
+	pthread_mutex_lock(&memoryLock);
+	if (pcbMemory && pcb->phys_block != PM_NONE) {
+		pm_free(pcbMemory, pcb->phys_block, pcb->footprint);
+	}
+	pcb->phys_block = PM_NONE;
+	pthread_mutex_unlock(&memoryLock);
+}
+
+
+/*
+	Draws the PCB's footprint and allocates it, returning 0 if the physical memory 
+	has no room for it. Does nothing without a physical memory, so the random 
+	sequence is the same as it always was.
+*/
+int pcb_take_memory(PCB pcb) {
+	if (pcbMemory == NULL) {
+		return 1;
+	}
+	pcb->footprint = MIN_FOOTPRINT << (sim_rand() % FOOTPRINT_DOUBLINGS);
+	pcb->footprint += sim_rand() % pcb->footprint;
+	pthread_mutex_lock(&memoryLock);
+	pcb->phys_block = pm_alloc(pcbMemory, pcb->footprint);
+	pthread_mutex_unlock(&memoryLock);
+	
+	return pcb->phys_block != PM_NONE;
+}
+
+
+/*
+ * Allocate a PCB and a context for that PCB, reusing a destroyed one if the pool
+ * has any. With a physical memory in use the PCB is given its footprint from it.
  *
- * Return: NULL if context or PCB allocation failed, the new pointer otherwise.
+ * Return: NULL if context, PCB or physical memory allocation failed, the new 
+ * pointer otherwise.
  */
 PCB PCB_create() {
-    PCB new_pcb = (PCB) malloc(sizeof(struct pcb));
-    if (new_pcb != NULL) {
+    PCB new_pcb = pcb_pool_take();
+	
+	if (new_pcb == NULL && (new_pcb = (PCB) malloc(sizeof(struct pcb))) != NULL) {
         new_pcb->context = (CPU_context_p) malloc(sizeof(struct cpu_context));
+	}
+    if (new_pcb != NULL) {
         if (new_pcb->context != NULL) {
             initialize_data(new_pcb);
-			PCB_assign_PID(new_pcb);
+			if (PCB_assign_PID(new_pcb)) {
+				pt_register(new_pcb);
+				if (!pcb_take_memory(new_pcb)) {
+					PCB_destroy(new_pcb);
+					new_pcb = NULL;
+				}
+			} else {
+				free(new_pcb->context);
+				free(new_pcb);
+				new_pcb = NULL;
+			}
         } else {
             free(new_pcb);
             new_pcb = NULL;
@@ -275,29 +473,141 @@ PCB PCB_create() {
 }
 
 /*
- * Frees a PCB and its context.
+ * Releases a PCB's slot, PID and physical memory and returns it to the pool, freeing
+ * it if the pool is full.
  *
  * Arguments: pcb: the pcb to free.
  */
 void PCB_destroy(/* in-out */ PCB pcb) {
 	if (pcb) {
-		if (pcb->context) {
-			free(pcb->context); 
-		}	
-		free(pcb);
+		pt_release(pcb);
+		PCB_release_PID(pcb);
+		PCB_release_memory(pcb);
+		free(pcb->page_table);
+		pcb->page_table = NULL;
+		pcb_pool_put(pcb);
 		
 		pcb = NULL;
 	}
 }
 
 /*
- * Assigns intial process ID to the process.
+	Grows the PID index until it covers the given PID, with pidLock held.
+*/
+int pid_index_reserve(unsigned int pid) {
+	unsigned int capacity = pidIndexCapacity ? pidIndexCapacity : PCB_TABLE_INITIAL_CAPACITY;
+	PCB * grown = NULL;
+	
+	while (capacity <= pid) {
+		capacity *= 2;
+	}
+	if (capacity == pidIndexCapacity) {
+		return 1;
+	}
+	grown = (PCB *) realloc(pidIndex, sizeof(PCB) * capacity);
+	if (!grown) {
+		return 0;
+	}
+	memset(grown + pidIndexCapacity, 0, sizeof(PCB) * (capacity - pidIndexCapacity));
+	pidIndex = grown;
+	pidIndexCapacity = capacity;
+	
+	return 1;
+}
+
+
+/*
+	Takes the given PID for the PCB, or the lowest free one if there is no given PID,
+	and puts the PCB in the index. Returns 0 if the PID is taken or memory ran out.
+*/
+int pid_take(PCB pcb, int given) {
+	unsigned int pid = IDA_NONE;
+	int ok = 0;
+	
+	pthread_mutex_lock(&pidLock);
+	if (pidAlloc || (pidAlloc = ida_create())) {
+		if (given) {
+			pid = ida_mark(pidAlloc, pcb->pid) ? pcb->pid : IDA_NONE;
+		} else {
+			pid = ida_alloc(pidAlloc);
+		}
+	}
+	if (pid != IDA_NONE) {
+		if (pid_index_reserve(pid)) {
+			pidIndex[pid] = pcb;
+			pcb->pid = pid;
+			ok = 1;
+		} else {
+			ida_free(pidAlloc, pid);
+		}
+	}
+	pthread_mutex_unlock(&pidLock);
+	
+	return ok;
+}
+
+
+/*
+ * Assigns the lowest free process ID to the process.
  *
  * Arguments: pcb: the pcb to modify.
+ * Return: 1 on success, 0 if memory ran out.
+ */
+int PCB_assign_PID(/* in */ PCB the_PCB) {
+	return pid_take(the_PCB, 0);
+}
+
+
+/*
+ * Takes the PID a restored PCB already has.
+ *
+ * Return: 1 on success, 0 if another PCB has it or memory ran out.
+ */
+int PCB_restore_PID(PCB pcb) {
+	return pid_take(pcb, 1);
+}
+
+
+/*
+ * Frees the PCB's process ID for reuse. Called by PCB_destroy.
+ */
+void PCB_release_PID(PCB pcb) {
+	pthread_mutex_lock(&pidLock);
+	if (pcb->pid < pidIndexCapacity && pidIndex[pcb->pid] == pcb) {
+		pidIndex[pcb->pid] = NULL;
+		ida_free(pidAlloc, pcb->pid);
+	}
+	pthread_mutex_unlock(&pidLock);
+}
+
+
+/*
+ * Looks a PCB up by its process ID.
+ *
+ * Return: the PCB, NULL if no live PCB has that PID.
+ */
+PCB PCB_find(unsigned int pid) {
+	PCB pcb = NULL;
+	
+	pthread_mutex_lock(&pidLock);
+	if (pid < pidIndexCapacity) {
+		pcb = pidIndex[pid];
+	}
+	pthread_mutex_unlock(&pidLock);
+	
+	return pcb;
+}
+
+
+/*
+ * Counts the process IDs in use and one past the largest ever handed out, which
+ * reuse keeps close to the most PCBs alive at once.
  */
-void PCB_assign_PID(/* in */ PCB the_PCB) {
-    the_PCB->pid = global_largest_PID;
-    global_largest_PID++;
+void PCB_pid_usage(unsigned int * used, unsigned int * limit) {
+	pthread_mutex_lock(&pidLock);
+	*used = pidAlloc ? pidAlloc->used : 0;
+	*limit = pidAlloc ? pidAlloc->limit : 0;
+	pthread_mutex_unlock(&pidLock);
 }
 
 /*
@@ -308,6 +618,9 @@ void PCB_assign_PID(/* in */ PCB the_PCB) {
  */
 void PCB_assign_state(/* in-out */ PCB the_pcb, /* in */ enum state_type the_state) {
     the_pcb->state = the_state;
+	if (the_pcb->slot >= 0) {
+		pcbTable->state[the_pcb->slot] = the_state;
+	}
 }
 
 /*
@@ -331,6 +644,283 @@ void PCB_assign_priority(/* in */ PCB the_pcb, /* in */ unsigned int the_priorit
     if (the_priority > NUM_PRIORITIES) {
         the_pcb->priority = NUM_PRIORITIES - 1;
     }
+	if (the_pcb->slot >= 0) {
+		pcbTable->priority[the_pcb->slot] = the_pcb->priority;
+	}
+}
+
+
+/*
+ * Sets the PC of the PCB's context.
+ */
+void PCB_set_pc(PCB pcb, unsigned int pc) {
+	pcb->context->pc = pc;
+	if (pcb->slot >= 0) {
+		pcbTable->pc[pcb->slot] = pc;
+	}
+}
+
+
+/*
+ * Records which of the scheduler's containers the PCB is now in.
+ */
+void PCB_set_location(PCB pcb, enum pcb_location location) {
+	pcb->location = location;
+	if (pcb->slot >= 0) {
+		pcbTable->location[pcb->slot] = location;
+	}
+}
+
+
+/*
+ * Sets how many times the PCB has run through to its max PC.
+ */
+void PCB_set_term_count(PCB pcb, unsigned int termCount) {
+	pcb->term_count = termCount;
+	if (pcb->slot >= 0) {
+		pcbTable->term_count[pcb->slot] = termCount;
+	}
+}
+
+
+/*
+ * Sets the PCB's max PC and how many times it runs through to it before it terminates.
+ */
+void PCB_set_limits(PCB pcb, unsigned int maxPC, unsigned int terminate) {
+	pcb->max_pc = maxPC;
+	pcb->terminate = terminate;
+	if (pcb->slot >= 0) {
+		pcbTable->max_pc[pcb->slot] = maxPC;
+		pcbTable->terminate[pcb->slot] = terminate;
+	}
+}
+
+
+/*
+	Grows one of the table's arrays to the new capacity.
+*/
+void * pt_grow_array(void * array, size_t elementSize, int capacity) {
+	return realloc(array, elementSize * capacity);
+}
+
+
+/*
+	Allocates the table the first time a PCB is created, or doubles it when full.
+	Returns 0 if memory ran out, in which case the PCB is left out of the table.
+*/
+int pt_grow() {
+	int capacity = pcbTable ? pcbTable->capacity * 2 : PCB_TABLE_INITIAL_CAPACITY;
+	void * grown = NULL;
+	
+	if (!pcbTable) {
+		pcbTable = (PCBTable) calloc(1, sizeof(struct pcb_table));
+		if (!pcbTable) {
+			return 0;
+		}
+	}
+	
+	if (!(grown = pt_grow_array(pcbTable->state, sizeof(unsigned char), capacity))) return 0;
+	pcbTable->state = grown;
+	if (!(grown = pt_grow_array(pcbTable->location, sizeof(unsigned char), capacity))) return 0;
+	pcbTable->location = grown;
+	if (!(grown = pt_grow_array(pcbTable->priority, sizeof(unsigned char), capacity))) return 0;
+	pcbTable->priority = grown;
+	if (!(grown = pt_grow_array(pcbTable->pc, sizeof(unsigned int), capacity))) return 0;
+	pcbTable->pc = grown;
+	if (!(grown = pt_grow_array(pcbTable->max_pc, sizeof(unsigned int), capacity))) return 0;
+	pcbTable->max_pc = grown;
+	if (!(grown = pt_grow_array(pcbTable->term_count, sizeof(unsigned int), capacity))) return 0;
+	pcbTable->term_count = grown;
+	if (!(grown = pt_grow_array(pcbTable->terminate, sizeof(unsigned int), capacity))) return 0;
+	pcbTable->terminate = grown;
+	if (!(grown = pt_grow_array(pcbTable->pcbs, sizeof(PCB), capacity))) return 0;
+	pcbTable->pcbs = grown;
+	if (!(grown = pt_grow_array(pcbTable->freeSlots, sizeof(int), capacity))) return 0;
+	pcbTable->freeSlots = grown;
+	
+	for (int i = pcbTable->capacity; i < capacity; i++) {
+		pcbTable->pcbs[i] = NULL;
+	}
+	pcbTable->capacity = capacity;
+	
+	return 1;
+}
+
+
+/*
+ * Grows the PCB table until it has at least the given number of slots.
+ *
+ * Return: 1 on success, 0 if memory ran out.
+ */
+int pt_reserve(int slots) {
+	while (!pcbTable || pcbTable->capacity < slots) {
+		if (!pt_grow()) {
+			return 0;
+		}
+	}
+	
+	return 1;
+}
+
+
+/*
+ * Puts a restored PCB back into the given slot, which must be free and within the
+ * capacity reserved with pt_reserve. The caller restores the free slot stack.
+ */
+void pt_place(PCB pcb, int slot) {
+	pcbTable->pcbs[slot] = pcb;
+	pcbTable->live++;
+	pcb->slot = slot;
+	pt_sync(pcb);
+}
+
+
+/*
+	Gives the PCB a slot in the table, reusing the most recently freed one.
+*/
+void pt_register(PCB pcb) {
+	int slot = 0;
+	
+	if (pcbTable && pcbTable->freeCount) {
+		slot = pcbTable->freeSlots[--pcbTable->freeCount];
+	} else {
+		if ((!pcbTable || pcbTable->used == pcbTable->capacity) && !pt_grow()) {
+			return;
+		}
+		slot = pcbTable->used++;
+	}
+	
+	pcbTable->pcbs[slot] = pcb;
+	pcbTable->live++;
+	pcb->slot = slot;
+	pt_sync(pcb);
+}
+
+
+/*
+	Frees the PCB's slot for reuse.
+*/
+void pt_release(PCB pcb) {
+	if (pcb->slot >= 0 && pcbTable->pcbs[pcb->slot] == pcb) {
+		pcbTable->pcbs[pcb->slot] = NULL;
+		pcbTable->freeSlots[pcbTable->freeCount++] = pcb->slot;
+		pcbTable->live--;
+	}
+	pcb->slot = -1;
+}
+
+
+/*
+ * Copies every hot field of the PCB into its slot in the PCB table.
+ */
+void pt_sync(PCB pcb) {
+	int slot = pcb->slot;
+	
+	if (slot >= 0) {
+		pcbTable->state[slot] = pcb->state;
+		pcbTable->location[slot] = pcb->location;
+		pcbTable->priority[slot] = pcb->priority;
+		pcbTable->pc[slot] = pcb->context->pc;
+		pcbTable->max_pc[slot] = pcb->max_pc;
+		pcbTable->term_count[slot] = pcb->term_count;
+		pcbTable->terminate[slot] = pcb->terminate;
+	}
+}
+
+
+/*
+ * Compares every live slot with its PCB and aborts on the first field that differs,
+ * which means something wrote the PCB around the PCB_assign and PCB_set functions.
+ * Does nothing unless built with PCB_TABLE_CHECK.
+ */
+void pt_check() {
+#ifdef PCB_TABLE_CHECK
+	PCB pcb = NULL;
+	
+	if (!pcbTable) {
+		return;
+	}
+	for (int i = 0; i < pcbTable->used; i++) {
+		pcb = pcbTable->pcbs[i];
+		if (pcb && (pcbTable->state[i] != pcb->state || pcbTable->location[i] != pcb->location
+				|| pcbTable->priority[i] != pcb->priority || pcbTable->pc[i] != pcb->context->pc
+				|| pcbTable->max_pc[i] != pcb->max_pc || pcbTable->term_count[i] != pcb->term_count
+				|| pcbTable->terminate[i] != pcb->terminate)) {
+			fprintf(stderr, "PCB table slot %d is out of step with P%u\r\n", i, pcb->pid);
+			abort();
+		}
+	}
+#endif
+}
+
+
+/*
+ * Counts the live PCBs in each state by scanning the table's state array.
+ *
+ * Arguments: counts: one entry per state_type, overwritten.
+ * Return: the number of live PCBs.
+ */
+int pt_count_states(int counts[]) {
+	pt_check();
+	for (int i = 0; i <= STATE_HALT; i++) {
+		counts[i] = 0;
+	}
+	if (!pcbTable) {
+		return 0;
+	}
+	for (int i = 0; i < pcbTable->used; i++) {
+		if (pcbTable->pcbs[i]) {
+			counts[pcbTable->state[i]]++;
+		}
+	}
+	
+	return pcbTable->live;
+}
+
+
+/*
+ * Counts the live PCBs at each priority by scanning the table's priority array.
+ *
+ * Arguments: counts: NUM_PRIORITIES entries, overwritten.
+ */
+void pt_count_priorities(int counts[]) {
+	pt_check();
+	for (int i = 0; i < NUM_PRIORITIES; i++) {
+		counts[i] = 0;
+	}
+	if (!pcbTable) {
+		return;
+	}
+	for (int i = 0; i < pcbTable->used; i++) {
+		if (pcbTable->pcbs[i]) {
+			counts[pcbTable->priority[i]]++;
+		}
+	}
+}
+
+
+/*
+	Prints how many live PCBs are in each state and at each priority.
+*/
+void toStringPCBTable() {
+	int states[STATE_HALT + 1];
+	int priorities[NUM_PRIORITIES];
+	int live = pt_count_states(states);
+	unsigned int pidsUsed = 0, pidLimit = 0;
+	
+	pt_count_priorities(priorities);
+	PCB_pid_usage(&pidsUsed, &pidLimit);
+	trace("PCB table: %d live, new %d, ready %d, running %d, int %d, wait %d, halt %d\r\n", live, 
+		states[STATE_NEW], states[STATE_READY], states[STATE_RUNNING], states[STATE_INT], 
+		states[STATE_WAIT], states[STATE_HALT]);
+	trace("PIDs: %u in use, all below %u\r\n", pidsUsed, pidLimit);
+	trace("By priority:");
+	for (int i = 0; i < NUM_PRIORITIES; i++) {
+		if (priorities[i]) {
+			trace(" %d:%d", i, priorities[i]);
+		}
+	}
+	trace("\r\n");
 }
 
 
@@ -342,95 +932,95 @@ void PCB_assign_priority(/* in */ PCB the_pcb, /* in */ unsigned int the_priorit
  */
 void toStringPCB(PCB thisPCB, int showCpu) {
 	if (thisPCB) {
-		printf("contents: ");
+		trace("contents: ");
 		
-		printf("PID: %d, ", thisPCB->pid);
+		trace("PID: %d, ", thisPCB->pid);
 
 		switch(thisPCB->state) {
 			case STATE_NEW:
-				printf("state: new, ");
+				trace("state: new, ");
 				break;
 			case STATE_READY:
-				printf("state: ready, ");
+				trace("state: ready, ");
 				break;
 			case STATE_RUNNING:
-				printf("state: running, ");
+				trace("state: running, ");
 				break;
 			case STATE_INT:
-				printf("state: interrupted, ");
+				trace("state: interrupted, ");
 				break;
 			case STATE_WAIT:
-				printf("state: waiting, ");
+				trace("state: waiting, ");
 				break;
 			case STATE_HALT:
-				printf("state: halted, ");
+				trace("state: halted, ");
 				break;
 		}
 		
 		switch(thisPCB->role) {
 			case COMP:
-				printf("role: comp, ");
+				trace("role: comp, ");
 				break;
 			case IO:
-				printf("role: io, ");
+				trace("role: io, ");
 				break;
 			case PAIR:
-				printf("role: pair, "); //producer/consumer
+				trace("role: pair, "); //producer/consumer
 				break;
 			case SHARED:
-				printf("role: shared, ");
+				trace("role: shared, ");
 				break;
 		}
 		
-		printf("priority: %d, ", thisPCB->priority);
-		printf("PC: %d, ", thisPCB->context->pc);
+		trace("priority: %d, ", thisPCB->priority);
+		trace("PC: %d, ", thisPCB->context->pc);
 		if (thisPCB->role == PAIR) {
-			printf("isProducer: %d, ", thisPCB->isProducer);
+			trace("isProducer: %d, ", thisPCB->isProducer);
 		}
 		//do it like IO if its PAIR or SHARED to show mutex positions
 		
-		printf("\r\nMAX PC: %d\r\n", thisPCB->max_pc);
+		trace("\r\nMAX PC: %d\r\n", thisPCB->max_pc);
 		
 		if (thisPCB->role == IO) {
-			printf("io_1 traps\r\n");
+			trace("io_1 traps\r\n");
 			for (int i = 0; i < TRAP_COUNT; i++) {
-				printf("%d ", thisPCB->io_1_traps[i]);
+				trace("%d ", thisPCB->io_1_traps[i]);
 			}
-			printf("\r\nio_2 traps\r\n");
+			trace("\r\nio_2 traps\r\n");
 			for (int i = 0; i < TRAP_COUNT; i++) {
-				printf("%d ", thisPCB->io_2_traps[i]);
+				trace("%d ", thisPCB->io_2_traps[i]);
 			}
-			printf("\r\n");
+			trace("\r\n");
 		} else if (thisPCB->role == SHARED) {
-			printf("mutex_r1 locks\r\n");
+			trace("mutex_r1 locks\r\n");
 			printPCLocations(thisPCB->lockR1);
-			printf("mutex_r1 unlocks\r\n");
+			trace("mutex_r1 unlocks\r\n");
 			printPCLocations(thisPCB->unlockR1);
-			printf("mutex_r2 locks\r\n");
+			trace("mutex_r2 locks\r\n");
 			printPCLocations(thisPCB->lockR2);
-			printf("mutex_r2 unlocks\r\n");
+			trace("mutex_r2 unlocks\r\n");
 			printPCLocations(thisPCB->unlockR2);
 		}  else if (thisPCB->role == PAIR) {
 			if (thisPCB->isProducer)  {
-				printf("cond_var signals\r\n");
+				trace("cond_var signals\r\n");
 				printPCLocations(thisPCB->signal_cond);
 			} else {
-				printf("cond_var waits\r\n");
+				trace("cond_var waits\r\n");
 				printPCLocations(thisPCB->wait_cond);
 			}
 		}
-		printf("terminate: %d\r\n", thisPCB->terminate);
-		printf("term_count: %d\r\n", thisPCB->term_count);
-		printf("\r\n");
+		trace("terminate: %d\r\n", thisPCB->terminate);
+		trace("term_count: %d\r\n", thisPCB->term_count);
+		trace("\r\n");
 		
 		if (showCpu) {
-			printf("mem: 0x%04X, ", thisPCB->mem);
-			printf("size: %d, ", thisPCB->size);
-			printf("channel_no: %d ", thisPCB->channel_no);
+			trace("mem: 0x%04X, ", thisPCB->mem);
+			trace("size: %d, ", thisPCB->size);
+			trace("channel_no: %d ", thisPCB->channel_no);
 			toStringCPUContext(thisPCB->context);
 		}
 	} else {
-		printf("PCB is null\r\n");
+		trace("PCB is null\r\n");
 	}
 }
 
@@ -439,16 +1029,16 @@ void toStringPCB(PCB thisPCB, int showCpu) {
 	Prints the CPU context
 */
 void toStringCPUContext(CPU_context_p context) {
-	printf(" CPU context values: ");
-	printf("ir:  %d, ", context->ir);
-	printf("psr: %d, ", context->psr);
-	printf("r0:  %d, ", context->r0);
-	printf("r1:  %d, ", context->r1);
-	printf("r2:  %d, ", context->r2);
-	printf("r3:  %d, ", context->r3);
-	printf("r4:  %d, ", context->r4);
-	printf("r5:  %d, ", context->r5);
-	printf("r6:  %d, ", context->r6);
-	printf("r7:  %d\r\n", context->r7);
+	trace(" CPU context values: ");
+	trace("ir:  %d, ", context->ir);
+	trace("psr: %d, ", context->psr);
+	trace("r0:  %d, ", context->r0);
+	trace("r1:  %d, ", context->r1);
+	trace("r2:  %d, ", context->r2);
+	trace("r3:  %d, ", context->r3);
+	trace("r4:  %d, ", context->r4);
+	trace("r5:  %d, ", context->r5);
+	trace("r6:  %d, ", context->r6);
+	trace("r7:  %d\r\n", context->r7);
 }
  
@@ -11,6 +11,12 @@
 #include<string.h>
 #include<time.h>
 
+/* 
+	Prints a line of the simulators' trace. Nothing is formatted while traceEnabled 
+	is cleared, which the bench modes do, the reports are written with fprintf.
+*/
+#define trace(...) (traceEnabled ? printf(__VA_ARGS__) : 0)
+
 #define NUM_PRIORITIES 16
 #define TRAP_COUNT 4
 #define LARGEST_PC_POSSIBLE 300
@@ -27,6 +33,12 @@
 
 #define MAX_PC_RANGE 50
 
+#define RT_PERIOD 200 //producers are soft real-time, they need RT_BUDGET iterations every RT_PERIOD
+#define RT_BUDGET 20
+
+#define MIN_FOOTPRINT 8 //a PCB's physical memory is drawn log-uniformly from MIN_FOOTPRINT units
+#define FOOTPRINT_DOUBLINGS 6 //to MIN_FOOTPRINT << FOOTPRINT_DOUBLINGS units
+
 
 
 /* The CPU state, values named as in the LC-3 processor. */
@@ -70,6 +82,24 @@ enum pcb_type {
 	SHARED
 };
 
+/* 
+	Which of the scheduler's containers a PCB is in. It is kept in the PCB table so
+	the scheduler can tell where a PCB is, a partner it is about to kill for example,
+	without searching every container for it.
+*/
+enum pcb_location {
+	LOC_NONE, // in no container, not yet admitted or being moved between two
+	LOC_CREATED,
+	LOC_INBOX, // posted to the ready inbox, or on its way there from I/O
+	LOC_READY, // somewhere in the scheduling policy's ready set
+	LOC_RUNNING,
+	LOC_BLOCKED,
+	LOC_KILLED
+};
+
+struct node;
+struct phys_mem;
+
 /* Process Control Block - Contains info required for executing processes. */
 typedef struct pcb {
     unsigned int pid; // process identification
@@ -81,13 +111,36 @@ typedef struct pcb {
     unsigned int size; // number of bytes in process
     unsigned char channel_no; // which I/O device or service Q
 	unsigned int max_pc; // this is essentially the quantum size
-	unsigned int creation;
+	unsigned int creation; //the iteration it was made in
 	unsigned int termination;
 	unsigned int terminate;
 	unsigned int term_count;
-	unsigned int io_1_traps[TRAP_COUNT];
-	unsigned int io_2_traps[TRAP_COUNT];
 	unsigned int blocked_timer;
+	double io_done_at; //wall clock ns when its I/O completed, only stamped when benchmarking
+	
+	unsigned long long vruntime; //for fair scheduling, weighted time spent running
+	unsigned int exec_start; //when the PCB was last dispatched, -1 if it isn't running
+	unsigned int run_time; //total iterations spent running
+	unsigned int tickets; //for proportional share scheduling
+	unsigned long long pass;
+	int ready_index; //position in the scheduling policy's ready structure, -1 if none
+	unsigned int ready_at; //when it last joined the ready set
+	unsigned int time_slice; //iterations left in the current slice, for the O(1) policy
+	unsigned int sleep_avg; //recent time spent blocked less time spent running
+	unsigned int sleep_start; //when the PCB last blocked
+	int slot; //index of this PCB in the PCB table, -1 if it isn't in it
+	unsigned char location; //which container the PCB is in, see pcb_location
+	struct node * node; //its node in the FIFO queue it is in, NULL if none
+	unsigned int * page_table; //the frame each page is in, allocated by the virtual memory on first use
+	unsigned int page_count;
+	int fault_page; //the page it is blocked faulting in, -1 if none
+	unsigned int footprint; //units of physical memory it was given, 0 if there is no physical memory
+	unsigned int phys_block; //where they are, PM_NONE if it holds none
+	
+	unsigned int rt_period; //for the real-time class, 0 if the PCB isn't real-time
+	unsigned int rt_budget; //iterations it may run each period
+	unsigned int rt_used; //iterations run in the current period
+	unsigned int rt_deadline; //end of the current period
 	
 	unsigned int lock_pc; //for mutex
 	unsigned int unlock_pc;
@@ -95,11 +148,13 @@ typedef struct pcb {
 	unsigned int signal_pc; //for condition variable
 	unsigned int wait_pc;
 	
+	//the trap arrays are kept together so matching a PC against all of them stays in cache
+	unsigned int io_1_traps[TRAP_COUNT];
+	unsigned int io_2_traps[TRAP_COUNT];
 	unsigned int lockR1[TRAP_COUNT];
 	unsigned int lockR2[TRAP_COUNT];
 	unsigned int unlockR1[TRAP_COUNT];
 	unsigned int unlockR2[TRAP_COUNT];
-
 	unsigned int wait_cond[TRAP_COUNT];
 	unsigned int signal_cond[TRAP_COUNT];
 	
@@ -117,6 +172,59 @@ typedef struct pcb {
 typedef PCB_s * PCB;
 
 
+/* 
+	The fields the simulator touches on every step or scans across every PCB are kept
+	again here, one array per field indexed by slot, so a scan over them streams 
+	through a few cache lines instead of pulling in whole PCBs with all their trap 
+	arrays. The table is written through by the PCB_assign and PCB_set functions, 
+	which must be used for these fields, and guarded by the same lock as the PCBs.
+	Building with PCB_TABLE_CHECK has the scans check both copies still agree.
+*/
+typedef struct pcb_table {
+	unsigned char * state;
+	unsigned char * location;
+	unsigned char * priority;
+	unsigned int * pc;
+	unsigned int * max_pc;
+	unsigned int * term_count;
+	unsigned int * terminate;
+	PCB * pcbs; // the full PCB for each slot, NULL for a free slot
+	int * freeSlots;
+	int freeCount;
+	int used; // slots at or above this have never been handed out
+	int capacity;
+	int live;
+} pcb_table_s;
+
+typedef pcb_table_s * PCBTable;
+
+#define PCB_TABLE_INITIAL_CAPACITY 256
+#define PCB_POOL_CAPACITY 1024 // destroyed PCBs kept for reuse, the rest are freed
+
+extern PCBTable pcbTable;
+
+extern unsigned int global_largest_MID;
+
+/* 
+	The simulators draw every random number from this one state instead of rand's 
+	hidden one, so a checkpoint can save it and a restored run continues the same 
+	sequence.
+*/
+extern unsigned int simRandState;
+
+extern int traceEnabled; // 1 unless a bench mode turned the trace off
+
+/*
+ * Returns the next number from the simulators' random sequence, like rand.
+ */
+int sim_rand();
+
+/*
+ * Restarts the simulators' random sequence from the given seed, like srand.
+ */
+void sim_srand(unsigned int seed);
+
+
 typedef struct COND_VAR {
 	int signal;
 } cond_var_s;
@@ -132,6 +240,7 @@ typedef struct MUTEX {
 	PCB hasLock;
 	PCB blocked;
 	ConditionVariable condVar;
+	struct node * node; //its node in the queue of killed Mutexes, NULL if it isn't in it
 } mutex_s;
 
 typedef mutex_s * Mutex;
@@ -169,12 +278,31 @@ int cond_var_wait (ConditionVariable);
 
 
 /*
- * Allocate a PCB and a context for that PCB.
+ * Allocate a PCB and a context for that PCB, reusing a destroyed one if the pool
+ * has any. With a physical memory in use the PCB is given its footprint from it.
  *
- * Return: NULL if context or PCB allocation failed, the new pointer otherwise.
+ * Return: NULL if context, PCB or physical memory allocation failed, the new 
+ * pointer otherwise.
  */
 PCB PCB_create();
 
+/*
+ * Frees every PCB kept in the pool.
+ */
+void PCB_pool_drain();
+
+/*
+ * Makes PCB_create give every PCB a footprint from the physical memory, NULL for
+ * none. The footprints of the live PCBs are moved into it, in table order, and one
+ * that doesn't fit is left holding none.
+ */
+void PCB_use_memory(struct phys_mem * memory);
+
+/*
+ * Frees the PCB's physical memory. Called by PCB_destroy, and safe to call twice.
+ */
+void PCB_release_memory(PCB pcb);
+
 
 enum pcb_type chooseRole();
 
@@ -182,18 +310,47 @@ enum pcb_type chooseRole();
 void initialize_pcb_type (PCB pcb, int isFirst, Mutex sharedMutexR1, Mutex sharedMutexR2);
 
 /*
- * Frees a PCB and its context.
+ * Releases a PCB's slot, PID and physical memory and returns it to the pool, 
+ * freeing it if the pool is full. The slot must be released on the thread that holds the PCB table's lock,
+ * so a PCB destroyed elsewhere has pt_release called on it first.
  *
  * Arguments: pcb: the pcb to free.
  */
 void PCB_destroy(/* in-out */ PCB pcb);
 
 /*
- * Assigns intial process ID to the process.
+ * Assigns the lowest free process ID to the process. IDs are reused once their PCB
+ * is destroyed.
  *
  * Arguments: pcb: the pcb to modify.
+ * Return: 1 on success, 0 if memory ran out.
+ */
+int PCB_assign_PID(/* in */ PCB pcb);
+
+/*
+ * Takes the PID a restored PCB already has.
+ *
+ * Return: 1 on success, 0 if another PCB has it or memory ran out.
  */
-void PCB_assign_PID(/* in */ PCB pcb);
+int PCB_restore_PID(PCB pcb);
+
+/*
+ * Frees the PCB's process ID for reuse. Called by PCB_destroy.
+ */
+void PCB_release_PID(PCB pcb);
+
+/*
+ * Looks a PCB up by its process ID.
+ *
+ * Return: the PCB, NULL if no live PCB has that PID.
+ */
+PCB PCB_find(unsigned int pid);
+
+/*
+ * Counts the process IDs in use and one past the largest ever handed out, which
+ * reuse keeps close to the most PCBs alive at once.
+ */
+void PCB_pid_usage(unsigned int * used, unsigned int * limit);
 
 /*
  * Sets the state of the process to the provided state.
@@ -219,6 +376,78 @@ void PCB_assign_parent(PCB the_pcb, int pid);
  */
 void PCB_assign_priority(/* in */ PCB pcb, /* in */ unsigned int priority);
 
+/*
+ * Sets the PC of the PCB's context.
+ */
+void PCB_set_pc(PCB pcb, unsigned int pc);
+
+/*
+ * Sets how many times the PCB has run through to its max PC.
+ */
+void PCB_set_term_count(PCB pcb, unsigned int termCount);
+
+/*
+ * Records which of the scheduler's containers the PCB is now in.
+ */
+void PCB_set_location(PCB pcb, enum pcb_location location);
+
+/*
+ * Sets the PCB's max PC and how many times it runs through to it before it terminates.
+ */
+void PCB_set_limits(PCB pcb, unsigned int maxPC, unsigned int terminate);
+
+/*
+ * Gives the PCB a slot in the PCB table. Called by PCB_create.
+ */
+void pt_register(PCB pcb);
+
+/*
+ * Grows the PCB table until it has at least the given number of slots.
+ *
+ * Return: 1 on success, 0 if memory ran out.
+ */
+int pt_reserve(int slots);
+
+/*
+ * Puts a restored PCB back into the given slot, which must be free and within the
+ * capacity reserved with pt_reserve. The caller restores the free slot stack.
+ */
+void pt_place(PCB pcb, int slot);
+
+/*
+ * Frees the PCB's slot in the PCB table. Called by PCB_destroy.
+ */
+void pt_release(PCB pcb);
+
+/*
+ * Copies every hot field of the PCB into its slot in the PCB table.
+ */
+void pt_sync(PCB pcb);
+
+/*
+ * Compares every live slot with its PCB and aborts on the first field that differs,
+ * which means something wrote the PCB around the PCB_assign and PCB_set functions.
+ * Does nothing unless built with PCB_TABLE_CHECK.
+ */
+void pt_check();
+
+/*
+ * Counts the live PCBs in each state by scanning the table's state array.
+ *
+ * Arguments: counts: one entry per state_type, overwritten.
+ * Return: the number of live PCBs.
+ */
+int pt_count_states(int counts[]);
+
+/*
+ * Counts the live PCBs at each priority by scanning the table's priority array.
+ *
+ * Arguments: counts: NUM_PRIORITIES entries, overwritten.
+ */
+void pt_count_priorities(int counts[]);
+
+void toStringPCBTable();
+
 int ioTrapContains(unsigned int, unsigned int[]);
 
 unsigned int makeMaxPC();
@@ -0,0 +1,173 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is a binary min-heap of PCBs. The order is given by a comparison function so
+	the same heap can be keyed by stride pass values, deadlines or anything else a
+	policy needs. Each PCB's ready_index tracks where it sits in the array, so a PCB
+	can be removed from the middle of the heap in O(log n) without searching for it.
+*/
+
+#include "pcb_heap.h"
+
+
+void heap_set (PCBHeap heap, int index, PCB pcb) {
+	heap->pcbs[index] = pcb;
+	pcb->ready_index = index;
+}
+
+
+void heap_sift_up (PCBHeap heap, int index) {
+	PCB pcb = heap->pcbs[index];
+	int parent = 0;
+
+	while (index > 0) {
+		parent = (index - 1) / 2;
+		if (!heap->before(pcb, heap->pcbs[parent])) {
+			break;
+		}
+		heap_set(heap, index, heap->pcbs[parent]);
+		index = parent;
+	}
+	heap_set(heap, index, pcb);
+}
+
+
+void heap_sift_down (PCBHeap heap, int index) {
+	PCB pcb = heap->pcbs[index];
+	int child = 0;
+
+	while ((child = 2 * index + 1) < heap->size) {
+		if (child + 1 < heap->size && heap->before(heap->pcbs[child + 1], heap->pcbs[child])) {
+			child++;
+		}
+		if (!heap->before(heap->pcbs[child], pcb)) {
+			break;
+		}
+		heap_set(heap, index, heap->pcbs[child]);
+		index = child;
+	}
+	heap_set(heap, index, pcb);
+}
+
+
+/*
+ * Creates an empty heap ordered by the given function.
+ *
+ * Return: A new heap on success, NULL on failure.
+ */
+PCBHeap heap_create (HeapBefore before) {
+	PCBHeap heap = (PCBHeap) malloc(sizeof(struct pcb_heap));
+
+	if (heap != NULL) {
+		heap->pcbs = (PCB *) malloc(sizeof(PCB) * HEAP_INITIAL_CAPACITY);
+		if (heap->pcbs == NULL) {
+			free(heap);
+			return NULL;
+		}
+		heap->size = 0;
+		heap->capacity = HEAP_INITIAL_CAPACITY;
+		heap->before = before;
+	}
+
+	return heap;
+}
+
+
+/*
+ * Destroys the heap and every PCB still in it.
+ */
+void heap_destroy (PCBHeap heap) {
+	if (heap) {
+		for (int i = 0; i < heap->size; i++) {
+			PCB_destroy(heap->pcbs[i]);
+		}
+		free(heap->pcbs);
+		free(heap);
+	}
+}
+
+
+/*
+ * Adds the PCB to the heap, growing it if needed.
+ *
+ * Return: 1 on success, 0 if the heap couldn't grow.
+ */
+int heap_push (PCBHeap heap, PCB pcb) {
+	PCB * grown = NULL;
+
+	if (heap->size == heap->capacity) {
+		grown = (PCB *) realloc(heap->pcbs, sizeof(PCB) * heap->capacity * 2);
+		if (grown == NULL) {
+			return 0;
+		}
+		heap->pcbs = grown;
+		heap->capacity *= 2;
+	}
+	heap->pcbs[heap->size] = pcb;
+	heap->size++;
+	heap_sift_up(heap, heap->size - 1);
+
+	return 1;
+}
+
+
+/*
+ * Removes and returns the first PCB, NULL if the heap is empty.
+ */
+PCB heap_pop (PCBHeap heap) {
+	if (heap->size == 0) {
+		return NULL;
+	}
+	return heap_remove(heap, heap->pcbs[0]);
+}
+
+
+/*
+ * Returns the first PCB without removing it.
+ */
+PCB heap_peek (PCBHeap heap) {
+	return heap->size ? heap->pcbs[0] : NULL;
+}
+
+
+/*
+ * Removes the given PCB from wherever it is in the heap.
+ *
+ * Return: the PCB, or NULL if it wasn't in this heap.
+ */
+PCB heap_remove (PCBHeap heap, PCB pcb) {
+	int index = pcb->ready_index;
+
+	if (index < 0 || index >= heap->size || heap->pcbs[index] != pcb) {
+		return NULL;
+	}
+
+	heap->size--;
+	if (index != heap->size) {
+		heap_set(heap, index, heap->pcbs[heap->size]);
+		heap_update(heap, heap->pcbs[index]);
+	}
+	pcb->ready_index = -1;
+
+	return pcb;
+}
+
+
+/*
+ * Moves the PCB to its correct place after its key has changed.
+ */
+void heap_update (PCBHeap heap, PCB pcb) {
+	int index = pcb->ready_index;
+
+	if (index > 0 && heap->before(pcb, heap->pcbs[(index - 1) / 2])) {
+		heap_sift_up(heap, index);
+	} else {
+		heap_sift_down(heap, index);
+	}
+}
+
+
+char heap_is_empty (PCBHeap heap) {
+	return heap->size == 0;
+}
@@ -0,0 +1,75 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is a binary min-heap of PCBs. The order is given by a comparison function so
+	the same heap can be keyed by stride pass values, deadlines or anything else a
+	policy needs. Each PCB's ready_index tracks where it sits in the array, so a PCB
+	can be removed from the middle of the heap in O(log n) without searching for it.
+*/
+
+#ifndef PCB_HEAP_H
+#define PCB_HEAP_H
+
+#include "pcb.h"
+
+#define HEAP_INITIAL_CAPACITY 64
+
+
+/* Returns non-zero if a should come out of the heap before b. */
+typedef int (*HeapBefore) (PCB a, PCB b);
+
+typedef struct pcb_heap {
+	PCB * pcbs;
+	int size;
+	int capacity;
+	HeapBefore before;
+} pcb_heap_s;
+
+typedef pcb_heap_s * PCBHeap;
+
+
+/*
+ * Creates an empty heap ordered by the given function.
+ *
+ * Return: A new heap on success, NULL on failure.
+ */
+PCBHeap heap_create (HeapBefore before);
+
+/*
+ * Destroys the heap and every PCB still in it.
+ */
+void heap_destroy (PCBHeap heap);
+
+/*
+ * Adds the PCB to the heap, growing it if needed.
+ *
+ * Return: 1 on success, 0 if the heap couldn't grow.
+ */
+int heap_push (PCBHeap heap, PCB pcb);
+
+/*
+ * Removes and returns the first PCB, NULL if the heap is empty.
+ */
+PCB heap_pop (PCBHeap heap);
+
+/*
+ * Returns the first PCB without removing it.
+ */
+PCB heap_peek (PCBHeap heap);
+
+/*
+ * Removes the given PCB from wherever it is in the heap.
+ *
+ * Return: the PCB, or NULL if it wasn't in this heap.
+ */
+PCB heap_remove (PCBHeap heap, PCB pcb);
+
+/*
+ * Moves the PCB to its correct place after its key has changed.
+ */
+void heap_update (PCBHeap heap, PCB pcb);
+
+char heap_is_empty (PCBHeap heap);
+
+#endif
@@ -0,0 +1,324 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is the simulated physical memory, with its buddy and segregated fit
+	policies. See phys_mem.h for how the free blocks are kept.
+*/
+
+#include "phys_mem.h"
+
+const char * pmPolicyNames[PM_POLICY_COUNT] = {"buddy", "segregated"};
+
+
+/*
+	The list a free block of the given size goes in: its order under PM_BUDDY, where
+	size already is the order, and the highest set bit under PM_SEGREGATED.
+*/
+int pm_class (PhysMem pm, unsigned int size) {
+	return pm->policy == PM_BUDDY ? (int) size : 31 - __builtin_clz(size);
+}
+
+
+/*
+	Puts a free block of the given size at the front of its list.
+*/
+void pm_push (PhysMem pm, unsigned int block, unsigned int size) {
+	int list = pm_class(pm, size);
+
+	pm->size[block] = size;
+	pm->state[block] = PM_FREE;
+	pm->prev[block] = PM_NONE;
+	pm->next[block] = pm->heads[list];
+	if (pm->heads[list] != PM_NONE) {
+		pm->prev[pm->heads[list]] = block;
+	}
+	pm->heads[list] = block;
+	pm->nonEmpty |= 1u << list;
+	if (pm->policy == PM_SEGREGATED) {
+		pm->tail[block + size - 1] = block;
+	}
+}
+
+
+/*
+	Takes a free block out of its list.
+*/
+void pm_unlink (PhysMem pm, unsigned int block) {
+	int list = pm_class(pm, pm->size[block]);
+
+	if (pm->prev[block] != PM_NONE) {
+		pm->next[pm->prev[block]] = pm->next[block];
+	} else {
+		pm->heads[list] = pm->next[block];
+	}
+	if (pm->next[block] != PM_NONE) {
+		pm->prev[pm->next[block]] = pm->prev[block];
+	}
+	if (pm->heads[list] == PM_NONE) {
+		pm->nonEmpty &= ~(1u << list);
+	}
+}
+
+
+/*
+	Takes the block, records it as allocated and counts it.
+*/
+unsigned int pm_take (PhysMem pm, unsigned int block, unsigned int size, unsigned int units, unsigned int used) {
+	pm->size[block] = size;
+	pm->state[block] = PM_USED;
+	pm->stats.allocations++;
+	pm->stats.usedUnits += used;
+	pm->stats.requestedUnits += units;
+	if (pm->stats.usedUnits > pm->stats.peakUnits) {
+		pm->stats.peakUnits = pm->stats.usedUnits;
+	}
+
+	return block;
+}
+
+
+unsigned int pm_buddy_alloc (PhysMem pm, unsigned int units) {
+	int order = units > 1 ? 32 - __builtin_clz(units - 1) : 0;
+	unsigned int candidates = order < PM_CLASSES ? pm->nonEmpty >> order << order : 0;
+	unsigned int block = 0;
+	int list = 0;
+
+	if (!candidates) {
+		return PM_NONE;
+	}
+	list = __builtin_ctz(candidates);
+	block = pm->heads[list];
+	pm_unlink(pm, block);
+	while (list > order) { //the upper half of each split goes back free
+		list--;
+		pm_push(pm, block + (1u << list), list);
+	}
+
+	return pm_take(pm, block, order, units, 1u << order);
+}
+
+
+void pm_buddy_free (PhysMem pm, unsigned int block) {
+	unsigned int order = pm->size[block];
+	unsigned int buddy = 0;
+
+	pm->stats.usedUnits -= 1u << order;
+	while (order < PM_CLASSES - 1) {
+		buddy = block ^ (1u << order);
+		if (buddy + (1u << order) > pm->units || pm->state[buddy] != PM_FREE || pm->size[buddy] != order) {
+			break;
+		}
+		pm_unlink(pm, buddy);
+		pm->state[buddy > block ? buddy : block] = PM_INTERIOR;
+		block = buddy < block ? buddy : block;
+		order++;
+	}
+	pm_push(pm, block, order);
+}
+
+
+unsigned int pm_segregated_alloc (PhysMem pm, unsigned int units) {
+	int list = 31 - __builtin_clz(units);
+	unsigned int candidates = 0;
+	unsigned int block = pm->heads[list];
+	unsigned int size = 0;
+
+	if (block == PM_NONE || pm->size[block] < units) { //any block of a higher list is big enough
+		candidates = list + 1 < PM_CLASSES ? pm->nonEmpty >> (list + 1) << (list + 1) : 0;
+		if (!candidates) {
+			return PM_NONE;
+		}
+		block = pm->heads[__builtin_ctz(candidates)];
+	}
+	size = pm->size[block];
+	pm_unlink(pm, block);
+	if (size > units) {
+		pm_push(pm, block + units, size - units);
+	}
+	pm->tail[block + units - 1] = block;
+
+	return pm_take(pm, block, units, units, units);
+}
+
+
+void pm_segregated_free (PhysMem pm, unsigned int block) {
+	unsigned int size = pm->size[block];
+	unsigned int after = block + size;
+	unsigned int before = 0;
+
+	pm->stats.usedUnits -= size;
+	if (after < pm->units && pm->state[after] == PM_FREE) {
+		pm_unlink(pm, after);
+		pm->state[after] = PM_INTERIOR;
+		size += pm->size[after];
+	}
+	if (block > 0) {
+		before = pm->tail[block - 1];
+		if (pm->state[before] == PM_FREE) {
+			pm_unlink(pm, before);
+			pm->state[block] = PM_INTERIOR;
+			size += pm->size[before];
+			block = before;
+		}
+	}
+	pm_push(pm, block, size);
+}
+
+
+/*
+ * Creates a physical memory of the given number of units, all free.
+ *
+ * Return: the memory, NULL if the size is out of range or memory ran out.
+ */
+PhysMem pm_create (int policy, unsigned int units) {
+	PhysMem pm = NULL;
+	unsigned int block = 0;
+	int order = 0;
+
+	if (policy < 0 || policy >= PM_POLICY_COUNT || units == 0 || units > PM_MAX_UNITS) {
+		return NULL;
+	}
+	pm = (PhysMem) calloc(1, sizeof(struct phys_mem));
+	if (pm == NULL) {
+		return NULL;
+	}
+	pm->policy = policy;
+	pm->units = units;
+	pm->next = (unsigned int *) malloc(sizeof(unsigned int) * units);
+	pm->prev = (unsigned int *) malloc(sizeof(unsigned int) * units);
+	pm->size = (unsigned int *) malloc(sizeof(unsigned int) * units);
+	pm->tail = (unsigned int *) malloc(sizeof(unsigned int) * units);
+	pm->state = (unsigned char *) calloc(units, 1);
+	if (!pm->next || !pm->prev || !pm->size || !pm->tail || !pm->state) {
+		pm_destroy(pm);
+		return NULL;
+	}
+	for (int i = 0; i < PM_CLASSES; i++) {
+		pm->heads[i] = PM_NONE;
+	}
+
+	if (policy == PM_SEGREGATED) {
+		pm_push(pm, 0, units);
+	} else {
+		while (block < units) { //the largest aligned power of two that still fits, then the next
+			order = 31 - __builtin_clz(units - block);
+			if (block) {
+				order = order < __builtin_ctz(block) ? order : __builtin_ctz(block);
+			}
+			pm_push(pm, block, order);
+			block += 1u << order;
+		}
+	}
+
+	return pm;
+}
+
+
+void pm_destroy (PhysMem pm) {
+	if (pm) {
+		free(pm->next);
+		free(pm->prev);
+		free(pm->size);
+		free(pm->tail);
+		free(pm->state);
+		free(pm);
+	}
+}
+
+
+/*
+ * Return: the policy with the given name, -1 if there isn't one.
+ */
+int pm_policy_by_name (const char * name) {
+	for (int i = 0; i < PM_POLICY_COUNT; i++) {
+		if (!strcmp(name, pmPolicyNames[i])) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+
+/*
+ * Allocates a block of at least the given number of units.
+ *
+ * Return: the block's first unit, PM_NONE if no free block can hold it.
+ */
+unsigned int pm_alloc (PhysMem pm, unsigned int units) {
+	unsigned int block = PM_NONE;
+
+	if (units && units <= pm->units) {
+		block = pm->policy == PM_BUDDY ? pm_buddy_alloc(pm, units) : pm_segregated_alloc(pm, units);
+	}
+	if (block == PM_NONE) {
+		pm->stats.failures++;
+	}
+
+	return block;
+}
+
+
+/*
+ * Frees a block, given the units that were asked for when it was allocated.
+ */
+void pm_free (PhysMem pm, unsigned int block, unsigned int units) {
+	if (block >= pm->units || pm->state[block] != PM_USED) {
+		return;
+	}
+	pm->stats.frees++;
+	pm->stats.requestedUnits -= units;
+	if (pm->policy == PM_BUDDY) {
+		pm_buddy_free(pm, block);
+	} else {
+		pm_segregated_free(pm, block);
+	}
+}
+
+
+/*
+ * Return: the units in the largest free block.
+ */
+unsigned int pm_largest_free (PhysMem pm) {
+	unsigned int largest = 0;
+	int list = 0;
+
+	if (!pm->nonEmpty) {
+		return 0;
+	}
+	list = 31 - __builtin_clz(pm->nonEmpty);
+	if (pm->policy == PM_BUDDY) {
+		return 1u << list;
+	}
+	for (unsigned int block = pm->heads[list]; block != PM_NONE; block = pm->next[block]) {
+		if (pm->size[block] > largest) {
+			largest = pm->size[block];
+		}
+	}
+
+	return largest;
+}
+
+
+/*
+ * Return: the external fragmentation, the share of the free units that aren't in
+ * the largest free block, 0 when nothing is free.
+ */
+double pm_fragmentation (PhysMem pm) {
+	unsigned int freeUnits = pm->units - pm->stats.usedUnits;
+
+	return freeUnits ? 1.0 - (double) pm_largest_free(pm) / freeUnits : 0;
+}
+
+
+void pm_report (FILE * out, PhysMem pm) {
+	pm_stats_s * stats = &pm->stats;
+
+	fprintf(out, "Physical memory: %s, %u units of %d bytes\r\n", pmPolicyNames[pm->policy], pm->units, PM_UNIT_BYTES);
+	fprintf(out, "allocations: %llu, failed: %llu, frees: %llu, in use: %u units (peak %u), asked for: %u units\r\n",
+		stats->allocations, stats->failures, stats->frees, stats->usedUnits, stats->peakUnits, stats->requestedUnits);
+	fprintf(out, "largest free block: %u units, external fragmentation: %.2f%%, internal: %.2f%%\r\n",
+		pm_largest_free(pm), 100.0 * pm_fragmentation(pm),
+		stats->usedUnits ? 100.0 * (stats->usedUnits - stats->requestedUnits) / stats->usedUnits : 0.0);
+}
@@ -0,0 +1,117 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is the simulated physical memory that PCBs are given their footprint from.
+	Memory is counted in units of PM_UNIT_BYTES and only its bookkeeping exists, one
+	entry per unit in each of the arrays below, indexed by the first unit of a block.
+	The free blocks are kept in PM_CLASSES doubly linked lists, with a bit per list
+	set while it isn't empty, so finding a list to allocate from is one count of
+	trailing zeros. There are two policies:
+
+	PM_BUDDY keeps power of two blocks aligned to their size, list i holding the free
+	blocks of 2^i units. A request is rounded up to a power of two, a larger block is
+	split in halves until it fits, and a freed block merges with its buddy, the other
+	half of the block it was split from, for as long as that is free too.
+
+	PM_SEGREGATED keeps blocks of any size, list i holding the free ones of 2^i to
+	2^(i+1) - 1 units. A request takes the first block of its own list if that one is
+	big enough, or else the first of the next list with any, which always is, and the
+	rest of the block goes back as a free block. A freed block merges with the free
+	blocks on either side of it, found through the boundary tag at the end of each.
+
+	It has no lock of its own, callers guard it.
+*/
+
+#ifndef PHYS_MEM_H
+#define PHYS_MEM_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PM_UNIT_BYTES 1024
+#define PM_CLASSES 32
+#define PM_MAX_UNITS (1u << 24)
+#define PM_NONE ((unsigned int) -1) // returned when no block could be allocated
+
+
+enum pm_policy {
+	PM_BUDDY,
+	PM_SEGREGATED,
+	PM_POLICY_COUNT
+};
+
+extern const char * pmPolicyNames[PM_POLICY_COUNT];
+
+enum pm_block_state {
+	PM_INTERIOR, // not the first unit of a block
+	PM_FREE,
+	PM_USED
+};
+
+typedef struct pm_stats {
+	unsigned long long allocations;
+	unsigned long long failures; // requests no free block could hold
+	unsigned long long frees;
+	unsigned int usedUnits; // units in allocated blocks
+	unsigned int requestedUnits; // units asked for, less than usedUnits when requests are rounded up
+	unsigned int peakUnits;
+} pm_stats_s;
+
+typedef struct phys_mem {
+	int policy;
+	unsigned int units;
+	unsigned int * next; // free list links
+	unsigned int * prev;
+	unsigned int * size; // a block's units, or its order under PM_BUDDY
+	unsigned int * tail; // at a block's last unit, its first, under PM_SEGREGATED
+	unsigned char * state; // see pm_block_state
+	unsigned int heads[PM_CLASSES];
+	unsigned int nonEmpty; // bit i is set while list i has a block
+	pm_stats_s stats;
+} phys_mem_s;
+
+typedef phys_mem_s * PhysMem;
+
+
+/*
+ * Creates a physical memory of the given number of units, all free.
+ *
+ * Return: the memory, NULL if the size is out of range or memory ran out.
+ */
+PhysMem pm_create (int policy, unsigned int units);
+
+void pm_destroy (PhysMem pm);
+
+/*
+ * Return: the policy with the given name, -1 if there isn't one.
+ */
+int pm_policy_by_name (const char * name);
+
+/*
+ * Allocates a block of at least the given number of units.
+ *
+ * Return: the block's first unit, PM_NONE if no free block can hold it.
+ */
+unsigned int pm_alloc (PhysMem pm, unsigned int units);
+
+/*
+ * Frees a block, given the units that were asked for when it was allocated.
+ */
+void pm_free (PhysMem pm, unsigned int block, unsigned int units);
+
+/*
+ * Return: the units in the largest free block.
+ */
+unsigned int pm_largest_free (PhysMem pm);
+
+/*
+ * Return: the external fragmentation, the share of the free units that aren't in
+ * the largest free block, 0 when nothing is free.
+ */
+double pm_fragmentation (PhysMem pm);
+
+void pm_report (FILE * out, PhysMem pm);
+
+#endif
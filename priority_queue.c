@@ -40,7 +40,9 @@ PriorityQueue pq_create() {
         if (failed != -1) {
             free(new_pq);
             new_pq = NULL;
-        }
+        } else {
+			new_pq->clock = 0;
+		}
     }
 
     return new_pq;
@@ -92,12 +94,14 @@ void pq_destroy(PriorityQueue PQ) {
  */
 void pq_enqueue(PriorityQueue PQ, PCB pcb) {
 	if(PQ && pcb) { 
-		q_enqueue(PQ->queues[pcb->priority], pcb);
+		if (q_enqueue(PQ->queues[pcb->priority], pcb)) {
+			PQ->queues[pcb->priority]->last_node->enqueued = PQ->clock;
+		}
 	} else {
 		if (!PQ) {
-			printf("\t\t\tPRIORITY QUEUE IS NULL\t\t\t\r\n");
+			trace("\t\t\tPRIORITY QUEUE IS NULL\t\t\t\r\n");
 		} else {
-			printf("\t\t\tPCB IS NULL\t\t\t\r\n");
+			trace("\t\t\tPCB IS NULL\t\t\t\r\n");
 		}
 	}
 }
@@ -125,44 +129,83 @@ PCB pq_dequeue(PriorityQueue PQ) {
 
 
 /*
-	Finds the matching PCB in the PriorityQueue and removes it. This is used when
-	trying to kill PAIR or SHARED processes and their shared Mutex.
+	Removes the PCB from whichever level it is on. This is used when trying to kill
+	PAIR or SHARED processes and their shared Mutex. The PCB's node says which queue
+	it is in, so no level is searched.
 */
 PCB pq_remove_matching_pcb(PriorityQueue PQ, PCB toFind) {
-	ReadyQueueNode curr;
-	ReadyQueueNode last;
-	PCB found = NULL;
+	ReadyQueue level = NULL;
 	
+	if (toFind->node == NULL) {
+		return NULL;
+	}
+	level = toFind->node->queue;
 	for (int i = 0; i < NUM_PRIORITIES; i++) {
-		curr = PQ->queues[i]->first_node;
-		last = NULL;
-		while (curr) { //searches through the linked list
-			if (curr->pcb == toFind) {
-				if (curr == PQ->queues[i]->first_node) { //if the PCB is the first node in the list
-					printf("found at start of queue\n");
-					//toStringPriorityQueue(PQ);
-					PQ->queues[i]->first_node = curr->next;
-					if (PQ->queues[i]->last_node == curr) { //if the PCB is the first and last node in the list
-						PQ->queues[i]->last_node = NULL;
-					}
-				} else { //otherwise
-					printf("not found at start of queue\n");
-					//toStringPriorityQueue(PQ);
-					last->next = curr->next;
-				}
-				//toStringPriorityQueue(PQ);
-			
-				found = curr->pcb;
-				free(curr);
-				break;
+		if (PQ->queues[i] == level) {
+			return q_remove(level, toFind);
+		}
+	}
+	
+	return NULL;
+}
+
+
+/*
+ * Sets the time that is stamped on nodes as they are enqueued.
+ *
+ * Arguments: PQ: The Priority Queue to update.
+ *            now: the current time.
+ */
+void pq_set_clock(PriorityQueue PQ, unsigned int now) {
+	PQ->clock = now;
+}
+
+
+/*
+	Promotes the PCBs that have been waiting at their level for at least threshold
+	time units. Since every level is FIFO, the head of a level is the one that has 
+	waited the longest, so only heads are checked and a level is skipped as soon as 
+	its head is too young. The lowest levels are checked first since they starve the 
+	most. Nodes are moved to the tail of the level above without being reallocated, 
+	and their timestamp restarts so they have to wait again before the next promotion.
+	At most budget PCBs are moved per call, which keeps each aging pass bounded.
+*/
+int pq_age(PriorityQueue PQ, unsigned int threshold, int budget) {
+	int promoted = 0;
+	ReadyQueue from, to;
+	ReadyQueueNode node;
+	
+	for (int i = NUM_PRIORITIES - 1; i > 0 && promoted < budget; i--) {
+		from = PQ->queues[i];
+		to = PQ->queues[i - 1];
+		while (promoted < budget && from->first_node 
+				&& PQ->clock - from->first_node->enqueued >= threshold) {
+			node = from->first_node;
+			from->first_node = node->next;
+			if (from->first_node == NULL) {
+				from->last_node = NULL;
+			} else {
+				from->first_node->prev = NULL;
 			}
+			from->size--;
 			
-			last = curr;
-			curr = curr->next;
+			node->next = NULL;
+			node->prev = to->last_node;
+			node->queue = to;
+			node->enqueued = PQ->clock;
+			PCB_assign_priority(node->pcb, i - 1);
+			if (to->last_node) {
+				to->last_node->next = node;
+			} else {
+				to->first_node = node;
+			}
+			to->last_node = node;
+			to->size++;
+			promoted++;
 		}
 	}
 	
-	return found;
+	return promoted;
 }
 
 
@@ -218,14 +261,14 @@ char pq_is_empty(PriorityQueue PQ) {
  * Arguments: PQ: the Priority Queue to create a string representation of.
  */
  void toStringPriorityQueue(PriorityQueue PQ) {
-	printf("\r\n");
+	trace("\r\n");
 	for (int i = 0; i < NUM_PRIORITIES; i++) {
 		//printf("Q%2d: Count=%d, QuantumSize=%d\r\n", i, PQ->queues[i]->size, PQ->queues[i]->quantum_size);
 		
-		printf("Q%2d: ", i);
+		trace("Q%2d: ", i);
 		toStringReadyQueue(PQ->queues[i]);
 	}
-	printf("\r\n");
+	trace("\r\n");
  }
  
 
@@ -14,6 +14,7 @@
 
 typedef struct priority_queue {
     ReadyQueue     queues[NUM_PRIORITIES];
+	unsigned int   clock; // current time, stamped on every enqueued node
 } PQ_s;
 
 typedef struct priority_queue * PriorityQueue;
@@ -51,6 +52,26 @@ PCB pq_dequeue(PriorityQueue PQ);
 
 PCB pq_remove_matching_pcb(PriorityQueue PQ, PCB toFind);
 
+/*
+ * Sets the time that is stamped on nodes as they are enqueued.
+ *
+ * Arguments: PQ: The Priority Queue to update.
+ *            now: the current time.
+ */
+void pq_set_clock(PriorityQueue PQ, unsigned int now);
+
+/*
+ * Promotes PCBs that have waited at their level for at least threshold time units
+ * up by one level. Each level is FIFO, so only the head of each level needs to be
+ * checked, and at most budget PCBs are moved per call.
+ *
+ * Arguments: PQ: The Priority Queue to age.
+ *            threshold: how long a PCB must wait at its level before promotion.
+ *            budget: the most PCBs to promote in this call.
+ * Return: The number of PCBs promoted.
+ */
+int pq_age(PriorityQueue PQ, unsigned int threshold, int budget);
+
 int getNextQuantumSize (PriorityQueue PQ);
 
 /*
@@ -0,0 +1,436 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is a red-black tree of PCBs ordered by virtual runtime, with ties broken by
+	pid so every key is unique. Inserting and removing are O(log n), and the leftmost
+	node is cached so the PCB with the smallest vruntime can be read in O(1). A PCB's
+	vruntime must not change while it is in the tree.
+*/
+
+#include "rb_tree.h"
+
+
+/*
+	Orders two PCBs by vruntime, then pid. Returns a negative number if a goes first.
+*/
+int rbt_compare (PCB a, PCB b) {
+	if (a->vruntime != b->vruntime) {
+		return a->vruntime < b->vruntime ? -1 : 1;
+	}
+	if (a->pid != b->pid) {
+		return a->pid < b->pid ? -1 : 1;
+	}
+	return 0;
+}
+
+
+void rbt_rotate_left (RBTree tree, RBNode node) {
+	RBNode right = node->right;
+
+	node->right = right->left;
+	if (right->left) {
+		right->left->parent = node;
+	}
+	right->parent = node->parent;
+	if (!node->parent) {
+		tree->root = right;
+	} else if (node == node->parent->left) {
+		node->parent->left = right;
+	} else {
+		node->parent->right = right;
+	}
+	right->left = node;
+	node->parent = right;
+}
+
+
+void rbt_rotate_right (RBTree tree, RBNode node) {
+	RBNode left = node->left;
+
+	node->left = left->right;
+	if (left->right) {
+		left->right->parent = node;
+	}
+	left->parent = node->parent;
+	if (!node->parent) {
+		tree->root = left;
+	} else if (node == node->parent->right) {
+		node->parent->right = left;
+	} else {
+		node->parent->left = left;
+	}
+	left->right = node;
+	node->parent = left;
+}
+
+
+char rbt_is_red (RBNode node) {
+	return node != NULL && node->color == RB_RED;
+}
+
+
+/*
+	Restores the red-black properties after a red node was linked in as a leaf.
+*/
+void rbt_insert_fixup (RBTree tree, RBNode node) {
+	RBNode uncle = NULL;
+
+	while (rbt_is_red(node->parent)) {
+		RBNode parent = node->parent;
+		RBNode grandparent = parent->parent;
+
+		if (parent == grandparent->left) {
+			uncle = grandparent->right;
+			if (rbt_is_red(uncle)) {
+				parent->color = RB_BLACK;
+				uncle->color = RB_BLACK;
+				grandparent->color = RB_RED;
+				node = grandparent;
+			} else {
+				if (node == parent->right) {
+					node = parent;
+					rbt_rotate_left(tree, node);
+					parent = node->parent;
+				}
+				parent->color = RB_BLACK;
+				grandparent->color = RB_RED;
+				rbt_rotate_right(tree, grandparent);
+			}
+		} else {
+			uncle = grandparent->left;
+			if (rbt_is_red(uncle)) {
+				parent->color = RB_BLACK;
+				uncle->color = RB_BLACK;
+				grandparent->color = RB_RED;
+				node = grandparent;
+			} else {
+				if (node == parent->left) {
+					node = parent;
+					rbt_rotate_right(tree, node);
+					parent = node->parent;
+				}
+				parent->color = RB_BLACK;
+				grandparent->color = RB_RED;
+				rbt_rotate_left(tree, grandparent);
+			}
+		}
+	}
+	tree->root->color = RB_BLACK;
+}
+
+
+/*
+	Puts the subtree at with in the place of the subtree at node.
+*/
+void rbt_transplant (RBTree tree, RBNode node, RBNode with) {
+	if (!node->parent) {
+		tree->root = with;
+	} else if (node == node->parent->left) {
+		node->parent->left = with;
+	} else {
+		node->parent->right = with;
+	}
+	if (with) {
+		with->parent = node->parent;
+	}
+}
+
+
+/*
+	Restores the red-black properties after a black node was unlinked. The child that
+	took its place may be NULL, so its parent is passed along separately.
+*/
+void rbt_delete_fixup (RBTree tree, RBNode node, RBNode parent) {
+	RBNode sibling = NULL;
+
+	while (node != tree->root && !rbt_is_red(node)) {
+		if (node == parent->left) {
+			sibling = parent->right;
+			if (rbt_is_red(sibling)) {
+				sibling->color = RB_BLACK;
+				parent->color = RB_RED;
+				rbt_rotate_left(tree, parent);
+				sibling = parent->right;
+			}
+			if (!rbt_is_red(sibling->left) && !rbt_is_red(sibling->right)) {
+				sibling->color = RB_RED;
+				node = parent;
+				parent = node->parent;
+			} else {
+				if (!rbt_is_red(sibling->right)) {
+					sibling->left->color = RB_BLACK;
+					sibling->color = RB_RED;
+					rbt_rotate_right(tree, sibling);
+					sibling = parent->right;
+				}
+				sibling->color = parent->color;
+				parent->color = RB_BLACK;
+				sibling->right->color = RB_BLACK;
+				rbt_rotate_left(tree, parent);
+				node = tree->root;
+			}
+		} else {
+			sibling = parent->left;
+			if (rbt_is_red(sibling)) {
+				sibling->color = RB_BLACK;
+				parent->color = RB_RED;
+				rbt_rotate_right(tree, parent);
+				sibling = parent->left;
+			}
+			if (!rbt_is_red(sibling->left) && !rbt_is_red(sibling->right)) {
+				sibling->color = RB_RED;
+				node = parent;
+				parent = node->parent;
+			} else {
+				if (!rbt_is_red(sibling->left)) {
+					sibling->right->color = RB_BLACK;
+					sibling->color = RB_RED;
+					rbt_rotate_left(tree, sibling);
+					sibling = parent->left;
+				}
+				sibling->color = parent->color;
+				parent->color = RB_BLACK;
+				sibling->left->color = RB_BLACK;
+				rbt_rotate_right(tree, parent);
+				node = tree->root;
+			}
+		}
+	}
+	if (node) {
+		node->color = RB_BLACK;
+	}
+}
+
+
+RBNode rbt_minimum (RBNode node) {
+	while (node && node->left) {
+		node = node->left;
+	}
+	return node;
+}
+
+
+/*
+	Returns the node that comes after the given one in key order.
+*/
+RBNode rbt_successor (RBNode node) {
+	RBNode parent = NULL;
+
+	if (node->right) {
+		return rbt_minimum(node->right);
+	}
+	parent = node->parent;
+	while (parent && node == parent->right) {
+		node = parent;
+		parent = parent->parent;
+	}
+	return parent;
+}
+
+
+/*
+	Unlinks the node from the tree and frees it, keeping the leftmost cache current.
+*/
+void rbt_delete_node (RBTree tree, RBNode node) {
+	RBNode child = NULL, childParent = NULL, next = NULL;
+	enum rb_color removedColor = node->color;
+
+	if (node == tree->leftmost) {
+		tree->leftmost = rbt_successor(node);
+	}
+
+	if (!node->left) {
+		child = node->right;
+		childParent = node->parent;
+		rbt_transplant(tree, node, node->right);
+	} else if (!node->right) {
+		child = node->left;
+		childParent = node->parent;
+		rbt_transplant(tree, node, node->left);
+	} else {
+		next = rbt_minimum(node->right);
+		removedColor = next->color;
+		child = next->right;
+		if (next->parent == node) {
+			childParent = next;
+		} else {
+			childParent = next->parent;
+			rbt_transplant(tree, next, next->right);
+			next->right = node->right;
+			next->right->parent = next;
+		}
+		rbt_transplant(tree, node, next);
+		next->left = node->left;
+		next->left->parent = next;
+		next->color = node->color;
+	}
+
+	if (removedColor == RB_BLACK) {
+		rbt_delete_fixup(tree, child, childParent);
+	}
+
+	free(node);
+	tree->size--;
+}
+
+
+/*
+ * Creates an empty tree.
+ *
+ * Return: A new tree on success, NULL on failure.
+ */
+RBTree rbt_create () {
+	RBTree tree = (RBTree) malloc(sizeof(struct rb_tree));
+
+	if (tree != NULL) {
+		tree->root = NULL;
+		tree->leftmost = NULL;
+		tree->size = 0;
+	}
+
+	return tree;
+}
+
+
+void rbt_destroy_subtree (RBNode node) {
+	if (node) {
+		rbt_destroy_subtree(node->left);
+		rbt_destroy_subtree(node->right);
+		PCB_destroy(node->pcb);
+		free(node);
+	}
+}
+
+
+/*
+ * Destroys the tree and every PCB still in it.
+ */
+void rbt_destroy (RBTree tree) {
+	if (tree) {
+		rbt_destroy_subtree(tree->root);
+		free(tree);
+	}
+}
+
+
+/*
+ * Inserts the PCB keyed by its current vruntime and pid.
+ *
+ * Return: 1 on success, 0 if the node couldn't be allocated.
+ */
+int rbt_insert (RBTree tree, PCB pcb) {
+	RBNode node = (RBNode) malloc(sizeof(struct rb_node));
+	RBNode parent = NULL, curr = tree->root;
+	int isLeftmost = 1;
+
+	if (node == NULL) {
+		return 0;
+	}
+
+	while (curr) {
+		parent = curr;
+		if (rbt_compare(pcb, curr->pcb) < 0) {
+			curr = curr->left;
+		} else {
+			curr = curr->right;
+			isLeftmost = 0;
+		}
+	}
+
+	node->left = NULL;
+	node->right = NULL;
+	node->parent = parent;
+	node->color = RB_RED;
+	node->pcb = pcb;
+	if (!parent) {
+		tree->root = node;
+	} else if (rbt_compare(pcb, parent->pcb) < 0) {
+		parent->left = node;
+	} else {
+		parent->right = node;
+	}
+	if (isLeftmost) {
+		tree->leftmost = node;
+	}
+
+	rbt_insert_fixup(tree, node);
+	tree->size++;
+
+	return 1;
+}
+
+
+/*
+ * Removes and returns the PCB with the smallest vruntime, NULL if the tree is empty.
+ */
+PCB rbt_pop_min (RBTree tree) {
+	PCB pcb = NULL;
+
+	if (tree->leftmost) {
+		pcb = tree->leftmost->pcb;
+		rbt_delete_node(tree, tree->leftmost);
+	}
+
+	return pcb;
+}
+
+
+/*
+ * Returns the PCB with the smallest vruntime without removing it.
+ */
+PCB rbt_peek_min (RBTree tree) {
+	return tree->leftmost ? tree->leftmost->pcb : NULL;
+}
+
+
+/*
+ * Removes the given PCB from the tree, looking it up by its vruntime and pid.
+ *
+ * Return: the PCB, or NULL if it wasn't in the tree.
+ */
+PCB rbt_remove (RBTree tree, PCB pcb) {
+	RBNode curr = tree->root;
+	int cmp = 0;
+
+	while (curr) {
+		cmp = rbt_compare(pcb, curr->pcb);
+		if (!cmp) {
+			if (curr->pcb != pcb) { //same key but a different PCB
+				return NULL;
+			}
+			rbt_delete_node(tree, curr);
+			return pcb;
+		}
+		curr = cmp < 0 ? curr->left : curr->right;
+	}
+
+	return NULL;
+}
+
+
+char rbt_is_empty (RBTree tree) {
+	return tree->root == NULL;
+}
+
+
+/*
+	Prints the PCBs in vruntime order.
+*/
+void toStringRBTree (RBTree tree) {
+	RBNode curr = tree->leftmost;
+
+	if (!curr) {
+		trace("\r\n");
+		return;
+	}
+	while (curr) {
+		trace("P%d(%llu)", curr->pcb->pid, curr->pcb->vruntime);
+		curr = rbt_successor(curr);
+		if (curr) {
+			trace(" -> ");
+		} else {
+			trace(" -> *\r\n");
+		}
+	}
+}
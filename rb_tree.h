@@ -0,0 +1,86 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is a red-black tree of PCBs ordered by virtual runtime, with ties broken by
+	pid so every key is unique. Inserting and removing are O(log n), and the leftmost
+	node is cached so the PCB with the smallest vruntime can be read in O(1). A PCB's
+	vruntime must not change while it is in the tree.
+*/
+
+#ifndef RB_TREE_H
+#define RB_TREE_H
+
+#include "pcb.h"
+
+enum rb_color {
+	RB_RED,
+	RB_BLACK
+};
+
+typedef struct rb_node {
+	struct rb_node * left;
+	struct rb_node * right;
+	struct rb_node * parent;
+	enum rb_color color;
+	PCB pcb;
+} rb_node_s;
+
+typedef rb_node_s * RBNode;
+
+typedef struct rb_tree {
+	RBNode root;
+	RBNode leftmost; // the node with the smallest key, NULL when empty
+	int size;
+} rb_tree_s;
+
+typedef rb_tree_s * RBTree;
+
+
+/*
+ * Creates an empty tree.
+ *
+ * Return: A new tree on success, NULL on failure.
+ */
+RBTree rbt_create ();
+
+/*
+ * Destroys the tree and every PCB still in it.
+ */
+void rbt_destroy (RBTree tree);
+
+/*
+ * Inserts the PCB keyed by its current vruntime and pid.
+ *
+ * Return: 1 on success, 0 if the node couldn't be allocated.
+ */
+int rbt_insert (RBTree tree, PCB pcb);
+
+/*
+ * Removes and returns the PCB with the smallest vruntime, NULL if the tree is empty.
+ */
+PCB rbt_pop_min (RBTree tree);
+
+/*
+ * Returns the PCB with the smallest vruntime without removing it.
+ */
+PCB rbt_peek_min (RBTree tree);
+
+/*
+ * Removes the given PCB from the tree, looking it up by its vruntime and pid.
+ *
+ * Return: the PCB, or NULL if it wasn't in the tree.
+ */
+PCB rbt_remove (RBTree tree, PCB pcb);
+
+char rbt_is_empty (RBTree tree);
+
+/*
+ * Returns the node that comes after the given one in key order, NULL if it is the
+ * last. Start from tree->leftmost to walk the whole tree.
+ */
+RBNode rbt_successor (RBNode node);
+
+void toStringRBTree (RBTree tree);
+
+#endif
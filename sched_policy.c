@@ -0,0 +1,203 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is the interface every scheduling policy implements. A policy owns the set
+	of ready PCBs and decides which one runs next and for how long. The scheduler only
+	talks to the ready set through these hooks, so policies can be swapped without
+	touching scheduling or the dispatcher.
+*/
+
+#include "sched_policy.h"
+#include "mlfq_policy.h"
+#include "cfs_policy.h"
+#include "share_policy.h"
+#include "edf_policy.h"
+#include "o1_policy.h"
+
+
+/*
+	The default hooks. A policy that doesn't care about an event leaves these in place.
+*/
+void policy_noop_pcb (SchedPolicy policy, PCB pcb) {
+}
+
+void policy_noop (SchedPolicy policy) {
+}
+
+void policy_no_checkpoint (SchedPolicy policy, Checkpoint ckpt) {
+	ckpt_fail(ckpt, "this policy can't be checkpointed");
+}
+
+unsigned int policy_default_quantum (SchedPolicy policy, PCB pcb) {
+	return 1;
+}
+
+
+/*
+ * Creates the policy with the given name.
+ *
+ * Return: the new policy, or NULL if the name is unknown or allocation failed.
+ */
+SchedPolicy policy_create (const char * name) {
+	SchedPolicy policy = NULL;
+	
+	if (name == NULL || !strcmp(name, "mlfq")) {
+		policy = mlfq_policy_create();
+	} else if (!strcmp(name, "cfs")) {
+		policy = cfs_policy_create();
+	} else if (!strcmp(name, "lottery")) {
+		policy = lottery_policy_create();
+	} else if (!strcmp(name, "stride")) {
+		policy = stride_policy_create();
+	} else if (!strcmp(name, "edf")) {
+		policy = edf_policy_create();
+	} else if (!strcmp(name, "o1")) {
+		policy = o1_policy_create();
+	} else {
+		printf("Unknown scheduling policy: %s\r\n", name);
+	}
+	
+	return policy;
+}
+
+
+/*
+ * Allocates a policy with every hook set to a no-op. Used by the individual
+ * policies' constructors, which then fill in the hooks they need.
+ */
+SchedPolicy policy_alloc (const char * name) {
+	SchedPolicy policy = (SchedPolicy) malloc(sizeof(struct sched_policy));
+	
+	if (policy != NULL) {
+		policy->name = name;
+		policy->data = NULL;
+		policy->clock = 0;
+		policy->enqueue = policy_noop_pcb;
+		policy->pick_next = NULL;
+		policy->peek = NULL;
+		policy->remove = NULL;
+		policy->quantum = policy_default_quantum;
+		policy->on_tick = policy_noop_pcb;
+		policy->on_block = policy_noop_pcb;
+		policy->on_wake = policy_noop_pcb;
+		policy->on_boost = policy_noop;
+		policy->count = NULL;
+		policy->print = policy_noop;
+		policy->checkpoint = policy_no_checkpoint;
+		policy->destroy = policy_noop;
+	}
+	
+	return policy;
+}
+
+
+void policy_destroy (SchedPolicy policy) {
+	if (policy) {
+		policy->destroy(policy);
+		free(policy);
+	}
+}
+
+
+void policy_set_clock (SchedPolicy policy, unsigned int now) {
+	policy->clock = now;
+}
+
+
+void policy_enqueue (SchedPolicy policy, PCB pcb) {
+	if (policy && pcb) {
+		policy->enqueue(policy, pcb);
+		PCB_set_location(pcb, LOC_READY);
+	} else {
+		if (!policy) {
+			trace("\t\t\tSCHEDULING POLICY IS NULL\t\t\t\r\n");
+		} else {
+			trace("\t\t\tPCB IS NULL\t\t\t\r\n");
+		}
+	}
+}
+
+
+/*
+	Every PCB picked is dispatched, so it is recorded as running.
+*/
+PCB policy_pick_next (SchedPolicy policy) {
+	PCB pcb = policy->pick_next(policy);
+	
+	if (pcb) {
+		PCB_set_location(pcb, LOC_RUNNING);
+	}
+	
+	return pcb;
+}
+
+
+PCB policy_peek (SchedPolicy policy) {
+	return policy->peek(policy);
+}
+
+
+PCB policy_remove (SchedPolicy policy, PCB pcb) {
+	PCB found = policy->remove(policy, pcb);
+	
+	if (found) {
+		PCB_set_location(found, LOC_NONE);
+	}
+	
+	return found;
+}
+
+
+unsigned int policy_quantum (SchedPolicy policy, PCB pcb) {
+	return policy->quantum(policy, pcb);
+}
+
+
+void policy_on_tick (SchedPolicy policy, PCB pcb) {
+	policy->on_tick(policy, pcb);
+}
+
+
+void policy_on_block (SchedPolicy policy, PCB pcb) {
+	policy->on_block(policy, pcb);
+}
+
+
+void policy_on_wake (SchedPolicy policy, PCB pcb) {
+	policy->on_wake(policy, pcb);
+}
+
+
+void policy_on_boost (SchedPolicy policy) {
+	policy->on_boost(policy);
+}
+
+
+char policy_is_empty (SchedPolicy policy) {
+	return policy->peek(policy) == NULL;
+}
+
+
+int policy_count (SchedPolicy policy) {
+	return policy->count(policy);
+}
+
+
+/*
+	Prints the policy's name and its ready set.
+*/
+void toStringPolicy (SchedPolicy policy) {
+	trace("Policy: %s\r\n", policy->name);
+	policy->print(policy);
+}
+
+
+/*
+ * Writes or reads the policy's clock and ready set. Loading must be into a policy of
+ * the same name that hasn't been used yet.
+ */
+void policy_checkpoint (SchedPolicy policy, Checkpoint ckpt) {
+	ckpt_value(ckpt, policy->clock);
+	policy->checkpoint(policy, ckpt);
+}
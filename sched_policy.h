@@ -0,0 +1,104 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is the interface every scheduling policy implements. A policy owns the set
+	of ready PCBs and decides which one runs next and for how long. The scheduler only
+	talks to the ready set through these hooks, so policies can be swapped without
+	touching scheduling or the dispatcher.
+*/
+
+#ifndef SCHED_POLICY_H
+#define SCHED_POLICY_H
+
+#include "pcb.h"
+#include "checkpoint.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_POLICY "mlfq"
+
+
+typedef struct sched_policy * SchedPolicy;
+
+typedef struct sched_policy {
+	const char * name;
+	void * data; // the policy's own ready structure
+	unsigned int clock; // current time, kept up to date by the scheduler
+
+	/* Adds a ready PCB to the ready set. */
+	void (*enqueue) (SchedPolicy policy, PCB pcb);
+	/* Removes and returns the PCB that should run next, NULL if none is ready. */
+	PCB (*pick_next) (SchedPolicy policy);
+	/* Returns the PCB that pick_next would return without removing it. */
+	PCB (*peek) (SchedPolicy policy);
+	/* Removes the given PCB from the ready set, returns it or NULL if it wasn't there. */
+	PCB (*remove) (SchedPolicy policy, PCB pcb);
+	/* Returns how many iterations the PCB may run before it is preempted. */
+	unsigned int (*quantum) (SchedPolicy policy, PCB pcb);
+	/* Called when the running PCB is preempted at the end of its quantum. */
+	void (*on_tick) (SchedPolicy policy, PCB pcb);
+	/* Called when the running PCB blocks for I/O. */
+	void (*on_block) (SchedPolicy policy, PCB pcb);
+	/* Called when a blocked PCB becomes ready again, before it is enqueued. */
+	void (*on_wake) (SchedPolicy policy, PCB pcb);
+	/* Called periodically so the policy can rebalance the ready set. */
+	void (*on_boost) (SchedPolicy policy);
+	int (*count) (SchedPolicy policy);
+	void (*print) (SchedPolicy policy);
+	/* Writes the ready set, or reads it back into the freshly created policy. */
+	void (*checkpoint) (SchedPolicy policy, Checkpoint ckpt);
+	/* Frees the ready set and every PCB still in it. */
+	void (*destroy) (SchedPolicy policy);
+} sched_policy_s;
+
+
+/*
+ * Creates the policy with the given name.
+ *
+ * Return: the new policy, or NULL if the name is unknown or allocation failed.
+ */
+SchedPolicy policy_create (const char * name);
+
+/*
+ * Allocates a policy with every hook set to a no-op. Used by the individual
+ * policies' constructors, which then fill in the hooks they need.
+ */
+SchedPolicy policy_alloc (const char * name);
+
+void policy_destroy (SchedPolicy policy);
+
+void policy_set_clock (SchedPolicy policy, unsigned int now);
+
+void policy_enqueue (SchedPolicy policy, PCB pcb);
+
+PCB policy_pick_next (SchedPolicy policy);
+
+PCB policy_peek (SchedPolicy policy);
+
+PCB policy_remove (SchedPolicy policy, PCB pcb);
+
+unsigned int policy_quantum (SchedPolicy policy, PCB pcb);
+
+void policy_on_tick (SchedPolicy policy, PCB pcb);
+
+void policy_on_block (SchedPolicy policy, PCB pcb);
+
+void policy_on_wake (SchedPolicy policy, PCB pcb);
+
+void policy_on_boost (SchedPolicy policy);
+
+char policy_is_empty (SchedPolicy policy);
+
+int policy_count (SchedPolicy policy);
+
+void toStringPolicy (SchedPolicy policy);
+
+/*
+ * Writes or reads the policy's clock and ready set. Loading must be into a policy of
+ * the same name that hasn't been used yet.
+ */
+void policy_checkpoint (SchedPolicy policy, Checkpoint ckpt);
+
+#endif
@@ -30,6 +30,11 @@ time_t t;
 
 int contextSwitchCount = 0;
 
+unsigned long benchIterations = 0; // how many loops osLoop runs when benchmarking, 0 otherwise
+unsigned long totalIterations = 0;
+unsigned long dispatchCount = 0;
+FILE * shutdownReport = NULL; // where the role counts are printed at shutdown, NULL for nowhere
+
 // The global counts of each PCB type, the final count at end of program run 
 // should be roughly 50%, 25%, 12.5%, 12.5% respectively.
 int compCount;
@@ -75,20 +80,20 @@ void osLoop () {
 				
 				if (timerInterrupt(iterationCount) == 1) {
 					pseudoISR(thisScheduler, IS_TIMER);
-					printf("Completed Timer Interrupt\n");
+					trace("Completed Timer Interrupt\n");
 					printSchedulerState(thisScheduler);
 					iterationCount++;
 				}
 				
 				if (ioTrap(thisScheduler->running) == 1) {
-					printf("Iteration: %d\r\n", iterationCount);
-					printf("Initiating I/O Trap\r\n");
-					printf("PC when I/O Trap is Reached: %d\r\n", thisScheduler->running->context->pc);
+					trace("Iteration: %d\r\n", iterationCount);
+					trace("Initiating I/O Trap\r\n");
+					trace("PC when I/O Trap is Reached: %d\r\n", thisScheduler->running->context->pc);
 					pseudoISR(thisScheduler, IS_IO_TRAP);
 					
 					printSchedulerState(thisScheduler);
 					iterationCount++;
-					printf("Completed I/O Trap\n");
+					trace("Completed I/O Trap\n");
 				}
 				
 				if (thisScheduler->running != NULL)
@@ -100,13 +105,13 @@ void osLoop () {
 				}
 				
 				if (ioInterrupt(thisScheduler->blocked) == 1) {
-					printf("Iteration: %d\r\n", iterationCount);
-					printf("Initiating I/O Interrupt\n");
+					trace("Iteration: %d\r\n", iterationCount);
+					trace("Initiating I/O Interrupt\n");
 					pseudoISR(thisScheduler, IS_IO_INTERRUPT);
 					
 					printSchedulerState(thisScheduler);
 					iterationCount++;
-					printf("Completed I/O Interrupt\n");
+					trace("Completed I/O Interrupt\n");
 				}
 				
 				// if running PCB's terminate == running PCB's term_count, then terminate (for real).
@@ -114,16 +119,17 @@ void osLoop () {
 			}
 		} else {
 			iterationCount++;
-			printf("Idle\n");
+			trace("Idle\n");
 		}
 	
 		
 		if (!(iterationCount % RESET_COUNT)) {
-			printf("\r\nRESETTING MLFQ\r\n");
-			printf("iterationCount: %d\n", iterationCount);
+			trace("\r\nRESETTING MLFQ\r\n");
+			trace("iterationCount: %d\n", iterationCount);
 			resetMLFQ(thisScheduler);
 			//printf("here5.9\n");
-			if (rand() % MAKE_PCB_CHANCE_DOMAIN <= MAKE_PCB_CHANCE_PERCENTAGE) {
+			//a benchmark keeps looping past MAX_PCB_TOTAL, but the mutex map can't hold any more
+			if (totalProcesses < MAX_PCB_TOTAL && sim_rand() % MAKE_PCB_CHANCE_DOMAIN <= MAKE_PCB_CHANCE_PERCENTAGE) {
 				//printf("here6\n");
 				totalProcesses += makePCBList (thisScheduler);
 			}
@@ -132,8 +138,13 @@ void osLoop () {
 			//printf("here6.6\n");
 			iterationCount = 1;
 		}
-		if (totalProcesses >= MAX_PCB_TOTAL) {
-			printf("Reached max PCBs, ending Scheduler.\r\n");
+		totalIterations++;
+		if (benchIterations) { //a benchmark runs a fixed number of loops instead of a fixed number of PCBs
+			if (totalIterations >= benchIterations) {
+				break;
+			}
+		} else if (totalProcesses >= MAX_PCB_TOTAL) {
+			trace("Reached max PCBs, ending Scheduler.\r\n");
 			break;
 		}
 	}
@@ -242,9 +253,9 @@ int timerInterrupt(int iterationCount)
 {
 	if (quantum_tick >= currQuantumSize)
 	{
-		printf("Iteration: %d\r\n", iterationCount);
-		printf("Initiating Timer Interrupt\n");
-		printf("Current quantum tick: %d\r\n", quantum_tick);
+		trace("Iteration: %d\r\n", iterationCount);
+		trace("Initiating Timer Interrupt\n");
+		trace("Current quantum tick: %d\r\n", quantum_tick);
 		quantum_tick = 0;
 		return 1;
 	}
@@ -320,7 +331,7 @@ int makePCBList (Scheduler theScheduler) {
 	int newPCBCount = 2;
 	//int mutexCount = rand() & MAX_MUTEX_IN_ROUND;
 	
-	int lottery = rand();
+	int lottery = sim_rand();
 	//for (int i = 0; i < newPCBCount; i++) {
 		
 	Mutex sharedMutexR1 = mutex_create();
@@ -354,8 +365,8 @@ int makePCBList (Scheduler theScheduler) {
 		//printf("Role was PAIR or SHARED, adding sharedMutexR1 M%d\r\n", sharedMutexR1->mid);
 		//printf("Role was PAIR or SHARED, adding sharedMutexR2 M%d\r\n", sharedMutexR2->mid);
 		if (newPCB1->role == SHARED) {
-			printf("=============================\n");
-			printf("Made Shared Resource pair\n");
+			trace("=============================\n");
+			trace("Made Shared Resource pair\n");
 			
 			if (DEADLOCK) {
 				populateMutexTraps1221(newPCB1, newPCB1->max_pc / MAX_DIVIDER);
@@ -368,24 +379,24 @@ int makePCBList (Scheduler theScheduler) {
 			
 			// toStringMutexTraps(newPCB1, newPCB2);
 		
-			printf("ADDING IN M%d from Shared Resource\n", sharedMutexR1->mid);
-			printf("ADDING IN M%d from Shared Resource\n", sharedMutexR2->mid);
+			trace("ADDING IN M%d from Shared Resource\n", sharedMutexR1->mid);
+			trace("ADDING IN M%d from Shared Resource\n", sharedMutexR2->mid);
 			
 			add_to_mutx_map(theScheduler->mutexes, sharedMutexR1, sharedMutexR1->mid);
 			add_to_mutx_map(theScheduler->mutexes, sharedMutexR2, sharedMutexR2->mid);
 			
-			printf("pcb1->mutex_R1_id: M%d\n", newPCB1->mutex_R1_id);
-			printf("pcb2->mutex_R2_id: M%d\n", newPCB2->mutex_R2_id);
+			trace("pcb1->mutex_R1_id: M%d\n", newPCB1->mutex_R1_id);
+			trace("pcb2->mutex_R2_id: M%d\n", newPCB2->mutex_R2_id);
 		} else {
 			/* LOOK AT THIS */
-			printf("=============================\n");
-			printf("Made Producer/Consumer\n");
+			trace("=============================\n");
+			trace("Made Producer/Consumer\n");
 			populateProducerConsumerTraps(newPCB1, newPCB1->max_pc / MAX_DIVIDER, newPCB1->isProducer);
 			populateProducerConsumerTraps(newPCB2, newPCB2->max_pc / MAX_DIVIDER, newPCB2->isProducer);
-			printf("ADDING IN M%d from Producer/Consumer\n", sharedMutexR1->mid);
+			trace("ADDING IN M%d from Producer/Consumer\n", sharedMutexR1->mid);
 			add_to_mutx_map(theScheduler->mutexes, sharedMutexR1, sharedMutexR1->mid);
-			printf("pcb1->mutex_R1_id: M%d\n", newPCB1->mutex_R1_id);
-			printf("pcb2->mutex_R1_id: M%d\n", newPCB2->mutex_R1_id);
+			trace("pcb1->mutex_R1_id: M%d\n", newPCB1->mutex_R1_id);
+			trace("pcb2->mutex_R1_id: M%d\n", newPCB2->mutex_R1_id);
 	
 			free(sharedMutexR2);
 		}
@@ -465,7 +476,7 @@ unsigned int runProcess (unsigned int pc, int quantumSize) {
 	//priority levels.
 	unsigned int jump;
 	if (quantumSize != 0) {
-		jump = rand() % quantumSize;
+		jump = sim_rand() % quantumSize;
 	}
 	
 	pc += jump;
@@ -481,9 +492,9 @@ unsigned int runProcess (unsigned int pc, int quantumSize) {
 void terminate(Scheduler theScheduler) {
 	if(theScheduler->running != NULL && theScheduler->running->terminate > 0 && theScheduler->running->terminate == theScheduler->running->term_count)
 	{
-		printf("Marking for termination...\r\n");
+		trace("Marking for termination...\r\n");
 		theScheduler->running->state = STATE_HALT;
-		printf("...\r\n");
+		trace("...\r\n");
 		scheduling(IS_TERMINATING, theScheduler);	
 	}
 	
@@ -505,7 +516,7 @@ void pseudoISR (Scheduler theScheduler, int interruptType) {
 	//printf("entering IRET\n");
 	pseudoIRET(theScheduler);
 	//printf("finished IRET\n");
-	printf("Exiting ISR\n");
+	trace("Exiting ISR\n");
 }
 
 
@@ -516,44 +527,44 @@ void pseudoISR (Scheduler theScheduler, int interruptType) {
 */
 void printSchedulerState (Scheduler theScheduler) {
 	
-	printf("MLFQ State\r\n");
+	trace("MLFQ State\r\n");
 	toStringPriorityQueue(theScheduler->ready);
-	printf("\r\n");
+	trace("\r\n");
 	
 	int index = 0;
 	// PRIVILIGED PID
 	while(privileged[index] != NULL && index < MAX_PRIVILEGE) {
-		printf("PCB PID %d, PRIORITY %d, PC %d\n", 
+		trace("PCB PID %d, PRIORITY %d, PC %d\n", 
 		privileged[index]->pid, privileged[index]->priority, 
 		privileged[index]->context->pc);
 		index++;
 	}
-	printf("blocked size: %d\r\n", theScheduler->blocked->size);
-	printf("killed size: %d\r\n", theScheduler->killed->size);
-	printf("killedMutexes size: %d\r\n", theScheduler->killedMutexes->size);
-	printf("\r\n");
+	trace("blocked size: %d\r\n", theScheduler->blocked->size);
+	trace("killed size: %d\r\n", theScheduler->killed->size);
+	trace("killedMutexes size: %d\r\n", theScheduler->killedMutexes->size);
+	trace("\r\n");
 	
 	if (pq_peek(theScheduler->ready) != NULL) {
-		printf("Going to be running ");
+		trace("Going to be running ");
 		if (theScheduler->running) {
 			toStringPCB(theScheduler->running, 0);
 		} else {
-			printf("\r\n");
+			trace("\r\n");
 		}
-		printf("Next highest priority PCB ");
+		trace("Next highest priority PCB ");
 		toStringPCB(pq_peek(theScheduler->ready), 0);
-		printf("\r\n\r\n\r\n");
+		trace("\r\n\r\n\r\n");
 	} else {
 		
 		if (theScheduler->running != NULL) {
-			printf("Going to be running ");
+			trace("Going to be running ");
 			toStringPCB(theScheduler->running, 0);
 		} else {
-			printf("\r\n");
+			trace("\r\n");
 		}
 
-		printf("Next highest priority PCB contents: The MLFQ is empty!\r\n");
-		printf("\r\n\r\n\r\n");
+		trace("Next highest priority PCB contents: The MLFQ is empty!\r\n");
+		trace("\r\n\r\n\r\n");
 	}
 }
 
@@ -570,16 +581,10 @@ void resetMLFQ (Scheduler theScheduler) {
 		ReadyQueue curr = theScheduler->ready->queues[i];
 		if (!q_is_empty(curr)) {
 			if (!q_is_empty(theScheduler->ready->queues[0])) {
-				theScheduler->ready->queues[0]->last_node->next = curr->first_node;
-				theScheduler->ready->queues[0]->last_node = curr->last_node;
-				theScheduler->ready->queues[0]->size += curr->size;
 				allEmpty = 0;
-			} else {
-				theScheduler->ready->queues[0]->first_node = curr->first_node;
-				theScheduler->ready->queues[0]->last_node = curr->last_node;
-				theScheduler->ready->queues[0]->size = curr->size;
 			}
 			resetReadyQueue(curr);
+			q_concat(theScheduler->ready->queues[0], curr);
 		}
 	}
 	
@@ -590,7 +595,7 @@ void resetMLFQ (Scheduler theScheduler) {
 
 
 /*
-	Resets the given ReadyQueue to be empty.
+	Sets every PCB in the given ReadyQueue back to the highest priority.
 */
 void resetReadyQueue (ReadyQueue queue) {
 	ReadyQueueNode ptr = queue->first_node;
@@ -598,9 +603,6 @@ void resetReadyQueue (ReadyQueue queue) {
 		ptr->pcb->priority = 0;
 		ptr = ptr->next;
 	}
-	queue->first_node = NULL;
-	queue->last_node = NULL;
-	queue->size = 0;
 }
 
 
@@ -619,14 +621,14 @@ void scheduling (int interrupt_code, Scheduler theScheduler) {
 	//Mutex currMutex;
 	
 	if (interrupt_code == IS_TIMER) {
-		printf("Entering Timer Interrupt\r\n");
+		trace("Entering Timer Interrupt\r\n");
 		theScheduler->interrupted->state = STATE_READY;
 		if (theScheduler->interrupted->priority < (NUM_PRIORITIES - 1)) {
 			theScheduler->interrupted->priority++;
 		} else {
 			theScheduler->interrupted->priority = 0;
 		}
-		printf("\r\nEnqueueing into MLFQ\r\n");
+		trace("\r\nEnqueueing into MLFQ\r\n");
 		toStringPCB(theScheduler->running, 0);
 		//printf("after1\n");
 		
@@ -639,16 +641,16 @@ void scheduling (int interrupt_code, Scheduler theScheduler) {
 		if (index != 0) {
 			privileged[index] = theScheduler->running;
 		}
-		printf("Exiting Timer Interrupt\r\n");
+		trace("Exiting Timer Interrupt\r\n");
 	}
 	else if (interrupt_code == IS_IO_TRAP)
 	{
 		// Do I/O trap handling
-		printf("Entering IO Trap\r\n");
-		int timer = (rand() % TIMER_RANGE + 1);
+		trace("Entering IO Trap\r\n");
+		int timer = (sim_rand() % TIMER_RANGE + 1);
 		theScheduler->interrupted->blocked_timer = timer;
 		theScheduler->interrupted->state = STATE_WAIT;
-		printf("\r\nEnqueueing into Blocked queue\r\n");
+		trace("\r\nEnqueueing into Blocked queue\r\n");
 		toStringPCB(theScheduler->interrupted, 0);
 		//printf("after\n");
 		//exit(0);
@@ -658,13 +660,13 @@ void scheduling (int interrupt_code, Scheduler theScheduler) {
 		theScheduler->interrupted = NULL;
 		
 		// schedule a new process
-		printf("Exiting IO Trap\r\n");
+		trace("Exiting IO Trap\r\n");
 	}
 	else if (interrupt_code == IS_IO_INTERRUPT)
 	{
-		printf("Entering IO Interrupt\r\n");
+		trace("Entering IO Interrupt\r\n");
 		// Do I/O interrupt handling
-		printf("\r\nEnqueueing into MLFQ from Blocked queue\r\n");
+		trace("\r\nEnqueueing into MLFQ from Blocked queue\r\n");
 		toStringPCB(q_peek(theScheduler->blocked), 0);
 		pq_enqueue(theScheduler->ready, q_dequeue(theScheduler->blocked));
 		//printSchedulerState(theScheduler);
@@ -676,13 +678,13 @@ void scheduling (int interrupt_code, Scheduler theScheduler) {
 			sysstack = theScheduler->running->context->pc;
 		}
 		theScheduler->interrupted = NULL;
-		printf("Exiting IO Interrupt\r\n");
+		trace("Exiting IO Interrupt\r\n");
 	}
 	
 	if (theScheduler->interrupted != NULL && theScheduler->interrupted->state == STATE_HALT) {
-		printf("entering handleKilledQueueInsertion\n");
+		trace("entering handleKilledQueueInsertion\n");
 		handleKilledQueueInsertion(theScheduler);
-		printf("finished handleKilledQueueInsertion\n");
+		trace("finished handleKilledQueueInsertion\n");
 	}
 	
 	// I/O interrupt does not require putting a new process
@@ -717,6 +719,7 @@ void dispatcher (Scheduler theScheduler) {
 		//printf("inside dispatcher\n");
 		currQuantumSize = getNextQuantumSize(theScheduler->ready);
 		theScheduler->running = pq_dequeue(theScheduler->ready);
+		dispatchCount++;
 		theScheduler->running->state = STATE_RUNNING;
 		theScheduler->interrupted = NULL;
 	}
@@ -800,8 +803,8 @@ void schedulerDeconstructor (Scheduler theScheduler) {
 		}
 		
 		if (theScheduler->interrupted && theScheduler->running && theScheduler->interrupted == theScheduler->running) {
-			//printf("destroying interrupted\n");
-			PCB_destroy(theScheduler->interrupted);
+			//the same PCB as running, which was already destroyed above
+			theScheduler->interrupted = NULL;
 		}
 		
 		//printf("destroying scheduler\n");
@@ -813,12 +816,15 @@ void schedulerDeconstructor (Scheduler theScheduler) {
 
 
 void displayRoleCountResults() {
-	printf("\r\nTOTAL ROLE TYPES: %d\r\n\r\n", (compCount + ioCount + pairCount + sharedCount));
+	if (!shutdownReport) {
+		return;
+	}
+	fprintf(shutdownReport, "\r\nTOTAL ROLE TYPES: %d\r\n\r\n", (compCount + ioCount + pairCount + sharedCount));
 	
-	printf("COMP: \t%d\r\n", compCount);
-	printf("IO: \t%d\r\n", ioCount);
-	printf("PAIR: \t%d\r\n", pairCount);
-	printf("SHARED: %d\r\n", sharedCount);
+	fprintf(shutdownReport, "COMP: \t%d\r\n", compCount);
+	fprintf(shutdownReport, "IO: \t%d\r\n", ioCount);
+	fprintf(shutdownReport, "PAIR: \t%d\r\n", pairCount);
+	fprintf(shutdownReport, "SHARED: %d\r\n", sharedCount);
 }
 
 int isPrivileged(PCB pcb) {
@@ -852,15 +858,55 @@ int isPrivileged(PCB pcb) {
 // }
 
 
+/*
+	Runs osLoop as a benchmark: a fixed seed, a fixed number of loops, and one CSV 
+	line of throughput numbers at the end. Called as "bench [iterations] [seed]". 
+	The trace is turned off so it doesn't dominate the timing, and the role counts go
+	to stderr.
+*/
+int runBenchmark (int argc, char * argv[]) {
+	bench_sim_result_s result = {"single", "mlfq", BENCH_SIM_SEED, 0, 0, 0, 0, 0};
+	double start = 0;
+	
+	benchIterations = BENCH_SIM_ITERATIONS;
+	if (argc > 2 && atoi(argv[2]) > 0) {
+		benchIterations = atoi(argv[2]);
+	}
+	if (argc > 3) {
+		result.seed = (unsigned int) strtoul(argv[3], NULL, 10);
+	}
+	sim_srand(result.seed);
+	shutdownReport = stderr; //keeps stdout to the one CSV line
+	traceEnabled = 0;
+	
+	start = bench_now();
+	osLoop();
+	result.wall_ns = bench_now() - start;
+	
+	result.iterations = totalIterations;
+	result.dispatches = dispatchCount;
+	result.peakRSS = bench_peak_rss();
+	bench_print_sim_header(stdout);
+	bench_print_sim(stdout, &result);
+	
+	return 0;
+}
+
+
 // lock\unlock tests
-void main () {
+void main (int argc, char * argv[]) {
 	setvbuf(stdout, NULL, _IONBF, 0);
-	srand((unsigned) time(&t));
+	if (argc > 1 && !strcmp(argv[1], "bench")) {
+		runBenchmark(argc, argv);
+		return;
+	}
+	sim_srand((unsigned) time(&t));
+	shutdownReport = stdout;
 	
 	int outerLoop = 100;
 	int innerLoop = 300;
 	int count = 0;
-	int mutexCount = rand() % MAX_MUTEX_IN_ROUND;
+	int mutexCount = sim_rand() % MAX_MUTEX_IN_ROUND;
 	if (!mutexCount) {
 		mutexCount++;
 	}
@@ -871,7 +917,7 @@ void main () {
 	}
 	while (count < 30000) {
 		if (scheduler->running->role == PAIR || scheduler->running->role == SHARED) {
-			printf("the running mutex_R1_id: %d\n", scheduler->running->mutex_R1_id);
+			trace("the running mutex_R1_id: %d\n", scheduler->running->mutex_R1_id);
 			useMutex (scheduler);
 		}
 		scheduler->running->context->pc++;
@@ -901,29 +947,29 @@ void main () {
 	Returns 1 if a context switched happen so the osLoop knows to start over, otherwise 0.
 */
 int useMutex (Scheduler thisScheduler) {	
-	printf("the running mutex_R1_id: %d\n", thisScheduler->running->mutex_R1_id);
+	trace("the running mutex_R1_id: %d\n", thisScheduler->running->mutex_R1_id);
 	int wait = 0, signal = 0; 
 	int lock = isLockPC(thisScheduler->running->context->pc, thisScheduler->running);
 	int unlock = isUnlockPC(thisScheduler->running->context->pc, thisScheduler->running);
-	printf("the running mutex_R1_id: %d\n", thisScheduler->running->mutex_R1_id);
+	trace("the running mutex_R1_id: %d\n", thisScheduler->running->mutex_R1_id);
 	
-	if (thisScheduler->running->role = PAIR) {
+	if (thisScheduler->running->role == PAIR) {
 		if (thisScheduler->running->isProducer) {
 			signal = isSignalPC(thisScheduler->running->context->pc, thisScheduler->running);
 		} else {
 			wait = isWaitPC(thisScheduler->running->context->pc, thisScheduler->running);
 		}
 	}
-	printf("the running mutex_R1_id: %d\n", thisScheduler->running->mutex_R1_id);
+	trace("the running mutex_R1_id: %d\n", thisScheduler->running->mutex_R1_id);
 	
 	Mutex currMutex = NULL;
 	
 	if (lock) {
-		printf("lock   the running mutex_R1_id: %d\n", thisScheduler->running->mutex_R1_id);
+		trace("lock   the running mutex_R1_id: %d\n", thisScheduler->running->mutex_R1_id);
 		printPCLocations(thisScheduler->running->lockR1);
 		printPCLocations(thisScheduler->running->lockR2);
 		if (lock == 1) { //is mutex_R1_id
-			printf("lock   the running mutex_R1_id: %d\n", thisScheduler->running->mutex_R1_id);
+			trace("lock   the running mutex_R1_id: %d\n", thisScheduler->running->mutex_R1_id);
 			currMutex = get_mutx(thisScheduler->mutexes, thisScheduler->running->mutex_R1_id);
 		} else { //is mutex_R2_id
 			currMutex = get_mutx(thisScheduler->mutexes, thisScheduler->running->mutex_R2_id);
@@ -932,19 +978,19 @@ int useMutex (Scheduler thisScheduler) {
 		if (currMutex) {
 			mutex_lock (currMutex, thisScheduler->running);
 			if (currMutex->hasLock != thisScheduler->running) {
-				printf("M%d already locked, going to wait for unlock\r\n");
+				trace("M%d already locked, going to wait for unlock\r\n");
 				pq_enqueue(thisScheduler->ready, thisScheduler->running);
 				thisScheduler->running = pq_dequeue(thisScheduler->ready);
 				return 1;
 			} else {
-				printf("M%d locked at PC %d\n", currMutex->mid, thisScheduler->running->context->pc);
+				trace("M%d locked at PC %d\n", currMutex->mid, thisScheduler->running->context->pc);
 			}
 		} else {
-			printf("\r\n\t\t\tcurrMutex was null!!!\r\n\r\n");
+			trace("\r\n\t\t\tcurrMutex was null!!!\r\n\r\n");
 			exit(0);
 		}
 	} else if (unlock) {
-		printf("unlock   the running mutex_R1_id: %d\n", thisScheduler->running->mutex_R1_id);
+		trace("unlock   the running mutex_R1_id: %d\n", thisScheduler->running->mutex_R1_id);
 		if (unlock == 1) { //is mutex_R1_id
 			currMutex = get_mutx(thisScheduler->mutexes, thisScheduler->running->mutex_R1_id);
 		} else { //is mutex_R2_id
@@ -953,24 +999,24 @@ int useMutex (Scheduler thisScheduler) {
 		
 		if (currMutex) {
 			mutex_unlock (currMutex, thisScheduler->running);
-			printf("M%d unlocked at PC %d\n", currMutex->mid, thisScheduler->running->context->pc);
+			trace("M%d unlocked at PC %d\n", currMutex->mid, thisScheduler->running->context->pc);
 		} else {
-			printf("\r\n\t\t\tcurrMutex was null!!!\r\n\r\n");
+			trace("\r\n\t\t\tcurrMutex was null!!!\r\n\r\n");
 			exit(0);
 		}
 	} else if (signal) {
-		printf("signal   the running mutex_R1_id: %d\n", thisScheduler->running->mutex_R1_id);
+		trace("signal   the running mutex_R1_id: %d\n", thisScheduler->running->mutex_R1_id);
 		currMutex = get_mutx(thisScheduler->mutexes, thisScheduler->running->mutex_R1_id);
 		
 		if (currMutex) {
 			cond_var_signal (currMutex->condVar);
-			printf("M%d condition variable signalled at PC %d\n", currMutex->mid, thisScheduler->running->context->pc);
+			trace("M%d condition variable signalled at PC %d\n", currMutex->mid, thisScheduler->running->context->pc);
 		} else {
-			printf("\r\n\t\t\tcurrMutex was null!!!\r\n\r\n");
+			trace("\r\n\t\t\tcurrMutex was null!!!\r\n\r\n");
 			exit(0);
 		}
 	} else if (wait) {
-		printf("wait   the running mutex_R1_id: %d\n", thisScheduler->running->mutex_R1_id);
+		trace("wait   the running mutex_R1_id: %d\n", thisScheduler->running->mutex_R1_id);
 		currMutex = get_mutx(thisScheduler->mutexes, thisScheduler->running->mutex_R1_id);
 		
 		if (currMutex) {
@@ -978,18 +1024,15 @@ int useMutex (Scheduler thisScheduler) {
 			if (isWaiting) {
 				pq_enqueue(thisScheduler->ready, thisScheduler->running);
 				thisScheduler->running = pq_dequeue(thisScheduler->ready);
-				printf("M%d condition variable waiting at PC %d\n", currMutex->mid, thisScheduler->running->context->pc);
+				trace("M%d condition variable waiting at PC %d\n", currMutex->mid, thisScheduler->running->context->pc);
 				return 1;
 			} else { //this part resets the condition variable so we don't need to keep making a new one
 				cond_var_init(currMutex->condVar);
 			}
 		} else {
-			printf("\r\n\t\t\tcurrMutex was null!!!\r\n\r\n");
+			trace("\r\n\t\t\tcurrMutex was null!!!\r\n\r\n");
 			exit(0);
 		}
-	} else {
-		printf("\r\n\t\t\tSomething went wrong in useMutex!!!\r\n");
-		exit(0);
 	}
 	
 	return 0;
@@ -999,11 +1042,11 @@ int useMutex (Scheduler thisScheduler) {
 //killed tests
 /*void main () {
 	setvbuf(stdout, NULL, _IONBF, 0);
-	srand((unsigned) time(&t));
+	sim_srand((unsigned) time(&t));
 	
 	int outerLoop = 100;
 	int innerLoop = 300;
-	int mutexCount = rand() % MAX_MUTEX_IN_ROUND;
+	int mutexCount = sim_rand() % MAX_MUTEX_IN_ROUND;
 	if (!mutexCount) {
 		mutexCount++;
 	}
@@ -1016,7 +1059,7 @@ int useMutex (Scheduler thisScheduler) {
 	
 	printSchedulerState(scheduler);
 	toStringMutexMap(scheduler->mutexes);
-	printf("BEFORE KILLING^^\n");
+	trace("BEFORE KILLING^^\n");
 	
 	while (!pq_is_empty(scheduler->ready)) {
 		PCB toRun = NULL;
@@ -1026,10 +1069,10 @@ int useMutex (Scheduler thisScheduler) {
 		if (!(scheduler->running)) {
 			scheduler->running = toRun;
 		} else {
-			printf("\r\nRunning is already P%d\r\n", scheduler->running->pid);
+			trace("\r\nRunning is already P%d\r\n", scheduler->running->pid);
 		}
 		handleKilledQueueInsertion(scheduler);
-		printf("Killed List: ");
+		trace("Killed List: ");
 		toStringReadyQueueMutexes(scheduler->killedMutexes);
 		if (scheduler->killed->size >= TOTAL_TERMINATED) {
 			handleKilledQueueEmptying(scheduler);
@@ -1041,7 +1084,7 @@ int useMutex (Scheduler thisScheduler) {
 	
 	printSchedulerState(scheduler);
 	toStringMutexMap(scheduler->mutexes);
-	printf("AFTER KILLING^^\n");
+	trace("AFTER KILLING^^\n");
 	
 	schedulerDeconstructor(scheduler);
 }*/
@@ -1055,12 +1098,12 @@ void handleKilledQueueInsertion (Scheduler theScheduler) {
 		mutex1 = take_n_remove_from_mutx_map(theScheduler->mutexes, theScheduler->running->mutex_R1_id);
 		mutex2 = take_n_remove_from_mutx_map(theScheduler->mutexes, theScheduler->running->mutex_R2_id);
 		if (!mutex1) {
-			printf("\r\n\t\t\tmutex1 was null! Tried to find M%d but it wasn't in the map!!!\r\n\r\n", theScheduler->running->mutex_R1_id);
+			trace("\r\n\t\t\tmutex1 was null! Tried to find M%d but it wasn't in the map!!!\r\n\r\n", theScheduler->running->mutex_R1_id);
 			exit(0);
 		}
 		
 		if (!mutex2) {
-			printf("\r\n\t\t\tmutex2 was null! Tried to find M%d but it wasn't in the map!!!\r\n\r\n", theScheduler->running->mutex_R2_id);
+			trace("\r\n\t\t\tmutex2 was null! Tried to find M%d but it wasn't in the map!!!\r\n\r\n", theScheduler->running->mutex_R2_id);
 			exit(0);
 		}
 		
@@ -1081,7 +1124,7 @@ void handleKilledQueueInsertion (Scheduler theScheduler) {
 		q_enqueue(theScheduler->killed, theScheduler->running);
 	}
 	
-	printf("Killed List: ");
+	trace("Killed List: ");
 toStringReadyQueue(theScheduler->killed);
 	theScheduler->running = NULL;
 }
@@ -1090,10 +1133,10 @@ toStringReadyQueue(theScheduler->killed);
 void handleKilledQueueEmptying (Scheduler theScheduler) {
 	
 	//PCB emptying
-	printf("Emptying killed PCB list\r\n");
+	trace("Emptying killed PCB list\r\n");
 	PCB toKill = NULL;
 	if (!(theScheduler->killed)) {
-		printf("\r\n\t\t\tkilled PCB queue is NULL!\r\n\r\n");
+		trace("\r\n\t\t\tkilled PCB queue is NULL!\r\n\r\n");
 		exit(0);
 	}
 	
@@ -1106,16 +1149,16 @@ void handleKilledQueueEmptying (Scheduler theScheduler) {
 			//if (theScheduler->killed->size > 1) {
 				//printf("pid to kill: P%d\n", toKill->pid);
 			if (toKill) {
-				printf("toKill: P%d\r\n", toKill->pid);
+				trace("toKill: P%d\r\n", toKill->pid);
 				PCB_destroy(toKill);
 			} else {
-				printf("\r\n\t\t\ttoKill PCB was NULL!\r\n\r\n");
+				trace("\r\n\t\t\ttoKill PCB was NULL!\r\n\r\n");
 				exit(0);
 			}
 				//printf("toKill == null: %d\n", (toKill == NULL));
 				//printf("pid after kill: P%d\n\n", toKill->pid);
 			//}
-			printf("Killed List: ");
+			trace("Killed List: ");
 			toStringReadyQueue(theScheduler->killed);
 			toKill = q_dequeue(theScheduler->killed);
 		} 
@@ -1123,31 +1166,31 @@ void handleKilledQueueEmptying (Scheduler theScheduler) {
 		if (toKill) {
 			PCB_destroy(toKill);
 		} else {
-			printf("\r\n\t\t\ttoKill PCB was NULL!\r\n\r\n");
+			trace("\r\n\t\t\ttoKill PCB was NULL!\r\n\r\n");
 			exit(0);
 		}
 	}
-	printf("After emptying\n");
-	printf("Killed List: ");
+	trace("After emptying\n");
+	trace("Killed List: ");
 	toStringReadyQueue(theScheduler->killed);
-	printf("is killed PCB list empty? ");
+	trace("is killed PCB list empty? ");
 	if (q_is_empty(theScheduler->killed)) {
-		printf("true\r\n");
+		trace("true\r\n");
 	} else {
-		printf("false\r\n");
+		trace("false\r\n");
 	}
 	
 	
 	//Mutex emptying
-	printf("Emptying killed MUTEX list\r\n");
+	trace("Emptying killed MUTEX list\r\n");
 	Mutex toKillMutex = NULL;
 	if (!(theScheduler->killedMutexes)) {
-		printf("\r\n\t\t\tkilled MUTEX queue is NULL!\r\n\r\n");
+		trace("\r\n\t\t\tkilled MUTEX queue is NULL!\r\n\r\n");
 		exit(0);
 	}
 	
 	if (theScheduler->killedMutexes && !q_is_empty(theScheduler->killedMutexes)) {
-		printf("here\r\n");
+		trace("here\r\n");
 		toKillMutex = q_dequeue_m(theScheduler->killedMutexes);
 	}
 	
@@ -1156,16 +1199,16 @@ void handleKilledQueueEmptying (Scheduler theScheduler) {
 			//if (theScheduler->killed->size > 1) {
 				//printf("pid to kill: P%d\n", toKill->pid);
 			if (toKillMutex) {
-				printf("toKillMutex: M%d\r\n", toKillMutex->mid);
+				trace("toKillMutex: M%d\r\n", toKillMutex->mid);
 				mutex_destroy(toKillMutex);
 			} else {
-				printf("\r\n\t\t\tin here toKill MUTEX was NULL!\r\n\r\n");
+				trace("\r\n\t\t\tin here toKill MUTEX was NULL!\r\n\r\n");
 				exit(0);
 			}
 				//printf("toKill == null: %d\n", (toKill == NULL));
 				//printf("pid after kill: P%d\n\n", toKill->pid);
 			//}
-			printf("Killed List: ");
+			trace("Killed List: ");
 			toStringReadyQueueMutexes(theScheduler->killedMutexes);
 			toKillMutex = q_dequeue_m(theScheduler->killedMutexes);
 		} 
@@ -1174,80 +1217,80 @@ void handleKilledQueueEmptying (Scheduler theScheduler) {
 			mutex_destroy(toKillMutex);
 		} else {
 			if (!q_is_empty(theScheduler->killedMutexes)) {
-				printf("\r\n\t\t\tor here toKill MUTEX was NULL!\r\n\r\n");
+				trace("\r\n\t\t\tor here toKill MUTEX was NULL!\r\n\r\n");
 				exit(0);
 			}
 		}
 	}
 	
-	printf("After emptying\n");
-	printf("Killed List: ");
+	trace("After emptying\n");
+	trace("Killed List: ");
 	toStringReadyQueueMutexes(theScheduler->killedMutexes);
-	printf("is killed MUTEX list empty? ");
+	trace("is killed MUTEX list empty? ");
 	if (q_is_empty(theScheduler->killedMutexes)) {
-		printf("true\r\n");
+		trace("true\r\n");
 	} else {
-		printf("false\r\n");
+		trace("false\r\n");
 	}
 		//exit(0);
 }
 
 void toStringMutexTraps(PCB newPCB1, PCB newPCB2) {
-		printf("PCB 1 ==================================\r\n");
+		trace("PCB 1 ==================================\r\n");
 			
 			
-		printf("mutex_1_traps lock\n");
-		printf("lock pcb1\r\n");
+		trace("mutex_1_traps lock\n");
+		trace("lock pcb1\r\n");
 		for (int i = 0; i < TRAP_COUNT; i++) {
 			
-			printf("%d ", newPCB1->lockR1[i]);
+			trace("%d ", newPCB1->lockR1[i]);
 		}
-		printf("unlock pcb1\r\n");
+		trace("unlock pcb1\r\n");
 		for (int i = 0; i < TRAP_COUNT; i++) {
 			
-			printf("%d ", newPCB1->unlockR1[i]);
+			trace("%d ", newPCB1->unlockR1[i]);
 		}
-		printf("\r\nmutex_2_traps lock\r\n");
-		printf("lock2 pcb1\r\n");
+		trace("\r\nmutex_2_traps lock\r\n");
+		trace("lock2 pcb1\r\n");
 		for (int i = 0; i < TRAP_COUNT; i++) {
 		
-			printf("%d ", newPCB1->lockR2[i]);
+			trace("%d ", newPCB1->lockR2[i]);
 		}
 		
-		printf("lock2 pcb1\r\n");
+		trace("lock2 pcb1\r\n");
 		for (int i = 0; i < TRAP_COUNT; i++) {
 			
-			printf("%d ", newPCB1->unlockR2[i]);
+			trace("%d ", newPCB1->unlockR2[i]);
 		}
-		printf("\n");
+		trace("\n");
 		
 		
-		printf("PCB 2 ==================================\r\n");
+		trace("PCB 2 ==================================\r\n");
 		
 		
-		printf("mutex_1_traps lock\n");
-		printf("lock pcb2\r\n");
+		trace("mutex_1_traps lock\n");
+		trace("lock pcb2\r\n");
 		for (int i = 0; i < TRAP_COUNT; i++) {
 			
-			printf("%d ", newPCB2->lockR1[i]);
+			trace("%d ", newPCB2->lockR1[i]);
 		}
 		
-			printf("unlock pcb2\r\n");
+			trace("unlock pcb2\r\n");
 		for (int i = 0; i < TRAP_COUNT; i++) {
 		
-			printf("%d ", newPCB2->unlockR1[i]);
+			trace("%d ", newPCB2->unlockR1[i]);
 		}
-		printf("\r\nmutex_2_traps lock\r\n");
-		printf("lock2 pcb2\r\n");
+		trace("\r\nmutex_2_traps lock\r\n");
+		trace("lock2 pcb2\r\n");
 		for (int i = 0; i < TRAP_COUNT; i++) {
 			
-			printf("%d ", newPCB2->lockR2[i]);
+			trace("%d ", newPCB2->lockR2[i]);
 		}
-		printf("lock2 pcb2\r\n");
+		trace("lock2 pcb2\r\n");
 		
 		for (int i = 0; i < TRAP_COUNT; i++) {
 			
-			printf("%d ", newPCB2->unlockR2[i]);
+			trace("%d ", newPCB2->unlockR2[i]);
 		}
 	
 	
@@ -1267,9 +1310,9 @@ void deadlockMonitor(Scheduler thisScheduler) {
 	mutex2 = get_mutx(thisScheduler->mutexes, thisScheduler->running->mutex_R2_id);
 	
 	if (mutex1->isLocked && (mutex1->hasLock == thisScheduler->running) && mutex2->isLocked && (mutex2->hasLock == thisScheduler->running)) {
-		printf("NO DEADLOCK DETECTED FOR PROCESSES PID%d & PID%d\r\n", mutex1->pcb1->pid, mutex1->pcb2->pid);
+		trace("NO DEADLOCK DETECTED FOR PROCESSES PID%d & PID%d\r\n", mutex1->pcb1->pid, mutex1->pcb2->pid);
 	} else {
-		printf("DEADLOCK DETECTED FOR PROCESSES PID%d & PID%d\r\n", mutex1->pcb1->pid, mutex1->pcb2->pid);
+		trace("DEADLOCK DETECTED FOR PROCESSES PID%d & PID%d\r\n", mutex1->pcb1->pid, mutex1->pcb2->pid);
 	}
 }
 
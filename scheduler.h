@@ -17,6 +17,7 @@
 //includes
 #include "priority_queue.h"
 #include "mutex_map.h"
+#include "bench.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -91,6 +92,8 @@ void resetReadyQueue (ReadyQueue queue);
 
 void osLoop ();
 
+int runBenchmark (int argc, char * argv[]);
+
 int timerInterrupt (int);
 
 int ioTrap (PCB);
@@ -18,6 +18,7 @@ unsigned int sysstack;
 int switchCalls;
 
 Scheduler thisScheduler;
+const char * policyName = DEFAULT_POLICY;
 
 PCB privileged[4];
 int privilege_counter = 0;
@@ -27,11 +28,53 @@ int currQuantumSize;
 int quantum_tick = 0; // Use for quantum length tracking
 int io_timer = 0;
 int totalProcesses = 0;
-int iteration = 0;
-int isIOTrapPos = 0;
-int hasBlockedPCB = 0;
+atomic_uint iteration = 0; // only osLoop advances it, everyone else just reads it
+atomic_int isIOTrapPos = 0; // written under the trapMutex, osLoop also reads it under the schedulerMutex
+PCB trapPCB = NULL; // the PCB whose I/O trap isIOTrapPos is reporting
+int pendingIOCompletions = 0; // I/O completions fired by the timer wheel but not yet serviced
+int timerExpired = 0;
+atomic_int stopRequested = 0; // set once by osLoop, every helper thread exits when it sees it
+atomic_int helpersBusy = 0; // timer and ioInterrupt threads between taking work and finishing it
+unsigned int deviceFree[MAX_DEVICES]; // when each I/O device will have finished every request queued on it
+int deviceCount = 1;
+int interruptThreadCount = 1; // ioInterrupt threads servicing the completions
 int deadlockDetected = 0;
 int isFirstRun = 0;
+unsigned int maxIterations = MAX_ITERATION_TOTAL;
+unsigned long dispatchCount = 0; // PCBs moved into running by the dispatcher
+unsigned long ioCompletionCount = 0;
+int benchmarking = 0; // stamps I/O completions so the wakeup latency can be measured
+double wakeSamples[BENCH_MAX_SAMPLES];
+int wakeSampleCount = 0;
+const char * checkpointPath = NULL; // where osLoop saves a checkpoint, NULL for never
+unsigned int checkpointAt = 0; // the iteration the checkpoint is saved at
+const char * restorePath = NULL; // the checkpoint osLoop resumes from instead of starting fresh
+sim_params_s simParams = {AGING_INTERVAL, 100, DEADLOCK_CHANCE_PERCENTAGE, 
+	IO_INT_CHANCE_PERCENTAGE, MAKE_PCB_CHANCE_PERCENTAGE, 0, TLB_ENTRIES, VM_CLOCK, DISK_LATENCY, WS_WINDOW, 0, PM_BUDDY, 0, 0, 0, ADMIT_BACKLOG};
+const char * whatIfSpecs[MAX_WHATIF_CHILDREN]; // the parameters each what-if child runs with
+int whatIfCount = 0; // children to fork, 0 for a normal run
+unsigned int whatIfAt = 0; // the iteration they are forked at
+int whatIfIndex = -1; // which child this process is, -1 in the parent
+pid_t whatIfPids[MAX_WHATIF_CHILDREN];
+int whatIfFds[MAX_WHATIF_CHILDREN]; // the parent reads each child's result from its pipe
+double whatIfStart = 0; // when this child was forked
+bench_whatif_s whatIfBase; // the counters when this child was forked, see readWhatIfCounters
+const char * workloadPath = NULL; // the workload file to replay instead of making random PCBs
+Workload workload = NULL;
+VirtualMemory vm = NULL; // the simulated virtual memory, NULL when simParams.frames is 0
+vm_stats_s memoryStats; // the virtual memory's counters as it was freed
+vm_stats_s whatIfMemoryBase; // vm's counters once this child was forked and its memory set up
+unsigned int diskFree = 0; // when the paging disk will have finished every read queued on it
+PhysMem physMem = NULL; // the simulated physical memory, NULL when simParams.memoryUnits is 0
+unsigned long admissionStalls = 0; // arrivals turned away because physical memory was full
+double endFragmentation = 0; // physMem's external fragmentation as it was freed
+double dispatchLatency = 0; // iterations recent dispatches waited in the ready set, a moving average
+unsigned long long latencyTotal = 0; // iterations every dispatch waited, for the mean
+unsigned long long whatIfLatencyBase = 0; // latencyTotal when this child was forked
+unsigned long deferredCount = 0; // new PCBs admission control held back when they arrived
+unsigned long releasedCount = 0; // those it has since admitted
+unsigned long long deferredIterations = 0; // iterations they were held back for in all
+unsigned long rejectedCount = 0; // new PCBs turned away because admission control's queue was full
 
 
 time_t t;
@@ -48,140 +91,80 @@ int contextSwitchCount;
 int incrementPair;
 
 pthread_mutex_t schedulerMutex;
-pthread_mutex_t iterationMutex;
 pthread_mutex_t randMutex;
 pthread_mutex_t printMutex;
 pthread_mutex_t totalProcessesMutex;
 pthread_mutex_t trapMutex;
 pthread_mutex_t interruptMutex;
+pthread_mutex_t reclaimMutex;
 
 pthread_cond_t trapCondVar;
 pthread_cond_t interruptCondVar;
+pthread_cond_t timerCondVar;
+pthread_cond_t reclaimCondVar;
 
+lock_profile_s lockProfiles[LOCK_COUNT];
+FILE * shutdownReport = NULL; // where osLoop prints its reports and the lock profile at shutdown, NULL for nowhere
+unsigned int trapMask = 0; // see runningTraps
+PCB trapMaskPCB = NULL; // the running PCB, dispatch and PC trapMask was matched for
+unsigned long trapMaskDispatch = 0;
+unsigned int trapMaskPC = 0;
 
 
-/*
-	Will look through the lockR1 and lockR2 arrays in the given pcb and see if 
-	they match the given PC value. If so, then return the array number, 0 otherwise.
-	
-	(1 for lockR1, 2 for lockR2)
-*/
-int isLockPC (unsigned int pc, PCB pcb) {
-	int isLock = 0;
-	for (int i = 0; i < TRAP_COUNT; i++) {
-		if (pc == pcb->lockR1[i]) {
-			isLock = 1;
-			break;
-		}
-	}
-	
-	if (pcb->role == SHARED && !isLock) {
-		for (int i = 0; i < TRAP_COUNT; i++) {
-			if (pc == pcb->lockR2[i]) {
-				isLock = 2;
-				break;
-			}
-		}
-	}
-	
-	return isLock;
-}
-
 
 /*
-	Will look through the unlockR1 and unlockR2 arrays in the given pcb and see if 
-	they match the given PC value. If so, then return the array number, 0 otherwise.
-	
-	(1 for unlockR1, 2 for unlockR2)
-*/
-int isUnlockPC (unsigned int pc, PCB pcb) {
-	int isUnlock = 0;
-	for (int i = 0; i < TRAP_COUNT; i++) {
-		if (pc == pcb->unlockR1[i]) {
-			isUnlock = 1;
-			break;
-		}
-	}
+	Turns the trap_match bits for a pair of R1/R2 arrays into the array number the
+	PC was found in, 0 if neither. R2 only counts for SHARED PCBs.
 	
-	if (pcb->role == SHARED && !isUnlock) {
-		for (int i = 0; i < TRAP_COUNT; i++) {
-			if (pc == pcb->unlockR2[i]) {
-				isUnlock = 2;
-				break;
-			}
-		}
-	}
-	
-	return isUnlock;
-}
-
-
-/*
-	Will look through the signal_cond array in the given pcb and see if 
-	they match the given PC value. If so, then return 1, 0 otherwise.
+	(1 for R1, 2 for R2)
 */
-int isSignalPC (unsigned int pc, PCB pcb) {
-	int isSignal = 0;
-	for (int i = 0; i < TRAP_COUNT; i++) {
-		if (pc == pcb->signal_cond[i]) {
-			isSignal = 1;
-			break;
-		}
+int trapResource (unsigned int mask, unsigned int r1Bit, unsigned int r2Bit, PCB pcb) {
+	if (mask & r1Bit) {
+		return 1;
+	} else if (pcb->role == SHARED && (mask & r2Bit)) {
+		return 2;
 	}
 	
-	return isSignal;
+	return 0;
 }
 
 
 /*
-	Will look through the signal_cond array in the given pcb and see if 
-	they match the given PC value. If so, then return 1, 0 otherwise.
+	Returns the trap_match mask for the running PCB at its PC. osLoop matches each PC 
+	once: the mask it takes after advancing the PC, for the I/O check, is the one the 
+	next step's useMutex gets, unless a dispatch or a PC change came in between. Must 
+	be called with the schedulerMutex held.
 */
-int isWaitPC (unsigned int pc, PCB pcb) {
-	int isWait = 0;
-	for (int i = 0; i < TRAP_COUNT; i++) {
-		if (pc == pcb->wait_cond[i]) {
-			isWait = 1;
-			break;
-		}
+unsigned int runningTraps (Scheduler theScheduler) {
+	PCB pcb = theScheduler->running;
+	
+	if (pcb != trapMaskPCB || dispatchCount != trapMaskDispatch || pcb->context->pc != trapMaskPC) {
+		trapMask = trap_match(pcb, pcb->context->pc);
+		trapMaskPCB = pcb;
+		trapMaskDispatch = dispatchCount;
+		trapMaskPC = pcb->context->pc;
 	}
 	
-	return isWait;
+	return trapMask;
 }
 
 
 /*
-	Will look through the I/O trap arrays in the given pcb and see if 
-	they match the given PC value. If so, then return 1, 0 otherwise.
+	Enqueues the PCB into one of the Scheduler's FIFO queues and records in the PCB 
+	table that it is there.
 */
-int isTrapPC (unsigned int pc, PCB pcb) {
-	int isTrap = 0;
-	if (pcb) {
-		for (int i = 0; i < TRAP_COUNT; i++) {
-			if (pc == pcb->io_1_traps[i]) {
-				isTrap = 1;
-				break;
-			}
-		}
-		
-		if (isTrap) {
-			for (int i = 0; i < TRAP_COUNT; i++) {
-				if (pc == pcb->io_2_traps[i]) {
-					isTrap = 1;
-					break;
-				}
-			}
-		}
-	}
-	
-	return isTrap;
+void moveToQueue (ReadyQueue queue, PCB pcb, enum pcb_location location) {
+	q_enqueue(queue, pcb);
+	PCB_set_location(pcb, location);
 }
 
 
 /*
 	This creates the list of new PCBs for the current loop through. It simulates
 	the creation of each PCB, the changing of state to new, enqueueing into the
-	list of created PCBs, and moving each of those PCBs into the ready queue.
+	list of created PCBs, and moving each of those PCBs into the ready queue. If 
+	either can't be given its memory neither is made, and it counts as an admission
+	stall.
 */
 int makePCBList (Scheduler theScheduler) {
 	int newPCBCount = 2;
@@ -190,7 +173,16 @@ int makePCBList (Scheduler theScheduler) {
 	Mutex sharedMutexR2 = mutex_create();
 	
 	PCB newPCB1 = PCB_create();
-	PCB newPCB2 = PCB_create();
+	PCB newPCB2 = newPCB1 ? PCB_create() : NULL;
+	
+	if (newPCB2 == NULL) { //the physical memory is full, so the pair is turned away
+		trace("No memory for a new pair, turning it away\r\n");
+		PCB_destroy(newPCB1);
+		mutex_destroy(sharedMutexR1);
+		mutex_destroy(sharedMutexR2);
+		admissionStalls++;
+		return 0;
+	}
 	newPCB2->parent = newPCB1->pid;
 	
 	if (isFirstRun) {
@@ -218,17 +210,17 @@ int makePCBList (Scheduler theScheduler) {
 	incrementRoleCount(newPCB2->role);
 	
 	if (newPCB1->role == COMP || newPCB1->role == IO) { //if the role isn't one that uses a mutex, then destroy it.
-		printf("Made COMP or IO pair\r\n");
+		trace("Made COMP or IO pair\r\n");
 		free(sharedMutexR1);
 		free(sharedMutexR2);
 	} else {
 		if (newPCB1->role == SHARED) {
-			printf("Made Shared Resource pair\r\n");
+			trace("Made Shared Resource pair\r\n");
 			if (DEADLOCK) {
-				pthread_mutex_lock(&randMutex);
-					int temp = rand() % DEADLOCK_CHANCE_DOMAIN;
-				pthread_mutex_unlock(&randMutex);
-				if (temp <= DEADLOCK_CHANCE_PERCENTAGE) {
+				lockMutex(RAND_LOCK);
+					int temp = sim_rand() % DEADLOCK_CHANCE_DOMAIN;
+				unlockMutex(RAND_LOCK);
+				if (temp <= simParams.deadlockChance) {
 					populateMutexTraps2112(newPCB1, newPCB1->max_pc / MAX_DIVIDER);
 					populateMutexTraps1221(newPCB2, newPCB2->max_pc / MAX_DIVIDER);
 				} else {
@@ -242,7 +234,7 @@ int makePCBList (Scheduler theScheduler) {
 			add_to_mutx_map(theScheduler->mutexes, sharedMutexR1, sharedMutexR1->mid);
 			add_to_mutx_map(theScheduler->mutexes, sharedMutexR2, sharedMutexR2->mid);
 		} else {
-			printf("Made Producer/Consumer\n");
+			trace("Made Producer/Consumer\n");
 			populateProducerConsumerTraps(newPCB1, newPCB1->max_pc / MAX_DIVIDER, newPCB1->isProducer);
 			populateProducerConsumerTraps(newPCB2, newPCB2->max_pc / MAX_DIVIDER, newPCB2->isProducer);
 			
@@ -252,35 +244,238 @@ int makePCBList (Scheduler theScheduler) {
 		
 	}
 	
-	newPCB1->state = STATE_NEW;
-	newPCB2->state = STATE_NEW;
+	PCB_assign_state(newPCB1, STATE_NEW);
+	PCB_assign_state(newPCB2, STATE_NEW);
+	newPCB1->creation = newPCB2->creation = iteration;
 	
-	q_enqueue(theScheduler->created, newPCB1);
-	q_enqueue(theScheduler->created, newPCB2);
+	moveToQueue(theScheduler->created, newPCB1, LOC_CREATED);
+	moveToQueue(theScheduler->created, newPCB2, LOC_CREATED);
 
 	if (newPCBCount) {
-		while (!q_is_empty(theScheduler->created)) {
-			PCB nextPCB = q_dequeue(theScheduler->created);
-			nextPCB->state = STATE_READY;
-			printf("Enqueuing newly created P%d into MLFQ\n", nextPCB->pid);
-			pq_enqueue(theScheduler->ready, nextPCB);
+		admitCreated(theScheduler);
+		deferredCount += (newPCB1->location == LOC_CREATED) + (newPCB2->location == LOC_CREATED);
+	}
+	
+	return newPCBCount;
+}
+
+
+/*
+	Posts the PCBs in the Created queue to the ready inbox, oldest first, for as long
+	as admission control lets them in. The rest stay in the Created queue, which is 
+	the admission queue, until a later call. The first time, when the Scheduler is 
+	new, the first ready PCB is also picked to run.
+*/
+void admitCreated (Scheduler theScheduler) {
+	unsigned int depth = policy_count(theScheduler->ready); //the inbox isn't counted, it's drained before every dispatch
+	
+	while (!q_is_empty(theScheduler->created) && admissionOpen(theScheduler, depth)) {
+		PCB nextPCB = q_dequeue(theScheduler->created);
+		trace("Admitting newly created P%d\n", nextPCB->pid);
+		if (nextPCB->creation != iteration) {
+			releasedCount++;
+			deferredIterations += iteration - nextPCB->creation;
 		}
+		PCB_set_location(nextPCB, LOC_INBOX);
+		postToInbox(theScheduler, nextPCB, 1);
+		depth++;
+	}
+	if (!q_is_empty(theScheduler->created)) {
+		trace("Admission control is holding back %u new PCBs\r\n", theScheduler->created->size);
+	}
+	
+	if (theScheduler->isNew) {
+		drainInbox(theScheduler);
+		theScheduler->running = policy_pick_next(theScheduler->ready);
 		
-		if (theScheduler->isNew) {
-			theScheduler->running = pq_dequeue(theScheduler->ready);
-			
-			pthread_mutex_lock(&printMutex);
-			printf("Dequeuing to run\n");
-			toStringPCB(theScheduler->running, 0);
-			pthread_mutex_unlock(&printMutex);
-			if (theScheduler->running) {
-				theScheduler->running->state = STATE_RUNNING;
+		lockMutex(PRINT_LOCK);
+		trace("Dequeuing to run\n");
+		toStringPCB(theScheduler->running, 0);
+		unlockMutex(PRINT_LOCK);
+		if (theScheduler->running) {
+			PCB_assign_state(theScheduler->running, STATE_RUNNING);
+		}
+		theScheduler->isNew = 0;
+	}
+}
+
+
+/*
+	Whether admission control lets another new PCB into a ready set depth deep. It 
+	does unless a limit in simParams is set and reached: the ready set's depth, the 
+	number of blocked PCBs or the recent dispatch latency. An empty ready set always
+	takes one, the latency doesn't change while nothing is dispatched.
+*/
+int admissionOpen (Scheduler theScheduler, unsigned int depth) {
+	return depth == 0 
+		|| ((!simParams.maxReady || depth < simParams.maxReady)
+		&& (!simParams.maxBlocked || theScheduler->blocked->size < simParams.maxBlocked)
+		&& (!simParams.maxLatency || dispatchLatency < simParams.maxLatency));
+}
+
+
+/*
+	Whether an arrival of count PCBs is rejected, which it is when the admission 
+	queue is holding PCBs back and has no room for them. Counts the rejected PCBs.
+*/
+int admissionRejects (Scheduler theScheduler, int count) {
+	if (theScheduler->created->size + count <= simParams.backlog) {
+		return 0;
+	}
+	trace("Admission queue full, rejecting %d new PCBs\r\n", count);
+	rejectedCount += count;
+	
+	return 1;
+}
+
+
+/*
+	Puts a PCB in the ready set, stamping when it joined so the dispatcher can measure
+	how long it waited. Must be called with the schedulerMutex held.
+*/
+void enqueueReady (Scheduler theScheduler, PCB pcb) {
+	pcb->ready_at = iteration;
+	policy_enqueue(theScheduler->ready, pcb);
+}
+
+
+/*
+	Creates the PCBs of one workload record, with their Mutexes if they are a pair,
+	and admits them. Trap lists the record doesn't give are made the way makePCBList
+	makes them. Returns how many PCBs were made.
+*/
+int makeWorkloadPCBs (Scheduler theScheduler, WorkloadRecord record) {
+	const unsigned int mutexTraps = (1u << WL_LOCK_R1) | (1u << WL_LOCK_R2) | (1u << WL_UNLOCK_R1)
+		| (1u << WL_UNLOCK_R2) | (1u << WL_WAIT) | (1u << WL_SIGNAL);
+	workload_pcb_s * desc = NULL;
+	Mutex mutexR1 = NULL, mutexR2 = NULL;
+	PCB pcbs[2] = {NULL, NULL};
+	PCB pcb = NULL;
+	int made = 0;
+	
+	if (record->count == 2) {
+		mutexR1 = mutex_create();
+		mutexR2 = record->pcbs[0].role == SHARED ? mutex_create() : mutexR1;
+	}
+	for (int i = 0; i < record->count; i++) {
+		desc = &record->pcbs[i];
+		pcb = pcbs[i] = PCB_create();
+		if (pcb == NULL) {
+			break;
+		}
+		pcb->role = desc->role;
+		pcb->isProducer = desc->role == PAIR && desc->isProducer;
+		pcb->isConsumer = desc->role == PAIR && !desc->isProducer;
+		PCB_set_limits(pcb, desc->max_pc, desc->terminate);
+		PCB_assign_priority(pcb, desc->priority);
+		memcpy(pcb->io_1_traps, desc->traps[WL_IO_1], sizeof(pcb->io_1_traps));
+		memcpy(pcb->io_2_traps, desc->traps[WL_IO_2], sizeof(pcb->io_2_traps));
+		memcpy(pcb->lockR1, desc->traps[WL_LOCK_R1], sizeof(pcb->lockR1));
+		memcpy(pcb->lockR2, desc->traps[WL_LOCK_R2], sizeof(pcb->lockR2));
+		memcpy(pcb->unlockR1, desc->traps[WL_UNLOCK_R1], sizeof(pcb->unlockR1));
+		memcpy(pcb->unlockR2, desc->traps[WL_UNLOCK_R2], sizeof(pcb->unlockR2));
+		memcpy(pcb->wait_cond, desc->traps[WL_WAIT], sizeof(pcb->wait_cond));
+		memcpy(pcb->signal_cond, desc->traps[WL_SIGNAL], sizeof(pcb->signal_cond));
+		
+		if (pcb->role == IO && !(desc->given & (1u << WL_IO_1))) {
+			populateIOTraps(pcb, 0);
+		}
+		if (pcb->role == IO && !(desc->given & (1u << WL_IO_2))) {
+			populateIOTraps(pcb, 1);
+		}
+		if (pcb->role == PAIR && !(desc->given & mutexTraps)) {
+			populateProducerConsumerTraps(pcb, pcb->max_pc / MAX_DIVIDER, pcb->isProducer);
+		}
+		if (pcb->role == SHARED && !(desc->given & mutexTraps)) {
+			populateMutexTraps1221(pcb, pcb->max_pc / MAX_DIVIDER);
+		}
+		if (pcb->isProducer) {
+			pcb->rt_period = RT_PERIOD;
+			pcb->rt_budget = RT_BUDGET;
+		}
+		if (mutexR1) {
+			pcb->mutex_R1_id = mutexR1->mid;
+			pcb->mutex_R2_id = mutexR2->mid;
+			if (i == 0) {
+				mutexR1->pcb1 = mutexR2->pcb1 = pcb;
+			} else {
+				pcb->parent = pcbs[0]->pid;
+				mutexR1->pcb2 = mutexR2->pcb2 = pcb;
 			}
-			theScheduler->isNew = 0;
 		}
+		incrementRoleCount(pcb->role);
+		PCB_assign_state(pcb, STATE_NEW);
+		pcb->creation = iteration;
+		made++;
 	}
 	
-	return newPCBCount;
+	if (made < record->count) { //out of memory, drop the whole record
+		admissionStalls++;
+		for (int i = 0; i < made; i++) {
+			PCB_destroy(pcbs[i]);
+		}
+		if (mutexR2 && mutexR2 != mutexR1) {
+			mutex_destroy(mutexR2);
+		}
+		if (mutexR1) {
+			mutex_destroy(mutexR1);
+		}
+		return 0;
+	}
+	if (mutexR1) {
+		add_to_mutx_map(theScheduler->mutexes, mutexR1, mutexR1->mid);
+		if (mutexR2 != mutexR1) {
+			add_to_mutx_map(theScheduler->mutexes, mutexR2, mutexR2->mid);
+		}
+	}
+	for (int i = 0; i < made; i++) {
+		moveToQueue(theScheduler->created, pcbs[i], LOC_CREATED);
+	}
+	admitCreated(theScheduler);
+	for (int i = 0; i < made; i++) {
+		deferredCount += pcbs[i]->location == LOC_CREATED;
+	}
+	
+	return made;
+}
+
+
+/*
+	Admits every workload record that has arrived by the current iteration. Returns
+	how many PCBs were made.
+*/
+int admitWorkload (Scheduler theScheduler) {
+	workload_record_s record;
+	int made = 0;
+	
+	while (wl_take(workload, iteration, &record)) {
+		if (!admissionRejects(theScheduler, record.count)) {
+			made += makeWorkloadPCBs(theScheduler, &record);
+		}
+	}
+	
+	return made;
+}
+
+
+/*
+	Schedules the next TIMER_MAKE_PCB: at the next workload arrival when a workload 
+	is being replayed, nothing once it has run out, and otherwise after the random 
+	wait makePCBList has always used.
+*/
+void scheduleArrivals (Scheduler theScheduler) {
+	unsigned int next = 0;
+	
+	if (workload) {
+		next = wl_next_arrival(workload);
+		if (next != WORKLOAD_NONE) {
+			tw_schedule(theScheduler->timers, next > iteration ? next : iteration + 1, TIMER_MAKE_PCB, NULL);
+		}
+	} else {
+		tw_schedule(theScheduler->timers, 
+			iteration + sampleGeometric(MAKE_PCB_CHANCE_DOMAIN, simParams.arrivalChance), 
+			TIMER_MAKE_PCB, NULL);
+	}
 }
 
 
@@ -317,10 +512,11 @@ void terminate(Scheduler theScheduler) {
 	if(theScheduler->running != NULL && theScheduler->running->terminate > 0 
 		&& theScheduler->running->terminate == theScheduler->running->term_count)
 	{
-		printf("\nMarking P%d for termination...\r\n", theScheduler->running->pid);
-		theScheduler->running->state = STATE_HALT;
+		trace("\nMarking P%d for termination...\r\n", theScheduler->running->pid);
+		PCB_assign_state(theScheduler->running, STATE_HALT);
 		theScheduler->interrupted = theScheduler->running;
-		printf("...\r\n");
+		theScheduler->running = NULL; //the PCB may be freed before the dispatcher runs
+		trace("...\r\n");
 		scheduling(IS_TERMINATING, theScheduler);	
 	}
 	
@@ -334,7 +530,7 @@ void terminate(Scheduler theScheduler) {
 */
 void pseudoISR (Scheduler theScheduler, int interruptType) {
 	if (theScheduler->running && theScheduler->running->state != STATE_HALT) {
-		theScheduler->running->state = STATE_INT;
+		PCB_assign_state(theScheduler->running, STATE_INT);
 		theScheduler->interrupted = theScheduler->running;
 		theScheduler->running = NULL;
 	} else {
@@ -342,7 +538,7 @@ void pseudoISR (Scheduler theScheduler, int interruptType) {
 										  //we're handling it correctly
 	}
 	scheduling(interruptType, theScheduler);
-	printf("Exiting ISR\n");
+	trace("Exiting ISR\n");
 }
 
 
@@ -353,104 +549,53 @@ void pseudoISR (Scheduler theScheduler, int interruptType) {
 */
 void printSchedulerState (Scheduler theScheduler) {
 	
-	printf("\r\nMLFQ State\r\n");
-	printf("iteration: %d\r\n", iteration);
-	toStringPriorityQueue(theScheduler->ready);
-	printf("\r\n");
+	trace("\r\nMLFQ State\r\n");
+	trace("iteration: %d\r\n", iteration);
+	toStringPolicy(theScheduler->ready);
+	trace("\r\n");
 	
 	int index = 0;
 
-	printf("blocked: ");
+	toStringPCBTable();
+	trace("inbox: %d\r\n", (int) lfq_size(theScheduler->inbox));
+	trace("blocked: ");
 	toStringReadyQueue(theScheduler->blocked);
-	printf("killed: ");
+	trace("killed: ");
 	toStringReadyQueue(theScheduler->killed);
-	printf("killedMutexes: ");
+	trace("killedMutexes: ");
 	toStringReadyQueueMutexes(theScheduler->killedMutexes);
-	printf("\r\n");
+	trace("\r\n");
 	
-	if (pq_peek(theScheduler->ready) != NULL) {
-		printf("Going to be running ");
+	if (policy_peek(theScheduler->ready) != NULL) {
+		trace("Going to be running ");
 		if (theScheduler->running) {
 			toStringPCB(theScheduler->running, 0);
 		} else {
-			printf("\r\n\r\n");
+			trace("\r\n\r\n");
 		}
-		printf("Next highest priority PCB ");
-		toStringPCB(pq_peek(theScheduler->ready), 0);
-		printf("\r\n\r\n\r\n");
+		trace("Next highest priority PCB ");
+		toStringPCB(policy_peek(theScheduler->ready), 0);
+		trace("\r\n\r\n\r\n");
 	} else {
 		
 		if (theScheduler->running != NULL) {
-			printf("Going to be running ");
+			trace("Going to be running ");
 			toStringPCB(theScheduler->running, 0);
 		} else {
-			printf("\r\n");
+			trace("\r\n");
 		}
 
-		printf("Next highest priority PCB contents: The MLFQ is empty!\r\n");
-		printf("\r\n\r\n\r\n");
+		trace("Next highest priority PCB contents: The MLFQ is empty!\r\n");
+		trace("\r\n\r\n\r\n");
 	}
 }
 
 
 /*
-	Used to move every value in the MLFQ back to the highest priority
-	ReadyQueue after a predetermined time. It does this by taking the first value
-	of each ReadyQueue (after the 0 *highest priority* queue) and setting it to
-	be the new last value of the 0 queue.
-*/
-void resetMLFQ (Scheduler theScheduler) {
-	int allEmpty = 1;
-	
-	printf("\r\n\r\nRESETTING MLFQ\r\n\r\n");
-	
-	if (!pq_is_empty(theScheduler->ready)) { //if the MLFQ isn't empty, then reset it
-		allEmpty = 0;
-		for (int i = 1; i < NUM_PRIORITIES; i++) {
-			ReadyQueue curr = theScheduler->ready->queues[i];
-			if (!q_is_empty(curr)) {
-				if (!q_is_empty(theScheduler->ready->queues[0])) {
-					theScheduler->ready->queues[0]->last_node->next = curr->first_node;
-					theScheduler->ready->queues[0]->last_node = curr->last_node;
-					theScheduler->ready->queues[0]->size += curr->size;
-					allEmpty = 0;
-				} else {
-					theScheduler->ready->queues[0]->first_node = curr->first_node;
-					theScheduler->ready->queues[0]->last_node = curr->last_node;
-					theScheduler->ready->queues[0]->size = curr->size;
-				}
-				resetReadyQueue(curr);
-			}
-		}
-	}
-	
-	if (allEmpty) {
-		theScheduler->isNew = 1;
-	}
-}
-
-
-/*
-	Resets the given ReadyQueue to be empty.
-*/
-void resetReadyQueue (ReadyQueue queue) {
-	ReadyQueueNode ptr = queue->first_node;
-	while (ptr) {
-		ptr->pcb->priority = 0;
-		ptr = ptr->next;
-	}
-	queue->first_node = NULL;
-	queue->last_node = NULL;
-	queue->size = 0;
-}
-
-
-/*
-	If the interrupt that occurs was a Timer interrupt, it will simply set the 
+	First, any PCBs posted to the ready inbox since the last call are moved into the
+	ready set. If the interrupt that occurs was a Timer interrupt, it will simply set the 
 	interrupted PCBs state to Ready and enqueue it into the Ready queue. If it is
-	an IO Trap, then it will put the running PCB into the Blocked queue. If it is
-	an IO Interrupt, then it will take the top of the Blocked queue and enqueue it
-	back into the MLFQ. If it is a termination, then the running PCB will be marked 
+	an IO Trap, then it will put the running PCB into the Blocked queue. If it is a termination, then the running PCB will be marked 
 	as such and, if its term_count is greater than its maximum terminate amount, will 
 	be enqueued into the Killed queue. Then, if the Killed queue is at or above its own 
 	TOTAL_TERMINATED size, it will be emptied. It then calls the dispatcher to get the 
@@ -460,89 +605,63 @@ void scheduling (int interrupt_code, Scheduler theScheduler) {
 	//Mutex currMutex;
 	int temp = 0, wentIn = 0;
 	PCB tmp = NULL;
+	
+	if (!q_is_empty(theScheduler->created)) { //PCBs admission control held back
+		admitCreated(theScheduler);
+	}
+	drainInbox(theScheduler);
 	if (interrupt_code == IS_TIMER) {
-		printf("Entering Timer Interrupt\r\n");
+		trace("Entering Timer Interrupt\r\n");
 		
 		if (theScheduler->interrupted) {
 			wentIn = 1;
-			printf("\r\nEnqueueing into priority %d of MLFQ\r\n", (theScheduler->interrupted->priority+1)%NUM_PRIORITIES);
+			PCB_assign_state(theScheduler->interrupted, STATE_READY);
+			policy_on_tick(theScheduler->ready, theScheduler->interrupted);
+			trace("\r\nEnqueueing into priority %d of MLFQ\r\n", theScheduler->interrupted->priority);
 			toStringPCB(theScheduler->interrupted, 0);
 			
-			theScheduler->interrupted->state = STATE_READY;
-			theScheduler->interrupted->priority = (theScheduler->interrupted->priority + 1) % NUM_PRIORITIES;
 			tmp = theScheduler->interrupted;
-			pq_enqueue(theScheduler->ready, theScheduler->interrupted);
+			enqueueReady(theScheduler, theScheduler->interrupted);
 			if (tmp == NULL) {
-				printf("tmp NULL after pq_enqueue!\n");
+				trace("tmp NULL after policy_enqueue!\n");
 				exit(0);
 			}
 			theScheduler->interrupted = NULL;
 		} else {
-			printf("\r\nEnqueueing into MLFQ\r\n");
-			printf("IDLE\r\n");
+			trace("\r\nEnqueueing into MLFQ\r\n");
+			trace("IDLE\r\n");
 		}
-		printf("Exiting Timer Interrupt\r\n");
+		trace("Exiting Timer Interrupt\r\n");
 	}
 	else if (interrupt_code == IS_IO_TRAP)
 	{
 		// Do I/O trap handling
-		printf("Entering IO Trap\r\n");
-		theScheduler->interrupted->state = STATE_WAIT;
+		trace("Entering IO Trap\r\n");
+		PCB_assign_state(theScheduler->interrupted, STATE_WAIT);
+		policy_on_block(theScheduler->ready, theScheduler->interrupted);
 		
-		pthread_mutex_lock(&printMutex);
-			printf("\r\nEnqueueing into Blocked queue\r\n");
+		lockMutex(PRINT_LOCK);
+			trace("\r\nEnqueueing into Blocked queue\r\n");
 			toStringPCB(theScheduler->interrupted, 0);
-		pthread_mutex_unlock(&printMutex);
-		
-		q_enqueue(theScheduler->blocked, theScheduler->interrupted);
-		theScheduler->interrupted = NULL;
-		pthread_mutex_lock(&printMutex);
-			printSchedulerState(theScheduler);
-		pthread_mutex_unlock(&printMutex);
-		pthread_mutex_lock(&interruptMutex);
-			hasBlockedPCB = 1;
-			printf("\nSending signal to ioInterrupt\n\n");
-			pthread_cond_signal(&interruptCondVar);
-		pthread_mutex_unlock(&interruptMutex);
-		printf("Exiting IO Trap\r\n");
-	}
-	else if (interrupt_code == IS_IO_INTERRUPT)
-	{
-		printf("Entering IO Interrupt\r\n");
-		// Do I/O interrupt handling
-		printf("\r\nEnqueueing into MLFQ from Blocked queue\r\n");
-		toStringPCB(q_peek(theScheduler->blocked), 0);
-		PCB theBlocked = q_dequeue(theScheduler->blocked);
-		theBlocked->state = STATE_READY;
-		pq_enqueue(theScheduler->ready, theBlocked);
-		if (theScheduler->interrupted != NULL)
-		{
-			theScheduler->running = theScheduler->interrupted;
-			theScheduler->running->state = STATE_RUNNING;
+		unlockMutex(PRINT_LOCK);
 		
-			sysstack = theScheduler->running->context->pc;
-		}
+		moveToQueue(theScheduler->blocked, theScheduler->interrupted, LOC_BLOCKED);
+		scheduleIOCompletion(theScheduler, theScheduler->interrupted);
 		theScheduler->interrupted = NULL;
-		pthread_mutex_lock(&printMutex);
+		lockMutex(PRINT_LOCK);
 			printSchedulerState(theScheduler);
-		pthread_mutex_unlock(&printMutex);
-		printf("Exiting IO Interrupt\r\n");
+		unlockMutex(PRINT_LOCK);
+		trace("Exiting IO Trap\r\n");
 	}
-	
 	if (theScheduler->interrupted != NULL && theScheduler->interrupted->state == STATE_HALT) {
-		printf("\nInserting P%d into the Killed queue\n\n", theScheduler->interrupted->pid);
+		trace("\nInserting P%d into the Killed queue\n\n", theScheduler->interrupted->pid);
 		handleKilledQueueInsertion(theScheduler);
 	}
 	
 	if (theScheduler->killed->size >= TOTAL_TERMINATED) {
 		handleKilledQueueEmptying(theScheduler);
 	}
-	// I/O interrupt does not require putting a new process
-	// into the running state, so we ignore this.
-	if(interrupt_code != IS_IO_INTERRUPT) 
-	{
-		dispatcher(theScheduler);
-	}
+	dispatcher(theScheduler);
 }
 
 
@@ -551,22 +670,41 @@ void scheduling (int interrupt_code, Scheduler theScheduler) {
 	running state of the Scheduler.
 */
 void dispatcher (Scheduler theScheduler) {
-	if (pq_peek(theScheduler->ready) != NULL && pq_peek(theScheduler->ready)->state != STATE_HALT) {
-		theScheduler->running = pq_dequeue(theScheduler->ready);
+	if (policy_peek(theScheduler->ready) != NULL && policy_peek(theScheduler->ready)->state != STATE_HALT) {
+		theScheduler->running = policy_pick_next(theScheduler->ready);
+		theScheduler->running->fault_page = -1; //a fault it was preempted before trapping on is retried
+		dispatchCount++;
+		latencyTotal += iteration - theScheduler->running->ready_at;
+		dispatchLatency += ((double) (iteration - theScheduler->running->ready_at) - dispatchLatency) / LATENCY_WEIGHT;
 		
-		pthread_mutex_lock(&printMutex);
-			printf("\r\nDequeueing to run\r\n");
+		lockMutex(PRINT_LOCK);
+			trace("\r\nDequeueing to run\r\n");
 			toStringPCB(theScheduler->running, 0);
-		pthread_mutex_unlock(&printMutex);
-		theScheduler->running->state = STATE_RUNNING;
+		unlockMutex(PRINT_LOCK);
+		PCB_assign_state(theScheduler->running, STATE_RUNNING);
 	} else if (theScheduler->running && theScheduler->running->state == STATE_HALT) { 
-		printf("\r\nNothing to dequeue for running, MLFQ is empty.\r\n");
+		trace("\r\nNothing to dequeue for running, MLFQ is empty.\r\n");
 		theScheduler->running = NULL; //do this so it doesn't continue to enqueue into the killed list an already enqueued PCB
 		theScheduler->interrupted = NULL;
 	} else {
 		theScheduler->running = NULL; //do this so it doesn't continue to enqueue into the killed list an already enqueued PCB
 		theScheduler->interrupted = NULL;
 	}
+	armQuantum(theScheduler);
+}
+
+
+/*
+	Puts the running PCB back in the ready set and dispatches the next one. Used when
+	it has to wait on a Mutex or condition variable, which doesn't block it and isn't
+	the end of its quantum, so the policy isn't told about a tick. The dispatcher 
+	gives the next PCB its own quantum. Must be called with the schedulerMutex held.
+*/
+void yieldRunning (Scheduler theScheduler) {
+	PCB_assign_state(theScheduler->running, STATE_READY);
+	enqueueReady(theScheduler, theScheduler->running);
+	theScheduler->running = NULL;
+	dispatcher(theScheduler);
 }
 
 
@@ -575,7 +713,7 @@ void dispatcher (Scheduler theScheduler) {
 */
 void pseudoIRET (Scheduler theScheduler) {
 	if (theScheduler->running != NULL) {
-		theScheduler->running->context->pc = sysstack;
+		PCB_set_pc(theScheduler->running, sysstack);
 	}
 }
 
@@ -590,8 +728,14 @@ Scheduler schedulerConstructor () {
 	newScheduler->killed = q_create();
 	newScheduler->blocked = q_create();
 	newScheduler->killedMutexes = q_create();
+	newScheduler->reclaimed = q_create();
+	newScheduler->reclaimedMutexes = q_create();
 	newScheduler->mutexes = create_mutx_map();
-	newScheduler->ready = pq_create();
+	newScheduler->ready = policy_create(policyName);
+	newScheduler->inbox = lfq_create(INBOX_CAPACITY);
+	newScheduler->ioDone = lfq_create(INBOX_CAPACITY);
+	newScheduler->timers = tw_create(0);
+	newScheduler->quantumEvent = NULL;
 	newScheduler->running = NULL;
 	newScheduler->interrupted = NULL;
 	newScheduler->isNew = 1;
@@ -615,9 +759,14 @@ void schedulerDeconstructor (Scheduler theScheduler) {
 
 	if (theScheduler) {
 		
+		if (theScheduler->ready && theScheduler->inbox) {
+			drainInbox(theScheduler);
+		}
+		toStringPCBTable();
+		
 		if (theScheduler->ready) {
 			remainingProcesses = countRemainingProcesses(theScheduler->ready);
-			pq_destroy(theScheduler->ready);
+			policy_destroy(theScheduler->ready);
 		}
 		
 		if (theScheduler->created) {
@@ -640,10 +789,31 @@ void schedulerDeconstructor (Scheduler theScheduler) {
 			q_destroy_m(theScheduler->killedMutexes);
 		}
 		
+		if (theScheduler->reclaimed) { //anything handed over after the reclaimer stopped
+			q_destroy(theScheduler->reclaimed);
+		}
+		
+		if (theScheduler->reclaimedMutexes) {
+			q_destroy_m(theScheduler->reclaimedMutexes);
+		}
+		
 		if (theScheduler->mutexes) {
 			mutex_map_destroy(theScheduler->mutexes);
 		}
 		
+		if (theScheduler->timers) {
+			tw_destroy(theScheduler->timers);
+		}
+		
+		if (theScheduler->inbox) {
+			lfq_destroy(theScheduler->inbox);
+		}
+		
+		if (theScheduler->ioDone) {
+			remainingInBlocked += lfq_size(theScheduler->ioDone);
+			lfq_destroy(theScheduler->ioDone);
+		}
+		
 		if (theScheduler->running) {
 			PCB_destroy(theScheduler->running);
 		}
@@ -657,42 +827,618 @@ void schedulerDeconstructor (Scheduler theScheduler) {
 		free (theScheduler);
 	}
 	
+	if (!shutdownReport) {
+		return;
+	}
 	displayRoleCountResults();
-	printf("Number of total iterations in osLoop: %d\r\n", iteration);
-	printf("Number of remaining PCBs in MLFQ: %d\r\n", remainingProcesses);
-	printf("Number of remaining PCBS in created: %d\r\n", remainingInCreated);
-	printf("Number of remaining PCBS in blocked: %d\r\n", remainingInBlocked);
-	printf("Number of remaining PCBS in killed: %d\r\n", remainingInKilled);
-	printf("Number of remaining Mutexes in killedMutexes: %d\r\n", remainingMutexesInKilled);
+	fprintf(shutdownReport, "Number of total iterations in osLoop: %d\r\n", iteration);
+	fprintf(shutdownReport, "Number of remaining PCBs in MLFQ: %d\r\n", remainingProcesses);
+	fprintf(shutdownReport, "Number of remaining PCBS in created: %d\r\n", remainingInCreated);
+	fprintf(shutdownReport, "Number of remaining PCBS in blocked: %d\r\n", remainingInBlocked);
+	fprintf(shutdownReport, "Number of remaining PCBS in killed: %d\r\n", remainingInKilled);
+	fprintf(shutdownReport, "Number of remaining Mutexes in killedMutexes: %d\r\n", remainingMutexesInKilled);
 	if (deadlockDetected) {
-		printf("Deadlock detected in this run!\r\n");
-		printf("Deadlock occurence: %d\r\n", deadlockCount);
+		fprintf(shutdownReport, "Deadlock detected in this run!\r\n");
+		fprintf(shutdownReport, "Deadlock occurence: %d\r\n", deadlockCount);
 	} else {
-		printf("No deadlock detected in this run!\r\n");
+		fprintf(shutdownReport, "No deadlock detected in this run!\r\n");
 	}
 }
 
 
 /*
-	Displays the number of PCBs created for each type.
+	Displays the number of PCBs created for each type on shutdownReport.
 */
 void displayRoleCountResults() {
-	printf("\r\nTOTAL ROLE TYPES: %d\r\n\r\n", (compCount + ioCount + pairCount + sharedCount));
+	fprintf(shutdownReport, "\r\nTOTAL ROLE TYPES: %d\r\n\r\n", (compCount + ioCount + pairCount + sharedCount));
+	
+	fprintf(shutdownReport, "COMP: \t%d\r\n", compCount);
+	fprintf(shutdownReport, "IO: \t%d\r\n", ioCount);
+	fprintf(shutdownReport, "PAIR: \t%d\r\n", pairCount);
+	fprintf(shutdownReport, "SHARED: %d\r\n", sharedCount);
+}
+
+
+/*
+	Attaches a fresh lock profile to each of the simulator's mutexes. Called at the 
+	start of osLoop, before anything takes them.
+*/
+void initLockProfiles () {
+	lp_init(&lockProfiles[SCHEDULER_LOCK], "scheduler", &schedulerMutex);
+	lp_init(&lockProfiles[RAND_LOCK], "rand", &randMutex);
+	lp_init(&lockProfiles[PRINT_LOCK], "print", &printMutex);
+	lp_init(&lockProfiles[TOTAL_PROCESSES_LOCK], "totalProcesses", &totalProcessesMutex);
+	lp_init(&lockProfiles[TRAP_LOCK], "trap", &trapMutex);
+	lp_init(&lockProfiles[INTERRUPT_LOCK], "interrupt", &interruptMutex);
+	lp_init(&lockProfiles[RECLAIM_LOCK], "reclaim", &reclaimMutex);
+}
+
+
+/*
+	Runs the simulator as a benchmark: a fixed seed, a fixed number of iterations, 
+	and one CSV line of throughput numbers at the end. The arguments are the same as
+	main's, "<policy> bench [iterations] [seed] [workload]". The trace is turned off so
+	it doesn't dominate the timing, build with -DSIM_NO_LOCK_PROFILE to drop the lock 
+	timing too. The reports and the lock profile go to stderr.
+*/
+int runBenchmark (int argc, char * argv[]) {
+	bench_sim_result_s result = {"pthreads", policyName, BENCH_SIM_SEED, 0, 0, 0, 0, 0};
+	double start = 0;
+	
+	maxIterations = BENCH_SIM_ITERATIONS;
+	if (argc > 3 && atoi(argv[3]) > 0) {
+		maxIterations = atoi(argv[3]);
+	}
+	if (argc > 4) {
+		result.seed = (unsigned int) strtoul(argv[4], NULL, 10);
+	}
+	if (argc > 5) {
+		workloadPath = argv[5];
+	}
+	sim_srand(result.seed);
+	shutdownReport = stderr; //keeps stdout to the one CSV line
+	traceEnabled = 0;
+	
+	start = bench_now();
+	osLoop();
+	result.wall_ns = bench_now() - start;
+	
+	result.iterations = iteration;
+	result.dispatches = dispatchCount;
+	result.schedulerLocks = lockProfiles[SCHEDULER_LOCK].acquisitions;
+	result.peakRSS = bench_peak_rss();
+	bench_print_sim_header(stdout);
+	bench_print_sim(stdout, &result);
+	
+	return 0;
+}
+
+
+/*
+	Forks off one run of the scaling benchmark with the given number of ioInterrupt 
+	threads and simulated I/O devices, so it starts from a fresh simulator, and reads
+	its point back through a pipe. Returns 1 if the run finished.
+*/
+int runScalePoint (int threads, unsigned int seed, bench_scale_point_s * point) {
+	pid_t child = 0;
+	double start = 0;
+	int fds[2], finished = 0;
+	
+	if (pipe(fds)) {
+		perror("pipe");
+		return 0;
+	}
+	child = fork();
+	if (child < 0) {
+		perror("fork");
+		close(fds[0]);
+		close(fds[1]);
+		return 0;
+	}
+	if (child == 0) {
+		close(fds[0]);
+		freopen("/dev/null", "w", stdout); //the simulator's own output isn't part of the report
+		traceEnabled = 0;
+		memset(point, 0, sizeof(*point));
+		deviceCount = threads;
+		interruptThreadCount = threads;
+		benchmarking = 1;
+		sim_srand(seed);
+		
+		start = bench_now();
+		osLoop();
+		point->sim.wall_ns = bench_now() - start;
+		
+		point->threads = threads;
+		point->devices = deviceCount;
+		point->sim.seed = seed;
+		point->sim.iterations = iteration;
+		point->sim.dispatches = dispatchCount;
+		point->sim.schedulerLocks = lockProfiles[SCHEDULER_LOCK].acquisitions;
+		point->sim.peakRSS = bench_peak_rss();
+		point->ioCompletions = ioCompletionCount;
+		point->schedulerContended = lockProfiles[SCHEDULER_LOCK].contended;
+		point->wakeP50 = bench_percentile(wakeSamples, wakeSampleCount, 0.50);
+		point->wakeP99 = bench_percentile(wakeSamples, wakeSampleCount, 0.99);
+		write(fds[1], point, sizeof(*point));
+		close(fds[1]);
+		_exit(0);
+	}
+	
+	close(fds[1]);
+	if (read(fds[0], point, sizeof(*point)) == sizeof(*point)) {
+		point->sim.simulator = "pthreads"; //the child's pointers mean nothing here
+		point->sim.policy = policyName;
+		finished = 1;
+	}
+	close(fds[0]);
+	waitpid(child, NULL, 0);
+	
+	return finished;
+}
+
+
+/*
+	Runs the benchmark for every thread count from 1 to maxThreads (the number of
+	online cores by default), with as many simulated I/O devices as ioInterrupt threads.
+	The arguments are "<policy> scale [iterations] [seed] [maxThreads] [reps]". Each 
+	thread count gets BENCH_SCALE_WARMUP runs that are thrown away and then reps 
+	measured ones, each in a fresh simulator, since a single run is too noisy to 
+	compare. Prints one CSV row per measured run and a summary of the median wall 
+	time per I/O completion with its spread, and where the throughput stops scaling.
+*/
+int runScalingBenchmark (int argc, char * argv[]) {
+	bench_scale_spread_s spreads[MAX_DEVICES];
+	bench_scale_point_s point;
+	bench_config_s config;
+	unsigned int seed = BENCH_SIM_SEED;
+	int maxThreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+	int count = 0, measured = 0;
+	double * samples = NULL;
+	
+	bench_config_init(&config, 0, NULL, stdout);
+	config.warmup = BENCH_SCALE_WARMUP;
+	config.reps = BENCH_SCALE_REPS;
+	maxIterations = BENCH_SIM_ITERATIONS;
+	if (argc > 3 && atoi(argv[3]) > 0) {
+		maxIterations = atoi(argv[3]);
+	}
+	if (argc > 4) {
+		seed = (unsigned int) strtoul(argv[4], NULL, 10);
+	}
+	if (argc > 5 && atoi(argv[5]) > 0) {
+		maxThreads = atoi(argv[5]);
+	}
+	if (argc > 6 && atoi(argv[6]) > 0) {
+		config.reps = atoi(argv[6]);
+	}
+	if (maxThreads < 1) {
+		maxThreads = 1;
+	} else if (maxThreads > MAX_DEVICES) {
+		maxThreads = MAX_DEVICES;
+	}
+	samples = (double *) malloc(sizeof(double) * config.reps);
+	if (samples == NULL) {
+		return 1;
+	}
 	
-	printf("COMP: \t%d\r\n", compCount);
-	printf("IO: \t%d\r\n", ioCount);
-	printf("PAIR: \t%d\r\n", pairCount);
-	printf("SHARED: %d\r\n", sharedCount);
+	bench_print_scale_header(config.out);
+	for (int threads = 1; threads <= maxThreads; threads++) {
+		measured = 0;
+		for (int r = 0; r < config.warmup + config.reps; r++) {
+			if (!runScalePoint(threads, seed, &point)) {
+				fprintf(stderr, "run with %d threads failed\r\n", threads);
+				continue;
+			}
+			if (r < config.warmup) {
+				continue;
+			}
+			point.rep = r - config.warmup;
+			bench_print_scale(config.out, &point);
+			if (point.ioCompletions) {
+				samples[measured++] = point.sim.wall_ns / point.ioCompletions;
+			}
+		}
+		if (measured) {
+			spreads[count].threads = threads;
+			spreads[count].nsPerIO = bench_summarize("scale", policyName, 1, samples, measured);
+			count++;
+		}
+	}
+	bench_print_scale_summary(config.out, spreads, count);
+	free(samples);
+	
+	return 0;
 }
 
 
 /*
-	The main function that kicks off the program
+	Reads a comma separated list of name=value pairs into params. The names are aging
+	(the boost interval), quantum (percent of the policy's quantum), deadlock, io and
+	arrival (the chances out of their domains), and for the virtual memory frames (0 
+	turns it off), tlb (entries), replace (fifo, clock, lru or ws), disk (the fault 
+	latency) and window (the ws policy's window), for the physical memory memory
+	(units, 0 turns it off) and alloc (buddy or segregated), and for admission 
+	control ready, blocked and latency (the limits it holds new PCBs back at, 0 for 
+	none) and backlog (how many it holds). "base" changes nothing. Returns 0 and 
+	says why if the spec is bad.
 */
-void main () {
+int parseSimParams (const char * spec, sim_params_s * params) {
+	char buffer[BENCH_VARIANT_LENGTH];
+	char * save = NULL, * pair = NULL, * value = NULL;
+	long number = 0;
+	
+	if (strlen(spec) >= sizeof(buffer)) {
+		fprintf(stderr, "parameters \"%s\" are too long\r\n", spec);
+		return 0;
+	}
+	strcpy(buffer, spec);
+	for (pair = strtok_r(buffer, ",", &save); pair; pair = strtok_r(NULL, ",", &save)) {
+		if (!strcmp(pair, "base")) {
+			continue;
+		}
+		value = strchr(pair, '=');
+		if (value == NULL) {
+			fprintf(stderr, "expected name=value, got \"%s\"\r\n", pair);
+			return 0;
+		}
+		*value++ = '\0';
+		number = strtol(value, NULL, 10);
+		if (!strcmp(pair, "aging") && number > 0) {
+			params->agingInterval = number;
+		} else if (!strcmp(pair, "quantum") && number > 0) {
+			params->quantumPercent = number;
+		} else if (!strcmp(pair, "deadlock") && number >= 0 && number <= DEADLOCK_CHANCE_DOMAIN) {
+			params->deadlockChance = number;
+		} else if (!strcmp(pair, "io") && number >= 0 && number <= IO_INT_CHANCE_DOMAIN) {
+			params->ioChance = number;
+		} else if (!strcmp(pair, "arrival") && number >= 0 && number <= MAKE_PCB_CHANCE_DOMAIN) {
+			params->arrivalChance = number;
+		} else if (!strcmp(pair, "frames") && number >= 0 && number <= VM_MAX_FRAMES) {
+			params->frames = number;
+		} else if (!strcmp(pair, "tlb") && number > 0 && number <= VM_MAX_TLB) {
+			params->tlbEntries = number;
+		} else if (!strcmp(pair, "replace") && vm_policy_by_name(value) >= 0) {
+			params->replacement = vm_policy_by_name(value);
+		} else if (!strcmp(pair, "disk") && number > 0) {
+			params->diskLatency = number;
+		} else if (!strcmp(pair, "window") && number > 0) {
+			params->wsWindow = number;
+		} else if (!strcmp(pair, "memory") && number >= 0 && number <= PM_MAX_UNITS) {
+			params->memoryUnits = number;
+		} else if (!strcmp(pair, "alloc") && pm_policy_by_name(value) >= 0) {
+			params->allocator = pm_policy_by_name(value);
+		} else if (!strcmp(pair, "ready") && number >= 0) {
+			params->maxReady = number;
+		} else if (!strcmp(pair, "blocked") && number >= 0) {
+			params->maxBlocked = number;
+		} else if (!strcmp(pair, "latency") && number >= 0) {
+			params->maxLatency = number;
+		} else if (!strcmp(pair, "backlog") && number >= 2) { //room for a pair
+			params->backlog = number;
+		} else {
+			fprintf(stderr, "unknown parameter or bad value \"%s=%s\"\r\n", pair, value);
+			return 0;
+		}
+	}
+	
+	return 1;
+}
+
+
+/*
+	Makes the virtual memory match simParams. One of a different size replaces it, 
+	which leaves every page unloaded, and frames of 0 removes it, so a what-if child 
+	can start paging from the forked state. The policy, window and disk latency 
+	apply from the next fault on. The physical memory is replaced the same way when 
+	its size or allocator changes, with the live PCBs' footprints moved into the new
+	one.
+*/
+void applyMemoryParams () {
+	PhysMem old = physMem;
+	
+	if (physMem == NULL || physMem->units != simParams.memoryUnits || physMem->policy != simParams.allocator) {
+		physMem = simParams.memoryUnits ? pm_create(simParams.allocator, simParams.memoryUnits) : NULL;
+		if (simParams.memoryUnits && physMem == NULL) {
+			fprintf(stderr, "couldn't create %u units of physical memory\r\n", simParams.memoryUnits);
+			exit(1);
+		}
+		if (physMem != old) {
+			PCB_use_memory(physMem);
+			pm_destroy(old);
+		}
+	}
+	if (vm && (vm->frameCount != simParams.frames || vm->tlbSize != simParams.tlbEntries)) {
+		vm_destroy(vm);
+		vm = NULL;
+	}
+	if (vm == NULL && simParams.frames) {
+		vm = vm_create(simParams.frames, simParams.tlbEntries);
+		if (vm == NULL) {
+			fprintf(stderr, "couldn't create %u frames of virtual memory\r\n", simParams.frames);
+			exit(1);
+		}
+	}
+	if (vm) {
+		vm->policy = simParams.replacement;
+		vm->window = simParams.wsWindow;
+	}
+}
+
+
+/*
+	Runs the simulator up to an iteration, then forks it into one child per parameter
+	set and runs every child on from that identical state, so the parameters can be 
+	compared without the runs drifting apart first. The arguments are 
+	"<policy> whatif <at> <iterations> <seed> <params> [params...]", see 
+	parseSimParams for the params. The children share the parent's memory copy-on-write,
+	so only what a child changes gets copied. Each trace goes to its own WHATIF_TRACE
+	file, and one CSV row per child is printed once they have all finished.
+*/
+int runWhatIf (int argc, char * argv[]) {
+	bench_whatif_s result;
+	vm_stats_s memory;
+	unsigned int seed = BENCH_SIM_SEED;
+	sim_params_s params;
+	FILE * report = NULL;
+	
+	if (argc < 7) {
+		fprintf(stderr, "usage: %s <policy> whatif <at> <iterations> <seed> <params> [params...]\r\n", argv[0]);
+		return 1;
+	}
+	whatIfAt = (unsigned int) strtoul(argv[3], NULL, 10);
+	maxIterations = (unsigned int) strtoul(argv[4], NULL, 10);
+	seed = (unsigned int) strtoul(argv[5], NULL, 10);
+	for (int i = 6; i < argc && whatIfCount < MAX_WHATIF_CHILDREN; i++) {
+		params = simParams;
+		if (!parseSimParams(argv[i], &params)) {
+			return 1;
+		}
+		whatIfSpecs[whatIfCount++] = argv[i];
+	}
+	if (whatIfAt >= maxIterations) {
+		fprintf(stderr, "the fork has to come before the last iteration\r\n");
+		return 1;
+	}
+	
+	report = fdopen(dup(STDOUT_FILENO), "w"); //stdout becomes the trace
+	freopen(WHATIF_TRACE ".parent.log", "w", stdout);
+	setvbuf(stdout, NULL, _IOFBF, BUFSIZ);
+	sim_srand(seed);
+	osLoop();
+	fflush(stdout);
+	
+	if (whatIfIndex >= 0) { //a child finishing, the parent never gets here
+		memset(&result, 0, sizeof(result));
+		strcpy(result.variant, whatIfSpecs[whatIfIndex]);
+		result.forkedAt = whatIfAt;
+		result.sim.seed = seed;
+		result.sim.iterations = iteration - whatIfAt;
+		result.sim.wall_ns = bench_now() - whatIfStart;
+		readWhatIfCounters(&result);
+		result.sim.dispatches -= whatIfBase.sim.dispatches;
+		result.ioCompletions -= whatIfBase.ioCompletions;
+		result.created -= whatIfBase.created;
+		result.deadlocks -= whatIfBase.deadlocks;
+		result.admissionStalls -= whatIfBase.admissionStalls;
+		result.live = pcbTable ? pcbTable->live : 0;
+		memory = memoryStats;
+		memory.references -= whatIfMemoryBase.references;
+		memory.tlbHits -= whatIfMemoryBase.tlbHits;
+		memory.faults -= whatIfMemoryBase.faults;
+		memory.evictions -= whatIfMemoryBase.evictions;
+		result.pageFaults = memory.faults;
+		result.faultRate = vm_fault_rate(&memory);
+		result.accessNs = vm_access_time(&memory);
+		result.fragmentation = endFragmentation;
+		result.deferred -= whatIfBase.deferred;
+		result.rejected -= whatIfBase.rejected;
+		result.dispatchLatency = result.sim.dispatches ? (double) (latencyTotal - whatIfLatencyBase) / result.sim.dispatches : 0;
+		write(whatIfFds[whatIfIndex], &result, sizeof(result));
+		_exit(0);
+	}
+	
+	bench_print_whatif_header(report);
+	for (int i = 0; i < whatIfCount; i++) {
+		if (read(whatIfFds[i], &result, sizeof(result)) == sizeof(result)) {
+			result.sim.policy = policyName; //the child's pointers mean nothing here
+			bench_print_whatif(report, &result);
+		} else {
+			fprintf(stderr, "what-if child \"%s\" failed\r\n", whatIfSpecs[i]);
+		}
+		close(whatIfFds[i]);
+		waitpid(whatIfPids[i], NULL, 0);
+	}
+	fclose(report);
+	
+	return 0;
+}
+
+
+/*
+	Reads the running totals a what-if child reports. Every child inherits the totals
+	of the run they shared up to the fork, so each child reads them once as it is 
+	forked and reports only what it added since.
+*/
+void readWhatIfCounters (bench_whatif_s * counters) {
+	counters->sim.dispatches = dispatchCount;
+	counters->ioCompletions = ioCompletionCount;
+	counters->created = totalProcesses;
+	counters->deadlocks = deadlockCount;
+	counters->admissionStalls = admissionStalls;
+	counters->deferred = deferredCount;
+	counters->rejected = rejectedCount;
+}
+
+
+/*
+	Forks the what-if children. Called on osLoop's thread after waitForQuiescence.
+	Every simulator mutex is held across the forks, so no child starts with one 
+	locked by a thread it doesn't have. In a child the mutexes are released, the 
+	condition variables the parent's helper threads were sleeping on are reset, the
+	child's parameters are applied and its trace is opened, and 1 is returned so 
+	osLoop starts new helper threads. The parent gets 0 once every child is forked.
+*/
+int forkWhatIfs () {
+	pid_t child = 0;
+	int fds[2], forked = 0;
+	
+	lockScheduler();
+	lockMutex(RAND_LOCK);
+	lockMutex(PRINT_LOCK);
+	lockMutex(TOTAL_PROCESSES_LOCK);
+	lockMutex(TRAP_LOCK);
+	lockMutex(INTERRUPT_LOCK);
+	lockMutex(RECLAIM_LOCK);
+	fflush(stdout);
+	for (int i = 0; i < whatIfCount; i++) {
+		if (pipe(fds)) {
+			perror("pipe");
+			break;
+		}
+		child = fork();
+		if (child < 0) {
+			perror("fork");
+			close(fds[0]);
+			close(fds[1]);
+			break;
+		}
+		if (child == 0) {
+			char tracePath[64];
+			
+			for (int j = 0; j < i; j++) {
+				close(whatIfFds[j]);
+			}
+			close(fds[0]);
+			whatIfFds[i] = fds[1];
+			whatIfIndex = i;
+			whatIfStart = bench_now();
+			readWhatIfCounters(&whatIfBase);
+			whatIfLatencyBase = latencyTotal;
+			parseSimParams(whatIfSpecs[i], &simParams);
+			applyMemoryParams();
+			if (vm) { //a new size starts the counters again
+				whatIfMemoryBase = vm->stats;
+			}
+			if (workload && !wl_reopen(workload)) { //the parent's file position is shared
+				fprintf(stderr, "what-if child %d couldn't reopen the workload\r\n", i);
+				_exit(1);
+			}
+			snprintf(tracePath, sizeof(tracePath), WHATIF_TRACE ".%d.log", i);
+			freopen(tracePath, "w", stdout);
+			setvbuf(stdout, NULL, _IOFBF, BUFSIZ);
+			shutdownReport = stdout; //the child's reports end its trace
+			trace("What-if child %d forked at iteration %u with \"%s\"\r\n", i, iteration, whatIfSpecs[i]);
+			
+			pthread_cond_init(&trapCondVar, NULL);
+			pthread_cond_init(&interruptCondVar, NULL);
+			pthread_cond_init(&timerCondVar, NULL);
+			pthread_cond_init(&reclaimCondVar, NULL);
+			unlockMutex(RECLAIM_LOCK);
+			unlockMutex(INTERRUPT_LOCK);
+			unlockMutex(TRAP_LOCK);
+			unlockMutex(TOTAL_PROCESSES_LOCK);
+			unlockMutex(PRINT_LOCK);
+			unlockMutex(RAND_LOCK);
+			unlockScheduler();
+			return 1;
+		}
+		close(fds[1]);
+		whatIfFds[i] = fds[0];
+		whatIfPids[i] = child;
+		forked++;
+	}
+	whatIfCount = forked; //the parent only waits for the ones it got
+	unlockMutex(RECLAIM_LOCK);
+	unlockMutex(INTERRUPT_LOCK);
+	unlockMutex(TRAP_LOCK);
+	unlockMutex(TOTAL_PROCESSES_LOCK);
+	unlockMutex(PRINT_LOCK);
+	unlockMutex(RAND_LOCK);
+	unlockScheduler();
+	
+	return 0;
+}
+
+
+/*
+	The main function that kicks off the program. The first argument, if given, is
+	the name of the scheduling policy to run. "<policy> bench [iterations] [seed]" 
+	runs it as a benchmark instead, see runBenchmark, and "<policy> scale ..." runs
+	the thread scaling benchmark, see runScalingBenchmark. "<policy> whatif ..." forks
+	a run into children with different parameters, see runWhatIf.
+	"<policy> checkpoint <file> <at> [iterations] [seed] [workload]" saves the whole simulator to 
+	file when iteration at is reached and keeps running, and 
+	"<policy> restore <file> [iterations] [saveTo at]" resumes from such a file, 
+	optionally saving again. "<policy> workload <file> [iterations] [seed]" replays a
+	workload file instead of making random PCBs, see workload.h. 
+	"<policy> params <params> [iterations] [seed] [saveTo at]" runs with the 
+	parameters changed, see parseSimParams, which is how the virtual memory is turned
+	on, optionally saving a checkpoint.
+*/
+void main (int argc, char * argv[]) {
 	
 	setvbuf(stdout, NULL, _IONBF, 0);
-	srand((unsigned) time(&t));
+	if (argc > 2 && !strcmp(argv[2], "bench")) {
+		policyName = argv[1];
+		runBenchmark(argc, argv);
+		pthread_exit(NULL);
+	}
+	if (argc > 2 && !strcmp(argv[2], "scale")) {
+		policyName = argv[1];
+		runScalingBenchmark(argc, argv);
+		pthread_exit(NULL);
+	}
+	if (argc > 2 && !strcmp(argv[2], "whatif")) {
+		policyName = argv[1];
+		runWhatIf(argc, argv);
+		pthread_exit(NULL);
+	}
+	sim_srand((unsigned) time(&t));
+	if (argc > 3 && !strcmp(argv[2], "workload")) { //<policy> workload <file> [iterations] [seed]
+		workloadPath = argv[3];
+		if (argc > 4 && atoi(argv[4]) > 0) {
+			maxIterations = atoi(argv[4]);
+		}
+		if (argc > 5) {
+			sim_srand((unsigned int) strtoul(argv[5], NULL, 10));
+		}
+	} else if (argc > 4 && !strcmp(argv[2], "checkpoint")) { //<policy> checkpoint <file> <at> [iterations] [seed] [workload]
+		checkpointPath = argv[3];
+		checkpointAt = (unsigned int) strtoul(argv[4], NULL, 10);
+		if (argc > 5 && atoi(argv[5]) > 0) {
+			maxIterations = atoi(argv[5]);
+		}
+		if (argc > 6) {
+			sim_srand((unsigned int) strtoul(argv[6], NULL, 10));
+		}
+		if (argc > 7) {
+			workloadPath = argv[7];
+		}
+	} else if (argc > 3 && !strcmp(argv[2], "params")) { //<policy> params <params> [iterations] [seed] [saveTo at]
+		if (!parseSimParams(argv[3], &simParams)) {
+			exit(1);
+		}
+		if (argc > 4 && atoi(argv[4]) > 0) {
+			maxIterations = atoi(argv[4]);
+		}
+		if (argc > 5) {
+			sim_srand((unsigned int) strtoul(argv[5], NULL, 10));
+		}
+		if (argc > 7) {
+			checkpointPath = argv[6];
+			checkpointAt = (unsigned int) strtoul(argv[7], NULL, 10);
+		}
+	} else if (argc > 3 && !strcmp(argv[2], "restore")) { //<policy> restore <file> [iterations] [saveTo at]
+		restorePath = argv[3];
+		if (argc > 4 && atoi(argv[4]) > 0) {
+			maxIterations = atoi(argv[4]);
+		}
+		if (argc > 6) {
+			checkpointPath = argv[5];
+			checkpointAt = (unsigned int) strtoul(argv[6], NULL, 10);
+		}
+	}
 	
 	compCount = 0;
 	ioCount = 0;
@@ -702,6 +1448,11 @@ void main () {
 	incrementPair = 0;
 	int i = 0;
 	
+	if (argc > 1) {
+		policyName = argv[1];
+	}
+	shutdownReport = stdout;
+	
 	osLoop();
 	
 	pthread_exit(NULL);
@@ -719,44 +1470,54 @@ void osLoop () {
 	void *status, *status2, *status3;
 	int temp = 0, makeMorePCBs = 0;
 	
+	initLockProfiles(); //makePCBList below already takes randMutex
 	totalProcesses = 0;
 	Scheduler scheduler = schedulerConstructor ();
 	currQuantumSize = 100;
+	applyMemoryParams(); //a restore applies the checkpoint's instead
 	
-	totalProcesses += makePCBList(scheduler);
+	if (restorePath) {
+		if (!restoreCheckpoint(scheduler, restorePath)) {
+			exit(1);
+		}
+	} else if (workloadPath) {
+		workload = wl_open(workloadPath);
+		if (workload == NULL) {
+			fprintf(stderr, "couldn't open workload %s\r\n", workloadPath);
+			exit(1);
+		}
+		totalProcesses += admitWorkload(scheduler);
+	} else {
+		totalProcesses += makePCBList(scheduler);
+	}
 	printSchedulerState(scheduler);
 	
 	scheduler->isNew = 0;
 	
-	pthread_attr_t attr;
 	pthread_mutex_init(&schedulerMutex, NULL);
-	pthread_mutex_init(&iterationMutex, NULL);
 	pthread_mutex_init(&randMutex, NULL);
 	pthread_mutex_init(&printMutex, NULL);
 	pthread_mutex_init(&totalProcessesMutex, NULL);
 	pthread_mutex_init(&trapMutex, NULL);
 	pthread_mutex_init(&interruptMutex, NULL);
+	pthread_mutex_init(&reclaimMutex, NULL);
 	
 	pthread_cond_init(&trapCondVar, NULL);
 	pthread_cond_init(&interruptCondVar, NULL);
+	pthread_cond_init(&timerCondVar, NULL);
+	pthread_cond_init(&reclaimCondVar, NULL);
+
+	//registers the recurring timed events, after this they re-arm themselves in fireTimers
+	if (!restorePath) { //a restored wheel already has them
+		armQuantum(scheduler);
+		tw_schedule(scheduler->timers, simParams.agingInterval, TIMER_AGING, NULL);
+		scheduleArrivals(scheduler);
+	}
 	
-	pthread_attr_init(&attr);
-	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
-	
-	pthread_t threads[3];
 	
-	int curr = 3;
+	pthread_t threads[3 + MAX_DEVICES];
 	
-	for (int i = 0; i < curr; i++) {
-		if (i == 0) {
-			pthread_create(&threads[i], &attr, timerInterrupt, (void *) scheduler);
-		} else if (i == 1) {
-			pthread_create(&threads[i], &attr, ioTrap, (void *) scheduler);
-		} else {
-			pthread_create(&threads[i], &attr, ioInterrupt, (void *) scheduler);
-		}
-	}
-	pthread_attr_destroy(&attr);
+	int curr = startHelperThreads(threads, scheduler);
 	
 	int isRunning = 0;
 	int isSwitched = 0;
@@ -765,22 +1526,37 @@ void osLoop () {
 
 	for(;;)
 	{		
-		pthread_mutex_lock(&schedulerMutex);
+		if (checkpointPath && iteration == checkpointAt) {
+			waitForQuiescence(scheduler);
+			lockScheduler();
+				saveCheckpoint(scheduler, checkpointPath);
+			unlockScheduler();
+		}
+		if (whatIfCount && iteration == whatIfAt) {
+			waitForQuiescence(scheduler);
+			if (forkWhatIfs()) {
+				curr = startHelperThreads(threads, scheduler); //only osLoop's thread survives the fork
+			} else {
+				break; //the parent just waits for the children
+			}
+		}
+		
+		lockScheduler();
 			if (scheduler && scheduler->running) {
 				isRunning = 1;
 			} else {
 				isRunning = 0;
 			}
-		pthread_mutex_unlock(&schedulerMutex);
+		unlockScheduler();
 		
 		if (isRunning) {
-			pthread_mutex_lock(&schedulerMutex);
+			lockScheduler();
 				if (scheduler && scheduler->running && (scheduler->running->role == PAIR || scheduler->running->role == SHARED)) {
-					isSwitched = useMutex(scheduler); //handles the locking/unlocking
+					isSwitched = useMutex(scheduler, runningTraps(scheduler)); //handles the locking/unlocking
 					
 					if (isSwitched) {
 						contextSwitchCount++;
-						printf("CONTEXT SWITCH COUNT: %d\r\n", contextSwitchCount);
+						trace("CONTEXT SWITCH COUNT: %d\r\n", contextSwitchCount);
 					}
 				
 					if (contextSwitchCount == 2) { //does the deadlock monitor if we perform a context switch 2 times.
@@ -791,166 +1567,675 @@ void osLoop () {
 						contextSwitchCount = 0;				
 					}
 				}
-			pthread_mutex_unlock(&schedulerMutex);
+			unlockScheduler();
 			
 			if (!isSwitched) { //if a context switch happened inside of useMutex, then we want to start over	
-				pthread_mutex_lock(&schedulerMutex);
+				lockScheduler();
 					if (scheduler && scheduler->running && !isIOTrapPos) {
-						scheduler->running->context->pc++;
-						if (scheduler->running->role == IO 
-							&& isTrapPC(scheduler->running->context->pc, scheduler->running)) {
-							pthread_mutex_lock(&trapMutex);
+						PCB_set_pc(scheduler->running, scheduler->running->context->pc + 1);
+						if ((vm && vm_reference(vm, scheduler->running)) //a page fault traps like I/O does
+							|| (scheduler->running->role == IO 
+							&& (runningTraps(scheduler) & (TRAP_IO_1 | TRAP_IO_2)))) {
+							lockMutex(TRAP_LOCK);
 								isIOTrapPos = 1;
+								trapPCB = scheduler->running;
 								pthread_cond_signal(&trapCondVar); //signals the ioTrap thread that an I/O position was reached
-							pthread_mutex_unlock(&trapMutex);
+							unlockMutex(TRAP_LOCK);
 						}
 					}
-				pthread_mutex_unlock(&schedulerMutex);
+				unlockScheduler();
 				
-				pthread_mutex_lock(&schedulerMutex);
+				lockScheduler();
 					if (scheduler && scheduler->running != NULL 
 							&& scheduler->running->term_count != scheduler->running->terminate)
 					{
 						if (scheduler->running->context->pc >= scheduler->running->max_pc) {
-							scheduler->running->context->pc = 0;
-							scheduler->running->term_count++; //increment term_count
+							PCB_set_pc(scheduler->running, 0);
+							PCB_set_term_count(scheduler->running, scheduler->running->term_count + 1);
 						}
 					}
-				pthread_mutex_unlock(&schedulerMutex);
+				unlockScheduler();
 				
-				pthread_mutex_lock(&schedulerMutex);
+				lockScheduler();
 					terminate(scheduler); //do termination
-				pthread_mutex_unlock(&schedulerMutex);
+				unlockScheduler();
 			}
 		}
 		
-		pthread_mutex_lock(&iterationMutex);
-			iteration++;			
-		pthread_mutex_unlock(&iterationMutex);
-		
-		
-		pthread_mutex_lock(&iterationMutex);
-			if(!(iteration % RESET_COUNT)) {
-				pthread_mutex_lock(&schedulerMutex); //resets the MLFQ
-					resetMLFQ(scheduler);
-				pthread_mutex_unlock(&schedulerMutex);
-			}
-		pthread_mutex_unlock(&iterationMutex);		
-		
-		pthread_mutex_lock(&randMutex);
-			temp = rand();
-		pthread_mutex_unlock(&randMutex);
+		atomic_fetch_add_explicit(&iteration, 1, memory_order_relaxed);
 		
-		pthread_mutex_lock(&schedulerMutex);
-			if (temp % MAKE_PCB_CHANCE_DOMAIN <= MAKE_PCB_CHANCE_PERCENTAGE) {
-				printf("\nMAKING NEW PCBS\r\n");
-				totalProcesses += makePCBList (scheduler); //makes new processes
+		lockScheduler();
+			policy_set_clock(scheduler->ready, iteration);
+			if (iteration >= tw_next_deadline(scheduler->timers)) { //the single check for every timed event
+				fireTimers(scheduler);
 			}
-		pthread_mutex_unlock(&schedulerMutex);
+		unlockScheduler();
 		
-
-		pthread_mutex_lock(&iterationMutex);
-			if (iteration >= MAX_ITERATION_TOTAL) {
-				printf("\n");
-				printf("MAX_ITERATION_TOTAL reached in main\r\n");
-				pthread_mutex_unlock(&iterationMutex);
-				break;
-			}
-		pthread_mutex_unlock(&iterationMutex);
-	}
-	pthread_cancel(threads[0]); 
-	pthread_mutex_lock(&trapMutex);
-	if (!isIOTrapPos) {
-		pthread_cancel(threads[1]);
-	}
-	pthread_mutex_unlock(&trapMutex);
-	pthread_mutex_lock(&interruptMutex);
-	if (!hasBlockedPCB) {
-		pthread_cancel(threads[2]);
+		if (iteration >= maxIterations) {
+			trace("\n");
+			trace("MAX_ITERATION_TOTAL reached in main\r\n");
+			break;
+		}
 	}
-	pthread_mutex_unlock(&interruptMutex);
+	requestShutdown();
 	
 	for (int i = 0; i < curr; i++) {
 		pthread_join(threads[i], &status); //joins all the threads together
 	}
+	if (shutdownReport) {
+		lp_report(shutdownReport, lockProfiles, LOCK_COUNT);
+	}
 
 	pthread_mutex_destroy(&schedulerMutex);
-	pthread_mutex_destroy(&iterationMutex);
 	pthread_mutex_destroy(&randMutex);
 	pthread_mutex_destroy(&printMutex);	
 	pthread_mutex_destroy(&totalProcessesMutex);
 	pthread_mutex_destroy(&trapMutex);
 	pthread_mutex_destroy(&interruptMutex);
+	pthread_mutex_destroy(&reclaimMutex);
 	
 	pthread_cond_destroy(&trapCondVar);
 	pthread_cond_destroy(&interruptCondVar);
+	pthread_cond_destroy(&timerCondVar);
+	pthread_cond_destroy(&reclaimCondVar);
 	
 	
 	printSchedulerState(scheduler);
+	if (shutdownReport) {
+		fprintf(shutdownReport, "Mean dispatch latency: %.2f iterations, recently %.2f\r\n", 
+			dispatchCount ? (double) latencyTotal / dispatchCount : 0.0, dispatchLatency);
+		fprintf(shutdownReport, "Admission control: %lu PCBs deferred, %lu admitted after %.2f iterations on average, %lu rejected\r\n",
+			deferredCount, releasedCount, releasedCount ? (double) deferredIterations / releasedCount : 0.0, rejectedCount);
+	}
+	if (vm) { //freed while its PCBs still are, it clears their page tables
+		if (shutdownReport) {
+			vm_report(shutdownReport, vm);
+		}
+		memoryStats = vm->stats;
+		vm_destroy(vm);
+		vm = NULL;
+	}
+	if (physMem) { //taken from the PCBs first, so destroying them doesn't free into it
+		if (shutdownReport) {
+			pm_report(shutdownReport, physMem);
+			fprintf(shutdownReport, "admission stalls: %lu\r\n", admissionStalls);
+		}
+		endFragmentation = pm_fragmentation(physMem);
+		PCB_use_memory(NULL);
+		pm_destroy(physMem);
+		physMem = NULL;
+	}
 	schedulerDeconstructor(scheduler);
+	PCB_pool_drain();
+	if (workload) {
+		wl_close(workload);
+		workload = NULL;
+	}
 }
 
 
 /*
-	This is the ioInterrupt thread. Its job is to service the I/O requests for the 
-	Process in the front of the Blocked queue. It does this by simulating a received 
-	I/O (via a random number that falls within certain parameters) then performing a 
-	context switch to move the service Process back into the MLFQ. This thread is set 
-	to be cancellable because it will be waiting for a signal that comes from the ioTrap 
-	thread once it's done performing its own context switch. And because the ioTrap could 
-	be stuck waiting even after the main thread is done executing, this will also spin 
-	since it is dependant on the ioTrap.
+	Starts the timer, ioTrap, reclaimer and interruptThreadCount ioInterrupt threads.
+	Returns how many were started.
 */
-void * ioInterrupt (void * theScheduler) {
-	Scheduler scheduler = (Scheduler) theScheduler;
+int startHelperThreads (pthread_t threads[], Scheduler theScheduler) {
+	pthread_attr_t attr;
+	int count = 3 + interruptThreadCount;
 	
-	pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+	for (int i = 0; i < count; i++) {
+		if (i == 0) {
+			pthread_create(&threads[i], &attr, timerInterrupt, (void *) theScheduler);
+		} else if (i == 1) {
+			pthread_create(&threads[i], &attr, ioTrap, (void *) theScheduler);
+		} else if (i == 2) {
+			pthread_create(&threads[i], &attr, reclaimer, (void *) theScheduler);
+		} else {
+			pthread_create(&threads[i], &attr, ioInterrupt, (void *) theScheduler);
+		}
+	}
+	pthread_attr_destroy(&attr);
 	
-	int isRunning = 0, temp = 0;
-	printf("Starting ioInterrupt thread\r\n\n");
-	for (;;) {
-		if (!isRunning) {
-			pthread_mutex_lock(&interruptMutex);
-				while (!hasBlockedPCB) {
-					printf("Waiting on condition variable in ioInterrupt\r\n");
-					pthread_cond_wait(&interruptCondVar, &interruptMutex);
-					printf("\nValue found in the blocked queue, waiting for I/O Interrupt!\r\n");
+	return count;
+}
+
+
+/*
+	Samples how many iterations pass until an event with a per iteration chance of
+	percentage out of domain happens, the same roll the old per iteration checks made.
+	The result is geometric and always at least 1.
+*/
+unsigned int sampleGeometric (int domain, int percentage) {
+	unsigned int trials = 1;
+	
+	lockMutex(RAND_LOCK);
+		while (sim_rand() % domain > percentage) {
+			trials++;
+		}
+	unlockMutex(RAND_LOCK);
+	
+	return trials;
+}
+
+
+/*
+	Samples how many iterations the I/O device needs to service one request. Each
+	iteration the request has the same simParams.ioChance chance of completing 
+	that the old polling ioInterrupt loop rolled for.
+*/
+unsigned int sampleIOServiceTime () {
+	return sampleGeometric(IO_INT_CHANCE_DOMAIN, simParams.ioChance);
+}
+
+
+/*
+	Starts a new quantum for the running PCB, replacing whatever quantum was pending.
+	The length comes from the scheduling policy, scaled by simParams.quantumPercent, 
+	or is a single iteration when nothing is running so the idle scheduler checks the
+	MLFQ again on the next step. 
+	Must be called with the schedulerMutex held.
+*/
+void armQuantum (Scheduler theScheduler) {
+	unsigned int quantum = 1;
+	
+	if (theScheduler->running) {
+		quantum = policy_quantum(theScheduler->ready, theScheduler->running) * simParams.quantumPercent / 100;
+		if (!quantum) {
+			quantum = 1;
+		}
+	}
+	currQuantumSize = quantum;
+	tw_cancel(theScheduler->timers, theScheduler->quantumEvent);
+	theScheduler->quantumEvent = tw_schedule(theScheduler->timers, iteration + quantum, TIMER_QUANTUM, NULL);
+}
+
+
+/*
+	Schedules the I/O completion for a PCB that was just put into the Blocked queue.
+	The request goes to whichever of the deviceCount devices frees up first, which 
+	is recorded in the PCB's channel_no. Each device services its requests in the 
+	order they arrive, so a request can't start before the one ahead of it on the 
+	same device has finished. A page fault goes to the paging disk instead, which 
+	takes simParams.diskLatency for each read. Must be called with the 
+	schedulerMutex held.
+*/
+void scheduleIOCompletion (Scheduler theScheduler, PCB pcb) {
+	unsigned int start = iteration;
+	int device = 0;
+	
+	if (pcb->fault_page >= 0) {
+		if (diskFree > start) {
+			start = diskFree;
+		}
+		diskFree = start + simParams.diskLatency;
+		pcb->blocked_timer = diskFree;
+		tw_schedule(theScheduler->timers, diskFree, TIMER_IO_COMPLETION, pcb);
+		trace("P%d page %d fault, the disk read will complete at iteration %u\r\n", pcb->pid, pcb->fault_page, diskFree);
+		return;
+	}
+	for (int i = 1; i < deviceCount; i++) {
+		if (deviceFree[i] < deviceFree[device]) {
+			device = i;
+		}
+	}
+	if (deviceFree[device] > start) {
+		start = deviceFree[device];
+	}
+	deviceFree[device] = start + sampleIOServiceTime();
+	pcb->channel_no = device;
+	pcb->blocked_timer = deviceFree[device];
+	tw_schedule(theScheduler->timers, deviceFree[device], TIMER_IO_COMPLETION, pcb);
+	trace("P%d I/O on device %d will complete at iteration %d\r\n", pcb->pid, device, deviceFree[device]);
+}
+
+
+/*
+	Advances the timer wheel to the current iteration and handles every event that 
+	came due. I/O completions and quantum expiries are handed to the ioInterrupt and
+	timer threads, the policy's periodic boost and PCB creation run here and schedule their next 
+	occurrence. Must be called with the schedulerMutex held.
+	
+	All of this runs under that lock, including taking a completed PCB off the 
+	blocked queue and making new PCBs. Only the relay from ioDone through the 
+	ioInterrupt threads to the inbox is done without it.
+*/
+void fireTimers (Scheduler theScheduler) {
+	int completions = 0, quantumExpired = 0;
+	TimerEvent expired = tw_advance(theScheduler->timers, iteration);
+	TimerEvent next = NULL;
+	PCB done = NULL;
+	unsigned int frame = 0;
+	
+	while (expired) {
+		next = expired->next;
+		switch (expired->type) {
+			case TIMER_IO_COMPLETION:
+				done = q_remove(theScheduler->blocked, expired->pcb); //NULL if it was killed while blocked
+				if (done && done->fault_page >= 0) {
+					if (vm) {
+						frame = vm_load(vm, done, done->fault_page);
+						trace("P%d page %d loaded into frame %u\r\n", done->pid, done->fault_page, frame);
+					}
+					done->fault_page = -1;
 				}
-				hasBlockedPCB = 0;
-				isRunning = 1;
-			pthread_mutex_unlock(&interruptMutex);
+				if (done) {
+					PCB_set_location(done, LOC_INBOX); //set here, the ioInterrupt threads don't hold the schedulerMutex
+					ioCompletionCount++;
+					if (benchmarking) {
+						done->io_done_at = bench_now();
+					}
+				}
+				if (done && !lfq_enqueue(theScheduler->ioDone, done)) {
+					postToInbox(theScheduler, done, 1); //ioInterrupt is too far behind, skip it
+				} else if (done) {
+					completions++;
+				}
+				break;
+			case TIMER_QUANTUM:
+				if (expired == theScheduler->quantumEvent) {
+					theScheduler->quantumEvent = NULL;
+				}
+				quantumExpired = 1;
+				break;
+			case TIMER_AGING:
+				policy_on_boost(theScheduler->ready);
+				tw_schedule(theScheduler->timers, iteration + simParams.agingInterval, TIMER_AGING, NULL);
+				break;
+			case TIMER_MAKE_PCB:
+				trace("\nMAKING NEW PCBS\r\n");
+				if (workload) {
+					totalProcesses += admitWorkload(theScheduler);
+				} else if (!admissionRejects(theScheduler, 2)) {
+					totalProcesses += makePCBList (theScheduler); //makes new processes
+				}
+				scheduleArrivals(theScheduler);
+				break;
 		}
-		
-		pthread_mutex_lock(&randMutex);
-			temp = rand() % IO_INT_CHANCE_DOMAIN;
-		pthread_mutex_unlock(&randMutex);
-		
-		if (temp <= IO_INT_CHANCE_PERCENTAGE) {
-			pthread_mutex_lock(&schedulerMutex);
-				printf("Received I/O\n");
-				printf("Starting ISR in ioInterrupt\r\n");
-				pseudoISR(scheduler, IS_IO_INTERRUPT);
-				printf("Finished ISR in ioInterrupt\r\n");
-				if (q_is_empty(scheduler->blocked)) {
-					pthread_mutex_lock(&interruptMutex);
-						hasBlockedPCB = 0;
-						isRunning = 0;
-					pthread_mutex_unlock(&interruptMutex);
+		tw_event_destroy(expired);
+		expired = next;
+	}
+	
+	if (completions || quantumExpired) {
+		lockMutex(INTERRUPT_LOCK);
+			if (completions) {
+				pendingIOCompletions += completions;
+				trace("\nSending signal to ioInterrupt\n\n");
+				if (completions > 1 && interruptThreadCount > 1) {
+					pthread_cond_broadcast(&interruptCondVar);
+				} else {
+					pthread_cond_signal(&interruptCondVar);
 				}
-			pthread_mutex_unlock(&schedulerMutex);
+			}
+			if (quantumExpired) {
+				timerExpired = 1;
+				pthread_cond_signal(&timerCondVar);
+			}
+		unlockMutex(INTERRUPT_LOCK);
+	}
+}
+
+
+/*
+	Posts a woken or newly created PCB to the ready inbox, which doesn't need the 
+	schedulerMutex. Only if the inbox is full is the scheduler lock taken, unless the
+	caller already holds it, so the inbox can be drained to make room.
+*/
+void postToInbox (Scheduler theScheduler, PCB pcb, int holdsLock) {
+	while (!lfq_enqueue(theScheduler->inbox, pcb)) {
+		if (holdsLock) {
+			drainInbox(theScheduler);
+		} else {
+			lockScheduler();
+				drainInbox(theScheduler);
+			unlockScheduler();
 		}
+	}
+}
+
+
+/*
+	Moves every PCB waiting in the ready inbox into the ready set, in the order they
+	were posted. PCBs coming back from I/O are woken, new ones are just marked ready.
+	Must be called with the schedulerMutex held.
+*/
+void drainInbox (Scheduler theScheduler) {
+	PCB pcb = NULL;
+	
+	while ((pcb = lfq_dequeue(theScheduler->inbox))) {
+		if (pcb->io_done_at) {
+			if (wakeSampleCount < BENCH_MAX_SAMPLES) {
+				wakeSamples[wakeSampleCount++] = bench_now() - pcb->io_done_at;
+			}
+			pcb->io_done_at = 0;
+		}
+		if (pcb->state == STATE_WAIT) {
+			trace("\r\nEnqueueing P%d into MLFQ from I/O\r\n", pcb->pid);
+			PCB_assign_state(pcb, STATE_READY);
+			policy_on_wake(theScheduler->ready, pcb);
+		} else {
+			trace("Enqueuing newly created P%d into MLFQ\n", pcb->pid);
+			PCB_assign_state(pcb, STATE_READY);
+		}
+		enqueueReady(theScheduler, pcb);
+	}
+}
+
+
+/*
+	Tells every helper thread to exit. The stop flag is set first, then each condition
+	variable is broadcast with its mutex held, so a thread is either about to check the
+	flag or already asleep and gets woken. Nothing has to be cancelled and every thread
+	is gone within one wakeup.
+*/
+void requestShutdown () {
+	atomic_store_explicit(&stopRequested, 1, memory_order_release);
+	
+	lockMutex(TRAP_LOCK);
+		pthread_cond_broadcast(&trapCondVar);
+	unlockMutex(TRAP_LOCK);
+	lockMutex(INTERRUPT_LOCK);
+		pthread_cond_broadcast(&interruptCondVar); //wakes every ioInterrupt
+		pthread_cond_broadcast(&timerCondVar);
+	unlockMutex(INTERRUPT_LOCK);
+	lockMutex(RECLAIM_LOCK);
+		pthread_cond_broadcast(&reclaimCondVar);
+	unlockMutex(RECLAIM_LOCK);
+}
+
+
+/*
+	Waits until none of the helper threads has work in hand: no I/O trap waiting for
+	ioTrap, no quantum expiry waiting for the timer thread, no I/O completion waiting
+	for an ioInterrupt thread, no killed PCBs waiting for the reclaimer, and none of 
+	them part way through handling one. Only osLoop hands them work, so once this returns on osLoop's thread nothing but osLoop
+	can change the scheduler until it carries on.
+*/
+void waitForQuiescence (Scheduler theScheduler) {
+	int busy = 1;
+	
+	while (busy) {
+		lockMutex(TRAP_LOCK);
+			busy = isIOTrapPos;
+		unlockMutex(TRAP_LOCK);
+		lockMutex(INTERRUPT_LOCK);
+			busy = busy || timerExpired || pendingIOCompletions || atomic_load(&helpersBusy);
+		unlockMutex(INTERRUPT_LOCK);
+		lockMutex(RECLAIM_LOCK);
+			busy = busy || !q_is_empty(theScheduler->reclaimed) || !q_is_empty(theScheduler->reclaimedMutexes);
+		unlockMutex(RECLAIM_LOCK);
+		if (busy) {
+			sched_yield();
+		}
+	}
+}
+
+
+/*
+	Writes or reads everything a run carries from one iteration to the next: the 
+	counters and the random sequence, the PCB table, the virtual memory, every queue 
+	and the Mutexes, the policy's ready set, the timer wheel and the running and interrupted PCBs. The 
+	ready inbox and ioDone are left out, saveCheckpoint makes sure they are empty. 
+	Loading must be into a freshly constructed Scheduler, before any thread is 
+	started. Returns 1 on success, 0 if anything couldn't be written or read.
+*/
+int checkpointScheduler (Scheduler theScheduler, Checkpoint ckpt) {
+	char * name = (char *) policyName;
+	unsigned int now = iteration;
+	
+	ckpt_string(ckpt, &name);
+	if (ckpt->loading) {
+		if (name && strcmp(name, policyName)) {
+			fprintf(stderr, "checkpoint was made with the %s policy\r\n", name);
+			ckpt_fail(ckpt, "policy doesn't match the checkpoint");
+		}
+		free(name);
+	}
+	
+	ckpt_value(ckpt, now);
+	ckpt_value(ckpt, simRandState);
+	ckpt_value(ckpt, global_largest_MID);
+	ckpt_value(ckpt, totalProcesses);
+	ckpt_value(ckpt, currQuantumSize);
+	ckpt_value(ckpt, sysstack);
+	ckpt_value(ckpt, switchCalls);
+	ckpt_value(ckpt, isFirstRun);
+	ckpt_value(ckpt, deadlockDetected);
+	ckpt_value(ckpt, deviceCount);
+	ckpt_value(ckpt, deviceFree);
+	ckpt_value(ckpt, dispatchCount);
+	ckpt_value(ckpt, ioCompletionCount);
+	ckpt_value(ckpt, compCount);
+	ckpt_value(ckpt, ioCount);
+	ckpt_value(ckpt, pairCount);
+	ckpt_value(ckpt, sharedCount);
+	ckpt_value(ckpt, deadlockCount);
+	ckpt_value(ckpt, contextSwitchCount);
+	ckpt_value(ckpt, incrementPair);
+	ckpt_value(ckpt, simParams);
+	ckpt_value(ckpt, diskFree);
+	ckpt_value(ckpt, admissionStalls);
+	ckpt_value(ckpt, dispatchLatency);
+	ckpt_value(ckpt, latencyTotal);
+	ckpt_value(ckpt, deferredCount);
+	ckpt_value(ckpt, releasedCount);
+	ckpt_value(ckpt, deferredIterations);
+	ckpt_value(ckpt, rejectedCount);
+	checkpointWorkload(ckpt);
+	if (ckpt->loading) {
+		atomic_store(&iteration, now);
+		applyMemoryParams();
+		if (deviceCount < 1 || deviceCount > MAX_DEVICES) {
+			ckpt_fail(ckpt, "checkpoint has a bad device count");
+		}
+	}
+	
+	ckpt_pcb_table(ckpt);
+	if (vm) {
+		vm_checkpoint(vm, ckpt);
+	}
+	if (physMem) {
+		ckpt_phys_mem(physMem, ckpt);
+	}
+	ckpt_queue(theScheduler->created, ckpt);
+	ckpt_queue(theScheduler->killed, ckpt);
+	ckpt_queue(theScheduler->blocked, ckpt);
+	ckpt_mutex_queue(theScheduler->killedMutexes, ckpt);
+	ckpt_mutex_map(theScheduler->mutexes, ckpt);
+	policy_checkpoint(theScheduler->ready, ckpt);
+	ckpt_timer_wheel(theScheduler->timers, ckpt, &theScheduler->quantumEvent);
+	ckpt_pcb_ref(ckpt, &theScheduler->running);
+	ckpt_pcb_ref(ckpt, &theScheduler->interrupted);
+	ckpt_value(ckpt, theScheduler->isNew);
+	
+	return !ckpt->failed;
+}
+
+
+/*
+	Writes or reads where the workload being replayed has got to: its path, or an 
+	empty one if the run makes random PCBs, the position of the next line and the
+	record already read from before it. Loading reopens the file at that position.
+*/
+void checkpointWorkload (Checkpoint ckpt) {
+	char * path = workload ? workload->path : "";
+	workload_record_s pending;
+	long offset = workload ? workload->offset : 0;
+	unsigned long lineNumber = workload ? workload->lineNumber : 0;
+	unsigned long admitted = workload ? workload->admitted : 0;
+	int hasPending = workload ? workload->hasPending : 0;
+	
+	memset(&pending, 0, sizeof(pending));
+	if (hasPending) {
+		pending = workload->pending;
+	}
+	ckpt_string(ckpt, &path);
+	ckpt_value(ckpt, offset);
+	ckpt_value(ckpt, lineNumber);
+	ckpt_value(ckpt, admitted);
+	ckpt_value(ckpt, hasPending);
+	ckpt_value(ckpt, pending);
+	if (!ckpt->loading || !path) {
+		return;
+	}
+	
+	if (*path && !ckpt->failed) {
+		workload = wl_open_at(path, offset, lineNumber, hasPending ? &pending : NULL);
+		if (workload == NULL) {
+			fprintf(stderr, "couldn't reopen workload %s\r\n", path);
+			ckpt_fail(ckpt, "checkpoint's workload is missing");
+		} else {
+			workload->admitted = admitted;
+			workloadPath = workload->path;
+		}
+	}
+	free(path);
+}
+
+
+/*
+	Saves the simulator to the given file. Must be called on osLoop's thread with the
+	schedulerMutex held, after waitForQuiescence, so the only PCBs in flight are the
+	ones in the ready inbox, which are moved into the ready set first.
+*/
+int saveCheckpoint (Scheduler theScheduler, const char * path) {
+	Checkpoint ckpt = NULL;
+	int ok = 0;
+	
+	drainInbox(theScheduler);
+	if (lfq_size(theScheduler->inbox) || lfq_size(theScheduler->ioDone)) {
+		fprintf(stderr, "simulator isn't quiescent, not saving %s\r\n", path);
+		return 0;
+	}
+	ckpt = ckpt_open(path, 0);
+	if (ckpt == NULL) {
+		fprintf(stderr, "couldn't open %s\r\n", path);
+		return 0;
+	}
+	ok = checkpointScheduler(theScheduler, ckpt);
+	ok = ckpt_close(ckpt) && ok;
+	if (ok) {
+		fprintf(stderr, "saved checkpoint %s at iteration %u\r\n", path, iteration);
+	}
+	
+	return ok;
+}
+
+
+/*
+	Replaces the freshly constructed Scheduler's empty state with the one saved in the
+	given file.
+*/
+int restoreCheckpoint (Scheduler theScheduler, const char * path) {
+	Checkpoint ckpt = ckpt_open(path, 1);
+	int ok = 0;
+	
+	if (ckpt == NULL) {
+		fprintf(stderr, "%s isn't a checkpoint\r\n", path);
+		return 0;
+	}
+	ok = checkpointScheduler(theScheduler, ckpt);
+	ok = ckpt_close(ckpt) && ok;
+	if (ok) {
+		fprintf(stderr, "restored checkpoint %s at iteration %u\r\n", path, iteration);
+	}
+	
+	return ok;
+}
+
+
+/*
+	This is the ioInterrupt thread. Its job is to service the I/O requests that have 
+	completed. It sleeps on its condition variable until the timer wheel in osLoop reports 
+	that one or more I/O completions have come due, then posts each serviced Process to
+	the lock-free ready inbox without taking the schedulerMutex. The scheduler moves them 
+	into the ready set the next time it runs. Nothing is polled, so the thread is idle 
+	whenever no completion is due. It exits once osLoop calls requestShutdown.
+	
+	There are interruptThreadCount of these threads. Each one claims an even share of 
+	the pending completions, so a burst is spread across all of them.
+*/
+void * ioInterrupt (void * theScheduler) {
+	Scheduler scheduler = (Scheduler) theScheduler;
+	PCB done = NULL;
+	unsigned int claimed = 0;
+	
+	trace("Starting ioInterrupt thread\r\n\n");
+	for (;;) {
+		lockMutex(INTERRUPT_LOCK);
+			while (!pendingIOCompletions && !atomic_load(&stopRequested)) {
+				trace("Waiting on condition variable in ioInterrupt\r\n");
+				waitCondition(&interruptCondVar, INTERRUPT_LOCK);
+			}
+			if (atomic_load(&stopRequested)) {
+				trace("MAX_ITERATION_TOTAL reached in ioInterrupt\r\n");
+				unlockMutex(INTERRUPT_LOCK);
+				break;
+			}
+			claimed = (pendingIOCompletions + interruptThreadCount - 1) / interruptThreadCount;
+			pendingIOCompletions -= claimed;
+			atomic_fetch_add(&helpersBusy, 1);
+		unlockMutex(INTERRUPT_LOCK);
 		
-		
-		pthread_mutex_lock(&iterationMutex);
-			if (iteration >= MAX_ITERATION_TOTAL) { 			//this is how we will break out of the loop, same as in main.
-				printf("MAX_ITERATION_TOTAL reached in ioTrap\r\n"); //may think about a check here instead
-				pthread_mutex_unlock(&iterationMutex);
+		while (claimed-- && (done = lfq_dequeue(scheduler->ioDone))) {
+			trace("Received I/O for P%d, posting it to the ready inbox\r\n", done->pid);
+			postToInbox(scheduler, done, 0);
+		}
+		atomic_fetch_sub(&helpersBusy, 1);
+	}
+	
+	trace("Finished ioInterrupt, exiting\r\n");
+	pthread_exit(NULL);
+}
+
+
+/*
+	This is the reclaimer thread. handleKilledQueueEmptying hands it each batch of 
+	killed PCBs and Mutexes, already taken out of the PCB table and with their PIDs
+	freed, and it returns them to the PCB pool and frees the Mutexes, so none of that
+	happens under the schedulerMutex. It takes the whole batch at once by swapping 
+	queues, and traces and frees it with the reclaimMutex released. It exits once osLoop calls requestShutdown.
+*/
+void * reclaimer (void * theScheduler) {
+	Scheduler scheduler = (Scheduler) theScheduler;
+	ReadyQueue pcbs = q_create();
+	ReadyQueue mutexes = q_create();
+	PCB pcb = NULL;
+	Mutex mutex = NULL;
+	int count = 0;
+	
+	trace("Starting reclaimer thread\r\n\n");
+	for (;;) {
+		lockMutex(RECLAIM_LOCK);
+			while (q_is_empty(scheduler->reclaimed) && q_is_empty(scheduler->reclaimedMutexes)
+					&& !atomic_load(&stopRequested)) {
+				waitCondition(&reclaimCondVar, RECLAIM_LOCK);
+			}
+			if (atomic_load(&stopRequested)) {
+				trace("MAX_ITERATION_TOTAL reached in reclaimer\r\n");
+				unlockMutex(RECLAIM_LOCK);
 				break;
 			}
-		pthread_mutex_unlock(&iterationMutex);
+			handOverQueue(&pcbs, &scheduler->reclaimed); //pcbs is always empty here, so this is a swap
+			handOverQueue(&mutexes, &scheduler->reclaimedMutexes);
+			atomic_fetch_add(&helpersBusy, 1);
+		unlockMutex(RECLAIM_LOCK);
+		
+		trace("Emptying Killed queue: ");
+		toStringReadyQueue(pcbs);
+		for (count = 0; (pcb = q_dequeue(pcbs)); count++) {
+			PCB_destroy(pcb);
+		}
+		while ((mutex = q_dequeue_m(mutexes))) {
+			mutex_destroy(mutex);
+		}
+		trace("Reclaimed %d PCBs\r\n", count);
+		atomic_fetch_sub(&helpersBusy, 1);
 	}
 	
-	printf("Finished ioInterrupt, exiting\r\n");
+	q_destroy(pcbs);
+	q_destroy_m(mutexes);
+	trace("Finished reclaimer, exiting\r\n");
 	pthread_exit(NULL);
 }
 
@@ -958,120 +2243,102 @@ void * ioInterrupt (void * theScheduler) {
 /*
 	This is the ioTrap thread. Its job is to wait for a signal from the main 
 	thread that a Process is requesting I/O, then perform a context switch of 
-	the Process into the Blocked queue to await the I/O. We make this cancellable 
-	because when the main thread is done executing, the ioTrap may still be waiting
-	for the condition signal, therefore causing the program to forever spin. By
-	calling a cancel in the main thread if this is still waiting, we solve that problem.
+	the Process into the Blocked queue to await the I/O. It exits once osLoop 
+	calls requestShutdown, which also wakes it if it is still waiting.
 */
 void * ioTrap (void * theScheduler) {
 	Scheduler scheduler = (Scheduler) theScheduler;
 	
-	pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
-	
-	printf("\nStarting ioTrap thread\r\n\n");
+	trace("\nStarting ioTrap thread\r\n\n");
 	for (;;) {
 		
-		pthread_mutex_lock(&trapMutex);
-			while (!isIOTrapPos) {
-				printf("Waiting on condition variable in ioTrap\r\n");
-				pthread_cond_wait(&trapCondVar, &trapMutex);
-				printf("Trap position reached, starting I/O Trap\r\n");
+		lockMutex(TRAP_LOCK);
+			while (!isIOTrapPos && !atomic_load(&stopRequested)) {
+				trace("Waiting on condition variable in ioTrap\r\n");
+				waitCondition(&trapCondVar, TRAP_LOCK);
+			}
+			if (atomic_load(&stopRequested)) {
+				trace("MAX_ITERATION_TOTAL reached in ioTrap\r\n");
+				unlockMutex(TRAP_LOCK);
+				break;
 			}
-		pthread_mutex_unlock(&trapMutex);
+			trace("Trap position reached, starting I/O Trap\r\n");
+		unlockMutex(TRAP_LOCK);
 		
-		pthread_mutex_lock(&schedulerMutex);
-			printf("Starting ISR in ioTrap\r\n");
-			pseudoISR(scheduler, IS_IO_TRAP);
-			printf("Finished ISR in ioTrap\r\n");
-		pthread_mutex_unlock(&schedulerMutex);
+		lockScheduler();
+			if (scheduler->running && scheduler->running == trapPCB) {
+				trace("Starting ISR in ioTrap\r\n");
+				pseudoISR(scheduler, IS_IO_TRAP);
+				trace("Finished ISR in ioTrap\r\n");
+			} else { //a timer interrupt or termination got to it first
+				trace("Trapping PCB is no longer running, skipping I/O Trap\r\n");
+			}
+			trapPCB = NULL;
+		unlockScheduler();
 		
-		pthread_mutex_lock(&trapMutex);
+		lockMutex(TRAP_LOCK);
 			isIOTrapPos = 0;
-		pthread_mutex_unlock(&trapMutex);
-		
-		pthread_mutex_lock(&iterationMutex);
-			if (iteration >= MAX_ITERATION_TOTAL) { 			//this is how we will break out of the loop, same as in main.
-				printf("MAX_ITERATION_TOTAL reached in ioTrap\r\n"); //may think about a check here instead
-				pthread_mutex_unlock(&iterationMutex);
-				break;
-			}
-		pthread_mutex_unlock(&iterationMutex);
+		unlockMutex(TRAP_LOCK);
 	}
 	
-	printf("Finished ioTrap, exiting\r\n");
+	trace("Finished ioTrap, exiting\r\n");
 	pthread_exit(NULL);
 }
 
 
 /*
-	Checks if the global quantum tick is greater than or equal to
-	the current quantum size for the running PCB. If so, then reset
-	the quantum tick to 0 and return 1 so the pseudoISR can occur.
-	If not, increase quantum tick by 1.
+	This is the timer thread. It sleeps until the timer wheel in osLoop reports that the 
+	running PCB's quantum has expired, then performs the timer interrupt. The dispatcher 
+	arms the quantum for whichever PCB it picks next. It exits once osLoop calls 
+	requestShutdown.
 */
 void * timerInterrupt(void * theScheduler)
 {	
 	Scheduler scheduler = (Scheduler) theScheduler;
 	
-	pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
-	unsigned int temp = 0;
-	unsigned int *seed;
-	
-	struct timespec quantum;
-	quantum.tv_sec = 0;
-	printf("\nStarting timer interrupt\r\n\n");
+	trace("\nStarting timer interrupt\r\n\n");
 	for(;;)
 	{
-		printf("top of timer\n");
-		quantum.tv_nsec = currQuantumSize; //this WAS locked by schedulerMutex
-		
-		nanosleep(&quantum, NULL); //puts the thread to sleep
-		//for (int i = 0; i < 100; i++){} //this was part of a test to make a more uniform distribution of PCBs in the MLFQ
+		trace("top of timer\n");
+		lockMutex(INTERRUPT_LOCK);
+			while (!timerExpired && !atomic_load(&stopRequested)) {
+				waitCondition(&timerCondVar, INTERRUPT_LOCK);
+			}
+			if (atomic_load(&stopRequested)) {
+				trace("MAX_ITERATION_TOTAL reached in timer\r\n");
+				unlockMutex(INTERRUPT_LOCK);
+				break;
+			}
+			timerExpired = 0;
+			atomic_fetch_add(&helpersBusy, 1);
+		unlockMutex(INTERRUPT_LOCK);
 		
-		pthread_mutex_lock(&schedulerMutex); //performs context switching as soon as it wakes
-			printf("\nTimer waking up\r\n");
-			printf("Starting ISR in timerInterrupt\r\n");
+		lockScheduler(); //performs context switching as soon as it wakes
+			trace("\nTimer waking up\r\n");
+			trace("Starting ISR in timerInterrupt\r\n");
 			pseudoISR(scheduler, IS_TIMER);
-			printf("Finished ISR in timerInterrupt\r\n");
+			trace("Finished ISR in timerInterrupt\r\n");
 			
-			pthread_mutex_lock(&printMutex);
+			lockMutex(PRINT_LOCK);
 				printSchedulerState(scheduler);
-			pthread_mutex_unlock(&printMutex);
-			currQuantumSize = getNextQuantumSize(scheduler->ready); //sets the quantum for the sleep amount
-		pthread_mutex_unlock(&schedulerMutex);
+			unlockMutex(PRINT_LOCK);
+		unlockScheduler();
+		atomic_fetch_sub(&helpersBusy, 1);
 		
-		pthread_mutex_lock(&iterationMutex);
-			if (iteration >= MAX_ITERATION_TOTAL) { 			//this is how we will break out of the loop, same as in main.
-				printf("MAX_ITERATION_TOTAL reached in timer\r\n"); //may think about a check here instead
-				pthread_mutex_unlock(&iterationMutex);
-				break;
-			}
-		pthread_mutex_unlock(&iterationMutex);
-		
-		printf("bottom of timer\n");
+		trace("bottom of timer\n");
 	}
 	
-	printf("Finished timer, exiting\n");
+	trace("Finished timer, exiting\n");
 	pthread_exit(NULL);
 }
 
 
 /*
-	Counts the remaining Processes in the MLFQ. It does so by dequeueing
-	so it needs to also free.
+	Counts the remaining Processes in the ready set. The policy keeps its own count, 
+	so nothing is dequeued, and policy_destroy frees them afterwards.
 */
-int countRemainingProcesses(PriorityQueue pq) {
-	int remaining = 0;
-	while (!pq_is_empty(pq)) {
-		PCB getting = pq_dequeue(pq);
-		if (!getting) {
-			break;
-		} else {
-			PCB_destroy(getting);
-			remaining++;
-		}
-	}
-	return remaining;
+int countRemainingProcesses(SchedPolicy policy) {
+	return policy_count(policy);
 }
 
 
@@ -1117,9 +2384,10 @@ int countRemainingProcessesInMutexQueue(ReadyQueue queue) {
 /*
 	If the Running PCB is of role PAIR or SHARED, then this function is called. What this
 	does is handle the locking, unlocking, signalling, and waiting for the Mutexes and 
-	their ConditionVariables. If it's determined to be a lock or unlock operation, it will 
-	return a 1 or 2 from the respective isLockPC or isUnlockPC saying which of the two SHARED 
-	resource the PC is found within, so we know which sharedMutex to look for in the MutexMap.
+	their ConditionVariables, going by the running PCB's trap mask, see runningTraps. If 
+	it's determined to be a lock or unlock operation, trapResource gives a 1 or 2 saying 
+	which of the two SHARED resource the PC is found within, so we know which sharedMutex 
+	to look for in the MutexMap.
 	
 	If a Mutex tries to lock, but the Mutex is already locked, it will simply stall the Mutex.
 	Meaning, it will simply perform a simple context switch on the running PCB and put it back 
@@ -1127,107 +2395,106 @@ int countRemainingProcessesInMutexQueue(ReadyQueue queue) {
 	
 	Returns 1 if a context switched happen so the osLoop knows to start over, otherwise 0.
 */
-int useMutex (Scheduler thisScheduler) {	
+int useMutex (Scheduler thisScheduler, unsigned int traps) {	
 	int wait = 0, signal = 0; 
-	int lock = isLockPC(thisScheduler->running->context->pc, thisScheduler->running);
-	int unlock = isUnlockPC(thisScheduler->running->context->pc, thisScheduler->running);
+	int lock = trapResource(traps, TRAP_LOCK_R1, TRAP_LOCK_R2, thisScheduler->running);
+	int unlock = trapResource(traps, TRAP_UNLOCK_R1, TRAP_UNLOCK_R2, thisScheduler->running);
 	
 	
 	if (thisScheduler->running->role == PAIR) {
 		if (thisScheduler->running->isProducer) {
-			signal = isSignalPC(thisScheduler->running->context->pc, thisScheduler->running);
+			signal = (traps & TRAP_SIGNAL) != 0;
 		} else {
-			wait = isWaitPC(thisScheduler->running->context->pc, thisScheduler->running);
+			wait = (traps & TRAP_WAIT) != 0;
 		}
 	}
 	
 	Mutex currMutex = NULL;
 		
 	if (lock) {
-		printf("lock values for R1 of P%d:\n", thisScheduler->running->pid);
+		trace("lock values for R1 of P%d:\n", thisScheduler->running->pid);
 		printPCLocations(thisScheduler->running->lockR1);
 		if (thisScheduler->running->role == SHARED) {
-			printf("lock values for R2 of P%d:\n", thisScheduler->running->pid);
+			trace("lock values for R2 of P%d:\n", thisScheduler->running->pid);
 			printPCLocations(thisScheduler->running->lockR2);
 		}
 		
 		if (lock == 1) { //is mutex_R1_id
-			printf("Getting the Mutex for R1\n");
+			trace("Getting the Mutex for R1\n");
 			currMutex = get_mutx(thisScheduler->mutexes, thisScheduler->running->mutex_R1_id);
 		} else { //is mutex_R2_id
-			printf("Getting the Mutex for R2\n");
+			trace("Getting the Mutex for R2\n");
 			currMutex = get_mutx(thisScheduler->mutexes, thisScheduler->running->mutex_R2_id);
 		}
 		
 		if (currMutex) {
 			int isLocked = mutex_lock (currMutex, thisScheduler->running);
 			if (currMutex->hasLock != thisScheduler->running) {
-				printf("PID%d: requested lock on mutex M%d - blocked by PID%d\r\n", 
+				trace("PID%d: requested lock on mutex M%d - blocked by PID%d\r\n", 
 					thisScheduler->running->pid, currMutex->mid, currMutex->hasLock->pid);
-				pq_enqueue(thisScheduler->ready, thisScheduler->running);
-				thisScheduler->running = pq_dequeue(thisScheduler->ready);
+				yieldRunning(thisScheduler);
 				return 1;
 			} else {
-				printf("PID%d: requested lock on mutex M%d - succeeded\r\n", 
+				trace("PID%d: requested lock on mutex M%d - succeeded\r\n", 
 					thisScheduler->running->pid, currMutex->mid);
 			}
 		} else {
 			toStringMutexMap(thisScheduler->mutexes);
-			printf("\r\n\t\t\tcurrMutex was null!!!\r\n\r\n");
+			trace("\r\n\t\t\tcurrMutex was null!!!\r\n\r\n");
 			exit(0);
 		}
-		printf("\n");
+		trace("\n");
 	} else if (unlock) {
-		printf("unlock values for R1 of P%d:\n", thisScheduler->running->pid);
+		trace("unlock values for R1 of P%d:\n", thisScheduler->running->pid);
 		printPCLocations(thisScheduler->running->unlockR1);
 		if (thisScheduler->running->role == SHARED) {
-			printf("unlock values for R2 of P%d:\n", thisScheduler->running->pid);
+			trace("unlock values for R2 of P%d:\n", thisScheduler->running->pid);
 			printPCLocations(thisScheduler->running->unlockR2);	
 		}
 		
 		if (unlock == 1) { //is mutex_R1_id
-			printf("Getting the Mutex for R1\n");
+			trace("Getting the Mutex for R1\n");
 			currMutex = get_mutx(thisScheduler->mutexes, thisScheduler->running->mutex_R1_id);
 		} else { //is mutex_R2_id
-			printf("Getting the Mutex for R2\n");
+			trace("Getting the Mutex for R2\n");
 			currMutex = get_mutx(thisScheduler->mutexes, thisScheduler->running->mutex_R2_id);
 		}
 		
 		if (currMutex) {
-			printf("Trying to use Mutex\n");
+			trace("Trying to use Mutex\n");
 			int result = mutex_unlock (currMutex, thisScheduler->running);
 			if(result == 1)
 			{
-				printf("M%d unlocked at PC %d\n", currMutex->mid, thisScheduler->running->context->pc);
+				trace("M%d unlocked at PC %d\n", currMutex->mid, thisScheduler->running->context->pc);
 			} 
 			else if (result == 2)
 			{
-				printf("Unlock failed, M%d is already owned and locked by P%d!\n", currMutex->mid, currMutex->hasLock->pid);
+				trace("Unlock failed, M%d is already owned and locked by P%d!\n", currMutex->mid, currMutex->hasLock->pid);
 			}
 		} else {
-			printf("\r\n\t\t\tcurrMutex was null!!!\r\n\r\n");
+			trace("\r\n\t\t\tcurrMutex was null!!!\r\n\r\n");
 			exit(0);
 		}
-		printf("\n");
+		trace("\n");
 	} else if (signal) {
-		printf("signal values for R1 of P%d:\n", thisScheduler->running->pid);
+		trace("signal values for R1 of P%d:\n", thisScheduler->running->pid);
 		printPCLocations(thisScheduler->running->signal_cond);
 		
 		currMutex = get_mutx(thisScheduler->mutexes, thisScheduler->running->mutex_R1_id);
 		
 		if (currMutex) {
 			cond_var_signal (currMutex->condVar);
-			printf("M%d condition variable signalled at PC %d\n", currMutex->mid, thisScheduler->running->context->pc);
+			trace("M%d condition variable signalled at PC %d\n", currMutex->mid, thisScheduler->running->context->pc);
 			
 			incrementPair++;
-			printf("Producer %d incremented incrementPair: %d\r\n", thisScheduler->running->pid, incrementPair);			
+			trace("Producer %d incremented incrementPair: %d\r\n", thisScheduler->running->pid, incrementPair);			
 		} else {
-			printf("\r\n\t\t\tcurrMutex was null!!!\r\n\r\n");
+			trace("\r\n\t\t\tcurrMutex was null!!!\r\n\r\n");
 			exit(0);
 		}
-		printf("\n");
+		trace("\n");
 	} else if (wait) {
-		printf("wait values for R1 of P%d:\n", thisScheduler->running->pid);
+		trace("wait values for R1 of P%d:\n", thisScheduler->running->pid);
 		printPCLocations(thisScheduler->running->wait_cond);
 		
 		currMutex = get_mutx(thisScheduler->mutexes, thisScheduler->running->mutex_R1_id);
@@ -1235,19 +2502,18 @@ int useMutex (Scheduler thisScheduler) {
 		if (currMutex) {
 			int isWaiting = cond_var_wait (currMutex->condVar);
 			if (isWaiting) { //enqueue PCB back into MLFQ so its Producer partner can call a signal, this simulates the waiting
-				pq_enqueue(thisScheduler->ready, thisScheduler->running);
-				thisScheduler->running = pq_dequeue(thisScheduler->ready);
-				printf("Consumer %d read incrementPair: %d\r\n", thisScheduler->running->pid, incrementPair);
-				printf("M%d condition variable waiting at PC %d\n\n", currMutex->mid, thisScheduler->running->context->pc);
+				trace("Consumer %d read incrementPair: %d\r\n", thisScheduler->running->pid, incrementPair);
+				trace("M%d condition variable waiting at PC %d\n\n", currMutex->mid, thisScheduler->running->context->pc);
+				yieldRunning(thisScheduler);
 				return 1;
 			} else { //this part resets the condition variable so we don't need to keep making a new one
 				cond_var_init(currMutex->condVar);
 			}
 		} else {
-			printf("\r\n\t\t\tcurrMutex was null!!!\r\n\r\n");
+			trace("\r\n\t\t\tcurrMutex was null!!!\r\n\r\n");
 			exit(0);
 		}
-		printf("\n");
+		trace("\n");
 	}
 	
 	return 0;
@@ -1265,7 +2531,7 @@ int useMutex (Scheduler thisScheduler) {
 */
 void handleKilledQueueInsertion (Scheduler theScheduler) {
 	Mutex mutex1 = NULL, mutex2 = NULL;
-	PCB found = NULL;
+	PCB found = NULL, partner = NULL;
 	
 	if (theScheduler->interrupted->role == PAIR || theScheduler->interrupted->role == SHARED) {
 		mutex1 = take_n_remove_from_mutx_map(theScheduler->mutexes, theScheduler->interrupted->mutex_R1_id);
@@ -1274,35 +2540,43 @@ void handleKilledQueueInsertion (Scheduler theScheduler) {
 		}
 		if (!mutex1) {
 			toStringMutexMap(theScheduler->mutexes);
-			printf("\r\n\t\t\tmutex1 was null! Tried to find M%d but it wasn't in the map!!!\r\n\r\n", theScheduler->running->mutex_R1_id);
+			trace("\r\n\t\t\tmutex1 was null! Tried to find M%d but it wasn't in the map!!!\r\n\r\n", theScheduler->interrupted->mutex_R1_id);
 			exit(0);
 		}
 		
 		if (theScheduler->interrupted->role == SHARED && !mutex2) {
 			toStringMutexMap(theScheduler->mutexes);
-			printf("\r\n\t\t\tmutex2 was null! Tried to find M%d but it wasn't in the map!!!\r\n\r\n", theScheduler->running->mutex_R2_id);
+			trace("\r\n\t\t\tmutex2 was null! Tried to find M%d but it wasn't in the map!!!\r\n\r\n", theScheduler->interrupted->mutex_R2_id);
 			exit(0);
 		}
 		
 		if (theScheduler->interrupted->role == SHARED) { //if the role is SHARED then I want to check if mutex2 is NULL
 			if (mutex1 && mutex2 && mutex1->pcb2 == theScheduler->interrupted) { //if interrupted is the pcb2 in the mutex, find the matching pcb1
-				printf("looking for pcb1\n");
-				found = pq_remove_matching_pcb(theScheduler->ready, mutex1->pcb1);
+				trace("looking for pcb1\n");
+				partner = mutex1->pcb1;
 			} else { //otherwise the interrupted is pcb1, so find pcb2
-				printf("looking for pcb2\n");
-				found = pq_remove_matching_pcb(theScheduler->ready, mutex1->pcb2);
+				trace("looking for pcb2\n");
+				partner = mutex1->pcb2;
 			}
 		} else { //if the role is PAIR then I don't want to check if mutex2 is NULL because it will always be NULL
 			if (mutex1 && mutex1->pcb2 == theScheduler->interrupted) {
-				found = pq_remove_matching_pcb(theScheduler->ready, mutex1->pcb1);
+				partner = mutex1->pcb1;
 			} else { 
-				found = pq_remove_matching_pcb(theScheduler->ready, mutex1->pcb2);
+				partner = mutex1->pcb2;
 			}
 		}
+		if (partner && partner->location == LOC_READY) { //the PCB table says where the partner is, so no container is searched
+			found = policy_remove(theScheduler->ready, partner);
+		}
 		
-		q_enqueue(theScheduler->killed, theScheduler->interrupted);
-		if (found && !q_contains(theScheduler->killed, found)) { //if found is null then the partnering pcb is already in the killed queue
-			q_enqueue(theScheduler->killed, found);
+		moveToQueue(theScheduler->killed, theScheduler->interrupted, LOC_KILLED);
+		if (found) {
+			moveToQueue(theScheduler->killed, found, LOC_KILLED);
+		} else if (partner && partner != theScheduler->interrupted && partner->location != LOC_KILLED) { 
+			//the partner is blocked or waiting in the inbox, so it can't be pulled out here.
+			//Its Mutexes are about to be freed, so it carries on as a plain COMP process
+			trace("P%d lost its partner, continuing as COMP\r\n", partner->pid);
+			partner->role = COMP;
 		}
 		
 		q_enqueue_m(theScheduler->killedMutexes, mutex1);
@@ -1311,7 +2585,7 @@ void handleKilledQueueInsertion (Scheduler theScheduler) {
 			q_enqueue_m(theScheduler->killedMutexes, mutex2);
 		}
 	} else {
-		q_enqueue(theScheduler->killed, theScheduler->interrupted);
+		moveToQueue(theScheduler->killed, theScheduler->interrupted, LOC_KILLED);
 	}
 	
 	theScheduler->interrupted = NULL;
@@ -1319,76 +2593,54 @@ void handleKilledQueueInsertion (Scheduler theScheduler) {
 
 
 /*
-	Handles emptying both the killed PCB queue and killed Mutexes queue. 
-	It prints out the results as it goes along.
+	Moves every node of *from onto the end of *to, leaving *from empty. When *to is 
+	already empty the two queues are just swapped, which takes constant time and keeps
+	each node's queue pointer right. Otherwise q_concat moves the nodes one at a time.
 */
-void handleKilledQueueEmptying (Scheduler theScheduler) {
-	
-	//PCB emptying
-	printf("Emptying Killed queue\r\n");
-	PCB toKill = NULL;
-	if (!(theScheduler->killed)) {
-		printf("\r\n\t\t\tkilled PCB queue is NULL!\r\n\r\n");
-		exit(0);
-	}
+void handOverQueue (ReadyQueue * to, ReadyQueue * from) {
+	ReadyQueue empty = NULL;
 	
-	if (theScheduler->killed && !q_is_empty(theScheduler->killed)) {
-		while(!q_is_empty(theScheduler->killed)) {
-			printf("Killed List: ");
-			toStringReadyQueue(theScheduler->killed);
-			toKill = q_dequeue(theScheduler->killed);
-			if (toKill) {
-				printf("toKill: P%d\r\n", toKill->pid);
-				PCB_destroy(toKill);
-			} else {
-				printf("\r\n\t\t\ttoKill PCB was NULL while emptying queue!\r\n\r\n");
-				exit(0);
-			}			
-		} 
-	} else {
-		printf("Something went wrong while emptying Killed queue\n");
-		exit(0);
-	}
-	printf("After emptying\n");
-	printf("Killed List: ");
-	toStringReadyQueue(theScheduler->killed);
-	printf("is killed PCB list empty? ");
-	if (q_is_empty(theScheduler->killed)) {
-		printf("true\r\n");
+	if (q_is_empty(*to)) {
+		empty = *to;
+		*to = *from;
+		*from = empty;
 	} else {
-		printf("false\r\n");
+		q_concat(*to, *from);
 	}
+}
+
+
+/*
+	Hands both the killed PCB queue and killed Mutexes queue to the reclaimer thread.
+	Each PCB's frames, physical memory, table slot and PID are freed here, under the
+	schedulerMutex that guards them, so they can be reused straight away. The queues
+	are then swapped for the reclaimer's, which takes constant time unless it hasn't 
+	taken the last batch yet. The PCBs themselves are freed, and traced, by the 
+	reclaimer.
+*/
+void handleKilledQueueEmptying (Scheduler theScheduler) {
+	ReadyQueueNode node = NULL;
 	
-	
-	//Mutex emptying
-	printf("Emptying killed MUTEX list\r\n");
-	Mutex toKillMutex = NULL;
-	if (!(theScheduler->killedMutexes)) {
-		printf("\r\n\t\t\tkilled MUTEX queue is NULL!\r\n\r\n");
+	if (!(theScheduler->killed) || !(theScheduler->killedMutexes)) {
+		trace("\r\n\t\t\tkilled queue is NULL!\r\n\r\n");
 		exit(0);
 	}
 	
-	if (theScheduler->killedMutexes && !q_is_empty(theScheduler->killedMutexes)) {
-		while(!q_is_empty(theScheduler->killedMutexes)) {
-			printf("Killed List: ");
-			toStringReadyQueueMutexes(theScheduler->killedMutexes);
-			toKillMutex = q_dequeue_m(theScheduler->killedMutexes);
-			if (toKillMutex) {
-				printf("toKillMutex: M%d\r\n", toKillMutex->mid);
-				mutex_destroy(toKillMutex);
-			} else {
-				printf("\r\n\t\t\tin here toKill MUTEX was NULL!\r\n\r\n");
-				exit(0);
-			}			
-		} 
-	} else {
-		if (!(theScheduler->killedMutexes)) {
-			printf("Something went wrong while emptying Killed Mutex queue\n");
-			exit(0);
-		} else {
-			printf("Killed Mutex queue is empty.\n");
+	for (node = theScheduler->killed->first_node; node; node = node->next) {
+		if (vm) {
+			vm_release(vm, node->pcb);
 		}
+		pt_release(node->pcb);
+		PCB_release_PID(node->pcb);
+		PCB_release_memory(node->pcb);
+		node->pcb->location = LOC_NONE;
 	}
+	
+	lockMutex(RECLAIM_LOCK);
+		handOverQueue(&theScheduler->reclaimed, &theScheduler->killed);
+		handOverQueue(&theScheduler->reclaimedMutexes, &theScheduler->killedMutexes);
+		pthread_cond_signal(&reclaimCondVar);
+	unlockMutex(RECLAIM_LOCK);
 }
 
 /*
@@ -1402,13 +2654,16 @@ int deadlockMonitor(Scheduler thisScheduler) {
 	Mutex mutex1;
 	Mutex mutex2;
 	
+	if (thisScheduler->running == NULL) { //a yield can leave nothing running
+		return 0;
+	}
 	if (thisScheduler->running->role == SHARED) {
-		printf("got into SHARED for deadlockMonitor\n");
+		trace("got into SHARED for deadlockMonitor\n");
 		mutex1 = get_mutx(thisScheduler->mutexes, thisScheduler->running->mutex_R1_id);
 		mutex2 = get_mutx(thisScheduler->mutexes, thisScheduler->running->mutex_R2_id);
 		
 		
-		if (mutex1->pcb1 != NULL && mutex1->pcb2 != NULL && mutex2->pcb1 != NULL && mutex2->pcb2 != NULL) {
+		if (mutex1 && mutex2 && mutex1->pcb1 != NULL && mutex1->pcb2 != NULL && mutex2->pcb1 != NULL && mutex2->pcb2 != NULL) { //the partner may have been killed and its mutexes freed already
 			
 			
 			if (mutex1->isLocked && mutex2->isLocked) {
@@ -1416,40 +2671,40 @@ int deadlockMonitor(Scheduler thisScheduler) {
 				if (thisScheduler->running == mutex1->pcb1) { // check if pcb1 also owns the other lock
 					if (mutex2->hasLock == mutex1->hasLock) {
 					
-						printf("PCB%d owns M1 and M2\r\n", thisScheduler->running->pid);
-						printf("NO DEADLOCK DETECTED FOR PROCESSES PID%d & PID%d\r\n", mutex1->pcb1->pid, mutex1->pcb2->pid);
+						trace("PCB%d owns M1 and M2\r\n", thisScheduler->running->pid);
+						trace("NO DEADLOCK DETECTED FOR PROCESSES PID%d & PID%d\r\n", mutex1->pcb1->pid, mutex1->pcb2->pid);
 					} else if (mutex2->hasLock == mutex1->pcb2) {
 					
-						printf("PCB%d owns M1, failed to lock M2\r\n", thisScheduler->running->pid);
-						printf("DEADLOCK DETECTED FOR PROCESSES PID%d & PID%d\r\n", mutex1->pcb1->pid, mutex1->pcb2->pid);
+						trace("PCB%d owns M1, failed to lock M2\r\n", thisScheduler->running->pid);
+						trace("DEADLOCK DETECTED FOR PROCESSES PID%d & PID%d\r\n", mutex1->pcb1->pid, mutex1->pcb2->pid);
 						wasFound = 1;
 					} else if (mutex1->hasLock == mutex1->pcb2) {
 					
-						printf("PCB%d owns M2, failed to lock M1\r\n", thisScheduler->running->pid);
-						printf("DEADLOCK DETECTED FOR PROCESSES PID%d & PID%d\r\n", mutex1->pcb1->pid, mutex1->pcb2->pid);
+						trace("PCB%d owns M2, failed to lock M1\r\n", thisScheduler->running->pid);
+						trace("DEADLOCK DETECTED FOR PROCESSES PID%d & PID%d\r\n", mutex1->pcb1->pid, mutex1->pcb2->pid);
 						wasFound = 1;
 					}
 					
 				} else if (thisScheduler->running == mutex2->pcb2) { // check if pcb2 also owns the other lock
 					if (mutex1->hasLock == mutex2->hasLock) {
 						
-						printf("PCB%d owns M1 and M2\r\n", thisScheduler->running->pid);
-						printf("NO DEADLOCK DETECTED FOR PROCESSES PID%d & PID%d\r\n", mutex1->pcb1->pid, mutex1->pcb2->pid);
+						trace("PCB%d owns M1 and M2\r\n", thisScheduler->running->pid);
+						trace("NO DEADLOCK DETECTED FOR PROCESSES PID%d & PID%d\r\n", mutex1->pcb1->pid, mutex1->pcb2->pid);
 
 					} else if (mutex1->hasLock == mutex2->pcb1) {
 					
-						printf("PCB%d owns M2, failed to lock M1\r\n", thisScheduler->running->pid);
-						printf("DEADLOCK DETECTED FOR PROCESSES PID%d & PID%d\r\n", mutex1->pcb1->pid, mutex1->pcb2->pid);
+						trace("PCB%d owns M2, failed to lock M1\r\n", thisScheduler->running->pid);
+						trace("DEADLOCK DETECTED FOR PROCESSES PID%d & PID%d\r\n", mutex1->pcb1->pid, mutex1->pcb2->pid);
 						wasFound = 1;
 					} else if (mutex2->hasLock == mutex1->pcb1) {
 						
-						printf("PCB%d owns M1, failed to lock M2\r\n", thisScheduler->running->pid);
-						printf("DEADLOCK DETECTED FOR PROCESSES PID%d & PID%d\r\n", mutex1->pcb1->pid, mutex1->pcb2->pid);
+						trace("PCB%d owns M1, failed to lock M2\r\n", thisScheduler->running->pid);
+						trace("DEADLOCK DETECTED FOR PROCESSES PID%d & PID%d\r\n", mutex1->pcb1->pid, mutex1->pcb2->pid);
 						wasFound = 1;
 					}		
 				}
 			} else {
-				printf("NO DEADLOCK DETECTED FOR PROCESSES PID%d & PID%d\r\n", mutex1->pcb1->pid, mutex1->pcb2->pid);
+				trace("NO DEADLOCK DETECTED FOR PROCESSES PID%d & PID%d\r\n", mutex1->pcb1->pid, mutex1->pcb2->pid);
 			}
 			
 		}	
@@ -1457,22 +2712,17 @@ int deadlockMonitor(Scheduler thisScheduler) {
 	if (wasFound) {
 			deadlockCount++;
 			
-			thisScheduler->running->term_count = thisScheduler->running->terminate;
+			PCB_set_term_count(thisScheduler->running, thisScheduler->running->terminate);
 			
 			if (thisScheduler->running == mutex1->pcb1) {
-				mutex1->pcb2->term_count = mutex1->pcb2->terminate;
-				mutex1->pcb2->state = STATE_HALT;
-				 
+				PCB_set_term_count(mutex1->pcb2, mutex1->pcb2->terminate);
 			} else {
-				mutex1->pcb1->term_count = mutex1->pcb1->terminate;
-				mutex1->pcb1->state = STATE_HALT;
+				PCB_set_term_count(mutex1->pcb1, mutex1->pcb1->terminate);
 			}
 			
-			remove_from_mutx_map(thisScheduler->mutexes, thisScheduler->running->mutex_R1_id);
-			remove_from_mutx_map(thisScheduler->mutexes, thisScheduler->running->mutex_R2_id);
-			
-			dispatcher(thisScheduler);
-			
+			//kills the running PCB now, before it can block on the lock again. Killing it
+			//takes the partner out of the ready set and retires both Mutexes with it
+			terminate(thisScheduler);
 		}
 	}
 	
@@ -17,18 +17,32 @@
 //includes
 #include "priority_queue.h"
 #include "mutex_map.h"
+#include "timer_wheel.h"
+#include "sched_policy.h"
+#include "lf_queue.h"
+#include "trap_match.h"
+#include "bench.h"
+#include "lock_profile.h"
+#include "checkpoint.h"
+#include "workload.h"
+#include "virtual_memory.h"
+#include "phys_mem.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <pthread.h>
 #include <unistd.h>
+#include <sched.h>
+#include <sys/wait.h>
 
 
 //defines
 #define MAX_PCB_TOTAL 300
 #define MAX_ITERATION_TOTAL 100000
-#define RESET_COUNT 20000
+#define AGING_INTERVAL 100
+#define INBOX_CAPACITY 1024
+#define MAX_DEVICES 64
 #define MAKE_PCBS 10
 #define MAX_MUTEX_IN_ROUND 3
 #define MAX_PC_JUMP 4000
@@ -52,17 +66,75 @@
 #define DEADLOCK 1
 #define DEADLOCK_CHANCE_DOMAIN 100
 #define DEADLOCK_CHANCE_PERCENTAGE 100
-
+#define MAX_WHATIF_CHILDREN 16
+#define WHATIF_TRACE "whatif" // what-if traces go to whatif.parent.log and whatif.<child>.log
+#define DISK_LATENCY 50 // iterations the disk takes to read in a faulting page
+#define TLB_ENTRIES 16
+#define WS_WINDOW 2000 // references a page stays in the working set for
+#define ADMIT_BACKLOG 32 // new PCBs admission control holds back before it rejects arrivals
+#define LATENCY_WEIGHT 8 // the recent dispatch latency moves 1/LATENCY_WEIGHT of the way to each dispatch's
+
+//every mutex is taken through its lock profile so the call site is recorded
+#define lockMutex(which) lp_lock(&lockProfiles[which], __func__, __LINE__)
+#define unlockMutex(which) lp_unlock(&lockProfiles[which])
+#define waitCondition(cond, which) lp_cond_wait(&lockProfiles[which], cond, __func__, __LINE__)
+#define lockScheduler() lockMutex(SCHEDULER_LOCK)
+#define unlockScheduler() unlockMutex(SCHEDULER_LOCK)
+
+
+
+//enums
+enum sim_lock {
+	SCHEDULER_LOCK,
+	RAND_LOCK,
+	PRINT_LOCK,
+	TOTAL_PROCESSES_LOCK,
+	TRAP_LOCK,
+	INTERRUPT_LOCK,
+	RECLAIM_LOCK,
+	LOCK_COUNT
+};
+
+extern lock_profile_s lockProfiles[LOCK_COUNT];
 
 
 //structs
+
+/* The tunables a run can change without rebuilding, see parseSimParams. */
+typedef struct sim_params {
+	unsigned int agingInterval; // iterations between the policy's periodic boosts
+	unsigned int quantumPercent; // every quantum the policy hands out is scaled by this
+	int deadlockChance; // out of DEADLOCK_CHANCE_DOMAIN, how often a SHARED pair is set up to deadlock
+	int ioChance; // out of IO_INT_CHANCE_DOMAIN, the per iteration chance an I/O request completes
+	int arrivalChance; // out of MAKE_PCB_CHANCE_DOMAIN, the per iteration chance new PCBs arrive
+	unsigned int frames; // physical frames of virtual memory, 0 runs without it
+	unsigned int tlbEntries;
+	int replacement; // the page replacement policy, see vm_policy
+	unsigned int diskLatency; // iterations a page fault blocks for, not counting the disk's queue
+	unsigned int wsWindow; // the working set window for the ws policy, in references
+	unsigned int memoryUnits; // units of physical memory PCBs are given footprints from, 0 runs without it
+	int allocator; // how it is allocated, see pm_policy
+	unsigned int maxReady; // admission control holds new PCBs back while the ready set is this deep, 0 for no limit
+	unsigned int maxBlocked; // or while this many are blocked
+	unsigned int maxLatency; // or while the recent dispatch latency is this many iterations
+	unsigned int backlog; // PCBs it holds back before new arrivals are rejected
+} sim_params_s;
+
+extern sim_params_s simParams;
+
 typedef struct scheduler {
 	ReadyQueue created;
 	ReadyQueue killed;
 	ReadyQueue blocked;
 	ReadyQueue killedMutexes;
+	ReadyQueue reclaimed; // killed PCBs handed to the reclaimer, guarded by the reclaimMutex
+	ReadyQueue reclaimedMutexes; // and their Mutexes
 	MutexMap mutexes;
-	PriorityQueue ready;
+	SchedPolicy ready;
+	LFQueue inbox; // woken and newly admitted PCBs waiting to join the ready set, only ioInterrupt posts to it without the schedulerMutex
+	LFQueue ioDone; // PCBs whose I/O has completed, waiting for ioInterrupt, filled by fireTimers under the schedulerMutex
+	TimerWheel timers;
+	TimerEvent quantumEvent;
 	PCB running;
 	PCB interrupted;
 	int isNew;
@@ -72,8 +144,26 @@ typedef scheduler_s * Scheduler;
 
 
 //declarations
+void moveToQueue (ReadyQueue queue, PCB pcb, enum pcb_location location);
+
 int makePCBList (Scheduler);
 
+void admitCreated (Scheduler theScheduler);
+
+int admissionOpen (Scheduler theScheduler, unsigned int depth);
+
+int admissionRejects (Scheduler theScheduler, int count);
+
+void enqueueReady (Scheduler theScheduler, PCB pcb);
+
+int makeWorkloadPCBs (Scheduler theScheduler, WorkloadRecord record);
+
+int admitWorkload (Scheduler theScheduler);
+
+void scheduleArrivals (Scheduler theScheduler);
+
+void checkpointWorkload (Checkpoint ckpt);
+
 unsigned int runProcess (unsigned int, int);
 
 void pseudoISR (Scheduler, int);
@@ -82,6 +172,8 @@ void scheduling (int, Scheduler);
 
 void dispatcher (Scheduler);
 
+void yieldRunning (Scheduler theScheduler);
+
 void pseudoIRET (Scheduler);
 
 void printSchedulerState (Scheduler);
@@ -94,43 +186,84 @@ int isPrivileged(PCB pcb);
 
 void terminate(Scheduler theScheduler);
 
-void resetMLFQ(Scheduler theScheduler);
-
-void resetReadyQueue (ReadyQueue queue);
 
 void osLoop ();
 
+int runBenchmark (int argc, char * argv[]);
+
+int runScalePoint (int threads, unsigned int seed, bench_scale_point_s * point);
+
+int runScalingBenchmark (int argc, char * argv[]);
+
+void waitForQuiescence (Scheduler theScheduler);
+
+int checkpointScheduler (Scheduler theScheduler, Checkpoint ckpt);
+
+int saveCheckpoint (Scheduler theScheduler, const char * path);
+
+int restoreCheckpoint (Scheduler theScheduler, const char * path);
+
+int parseSimParams (const char * spec, sim_params_s * params);
+
+void applyMemoryParams ();
+
+int runWhatIf (int argc, char * argv[]);
+
+void readWhatIfCounters (bench_whatif_s * counters);
+
+int forkWhatIfs ();
+
+int startHelperThreads (pthread_t threads[], Scheduler theScheduler);
+
+void initLockProfiles ();
+
+void requestShutdown ();
+
 void * timerInterrupt (void *);
 
 void * ioTrap (void *);
 
 void * ioInterrupt (void *);
 
+void * reclaimer (void *);
+
+unsigned int sampleGeometric (int domain, int percentage);
+
+unsigned int sampleIOServiceTime ();
+
+void armQuantum (Scheduler theScheduler);
+
+void scheduleIOCompletion (Scheduler theScheduler, PCB pcb);
+
+void fireTimers (Scheduler theScheduler);
+
+void postToInbox (Scheduler theScheduler, PCB pcb, int holdsLock);
+
+void drainInbox (Scheduler theScheduler);
+
 void incrementRoleCount (enum pcb_type);
 
 void displayRoleCountResults();
 
 void handleKilledQueueInsertion (Scheduler theScheduler);
 
+void handOverQueue (ReadyQueue * to, ReadyQueue * from);
+
 void handleKilledQueueEmptying (Scheduler theScheduler);
 
 void lockAttempt(Scheduler theScheduler, int trapVal);
 
 void unlockAttempt(Scheduler theScheduler, int trapVal);
 
-int useMutex (Scheduler thisScheduler);
-
-int isLockPC (unsigned int pc, PCB pcb);
-
-int isUnlockPC (unsigned int pc, PCB pcb);
+int useMutex (Scheduler thisScheduler, unsigned int traps);
 
-int isSignalPC (unsigned int pc, PCB pcb);
+int trapResource (unsigned int mask, unsigned int r1Bit, unsigned int r2Bit, PCB pcb);
 
-int isWaitPC (unsigned int pc, PCB pcb);
+unsigned int runningTraps (Scheduler theScheduler);
 
 int deadlockMonitor (Scheduler thisScheduler);
 
-int countRemainingProcesses(PriorityQueue pq);
+int countRemainingProcesses(SchedPolicy policy);
 
 int countRemainingProcessesInQueue(ReadyQueue queue);
 
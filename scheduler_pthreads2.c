@@ -13,11 +13,20 @@
 
 #include "scheduler_pthreads.h"
 
+#define RESET_COUNT 20000 // this copy still resets the whole MLFQ this often instead of aging it
+
+void resetMLFQ (Scheduler theScheduler);
+
+void resetReadyQueue (ReadyQueue queue);
+
+int countRemainingInMLFQ (PriorityQueue pq);
+
 
 unsigned int sysstack;
 int switchCalls;
 
 Scheduler thisScheduler;
+PriorityQueue mlfq; // this copy's ready set, the Scheduler's ready field is for scheduler_pthreads.c's policies
 
 PCB privileged[4];
 int privilege_counter = 0;
@@ -263,11 +272,11 @@ int makePCBList (Scheduler theScheduler) {
 			PCB nextPCB = q_dequeue(theScheduler->created);
 			nextPCB->state = STATE_READY;
 			printf("Enqueuing newly created P%d into MLFQ\n", nextPCB->pid);
-			pq_enqueue(theScheduler->ready, nextPCB);
+			pq_enqueue(mlfq, nextPCB);
 		}
 		
 		if (theScheduler->isNew) {
-			theScheduler->running = pq_dequeue(theScheduler->ready);
+			theScheduler->running = pq_dequeue(mlfq);
 			
 			pthread_mutex_lock(&printMutex);
 			printf("Dequeuing to run\n");
@@ -355,7 +364,7 @@ void printSchedulerState (Scheduler theScheduler) {
 	
 	printf("\r\nMLFQ State\r\n");
 	printf("iteration: %d\r\n", iteration);
-	toStringPriorityQueue(theScheduler->ready);
+	toStringPriorityQueue(mlfq);
 	printf("\r\n");
 	
 	int index = 0;
@@ -368,7 +377,7 @@ void printSchedulerState (Scheduler theScheduler) {
 	toStringReadyQueueMutexes(theScheduler->killedMutexes);
 	printf("\r\n");
 	
-	if (pq_peek(theScheduler->ready) != NULL) {
+	if (pq_peek(mlfq) != NULL) {
 		printf("Going to be running ");
 		if (theScheduler->running) {
 			toStringPCB(theScheduler->running, 0);
@@ -376,7 +385,7 @@ void printSchedulerState (Scheduler theScheduler) {
 			printf("\r\n\r\n");
 		}
 		printf("Next highest priority PCB ");
-		toStringPCB(pq_peek(theScheduler->ready), 0);
+		toStringPCB(pq_peek(mlfq), 0);
 		printf("\r\n\r\n\r\n");
 	} else {
 		
@@ -404,22 +413,16 @@ void resetMLFQ (Scheduler theScheduler) {
 	
 	printf("\r\n\r\nRESETTING MLFQ\r\n\r\n");
 	
-	if (!pq_is_empty(theScheduler->ready)) { //if the MLFQ isn't empty, then reset it
+	if (!pq_is_empty(mlfq)) { //if the MLFQ isn't empty, then reset it
 		allEmpty = 0;
 		for (int i = 1; i < NUM_PRIORITIES; i++) {
-			ReadyQueue curr = theScheduler->ready->queues[i];
+			ReadyQueue curr = mlfq->queues[i];
 			if (!q_is_empty(curr)) {
-				if (!q_is_empty(theScheduler->ready->queues[0])) {
-					theScheduler->ready->queues[0]->last_node->next = curr->first_node;
-					theScheduler->ready->queues[0]->last_node = curr->last_node;
-					theScheduler->ready->queues[0]->size += curr->size;
+				if (!q_is_empty(mlfq->queues[0])) {
 					allEmpty = 0;
-				} else {
-					theScheduler->ready->queues[0]->first_node = curr->first_node;
-					theScheduler->ready->queues[0]->last_node = curr->last_node;
-					theScheduler->ready->queues[0]->size = curr->size;
 				}
 				resetReadyQueue(curr);
+				q_concat(mlfq->queues[0], curr);
 			}
 		}
 	}
@@ -431,17 +434,14 @@ void resetMLFQ (Scheduler theScheduler) {
 
 
 /*
-	Resets the given ReadyQueue to be empty.
+	Sets every PCB in the given ReadyQueue back to the highest priority.
 */
 void resetReadyQueue (ReadyQueue queue) {
 	ReadyQueueNode ptr = queue->first_node;
 	while (ptr) {
-		ptr->pcb->priority = 0;
+		PCB_assign_priority(ptr->pcb, 0); //keeps the PCB table's copy of the priority in step
 		ptr = ptr->next;
 	}
-	queue->first_node = NULL;
-	queue->last_node = NULL;
-	queue->size = 0;
 }
 
 
@@ -471,7 +471,7 @@ void scheduling (int interrupt_code, Scheduler theScheduler) {
 			theScheduler->interrupted->state = STATE_READY;
 			theScheduler->interrupted->priority = (theScheduler->interrupted->priority + 1) % NUM_PRIORITIES;
 			tmp = theScheduler->interrupted;
-			pq_enqueue(theScheduler->ready, theScheduler->interrupted);
+			pq_enqueue(mlfq, theScheduler->interrupted);
 			if (tmp == NULL) {
 				printf("tmp NULL after pq_enqueue!\n");
 				exit(0);
@@ -514,7 +514,7 @@ void scheduling (int interrupt_code, Scheduler theScheduler) {
 		toStringPCB(q_peek(theScheduler->blocked), 0);
 		PCB theBlocked = q_dequeue(theScheduler->blocked);
 		theBlocked->state = STATE_READY;
-		pq_enqueue(theScheduler->ready, theBlocked);
+		pq_enqueue(mlfq, theBlocked);
 		if (theScheduler->interrupted != NULL)
 		{
 			theScheduler->running = theScheduler->interrupted;
@@ -551,8 +551,8 @@ void scheduling (int interrupt_code, Scheduler theScheduler) {
 	running state of the Scheduler.
 */
 void dispatcher (Scheduler theScheduler) {
-	if (pq_peek(theScheduler->ready) != NULL && pq_peek(theScheduler->ready)->state != STATE_HALT) {
-		theScheduler->running = pq_dequeue(theScheduler->ready);
+	if (pq_peek(mlfq) != NULL && pq_peek(mlfq)->state != STATE_HALT) {
+		theScheduler->running = pq_dequeue(mlfq);
 		
 		pthread_mutex_lock(&printMutex);
 			printf("\r\nDequeueing to run\r\n");
@@ -591,7 +591,8 @@ Scheduler schedulerConstructor () {
 	newScheduler->blocked = q_create();
 	newScheduler->killedMutexes = q_create();
 	newScheduler->mutexes = create_mutx_map();
-	newScheduler->ready = pq_create();
+	newScheduler->ready = NULL;
+	mlfq = pq_create();
 	newScheduler->running = NULL;
 	newScheduler->interrupted = NULL;
 	newScheduler->isNew = 1;
@@ -615,9 +616,10 @@ void schedulerDeconstructor (Scheduler theScheduler) {
 
 	if (theScheduler) {
 		
-		if (theScheduler->ready) {
-			remainingProcesses = countRemainingProcesses(theScheduler->ready);
-			pq_destroy(theScheduler->ready);
+		if (mlfq) {
+			remainingProcesses = countRemainingInMLFQ(mlfq);
+			pq_destroy(mlfq);
+			mlfq = NULL;
 		}
 		
 		if (theScheduler->created) {
@@ -779,7 +781,7 @@ void osLoop () {
 		if (isRunning) {
 			pthread_mutex_lock(&schedulerMutex);
 				if (scheduler && scheduler->running && (scheduler->running->role == PAIR || scheduler->running->role == SHARED)) {
-					isSwitched = useMutex(scheduler); //handles the locking/unlocking
+					isSwitched = useMutex(scheduler, 0); //handles the locking/unlocking
 					
 					if (isSwitched) {
 						contextSwitchCount++;
@@ -1040,7 +1042,7 @@ void * timerInterrupt(void * theScheduler)
 			pthread_mutex_lock(&printMutex);
 				printSchedulerState(scheduler);
 			pthread_mutex_unlock(&printMutex);
-			currQuantumSize = getNextQuantumSize(scheduler->ready); //sets the quantum for the sleep amount
+			currQuantumSize = getNextQuantumSize(mlfq); //sets the quantum for the sleep amount
 		pthread_mutex_unlock(&schedulerMutex);
 		
 		pthread_mutex_lock(&iterationMutex);
@@ -1063,7 +1065,7 @@ void * timerInterrupt(void * theScheduler)
 	Counts the remaining Processes in the MLFQ. It does so by dequeueing
 	so it needs to also free.
 */
-int countRemainingProcesses(PriorityQueue pq) {
+int countRemainingInMLFQ(PriorityQueue pq) {
 	int remaining = 0;
 	while (!pq_is_empty(pq)) {
 		PCB getting = pq_dequeue(pq);
@@ -1129,8 +1131,9 @@ int countRemainingProcessesInMutexQueue(ReadyQueue queue) {
 	into the MLFQ and set the running to the MLFQ dequeue. This happens for lock and wait.
 	
 	Returns 1 if a context switched happen so the osLoop knows to start over, otherwise 0.
+	The traps mask is ignored, this copy still looks through each trap array itself.
 */
-int useMutex (Scheduler thisScheduler) {	
+int useMutex (Scheduler thisScheduler, unsigned int traps) {	
 	int wait = 0, signal = 0; 
 	int lock = isLockPC(thisScheduler->running->context->pc, thisScheduler->running);
 	int unlock = isUnlockPC(thisScheduler->running->context->pc, thisScheduler->running);
@@ -1167,8 +1170,8 @@ int useMutex (Scheduler thisScheduler) {
 			if (currMutex->hasLock != thisScheduler->running) {
 				printf("PID%d: requested lock on mutex M%d - blocked by PID%d\r\n", 
 					thisScheduler->running->pid, currMutex->mid, currMutex->hasLock->pid);
-				pq_enqueue(thisScheduler->ready, thisScheduler->running);
-				thisScheduler->running = pq_dequeue(thisScheduler->ready);
+				pq_enqueue(mlfq, thisScheduler->running);
+				thisScheduler->running = pq_dequeue(mlfq);
 				return 1;
 			} else {
 				printf("PID%d: requested lock on mutex M%d - succeeded\r\n", 
@@ -1238,8 +1241,8 @@ int useMutex (Scheduler thisScheduler) {
 		if (currMutex) {
 			int isWaiting = cond_var_wait (currMutex->condVar);
 			if (isWaiting) { //enqueue PCB back into MLFQ so its Producer partner can call a signal, this simulates the waiting
-				pq_enqueue(thisScheduler->ready, thisScheduler->running);
-				thisScheduler->running = pq_dequeue(thisScheduler->ready);
+				pq_enqueue(mlfq, thisScheduler->running);
+				thisScheduler->running = pq_dequeue(mlfq);
 				printf("Consumer %d read incrementPair: %d\r\n", thisScheduler->running->pid, incrementPair);
 				printf("M%d condition variable waiting at PC %d\n\n", currMutex->mid, thisScheduler->running->context->pc);
 				return 1;
@@ -1290,16 +1293,16 @@ void handleKilledQueueInsertion (Scheduler theScheduler) {
 		if (theScheduler->interrupted->role == SHARED) { //if the role is SHARED then I want to check if mutex2 is NULL
 			if (mutex1 && mutex2 && mutex1->pcb2 == theScheduler->interrupted) { //if interrupted is the pcb2 in the mutex, find the matching pcb1
 				printf("looking for pcb1\n");
-				found = pq_remove_matching_pcb(theScheduler->ready, mutex1->pcb1);
+				found = pq_remove_matching_pcb(mlfq, mutex1->pcb1);
 			} else { //otherwise the interrupted is pcb1, so find pcb2
 				printf("looking for pcb2\n");
-				found = pq_remove_matching_pcb(theScheduler->ready, mutex1->pcb2);
+				found = pq_remove_matching_pcb(mlfq, mutex1->pcb2);
 			}
 		} else { //if the role is PAIR then I don't want to check if mutex2 is NULL because it will always be NULL
 			if (mutex1 && mutex1->pcb2 == theScheduler->interrupted) {
-				found = pq_remove_matching_pcb(theScheduler->ready, mutex1->pcb1);
+				found = pq_remove_matching_pcb(mlfq, mutex1->pcb1);
 			} else { 
-				found = pq_remove_matching_pcb(theScheduler->ready, mutex1->pcb2);
+				found = pq_remove_matching_pcb(mlfq, mutex1->pcb2);
 			}
 		}
 		
@@ -0,0 +1,382 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	The proportional share policies. Every PCB holds tickets based on its priority and
+	role, and should get a share of the CPU equal to its share of the tickets. Lottery
+	scheduling draws a random ticket each time, using a Fenwick tree to find the
+	holder. Stride scheduling is the deterministic version, each PCB's pass value
+	moves forward by its stride for every iteration it runs and the lowest pass, kept
+	at the top of a min-heap, runs next. Both print how far the CPU time the ready
+	PCBs have received is from their ticket share.
+*/
+
+#include "share_policy.h"
+
+typedef struct lottery_data {
+	FenwickTree tree;
+	PCB winner; // the result of the last draw, until the ready set changes
+	unsigned int seed;
+} lottery_data_s;
+
+typedef lottery_data_s * LotteryData;
+
+typedef struct stride_data {
+	PCBHeap heap;
+	unsigned long long global_pass; // the lowest pass handed out so far, never moves back
+} stride_data_s;
+
+typedef stride_data_s * StrideData;
+
+
+unsigned int share_tickets (PCB pcb) {
+	unsigned int tickets = SHARE_BASE_TICKETS * (NUM_PRIORITIES - (pcb->priority < NUM_PRIORITIES ? pcb->priority : NUM_PRIORITIES - 1));
+	
+	if (pcb->role == IO) {
+		tickets *= SHARE_IO_MULTIPLIER;
+	}
+	
+	return tickets;
+}
+
+
+/*
+	Adds the time the PCB has run since it was dispatched to its run_time.
+	
+	Return: the iterations it ran, 0 if it wasn't running.
+*/
+unsigned int share_charge (SchedPolicy policy, PCB pcb) {
+	unsigned int ran = 0;
+	
+	if (pcb->exec_start != (unsigned int) -1) {
+		if (policy->clock > pcb->exec_start) {
+			ran = policy->clock - pcb->exec_start;
+		}
+		pcb->run_time += ran;
+		pcb->exec_start = -1;
+	}
+	
+	return ran;
+}
+
+
+unsigned int share_quantum (SchedPolicy policy, PCB pcb) {
+	return SHARE_QUANTUM;
+}
+
+
+void share_on_block (SchedPolicy policy, PCB pcb) {
+	share_charge(policy, pcb);
+}
+
+
+/*
+	Compares the CPU time each ready PCB has received against its share of the
+	tickets held by the ready PCBs, and prints the mean and largest difference.
+	Empty slots in pcbs are skipped.
+*/
+void share_report (PCB * pcbs, int count) {
+	unsigned long long totalTickets = 0, totalRun = 0;
+	double achieved = 0, target = 0, deviation = 0, sum = 0, largest = 0;
+	int n = 0;
+	
+	for (int i = 0; i < count; i++) {
+		if (pcbs[i]) {
+			totalTickets += pcbs[i]->tickets;
+			totalRun += pcbs[i]->run_time;
+			n++;
+		}
+	}
+	if (!n || !totalTickets || !totalRun) {
+		trace("Share deviation: no CPU time given out yet\r\n");
+		return;
+	}
+	
+	for (int i = 0; i < count; i++) {
+		if (pcbs[i]) {
+			achieved = (double) pcbs[i]->run_time / totalRun;
+			target = (double) pcbs[i]->tickets / totalTickets;
+			deviation = achieved > target ? achieved - target : target - achieved;
+			sum += deviation;
+			if (deviation > largest) {
+				largest = deviation;
+			}
+		}
+	}
+	trace("Share deviation over %d PCBs: mean %.2f%%, max %.2f%%\r\n", n, sum / n * 100, largest * 100);
+}
+
+
+/*
+	A PCB coming off the CPU is charged for the time it ran, then its tickets are
+	put back in the draw.
+*/
+void lottery_enqueue (SchedPolicy policy, PCB pcb) {
+	LotteryData lottery = (LotteryData) policy->data;
+	
+	share_charge(policy, pcb);
+	pcb->tickets = share_tickets(pcb);
+	if (!ft_insert(lottery->tree, pcb, pcb->tickets)) {
+		trace("\t\t\tLOTTERY COULDN'T GROW FOR P%d\t\t\t\r\n", pcb->pid);
+	}
+	lottery->winner = NULL;
+}
+
+
+/*
+	Draws a ticket, unless a draw is already waiting to be picked.
+*/
+PCB lottery_peek (SchedPolicy policy) {
+	LotteryData lottery = (LotteryData) policy->data;
+	unsigned long long ticket = 0;
+	
+	if (!lottery->winner && lottery->tree->total) {
+		ticket = ((unsigned long long) rand_r(&lottery->seed) * ((unsigned long long) RAND_MAX + 1) 
+			+ rand_r(&lottery->seed)) % lottery->tree->total;
+		lottery->winner = ft_find(lottery->tree, ticket);
+	}
+	
+	return lottery->winner;
+}
+
+
+PCB lottery_pick_next (SchedPolicy policy) {
+	LotteryData lottery = (LotteryData) policy->data;
+	PCB pcb = lottery_peek(policy);
+	
+	if (pcb) {
+		ft_remove(lottery->tree, pcb);
+		lottery->winner = NULL;
+		pcb->exec_start = policy->clock;
+	}
+	
+	return pcb;
+}
+
+
+PCB lottery_remove (SchedPolicy policy, PCB pcb) {
+	LotteryData lottery = (LotteryData) policy->data;
+	PCB found = ft_remove(lottery->tree, pcb);
+	
+	if (found) {
+		lottery->winner = NULL;
+	}
+	
+	return found;
+}
+
+
+int lottery_count (SchedPolicy policy) {
+	return ((LotteryData) policy->data)->tree->size;
+}
+
+
+void lottery_print (SchedPolicy policy) {
+	FenwickTree tree = ((LotteryData) policy->data)->tree;
+	
+	trace("Q:Count=%d, tickets: %llu: ", tree->size, tree->total);
+	for (int i = 0; i < tree->used; i++) {
+		if (tree->pcbs[i]) {
+			trace("P%d(%u) -> ", tree->pcbs[i]->pid, tree->weights[i]);
+		}
+	}
+	trace("*\r\n");
+	share_report(tree->pcbs, tree->used);
+}
+
+
+/*
+	The winner of the last draw is kept, so the next pick_next doesn't draw again.
+*/
+void lottery_checkpoint (SchedPolicy policy, Checkpoint ckpt) {
+	LotteryData lottery = (LotteryData) policy->data;
+	
+	ckpt_fenwick_tree(lottery->tree, ckpt);
+	ckpt_pcb_ref(ckpt, &lottery->winner);
+	ckpt_value(ckpt, lottery->seed);
+}
+
+
+void lottery_destroy (SchedPolicy policy) {
+	LotteryData lottery = (LotteryData) policy->data;
+	
+	ft_destroy(lottery->tree);
+	free(lottery);
+	policy->data = NULL;
+}
+
+
+/*
+ * Creates a lottery policy backed by a Fenwick tree of tickets.
+ *
+ * Return: the new policy, NULL on failure.
+ */
+SchedPolicy lottery_policy_create () {
+	SchedPolicy policy = policy_alloc("lottery");
+	LotteryData lottery = NULL;
+	
+	if (policy != NULL) {
+		lottery = (LotteryData) malloc(sizeof(struct lottery_data));
+		if (lottery != NULL) {
+			lottery->tree = ft_create();
+		}
+		if (lottery == NULL || lottery->tree == NULL) {
+			free(lottery);
+			free(policy);
+			return NULL;
+		}
+		lottery->winner = NULL;
+		lottery->seed = sim_rand();
+		policy->data = lottery;
+		policy->enqueue = lottery_enqueue;
+		policy->pick_next = lottery_pick_next;
+		policy->peek = lottery_peek;
+		policy->remove = lottery_remove;
+		policy->quantum = share_quantum;
+		policy->on_block = share_on_block;
+		policy->count = lottery_count;
+		policy->print = lottery_print;
+		policy->checkpoint = lottery_checkpoint;
+		policy->destroy = lottery_destroy;
+	}
+	
+	return policy;
+}
+
+
+int stride_before (PCB a, PCB b) {
+	if (a->pass != b->pass) {
+		return a->pass < b->pass;
+	}
+	return a->pid < b->pid;
+}
+
+
+/*
+	A PCB coming off the CPU moves its pass forward by its stride for each iteration 
+	it ran. Any other PCB, new or woken from I/O, starts no further back than the 
+	global pass so it can't build up credit while it isn't competing.
+*/
+void stride_enqueue (SchedPolicy policy, PCB pcb) {
+	StrideData stride = (StrideData) policy->data;
+	unsigned int ran = 0;
+	
+	pcb->tickets = share_tickets(pcb);
+	if (pcb->exec_start != (unsigned int) -1) {
+		ran = share_charge(policy, pcb);
+		pcb->pass += (unsigned long long) ran * (STRIDE_ONE / pcb->tickets);
+	} else if (pcb->pass < stride->global_pass) {
+		pcb->pass = stride->global_pass;
+	}
+	
+	if (!heap_push(stride->heap, pcb)) {
+		trace("\t\t\tSTRIDE COULDN'T GROW FOR P%d\t\t\t\r\n", pcb->pid);
+	}
+}
+
+
+/*
+	Blocking PCBs still pay for the iterations they ran before the trap.
+*/
+void stride_on_block (SchedPolicy policy, PCB pcb) {
+	unsigned int ran = share_charge(policy, pcb);
+	
+	pcb->pass += (unsigned long long) ran * (STRIDE_ONE / pcb->tickets);
+}
+
+
+PCB stride_pick_next (SchedPolicy policy) {
+	StrideData stride = (StrideData) policy->data;
+	PCB pcb = heap_pop(stride->heap);
+	
+	if (pcb) {
+		if (pcb->pass > stride->global_pass) {
+			stride->global_pass = pcb->pass;
+		}
+		pcb->exec_start = policy->clock;
+	}
+	
+	return pcb;
+}
+
+
+PCB stride_peek (SchedPolicy policy) {
+	return heap_peek(((StrideData) policy->data)->heap);
+}
+
+
+PCB stride_remove (SchedPolicy policy, PCB pcb) {
+	return heap_remove(((StrideData) policy->data)->heap, pcb);
+}
+
+
+int stride_count (SchedPolicy policy) {
+	return ((StrideData) policy->data)->heap->size;
+}
+
+
+void stride_print (SchedPolicy policy) {
+	StrideData stride = (StrideData) policy->data;
+	
+	trace("global pass: %llu\r\n", stride->global_pass);
+	trace("Q:Count=%d: ", stride->heap->size);
+	for (int i = 0; i < stride->heap->size; i++) { //heap order, only the first is guaranteed lowest
+		trace("P%d(%llu) -> ", stride->heap->pcbs[i]->pid, stride->heap->pcbs[i]->pass);
+	}
+	trace("*\r\n");
+	share_report(stride->heap->pcbs, stride->heap->size);
+}
+
+
+void stride_checkpoint (SchedPolicy policy, Checkpoint ckpt) {
+	StrideData stride = (StrideData) policy->data;
+	
+	ckpt_value(ckpt, stride->global_pass);
+	ckpt_pcb_heap(stride->heap, ckpt);
+}
+
+
+void stride_destroy (SchedPolicy policy) {
+	StrideData stride = (StrideData) policy->data;
+	
+	heap_destroy(stride->heap);
+	free(stride);
+	policy->data = NULL;
+}
+
+
+/*
+ * Creates a stride policy backed by a min-heap of pass values.
+ *
+ * Return: the new policy, NULL on failure.
+ */
+SchedPolicy stride_policy_create () {
+	SchedPolicy policy = policy_alloc("stride");
+	StrideData stride = NULL;
+	
+	if (policy != NULL) {
+		stride = (StrideData) malloc(sizeof(struct stride_data));
+		if (stride != NULL) {
+			stride->heap = heap_create(stride_before);
+		}
+		if (stride == NULL || stride->heap == NULL) {
+			free(stride);
+			free(policy);
+			return NULL;
+		}
+		stride->global_pass = 0;
+		policy->data = stride;
+		policy->enqueue = stride_enqueue;
+		policy->pick_next = stride_pick_next;
+		policy->peek = stride_peek;
+		policy->remove = stride_remove;
+		policy->quantum = share_quantum;
+		policy->on_block = stride_on_block;
+		policy->count = stride_count;
+		policy->print = stride_print;
+		policy->checkpoint = stride_checkpoint;
+		policy->destroy = stride_destroy;
+	}
+	
+	return policy;
+}
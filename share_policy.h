@@ -0,0 +1,41 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	The proportional share policies. Every PCB holds tickets based on its priority and
+	role, and should get a share of the CPU equal to its share of the tickets. Lottery
+	scheduling draws a random ticket each time, using a Fenwick tree to find the
+	holder. Stride scheduling is the deterministic version, each PCB's pass value
+	moves forward by its stride for every iteration it runs and the lowest pass, kept
+	at the top of a min-heap, runs next. Both print how far the CPU time the ready
+	PCBs have received is from their ticket share.
+*/
+
+#ifndef SHARE_POLICY_H
+#define SHARE_POLICY_H
+
+#include "sched_policy.h"
+#include "fenwick_tree.h"
+#include "pcb_heap.h"
+
+#define SHARE_BASE_TICKETS 10 // tickets per priority level above the lowest
+#define SHARE_IO_MULTIPLIER 2 // I/O bound PCBs get extra tickets since they rarely use them all
+#define SHARE_QUANTUM 10
+#define STRIDE_ONE (1 << 20) // stride = STRIDE_ONE / tickets
+
+
+/*
+ * Creates a lottery policy backed by a Fenwick tree of tickets.
+ *
+ * Return: the new policy, NULL on failure.
+ */
+SchedPolicy lottery_policy_create ();
+
+/*
+ * Creates a stride policy backed by a min-heap of pass values.
+ *
+ * Return: the new policy, NULL on failure.
+ */
+SchedPolicy stride_policy_create ();
+
+#endif
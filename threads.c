@@ -11,27 +11,27 @@ unsigned int global_largest_MID;
 	This was used in testing to make sure everything was working as it should.
 */
 void printNull2 (Mutex mutex) {
-	printf("pcb1 is null: %d\n", (mutex->pcb1 == NULL));
+	trace("pcb1 is null: %d\n", (mutex->pcb1 == NULL));
 	if (mutex->pcb1 != NULL) {
-		printf("pcb1 values\n");
+		trace("pcb1 values\n");
 		toStringPCB(mutex->pcb1, 0);
 	}
 	
-	printf("pcb2 is null: %d\n", (mutex->pcb2 == NULL));
+	trace("pcb2 is null: %d\n", (mutex->pcb2 == NULL));
 	if (mutex->pcb2 != NULL) {
-		printf("pcb2 values\n");
+		trace("pcb2 values\n");
 		toStringPCB(mutex->pcb2, 0);
 	}
 	
-	printf("hasLock is null: %d\n", (mutex->hasLock == NULL));
+	trace("hasLock is null: %d\n", (mutex->hasLock == NULL));
 	if (mutex->hasLock != NULL) {
-		printf("hasLock values\n");
+		trace("hasLock values\n");
 		toStringPCB(mutex->hasLock, 0);
 	}
 	
-	printf("blocked is null: %d\n", (mutex->blocked == NULL));
+	trace("blocked is null: %d\n", (mutex->blocked == NULL));
 	if (mutex->blocked != NULL) {
-		printf("blocked values\n");
+		trace("blocked values\n");
 		toStringPCB(mutex->blocked, 0);
 	}
 }
@@ -49,6 +49,7 @@ Mutex mutex_create () {
 	mutex->blocked = NULL;
 	mutex->pcb1 = NULL;
 	mutex->pcb2 = NULL;
+	mutex->node = NULL;
 	mutex->mid = global_largest_MID;
 	global_largest_MID++;
 	return mutex;
@@ -64,6 +65,7 @@ void mutex_init (Mutex mutex) {
 	mutex->blocked = NULL;
 	mutex->pcb1 = NULL;
 	mutex->pcb2 = NULL;
+	mutex->node = NULL;
 	mutex->mid = global_largest_MID;
 	global_largest_MID++;
 }
@@ -80,7 +82,7 @@ int mutex_lock (Mutex mutex, PCB pcb) {
 		if (mutex->isLocked || mutex->hasLock == pcb) {
 			if(mutex->isLocked && mutex->hasLock == pcb)
 			{
-				printf("\r\n\r\n\t\tMUTEX IS ALREADY LOCKED!!!!!!!!!!\r\n\r\n");
+				trace("\r\n\r\n\t\tMUTEX IS ALREADY LOCKED!!!!!!!!!!\r\n\r\n");
 			}
 			return 0;
 		} else {
@@ -90,7 +92,7 @@ int mutex_lock (Mutex mutex, PCB pcb) {
 		}
 
 	}  else {
-		printf("\r\n\r\n\t\tMUTEX IS NULL. LOCK FAILED\r\n\r\n");
+		trace("\r\n\r\n\t\tMUTEX IS NULL. LOCK FAILED\r\n\r\n");
 		return 0;
 	}
 }
@@ -111,7 +113,7 @@ int mutex_trylock (Mutex mutex, PCB pcb) {
 			mutex->hasLock = pcb;
 		}
 	} else {
-		printf("\r\n\r\n\t\tMUTEX IS NULL. TRYLOCK FAILED\r\n\r\n");
+		trace("\r\n\r\n\t\tMUTEX IS NULL. TRYLOCK FAILED\r\n\r\n");
 	}
 	
 	return wasLocked;
@@ -125,19 +127,19 @@ int mutex_trylock (Mutex mutex, PCB pcb) {
 int mutex_unlock (Mutex mutex, PCB pcb) {
 	if (mutex) {
 		if (!mutex->isLocked) { 
-			printf("\r\n\r\n\t\tMUTEX IS ALREADY UNLOCKED\r\n\r\n");
+			trace("\r\n\r\n\t\tMUTEX IS ALREADY UNLOCKED\r\n\r\n");
 			return 0;
 		} else if (mutex->isLocked && mutex->hasLock == pcb) {
 			mutex->isLocked = 0;
 			mutex->hasLock = NULL;
 			return 1;
 		} else {
-			printf("\r\n\r\n\t\tMUTEX IS OWNED BY OTHER PROCESS\r\n\r\n");
+			trace("\r\n\r\n\t\tMUTEX IS OWNED BY OTHER PROCESS\r\n\r\n");
 			return 2;
 		}
 		
 	} else {
-		printf("\r\n\r\n\t\tMUTEX IS NULL. UNLOCK FAILED\r\n\r\n");
+		trace("\r\n\r\n\t\tMUTEX IS NULL. UNLOCK FAILED\r\n\r\n");
 		return 0;
 	}
 }
@@ -147,16 +149,16 @@ int mutex_unlock (Mutex mutex, PCB pcb) {
 	Prints the contents of the mutex.
 */
 void toStringMutex (Mutex mutex) {
-	printf ("Mutex:\r\n");
-	printf("mid: %d, isLocked: %d\r\n", mutex->mid, mutex->isLocked);
+	trace ("Mutex:\r\n");
+	trace("mid: %d, isLocked: %d\r\n", mutex->mid, mutex->isLocked);
 	
-	printf("pcb1: ");
+	trace("pcb1: ");
 	toStringPCB(mutex->pcb1, 0);
-	printf("lock pc: %d, unlock pc: %d\r\n\r\n", mutex->pcb1->lock_pc, mutex->pcb1->unlock_pc);
+	trace("lock pc: %d, unlock pc: %d\r\n\r\n", mutex->pcb1->lock_pc, mutex->pcb1->unlock_pc);
 	
-	printf("pcb2: ");
+	trace("pcb2: ");
 	toStringPCB(mutex->pcb2, 0);
-	printf("lock pc: %d, unlock pc: %d\r\n\r\n", mutex->pcb2->lock_pc, mutex->pcb2->unlock_pc);
+	trace("lock pc: %d, unlock pc: %d\r\n\r\n", mutex->pcb2->lock_pc, mutex->pcb2->unlock_pc);
 }
 
 
@@ -172,7 +174,7 @@ void mutex_destroy(Mutex mutex) {
 		free (mutex);
 		mutex = NULL;
 	} else {
-		printf("mutex was null\n");
+		trace("mutex was null\n");
 	}
 }
 
@@ -197,7 +199,7 @@ void cond_var_init (ConditionVariable condVar) {
 	Displays the status of a Condition Variable's signal.
 */
 void toStringConditionVariable (ConditionVariable condVar) {
-	printf("signal: %d\r\n", condVar->signal);
+	trace("signal: %d\r\n", condVar->signal);
 }
 
 /*
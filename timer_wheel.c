@@ -0,0 +1,308 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is a hierarchical timer wheel that holds every simulated timed event (quantum
+	expiry, I/O completion, MLFQ aging and PCB creation). Time is measured in osLoop
+	iterations. Level 0 has one slot per iteration, and each level above it has slots
+	TIMER_WHEEL_SLOTS times wider. Events in the upper levels are cascaded down as the
+	clock reaches them, so scheduling and cancelling are O(1) and the main loop only
+	needs to compare the clock against tw_next_deadline once per step.
+*/
+
+#include "timer_wheel.h"
+
+#define TIMER_WHEEL_RANGE (1u << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS))
+
+
+/*
+	Appends the event to the end of the given slot's list so events that share a
+	deadline fire in the order they were scheduled.
+*/
+void tw_link (TimerWheel wheel, TimerEvent event, int level, int slot) {
+	TimerEvent last = wheel->tails[level][slot];
+
+	event->level = level;
+	event->slot = slot;
+	event->next = NULL;
+	event->prev = last;
+	if (!last) {
+		wheel->slots[level][slot] = event;
+	} else {
+		last->next = event;
+	}
+	wheel->tails[level][slot] = event;
+}
+
+
+/*
+	Unlinks the event from whichever slot it currently sits in.
+*/
+void tw_unlink (TimerWheel wheel, TimerEvent event) {
+	if (event->prev) {
+		event->prev->next = event->next;
+	} else {
+		wheel->slots[event->level][event->slot] = event->next;
+	}
+	if (event->next) {
+		event->next->prev = event->prev;
+	} else {
+		wheel->tails[event->level][event->slot] = event->prev;
+	}
+	event->next = NULL;
+	event->prev = NULL;
+	event->slot = -1;
+}
+
+
+/*
+	Puts the event into the level and slot that matches how far its deadline is from
+	the wheel's current time. Events further out than the whole wheel can hold are
+	parked in the top level and placed again when that slot cascades. Nothing is 
+	placed before earliest: new events go no earlier than the next tick, while 
+	cascaded events may land in the current tick's slot, which is expired right after.
+*/
+void tw_place (TimerWheel wheel, TimerEvent event, unsigned int earliest) {
+	unsigned int expires = event->deadline;
+	unsigned int delta = 0;
+	unsigned int boundary = 0;
+	int level = 0;
+
+	if (expires < earliest) { //already due
+		expires = earliest;
+	}
+	delta = expires - wheel->now;
+	while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (1u << ((level + 1) * TIMER_WHEEL_BITS))) {
+		level++;
+	}
+	if (delta >= TIMER_WHEEL_RANGE) {
+		expires = wheel->now + TIMER_WHEEL_RANGE - 1;
+	}
+
+	tw_link(wheel, event, level, (expires >> (level * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK);
+
+	if (level == 0) {
+		if (expires < wheel->next) {
+			wheel->next = expires;
+		}
+	} else {
+		boundary = (wheel->now | TIMER_WHEEL_MASK) + 1; //the next time level 1 cascades
+		if (boundary < wheel->next) {
+			wheel->next = boundary;
+		}
+	}
+}
+
+
+/*
+	Finds the earliest time the wheel has work to do: the first occupied level 0 slot,
+	or the next cascade if anything is waiting in the upper levels.
+*/
+unsigned int tw_compute_next (TimerWheel wheel) {
+	unsigned int next = TIMER_NEVER;
+
+	if (wheel->count) {
+		for (unsigned int i = 1; i < TIMER_WHEEL_SLOTS; i++) {
+			if (wheel->slots[0][(wheel->now + i) & TIMER_WHEEL_MASK]) {
+				next = wheel->now + i;
+				break;
+			}
+		}
+		if (wheel->count > wheel->levelCount[0]) {
+			unsigned int boundary = (wheel->now | TIMER_WHEEL_MASK) + 1;
+			if (boundary < next) {
+				next = boundary;
+			}
+		}
+	}
+
+	return next;
+}
+
+
+/*
+	Takes every event out of an upper level slot and places it again relative to the
+	current time, which moves it down one or more levels.
+*/
+void tw_cascade (TimerWheel wheel, int level, int slot) {
+	TimerEvent curr = wheel->slots[level][slot];
+	TimerEvent next = NULL;
+
+	wheel->slots[level][slot] = NULL;
+	wheel->tails[level][slot] = NULL;
+	while (curr) {
+		next = curr->next;
+		wheel->levelCount[level]--;
+		tw_place(wheel, curr, wheel->now);
+		wheel->levelCount[curr->level]++;
+		curr = next;
+	}
+}
+
+
+/*
+ * Creates a timer wheel whose clock starts at the given time.
+ *
+ * Return: A new timer wheel on success, NULL on failure.
+ */
+TimerWheel tw_create (unsigned int now) {
+	TimerWheel wheel = (TimerWheel) malloc(sizeof(struct timer_wheel));
+
+	if (wheel != NULL) {
+		for (int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+			for (int i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+				wheel->slots[level][i] = NULL;
+				wheel->tails[level][i] = NULL;
+			}
+			wheel->levelCount[level] = 0;
+		}
+		wheel->now = now;
+		wheel->next = TIMER_NEVER;
+		wheel->count = 0;
+	}
+
+	return wheel;
+}
+
+
+/*
+ * Destroys the timer wheel along with any events still scheduled in it. The PCBs
+ * the events point to are not freed.
+ */
+void tw_destroy (TimerWheel wheel) {
+	TimerEvent curr = NULL, last = NULL;
+
+	if (wheel) {
+		for (int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+			for (int i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+				curr = wheel->slots[level][i];
+				while (curr) {
+					last = curr;
+					curr = curr->next;
+					free(last);
+				}
+			}
+		}
+		free(wheel);
+	}
+}
+
+
+/*
+ * Schedules a new event to fire once the wheel's clock reaches the deadline. A
+ * deadline in the past fires on the next advance.
+ *
+ * Return: the scheduled event (usable with tw_cancel), NULL on failure.
+ */
+TimerEvent tw_schedule (TimerWheel wheel, unsigned int deadline, enum timer_type type, PCB pcb) {
+	TimerEvent event = (TimerEvent) malloc(sizeof(struct timer_event));
+
+	if (event != NULL) {
+		event->deadline = deadline;
+		event->type = type;
+		event->pcb = pcb;
+		tw_place(wheel, event, wheel->now + 1);
+		wheel->levelCount[event->level]++;
+		wheel->count++;
+	}
+
+	return event;
+}
+
+
+/*
+ * Removes a scheduled event from the wheel and frees it.
+ */
+void tw_cancel (TimerWheel wheel, TimerEvent event) {
+	if (wheel && event && event->slot >= 0) {
+		wheel->levelCount[event->level]--;
+		tw_unlink(wheel, event);
+		wheel->count--;
+		free(event);
+	}
+}
+
+
+/*
+ * Moves the clock forward to the given time and unlinks every event whose deadline
+ * has been reached. Stretches of time before the next deadline are skipped in one
+ * step instead of being walked slot by slot.
+ *
+ * Return: the expired events chained through next in deadline order, NULL if none.
+ * The caller frees each one with tw_event_destroy.
+ */
+TimerEvent tw_advance (TimerWheel wheel, unsigned int now) {
+	TimerEvent expired = NULL, expiredLast = NULL;
+	TimerEvent curr = NULL;
+	int slot = 0;
+
+	while (wheel->now < now) {
+		if (wheel->next > wheel->now + 1) { //nothing to do until next, jump straight to it
+			if (wheel->next > now) {
+				wheel->now = now;
+				break;
+			}
+			wheel->now = wheel->next - 1;
+		}
+
+		wheel->now++;
+		if (!(wheel->now & TIMER_WHEEL_MASK)) {
+			for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+				slot = (wheel->now >> (level * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK;
+				tw_cascade(wheel, level, slot);
+				if (slot) {
+					break;
+				}
+			}
+		}
+
+		slot = wheel->now & TIMER_WHEEL_MASK;
+		curr = wheel->slots[0][slot];
+		if (curr) {
+			if (expiredLast) {
+				expiredLast->next = curr;
+				curr->prev = expiredLast;
+			} else {
+				expired = curr;
+			}
+			while (curr) {
+				curr->slot = -1;
+				wheel->levelCount[0]--;
+				wheel->count--;
+				expiredLast = curr;
+				curr = curr->next;
+			}
+			wheel->slots[0][slot] = NULL;
+			wheel->tails[0][slot] = NULL;
+		}
+
+		if (wheel->now >= wheel->next) {
+			wheel->next = tw_compute_next(wheel);
+		}
+	}
+
+	return expired;
+}
+
+
+/*
+ * Returns the earliest time at which the wheel needs to be advanced, TIMER_NEVER
+ * if it is empty. This may be a cascade point rather than an actual deadline, but
+ * no event fires before it.
+ */
+unsigned int tw_next_deadline (TimerWheel wheel) {
+	return wheel->next;
+}
+
+
+void tw_event_destroy (TimerEvent event) {
+	free(event);
+}
+
+
+char tw_is_empty (TimerWheel wheel) {
+	return wheel->count == 0;
+}
+
+
+#undef TIMER_WHEEL_RANGE
@@ -0,0 +1,110 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is a hierarchical timer wheel that holds every simulated timed event (quantum
+	expiry, I/O completion, MLFQ aging and PCB creation). Time is measured in osLoop
+	iterations. Level 0 has one slot per iteration, and each level above it has slots
+	TIMER_WHEEL_SLOTS times wider. Events in the upper levels are cascaded down as the
+	clock reaches them, so scheduling and cancelling are O(1) and the main loop only
+	needs to compare the clock against tw_next_deadline once per step.
+*/
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include "pcb.h"
+
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_NEVER 0xFFFFFFFF
+
+
+enum timer_type {
+	TIMER_IO_COMPLETION,
+	TIMER_QUANTUM,
+	TIMER_AGING,
+	TIMER_MAKE_PCB
+};
+
+/* A single timed event, kept in a doubly linked list inside its slot. */
+typedef struct timer_event {
+	struct timer_event * next;
+	struct timer_event * prev;
+	unsigned int deadline;
+	int level;
+	int slot; // -1 when the event is not scheduled
+	enum timer_type type;
+	PCB pcb;
+} timer_event_s;
+
+typedef timer_event_s * TimerEvent;
+
+typedef struct timer_wheel {
+	TimerEvent slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+	TimerEvent tails[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+	unsigned int now;
+	unsigned int next; // nothing can fire before this time
+	unsigned int levelCount[TIMER_WHEEL_LEVELS];
+	unsigned int count;
+} timer_wheel_s;
+
+typedef timer_wheel_s * TimerWheel;
+
+
+/*
+ * Creates a timer wheel whose clock starts at the given time.
+ *
+ * Return: A new timer wheel on success, NULL on failure.
+ */
+TimerWheel tw_create (unsigned int now);
+
+/*
+ * Destroys the timer wheel along with any events still scheduled in it. The PCBs
+ * the events point to are not freed.
+ */
+void tw_destroy (TimerWheel wheel);
+
+/*
+ * Schedules a new event to fire once the wheel's clock reaches the deadline. A
+ * deadline in the past fires on the next advance.
+ *
+ * Return: the scheduled event (usable with tw_cancel), NULL on failure.
+ */
+TimerEvent tw_schedule (TimerWheel wheel, unsigned int deadline, enum timer_type type, PCB pcb);
+
+/*
+ * Removes a scheduled event from the wheel and frees it.
+ */
+void tw_cancel (TimerWheel wheel, TimerEvent event);
+
+/*
+ * Moves the clock forward to the given time and unlinks every event whose deadline
+ * has been reached.
+ *
+ * Return: the expired events chained through next in deadline order, NULL if none.
+ * The caller frees each one with tw_event_destroy.
+ */
+TimerEvent tw_advance (TimerWheel wheel, unsigned int now);
+
+/*
+ * Returns the earliest time at which the wheel needs to be advanced, TIMER_NEVER
+ * if it is empty. This may be a cascade point rather than an actual deadline, but
+ * no event fires before it.
+ */
+unsigned int tw_next_deadline (TimerWheel wheel);
+
+void tw_event_destroy (TimerEvent event);
+
+char tw_is_empty (TimerWheel wheel);
+
+/*
+ * Appends the event to the end of the given slot's list and records where it sits,
+ * without checking that the slot fits its deadline. Used to put events back where
+ * they were when restoring a checkpoint.
+ */
+void tw_link (TimerWheel wheel, TimerEvent event, int level, int slot);
+
+#endif
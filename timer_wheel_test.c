@@ -0,0 +1,182 @@
+// timer wheel testing file
+// for testing purposes only
+
+#include "timer_wheel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#define MAX_EVENTS 64
+#define LEVEL_SPAN(level) (1u << ((level) * TIMER_WHEEL_BITS)) // 64^level, where that level's slots wrap
+
+/*
+	Each event's pcb is a made up pointer holding its index into fired[], it's never
+	dereferenced.
+*/
+#define TAG(i) ((PCB) (uintptr_t) ((i) + 1))
+#define UNTAG(pcb) ((int) ((uintptr_t) (pcb) - 1))
+
+unsigned int deadlines[MAX_EVENTS];
+int fired[MAX_EVENTS];
+int cancelled[MAX_EVENTS];
+int eventCount = 0;
+int lateOrEarly = 0;
+
+int failures = 0;
+
+
+void check (int passed, const char * what) {
+	if (passed) {
+		printf("Success: %s\n", what);
+	} else {
+		printf("Fail: %s\n", what);
+		failures++;
+	}
+}
+
+
+TimerEvent add (TimerWheel wheel, unsigned int deadline) {
+	deadlines[eventCount] = deadline;
+	fired[eventCount] = 0;
+	cancelled[eventCount] = 0;
+	return tw_schedule(wheel, deadline, TIMER_IO_COMPLETION, TAG(eventCount++));
+}
+
+
+/*
+	Counts each expired event and checks it came due exactly at now.
+*/
+void collect (TimerEvent expired, unsigned int now) {
+	TimerEvent next = NULL;
+	int i = 0;
+
+	while (expired) {
+		next = expired->next;
+		i = UNTAG(expired->pcb);
+		fired[i]++;
+		if (deadlines[i] != now) {
+			printf("event %d due at %u fired at %u\n", i, deadlines[i], now);
+			lateOrEarly++;
+		}
+		tw_event_destroy(expired);
+		expired = next;
+	}
+}
+
+
+/*
+	Steps the clock one iteration at a time up to end, advancing the wheel only when
+	tw_next_deadline says so, the same way osLoop does.
+*/
+void run (TimerWheel wheel, unsigned int start, unsigned int end) {
+	for (unsigned int now = start + 1; now <= end; now++) {
+		if (now >= tw_next_deadline(wheel)) {
+			collect(tw_advance(wheel, now), now);
+		}
+	}
+}
+
+
+int allFiredOnce () {
+	for (int i = 0; i < eventCount; i++) {
+		if (fired[i] != !cancelled[i]) {
+			printf("event %d due at %u fired %d times\n", i, deadlines[i], fired[i]);
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+
+/*
+	Puts events just before, at and just after each level's span, measured from start,
+	and runs the clock until all of them are due.
+*/
+void testLevels (unsigned int start) {
+	TimerWheel wheel = tw_create(start);
+	unsigned int offsets[] = {1, 2, 63, 64, 65, 127, 128, 4095, 4096, 4097, 262143, 262144, 262145,
+		LEVEL_SPAN(4) - 1, LEVEL_SPAN(4), LEVEL_SPAN(4) + 4000};
+	char what[128];
+
+	eventCount = 0;
+	lateOrEarly = 0;
+	for (int i = 0; i < (int) (sizeof(offsets) / sizeof(offsets[0])); i++) {
+		add(wheel, start + offsets[i]);
+	}
+	run(wheel, start, start + LEVEL_SPAN(4) + 5000);
+	snprintf(what, sizeof(what), "starting at %u, every event fires once at its deadline", start);
+	check(allFiredOnce() && !lateOrEarly, what);
+	check(tw_is_empty(wheel) && tw_next_deadline(wheel) == TIMER_NEVER, "the wheel is empty afterwards");
+	tw_destroy(wheel);
+}
+
+
+int main () {
+	TimerWheel wheel = NULL;
+	TimerEvent toCancel[4];
+	TimerEvent expired = NULL, next = NULL;
+	int inOrder = 1, count = 0;
+
+	setvbuf(stdout, NULL, _IONBF, 0);
+	printf("Beginning testing...\n");
+
+	printf("\n-------------------------\nLevel cascade test - deadlines on either side of each level\n");
+	testLevels(0);
+	testLevels(1000); //not lined up with any slot
+	for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+		testLevels(LEVEL_SPAN(level) - 3); //the clock crosses 64^k, where that level's slots wrap
+	}
+	testLevels(LEVEL_SPAN(TIMER_WHEEL_LEVELS) - 3); //the top level wraps too
+
+	printf("\n-------------------------\nCancel test - cancel events in each level, before and after they cascade\n");
+	wheel = tw_create(0);
+	eventCount = 0;
+	lateOrEarly = 0;
+	toCancel[0] = add(wheel, 10);
+	toCancel[1] = add(wheel, 5000);
+	toCancel[2] = add(wheel, 300000);
+	toCancel[3] = add(wheel, 4100); //cancelled only after it has cascaded into level 0
+	add(wheel, 10); //shares a slot with the first
+	add(wheel, 5000);
+	add(wheel, 300000);
+	add(wheel, 4100);
+	check(toCancel[0]->level == 0 && toCancel[1]->level == 2 && toCancel[2]->level == 3, "events start in the level their distance needs");
+	for (int i = 0; i < 3; i++) {
+		tw_cancel(wheel, toCancel[i]);
+		cancelled[i] = 1;
+	}
+	run(wheel, 0, 4096);
+	check(toCancel[3]->level == 0 && toCancel[3]->slot >= 0, "an event 4 past a level 2 boundary is in level 0 once the clock reaches it");
+	tw_cancel(wheel, toCancel[3]);
+	cancelled[3] = 1;
+	run(wheel, 4096, 400000);
+	check(allFiredOnce() && !lateOrEarly, "cancelled events never fire and the rest fire once at their deadline");
+	check(tw_is_empty(wheel), "the wheel is empty afterwards");
+	tw_destroy(wheel);
+
+	printf("\n-------------------------\nJump test - advance straight past several deadlines\n");
+	wheel = tw_create(0);
+	eventCount = 0;
+	add(wheel, 70000);
+	add(wheel, 70);
+	add(wheel, 700);
+	add(wheel, 70);
+	expired = tw_advance(wheel, 100000);
+	for (TimerEvent e = expired; e; e = e->next, count++) {
+		inOrder &= e->next == NULL || e->deadline <= e->next->deadline;
+	}
+	check(count == 4 && inOrder, "all four come back in deadline order");
+	check(UNTAG(expired->pcb) == 1 && UNTAG(expired->next->pcb) == 3, "events sharing a deadline keep the order they were scheduled in");
+	while (expired) {
+		next = expired->next;
+		tw_event_destroy(expired);
+		expired = next;
+	}
+	check(tw_is_empty(wheel), "the wheel is empty afterwards");
+	tw_destroy(wheel);
+
+	printf("\n%s, %d failed\n", failures ? "FAILED" : "PASSED", failures);
+
+	return failures != 0;
+}
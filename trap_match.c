@@ -0,0 +1,128 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	Matches the running PCB's PC against every one of its trap arrays in one pass and
+	returns a bitmask of the events that fire at that PC. When the compiler targets
+	AVX2 or SSE2 the comparisons are done eight or four trap values at a time, 
+	otherwise (or with TRAP_MATCH_SCALAR defined) it falls back to a plain loop.
+*/
+
+#include "trap_match.h"
+
+#if !defined(TRAP_MATCH_SCALAR) && defined(__AVX2__)
+#include <immintrin.h>
+#define TRAP_MATCH_AVX2
+#elif !defined(TRAP_MATCH_SCALAR) && defined(__SSE2__)
+#include <emmintrin.h>
+#define TRAP_MATCH_SSE2
+#endif
+
+
+/*
+	Returns 1 if any of the count values is the PC.
+*/
+int trap_match_one_scalar (const unsigned int * traps, int count, unsigned int pc) {
+	for (int i = 0; i < count; i++) {
+		if (traps[i] == pc) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+
+#if defined(TRAP_MATCH_AVX2) || defined(TRAP_MATCH_SSE2)
+/*
+	The vector version of trap_match_one_scalar. Every lane of the array is compared
+	and the results are ORed together, so there is no branch until the very end.
+*/
+int trap_match_one (const unsigned int * traps, int count, unsigned int pc) {
+	__m128i hits4 = _mm_setzero_si128();
+	__m128i pc4 = _mm_set1_epi32((int) pc);
+	int i = 0;
+	int found = 0;
+	
+#ifdef TRAP_MATCH_AVX2
+	__m256i hits8 = _mm256_setzero_si256();
+	__m256i pc8 = _mm256_set1_epi32((int) pc);
+	
+	for (; i + 8 <= count; i += 8) {
+		hits8 = _mm256_or_si256(hits8, _mm256_cmpeq_epi32(pc8, _mm256_loadu_si256((const __m256i *) (traps + i))));
+	}
+	found = !_mm256_testz_si256(hits8, hits8);
+#endif
+	for (; i + 4 <= count; i += 4) {
+		hits4 = _mm_or_si128(hits4, _mm_cmpeq_epi32(pc4, _mm_loadu_si128((const __m128i *) (traps + i))));
+	}
+	found |= _mm_movemask_epi8(hits4) != 0;
+	
+	return found | trap_match_one_scalar(traps + i, count - i, pc);
+}
+#endif
+
+
+/*
+ * Compares the PC against TRAP_ARRAY_COUNT arrays of count trap values each, using
+ * the widest vector compares available.
+ *
+ * Return: a mask with bit i set if arrays[i] holds the PC.
+ */
+unsigned int trap_match_arrays (const unsigned int * arrays[], int count, unsigned int pc) {
+	unsigned int mask = 0;
+	
+	for (int a = 0; a < TRAP_ARRAY_COUNT; a++) {
+#if defined(TRAP_MATCH_AVX2) || defined(TRAP_MATCH_SSE2)
+		mask |= (unsigned int) trap_match_one(arrays[a], count, pc) << a;
+#else
+		mask |= (unsigned int) trap_match_one_scalar(arrays[a], count, pc) << a;
+#endif
+	}
+	
+	return mask;
+}
+
+
+/*
+ * The same as trap_match_arrays, one comparison at a time.
+ */
+unsigned int trap_match_arrays_scalar (const unsigned int * arrays[], int count, unsigned int pc) {
+	unsigned int mask = 0;
+	
+	for (int a = 0; a < TRAP_ARRAY_COUNT; a++) {
+		mask |= (unsigned int) trap_match_one_scalar(arrays[a], count, pc) << a;
+	}
+	
+	return mask;
+}
+
+
+/*
+ * Compares the PC against every trap array of the PCB.
+ *
+ * Return: a mask of trap_event bits, one for each array that holds the PC.
+ */
+unsigned int trap_match (PCB pcb, unsigned int pc) {
+	const unsigned int * arrays[TRAP_ARRAY_COUNT] = {
+		pcb->io_1_traps, pcb->io_2_traps, 
+		pcb->lockR1, pcb->lockR2, 
+		pcb->unlockR1, pcb->unlockR2, 
+		pcb->signal_cond, pcb->wait_cond
+	};
+	
+	return trap_match_arrays(arrays, TRAP_COUNT, pc);
+}
+
+
+/*
+ * Returns the name of the instruction set trap_match_arrays was compiled for.
+ */
+const char * trap_match_isa () {
+#if defined(TRAP_MATCH_AVX2)
+	return "avx2";
+#elif defined(TRAP_MATCH_SSE2)
+	return "sse2";
+#else
+	return "scalar";
+#endif
+}
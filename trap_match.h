@@ -0,0 +1,56 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	Matches the running PCB's PC against every one of its trap arrays in one pass and
+	returns a bitmask of the events that fire at that PC. When the compiler targets
+	AVX2 or SSE2 the comparisons are done eight or four trap values at a time, 
+	otherwise (or with TRAP_MATCH_SCALAR defined) it falls back to a plain loop.
+*/
+
+#ifndef TRAP_MATCH_H
+#define TRAP_MATCH_H
+
+#include "pcb.h"
+
+#define TRAP_ARRAY_COUNT 8
+
+/* One bit per trap array, in the order trap_match checks them. */
+enum trap_event {
+	TRAP_IO_1 = 1 << 0,
+	TRAP_IO_2 = 1 << 1,
+	TRAP_LOCK_R1 = 1 << 2,
+	TRAP_LOCK_R2 = 1 << 3,
+	TRAP_UNLOCK_R1 = 1 << 4,
+	TRAP_UNLOCK_R2 = 1 << 5,
+	TRAP_SIGNAL = 1 << 6,
+	TRAP_WAIT = 1 << 7
+};
+
+
+/*
+ * Compares the PC against every trap array of the PCB.
+ *
+ * Return: a mask of trap_event bits, one for each array that holds the PC.
+ */
+unsigned int trap_match (PCB pcb, unsigned int pc);
+
+/*
+ * Compares the PC against TRAP_ARRAY_COUNT arrays of count trap values each, using
+ * the widest vector compares available.
+ *
+ * Return: a mask with bit i set if arrays[i] holds the PC.
+ */
+unsigned int trap_match_arrays (const unsigned int * arrays[], int count, unsigned int pc);
+
+/*
+ * The same as trap_match_arrays, one comparison at a time.
+ */
+unsigned int trap_match_arrays_scalar (const unsigned int * arrays[], int count, unsigned int pc);
+
+/*
+ * Returns the name of the instruction set trap_match_arrays was compiled for.
+ */
+const char * trap_match_isa ();
+
+#endif
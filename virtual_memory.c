@@ -0,0 +1,389 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is the simulated virtual memory: the frame table, the TLB and the page
+	replacement policies. See virtual_memory.h for the address spaces and the
+	references each step makes.
+*/
+
+#include "virtual_memory.h"
+
+const char * vmPolicyNames[VM_POLICY_COUNT] = {"fifo", "clock", "lru", "ws"};
+
+
+/*
+	Allocates the PCB's page table, with every page unmapped, the first time it is
+	needed. Returns 0 if memory ran out.
+*/
+int vm_attach (PCB pcb) {
+	unsigned int count = pcb->max_pc / VM_PAGE_SIZE + 1 + VM_DATA_PAGES; //the PC reaches max_pc before it wraps
+
+	if (pcb->page_table) {
+		return 1;
+	}
+	pcb->page_table = (unsigned int *) malloc(sizeof(unsigned int) * count);
+	if (pcb->page_table == NULL) {
+		return 0;
+	}
+	memset(pcb->page_table, 0xff, sizeof(unsigned int) * count);
+	pcb->page_count = count;
+	pcb->size = count * VM_PAGE_SIZE;
+
+	return 1;
+}
+
+
+/*
+	The data page referenced at the given PC. Which VM_PHASE_PAGES pages a phase uses
+	is mixed from the phase and the PID, so every PCB moves through its data pages
+	differently but always the same way.
+*/
+unsigned int vm_data_page (PCB pcb, unsigned int pc) {
+	unsigned int base = (pc / VM_PHASE_LENGTH + 1) * 2654435761u ^ pcb->pid * 40503u;
+
+	base ^= base >> 15;
+	return pcb->page_count - VM_DATA_PAGES + (base + pc / VM_DATA_EVERY % VM_PHASE_PAGES) % VM_DATA_PAGES;
+}
+
+
+/*
+	Empties every TLB entry for the page, or for any of the PID's pages if page is
+	VM_NO_FRAME.
+*/
+void vm_tlb_flush (VirtualMemory vm, unsigned int pid, unsigned int page) {
+	for (unsigned int i = 0; i < vm->tlbSize; i++) {
+		if (vm->tlb[i].frame != VM_NO_FRAME && vm->tlb[i].pid == pid
+				&& (page == VM_NO_FRAME || vm->tlb[i].page == page)) {
+			vm->tlb[i].frame = VM_NO_FRAME;
+		}
+	}
+}
+
+
+/*
+	Shifts every frame's referenced bit into the top of its aging counter.
+*/
+void vm_age (VirtualMemory vm) {
+	for (unsigned int i = 0; i < vm->frameCount; i++) {
+		vm->frames[i].age = (vm->frames[i].age >> 1) | (vm->frames[i].referenced << 7);
+		vm->frames[i].referenced = 0;
+	}
+}
+
+
+/*
+	Makes one reference to the page. Returns 1 if it isn't in a frame.
+*/
+int vm_touch (VirtualMemory vm, PCB pcb, unsigned int page) {
+	unsigned int frame = VM_NO_FRAME;
+
+	vm->stats.references++;
+	if (vm->policy == VM_LRU && vm->stats.references % VM_AGING_REFERENCES == 0) {
+		vm_age(vm);
+	}
+	for (unsigned int i = 0; i < vm->tlbSize; i++) {
+		if (vm->tlb[i].frame != VM_NO_FRAME && vm->tlb[i].pid == pcb->pid && vm->tlb[i].page == page) {
+			vm->stats.tlbHits++;
+			vm->frames[vm->tlb[i].frame].referenced = 1;
+			return 0;
+		}
+	}
+
+	frame = pcb->page_table[page];
+	if (frame == VM_NO_FRAME) {
+		vm->stats.faults++;
+		pcb->fault_page = page;
+		return 1;
+	}
+	vm->frames[frame].referenced = 1;
+	vm->tlb[vm->tlbNext].pid = pcb->pid;
+	vm->tlb[vm->tlbNext].page = page;
+	vm->tlb[vm->tlbNext].frame = frame;
+	vm->tlbNext = (vm->tlbNext + 1) % vm->tlbSize;
+
+	return 0;
+}
+
+
+/*
+	Picks the frame whose page the policy evicts. Every frame is in use.
+*/
+unsigned int vm_pick_victim (VirtualMemory vm) {
+	unsigned int victim = 0;
+	vm_frame_s * frame = NULL;
+
+	switch (vm->policy) {
+		case VM_FIFO:
+			for (unsigned int i = 1; i < vm->frameCount; i++) {
+				if (vm->frames[i].loadedAt < vm->frames[victim].loadedAt) {
+					victim = i;
+				}
+			}
+			return victim;
+		case VM_LRU:
+			for (unsigned int i = 1; i < vm->frameCount; i++) {
+				if (vm->frames[i].age < vm->frames[victim].age) {
+					victim = i;
+				}
+			}
+			return victim;
+		case VM_WS:
+			victim = vm->hand;
+			for (unsigned int i = 0; i < vm->frameCount; i++) {
+				frame = &vm->frames[vm->hand];
+				if (frame->referenced) {
+					frame->referenced = 0;
+					frame->lastUse = vm->stats.references;
+				} else if (vm->stats.references - frame->lastUse > vm->window) {
+					victim = vm->hand;
+					vm->hand = (vm->hand + 1) % vm->frameCount;
+					return victim;
+				} else if (frame->lastUse < vm->frames[victim].lastUse) {
+					victim = vm->hand;
+				}
+				vm->hand = (vm->hand + 1) % vm->frameCount;
+			}
+			return victim; //every page is in the working set, the least recently used goes
+		default:
+			for (;;) {
+				frame = &vm->frames[vm->hand];
+				victim = vm->hand;
+				vm->hand = (vm->hand + 1) % vm->frameCount;
+				if (!frame->referenced) {
+					return victim;
+				}
+				frame->referenced = 0;
+			}
+	}
+}
+
+
+/*
+ * Creates a virtual memory with every frame free and an empty TLB.
+ *
+ * Return: the virtual memory, NULL if a size is out of range or memory ran out.
+ */
+VirtualMemory vm_create (unsigned int frameCount, unsigned int tlbSize) {
+	VirtualMemory vm = NULL;
+
+	if (frameCount == 0 || frameCount > VM_MAX_FRAMES || tlbSize == 0 || tlbSize > VM_MAX_TLB) {
+		return NULL;
+	}
+	vm = (VirtualMemory) calloc(1, sizeof(struct virtual_memory));
+	if (vm == NULL) {
+		return NULL;
+	}
+	vm->frames = (vm_frame_s *) calloc(frameCount, sizeof(vm_frame_s));
+	vm->freeFrames = (unsigned int *) malloc(sizeof(unsigned int) * frameCount);
+	vm->tlb = (vm_tlb_entry_s *) malloc(sizeof(vm_tlb_entry_s) * tlbSize);
+	if (vm->frames == NULL || vm->freeFrames == NULL || vm->tlb == NULL) {
+		vm_destroy(vm);
+		return NULL;
+	}
+	vm->frameCount = frameCount;
+	vm->tlbSize = tlbSize;
+	for (unsigned int i = 0; i < frameCount; i++) {
+		vm->freeFrames[i] = frameCount - 1 - i; //frame 0 is handed out first
+	}
+	vm->freeCount = frameCount;
+	for (unsigned int i = 0; i < tlbSize; i++) {
+		vm->tlb[i].frame = VM_NO_FRAME;
+	}
+	vm->policy = VM_CLOCK;
+
+	return vm;
+}
+
+
+/*
+ * Frees the virtual memory. Every page still loaded is taken out of its PCB's page
+ * table, so the PCBs can go on without it.
+ */
+void vm_destroy (VirtualMemory vm) {
+	if (vm) {
+		for (unsigned int i = 0; vm->frames && i < vm->frameCount; i++) {
+			if (vm->frames[i].owner) {
+				vm->frames[i].owner->page_table[vm->frames[i].page] = VM_NO_FRAME;
+			}
+		}
+		free(vm->frames);
+		free(vm->freeFrames);
+		free(vm->tlb);
+		free(vm);
+	}
+}
+
+
+/*
+ * Return: the policy with the given name, -1 if there isn't one.
+ */
+int vm_policy_by_name (const char * name) {
+	for (int i = 0; i < VM_POLICY_COUNT; i++) {
+		if (!strcmp(name, vmPolicyNames[i])) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+
+/*
+ * Makes the references for the PC the PCB has just stepped to. On a page fault the
+ * page is recorded in the PCB's fault_page and the rest of the step's references
+ * aren't made.
+ *
+ * Return: 1 on a page fault, 0 otherwise.
+ */
+int vm_reference (VirtualMemory vm, PCB pcb) {
+	unsigned int pc = pcb->context->pc;
+
+	if (!vm_attach(pcb)) {
+		return 0; //without a page table the PCB runs as if it had no virtual memory
+	}
+	if (vm_touch(vm, pcb, pc / VM_PAGE_SIZE)) {
+		return 1;
+	}
+
+	return pc % VM_DATA_EVERY == 0 && vm_touch(vm, pcb, vm_data_page(pcb, pc));
+}
+
+
+/*
+ * Loads the page into a frame, evicting a page if none is free. Called once the
+ * disk read for a fault has completed.
+ *
+ * Return: the frame, VM_NO_FRAME if the PCB's page table couldn't be allocated.
+ */
+unsigned int vm_load (VirtualMemory vm, PCB pcb, unsigned int page) {
+	unsigned int frame = VM_NO_FRAME;
+	vm_frame_s * victim = NULL;
+
+	if (!vm_attach(pcb) || page >= pcb->page_count) {
+		return VM_NO_FRAME;
+	}
+	if (pcb->page_table[page] != VM_NO_FRAME) {
+		return pcb->page_table[page];
+	}
+
+	if (vm->freeCount) {
+		frame = vm->freeFrames[--vm->freeCount];
+	} else {
+		frame = vm_pick_victim(vm);
+		victim = &vm->frames[frame];
+		victim->owner->page_table[victim->page] = VM_NO_FRAME;
+		vm_tlb_flush(vm, victim->owner->pid, victim->page);
+		vm->stats.evictions++;
+	}
+
+	vm->frames[frame].owner = pcb;
+	vm->frames[frame].page = page;
+	vm->frames[frame].loadedAt = vm->stats.references;
+	vm->frames[frame].lastUse = vm->stats.references;
+	vm->frames[frame].referenced = 1;
+	vm->frames[frame].age = 0x80;
+	pcb->page_table[page] = frame;
+
+	return frame;
+}
+
+
+/*
+ * Frees every frame the PCB has pages in and drops its TLB entries. Called when the
+ * PCB is killed, its page table is freed with the PCB.
+ */
+void vm_release (VirtualMemory vm, PCB pcb) {
+	unsigned int frame = VM_NO_FRAME;
+
+	if (pcb->page_table == NULL) {
+		return;
+	}
+	for (unsigned int page = 0; page < pcb->page_count; page++) {
+		frame = pcb->page_table[page];
+		if (frame != VM_NO_FRAME) {
+			vm->frames[frame].owner = NULL;
+			vm->frames[frame].referenced = 0;
+			vm->freeFrames[vm->freeCount++] = frame;
+			pcb->page_table[page] = VM_NO_FRAME;
+		}
+	}
+	vm_tlb_flush(vm, pcb->pid, VM_NO_FRAME);
+}
+
+
+/*
+ * Return: page faults per reference.
+ */
+double vm_fault_rate (vm_stats_s * stats) {
+	return stats->references ? (double) stats->faults / stats->references : 0;
+}
+
+
+/*
+ * Return: the mean ns per reference, counting VM_TLB_NS for the TLB, VM_MEMORY_NS
+ * for each memory access and VM_FAULT_NS for each fault.
+ */
+double vm_access_time (vm_stats_s * stats) {
+	unsigned long long misses = stats->references - stats->tlbHits; //each walks the page table
+	double total = 0;
+
+	if (!stats->references) {
+		return 0;
+	}
+	total = (double) stats->references * (VM_TLB_NS + VM_MEMORY_NS) + (double) misses * VM_MEMORY_NS
+		+ (double) stats->faults * VM_FAULT_NS;
+
+	return total / stats->references;
+}
+
+
+void vm_report (FILE * out, VirtualMemory vm) {
+	vm_stats_s * stats = &vm->stats;
+
+	fprintf(out, "Virtual memory: %s replacement, %u frames of %d addresses, %u entry TLB\r\n",
+		vmPolicyNames[vm->policy], vm->frameCount, VM_PAGE_SIZE, vm->tlbSize);
+	fprintf(out, "references: %llu, TLB hits: %llu (%.2f%%), page faults: %llu (%.4f%%), evictions: %llu\r\n",
+		stats->references, stats->tlbHits,
+		stats->references ? 100.0 * stats->tlbHits / stats->references : 0.0,
+		stats->faults, 100.0 * vm_fault_rate(stats), stats->evictions);
+	fprintf(out, "effective access time: %.1f ns\r\n", vm_access_time(stats));
+}
+
+
+/*
+ * Writes or reads the frames, the TLB and the counters. Must be loaded into a newly
+ * created virtual memory of the same size, after the PCB table.
+ */
+void vm_checkpoint (VirtualMemory vm, Checkpoint ckpt) {
+	vm_frame_s * frame = NULL;
+
+	ckpt_value(ckpt, vm->stats);
+	ckpt_value(ckpt, vm->hand);
+	ckpt_value(ckpt, vm->tlbNext);
+	ckpt_value(ckpt, vm->freeCount);
+	if (vm->freeCount > vm->frameCount || vm->hand >= vm->frameCount || vm->tlbNext >= vm->tlbSize) {
+		ckpt_fail(ckpt, "checkpoint's virtual memory doesn't fit");
+		return;
+	}
+	ckpt_bytes(ckpt, vm->freeFrames, sizeof(unsigned int) * vm->freeCount);
+	ckpt_bytes(ckpt, vm->tlb, sizeof(vm_tlb_entry_s) * vm->tlbSize);
+
+	for (unsigned int i = 0; i < vm->frameCount && !ckpt->failed; i++) {
+		frame = &vm->frames[i];
+		ckpt_pcb_ref(ckpt, &frame->owner);
+		ckpt_value(ckpt, frame->page);
+		ckpt_value(ckpt, frame->loadedAt);
+		ckpt_value(ckpt, frame->lastUse);
+		ckpt_value(ckpt, frame->referenced);
+		ckpt_value(ckpt, frame->age);
+		if (ckpt->loading && frame->owner) {
+			if (!vm_attach(frame->owner) || frame->page >= frame->owner->page_count) {
+				ckpt_fail(ckpt, "checkpoint's page table doesn't fit its PCB");
+				frame->owner = NULL;
+			} else {
+				frame->owner->page_table[frame->page] = i;
+			}
+		}
+	}
+}
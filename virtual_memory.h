@@ -0,0 +1,150 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is the simulated virtual memory. Each PCB gets an address space of one page
+	per VM_PAGE_SIZE PCs of code plus VM_DATA_PAGES pages of data, and every step it
+	runs makes a memory reference: the instruction at its PC, and on every
+	VM_DATA_EVERY-th PC a data reference too. The data references stay within
+	VM_PHASE_PAGES pages for VM_PHASE_LENGTH PCs at a time and then move on, so a
+	PCB has a working set that shifts as it runs.
+
+	A reference is looked up in a fully associative TLB tagged by PID, then in the
+	PCB's page table. A page that isn't in any frame is a page fault: the reference
+	reports it and the scheduler blocks the PCB on the disk until vm_load brings the
+	page in, evicting another page if no frame is free. Which page is evicted is up
+	to the replacement policy, which can be changed at any time. Nothing here takes
+	a lock, the scheduler calls it with the schedulerMutex held.
+*/
+
+#ifndef VIRTUAL_MEMORY_H
+#define VIRTUAL_MEMORY_H
+
+#include "checkpoint.h"
+
+#define VM_PAGE_SIZE 32 // addresses per page, a PC is one address
+#define VM_DATA_PAGES 16 // data pages in every address space
+#define VM_DATA_EVERY 4 // a data reference is made on every PC that is a multiple of this
+#define VM_PHASE_LENGTH 64 // PCs the data references stay in one set of pages for
+#define VM_PHASE_PAGES 4 // pages in that set
+#define VM_AGING_REFERENCES 256 // references between shifts of the LRU aging counters
+#define VM_NO_FRAME ((unsigned int) -1) // a page table or TLB entry that maps nothing
+#define VM_MAX_FRAMES (1u << 20)
+#define VM_MAX_TLB 1024
+
+#define VM_TLB_NS 1 // what each part of an access costs a real machine, for the
+#define VM_MEMORY_NS 100 // effective access time
+#define VM_FAULT_NS 8000000
+
+
+/* The replacement policies, in the order their names are parsed. */
+enum vm_policy {
+	VM_FIFO, // the page loaded longest ago
+	VM_CLOCK, // second chance, the first page the hand finds unreferenced
+	VM_LRU, // LRU approximated with 8 bit aging counters
+	VM_WS, // WSClock, the first page the hand finds outside the working set window
+	VM_POLICY_COUNT
+};
+
+extern const char * vmPolicyNames[VM_POLICY_COUNT];
+
+typedef struct vm_frame {
+	PCB owner; // NULL while the frame is free
+	unsigned int page;
+	unsigned long long loadedAt; // the reference count when the page was loaded
+	unsigned long long lastUse; // when the hand last found it referenced, for WSClock
+	unsigned char referenced; // set by every reference to the page
+	unsigned char age; // the aging counter, only kept up under VM_LRU
+} vm_frame_s;
+
+typedef struct vm_tlb_entry {
+	unsigned int pid;
+	unsigned int page;
+	unsigned int frame; // VM_NO_FRAME if the entry is empty
+} vm_tlb_entry_s;
+
+typedef struct vm_stats {
+	unsigned long long references;
+	unsigned long long tlbHits;
+	unsigned long long faults;
+	unsigned long long evictions;
+} vm_stats_s;
+
+typedef struct virtual_memory {
+	vm_frame_s * frames;
+	unsigned int frameCount;
+	unsigned int * freeFrames; // a stack of the frames nothing is loaded in
+	unsigned int freeCount;
+	vm_tlb_entry_s * tlb;
+	unsigned int tlbSize;
+	unsigned int tlbNext; // the entry the next TLB miss replaces
+	unsigned int hand; // the clock hand, for VM_CLOCK and VM_WS
+	int policy;
+	unsigned long long window; // references a page stays in the working set for, for VM_WS
+	vm_stats_s stats;
+} virtual_memory_s;
+
+typedef virtual_memory_s * VirtualMemory;
+
+
+/*
+ * Creates a virtual memory with every frame free and an empty TLB.
+ *
+ * Return: the virtual memory, NULL if a size is out of range or memory ran out.
+ */
+VirtualMemory vm_create (unsigned int frameCount, unsigned int tlbSize);
+
+/*
+ * Frees the virtual memory. Every page still loaded is taken out of its PCB's page
+ * table, so the PCBs can go on without it.
+ */
+void vm_destroy (VirtualMemory vm);
+
+/*
+ * Return: the policy with the given name, -1 if there isn't one.
+ */
+int vm_policy_by_name (const char * name);
+
+/*
+ * Makes the references for the PC the PCB has just stepped to. On a page fault the
+ * page is recorded in the PCB's fault_page and the rest of the step's references
+ * aren't made.
+ *
+ * Return: 1 on a page fault, 0 otherwise.
+ */
+int vm_reference (VirtualMemory vm, PCB pcb);
+
+/*
+ * Loads the page into a frame, evicting a page if none is free. Called once the
+ * disk read for a fault has completed.
+ *
+ * Return: the frame, VM_NO_FRAME if the PCB's page table couldn't be allocated.
+ */
+unsigned int vm_load (VirtualMemory vm, PCB pcb, unsigned int page);
+
+/*
+ * Frees every frame the PCB has pages in and drops its TLB entries. Called when the
+ * PCB is killed, its page table is freed with the PCB.
+ */
+void vm_release (VirtualMemory vm, PCB pcb);
+
+/*
+ * Return: page faults per reference.
+ */
+double vm_fault_rate (vm_stats_s * stats);
+
+/*
+ * Return: the mean ns per reference, counting VM_TLB_NS for the TLB, VM_MEMORY_NS
+ * for each memory access and VM_FAULT_NS for each fault.
+ */
+double vm_access_time (vm_stats_s * stats);
+
+void vm_report (FILE * out, VirtualMemory vm);
+
+/*
+ * Writes or reads the frames, the TLB and the counters. Must be loaded into a newly
+ * created virtual memory of the same size, after the PCB table.
+ */
+void vm_checkpoint (VirtualMemory vm, Checkpoint ckpt);
+
+#endif
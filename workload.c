@@ -0,0 +1,277 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is a streaming reader for workload files, which replace the random PCBs that
+	makePCBList generates with ones described ahead of time. See workload.h for the
+	file format. The reader only parses, the scheduler turns each record into PCBs.
+*/
+
+#include "workload.h"
+
+const char * workloadTrapNames[WL_TRAP_KINDS] = {
+	"io1", "io2", "lock1", "lock2", "unlock1", "unlock2", "wait", "signal"
+};
+
+
+/*
+	Reports a bad line and stops the workload. Everything admitted so far stays.
+*/
+void wl_fail (Workload workload, const char * reason) {
+	fprintf(stderr, "workload %s line %lu: %s\r\n", workload->path, workload->lineNumber, reason);
+	workload->failed = 1;
+	workload->hasPending = 0;
+}
+
+
+/*
+	Parses one trap list, "<name>=<pc>,<pc>,...", into the PCB. Returns 0 if it is bad.
+*/
+int wl_parse_traps (workload_pcb_s * pcb, char * token) {
+	char * value = strchr(token, '=');
+	char * save = NULL, * pc = NULL, * end = NULL;
+	int kind = 0, count = 0;
+	unsigned long number = 0;
+
+	if (value == NULL) {
+		return 0;
+	}
+	*value++ = '\0';
+	while (kind < WL_TRAP_KINDS && strcmp(token, workloadTrapNames[kind])) {
+		kind++;
+	}
+	if (kind == WL_TRAP_KINDS || (pcb->given & (1u << kind))) {
+		return 0;
+	}
+	for (pc = strtok_r(value, ",", &save); pc; pc = strtok_r(NULL, ",", &save)) {
+		number = strtoul(pc, &end, 10);
+		if (*end || count == TRAP_COUNT || number == 0 || number >= pcb->max_pc) {
+			return 0;
+		}
+		pcb->traps[kind][count++] = (unsigned int) number;
+	}
+	pcb->given |= 1u << kind;
+
+	return count > 0;
+}
+
+
+/*
+	Reads the next PCB line. Returns 1 when one was read, 0 at the end of the file and
+	-1 after reporting a bad line.
+*/
+int wl_read_pcb (Workload workload, workload_pcb_s * pcb, unsigned int * arrival) {
+	char role[16];
+	char * rest = NULL, * token = NULL, * save = NULL;
+	int used = 0;
+
+	for (;;) {
+		if (getline(&workload->line, &workload->lineSize, workload->file) < 0) {
+			return 0;
+		}
+		workload->lineNumber++;
+		rest = workload->line + strspn(workload->line, " \t\r\n");
+		if (*rest && *rest != '#') {
+			break;
+		}
+	}
+
+	memset(pcb, 0, sizeof(workload_pcb_s));
+	if (sscanf(rest, "%u %15s %u %u %u%n", arrival, role, &pcb->priority, &pcb->max_pc,
+			&pcb->terminate, &used) != 5) {
+		wl_fail(workload, "expected <arrival> <role> <priority> <max_pc> <terminate>");
+		return -1;
+	}
+	if (!strcmp(role, "comp")) {
+		pcb->role = COMP;
+	} else if (!strcmp(role, "io")) {
+		pcb->role = IO;
+	} else if (!strcmp(role, "producer") || !strcmp(role, "consumer")) {
+		pcb->role = PAIR;
+		pcb->isProducer = role[0] == 'p';
+	} else if (!strcmp(role, "shared")) {
+		pcb->role = SHARED;
+	} else {
+		wl_fail(workload, "role must be comp, io, producer, consumer or shared");
+		return -1;
+	}
+	if (pcb->priority >= NUM_PRIORITIES || pcb->max_pc < MAX_DIVIDER || pcb->terminate == 0) {
+		wl_fail(workload, "priority, max_pc or terminate is out of range");
+		return -1;
+	}
+
+	for (token = strtok_r(rest + used, " \t\r\n", &save); token; token = strtok_r(NULL, " \t\r\n", &save)) {
+		if (!wl_parse_traps(pcb, token)) {
+			wl_fail(workload, "bad trap list, expected <name>=<pc>,... with each pc below max_pc");
+			return -1;
+		}
+	}
+
+	return 1;
+}
+
+
+/*
+	Reads the record after the pending one into pending, both PCBs of a pair together.
+*/
+void wl_advance (Workload workload) {
+	workload_record_s * record = &workload->pending;
+	unsigned int last = workload->hasPending ? record->arrival : 0, partner = 0;
+	int result = 0;
+
+	workload->hasPending = 0;
+	if (workload->failed) {
+		return;
+	}
+	result = wl_read_pcb(workload, &record->pcbs[0], &record->arrival);
+	if (result <= 0) {
+		return;
+	}
+	record->count = 1;
+	if (record->arrival < last) {
+		wl_fail(workload, "arrivals must not go backwards");
+		return;
+	}
+
+	if (record->pcbs[0].role == PAIR || record->pcbs[0].role == SHARED) {
+		result = wl_read_pcb(workload, &record->pcbs[1], &partner);
+		if (result < 0) {
+			return;
+		}
+		if (result == 0 || partner != record->arrival || record->pcbs[1].role != record->pcbs[0].role
+				|| (record->pcbs[0].role == PAIR && record->pcbs[1].isProducer == record->pcbs[0].isProducer)) {
+			wl_fail(workload, "a producer needs a consumer, and a shared PCB another shared PCB, on the next line at the same arrival");
+			return;
+		}
+		record->count = 2;
+	}
+
+	workload->offset = ftell(workload->file);
+	workload->hasPending = 1;
+}
+
+
+/*
+	Allocates a workload over an already opened file.
+*/
+Workload wl_create (const char * path, FILE * file) {
+	Workload workload = (Workload) calloc(1, sizeof(struct workload));
+
+	if (workload == NULL) {
+		fclose(file);
+		return NULL;
+	}
+	workload->path = strdup(path);
+	workload->file = file;
+
+	return workload;
+}
+
+
+/*
+ * Opens a workload file and reads its first record.
+ *
+ * Return: the workload, NULL if the file couldn't be opened.
+ */
+Workload wl_open (const char * path) {
+	FILE * file = fopen(path, "r");
+	Workload workload = NULL;
+
+	if (file == NULL) {
+		return NULL;
+	}
+	workload = wl_create(path, file);
+	if (workload != NULL) {
+		wl_advance(workload);
+	}
+
+	return workload;
+}
+
+
+/*
+ * Opens a workload file part way through: offset and lineNumber are where the line
+ * after the pending record starts, and pending is the record that was read before it.
+ *
+ * Return: the workload, NULL if the file couldn't be opened.
+ */
+Workload wl_open_at (const char * path, long offset, unsigned long lineNumber, WorkloadRecord pending) {
+	FILE * file = fopen(path, "r");
+	Workload workload = NULL;
+
+	if (file == NULL || fseek(file, offset, SEEK_SET)) {
+		if (file) {
+			fclose(file);
+		}
+		return NULL;
+	}
+	workload = wl_create(path, file);
+	if (workload != NULL) {
+		workload->offset = offset;
+		workload->lineNumber = lineNumber;
+		if (pending) {
+			workload->pending = *pending;
+			workload->hasPending = 1;
+		}
+	}
+
+	return workload;
+}
+
+
+/*
+ * Reopens the workload's file so this process has its own file position, used by a
+ * child after a fork.
+ *
+ * Return: 1 on success, 0 if the file couldn't be opened again.
+ */
+int wl_reopen (Workload workload) {
+	FILE * file = fopen(workload->path, "r");
+
+	if (file == NULL || fseek(file, workload->offset, SEEK_SET)) {
+		if (file) {
+			fclose(file);
+		}
+		return 0;
+	}
+	fclose(workload->file);
+	workload->file = file;
+
+	return 1;
+}
+
+
+void wl_close (Workload workload) {
+	if (workload) {
+		fclose(workload->file);
+		free(workload->path);
+		free(workload->line);
+		free(workload);
+	}
+}
+
+
+/*
+ * Return: the arrival of the next record, WORKLOAD_NONE if there are no more.
+ */
+unsigned int wl_next_arrival (Workload workload) {
+	return workload->hasPending ? workload->pending.arrival : WORKLOAD_NONE;
+}
+
+
+/*
+ * Hands out the next record if it has arrived by now, and reads the one after it.
+ *
+ * Return: 1 if a record was copied into record, 0 if the next one hasn't arrived or
+ * there are no more.
+ */
+int wl_take (Workload workload, unsigned int now, WorkloadRecord record) {
+	if (!workload->hasPending || workload->pending.arrival > now) {
+		return 0;
+	}
+	*record = workload->pending;
+	workload->admitted++;
+	wl_advance(workload);
+
+	return 1;
+}
@@ -0,0 +1,117 @@
+/*
+	12/6/2017
+	Authors: Connor Lundberg, Jacob Ackerman, Jasmine Dacones
+
+	This is a streaming reader for workload files, which replace the random PCBs that
+	makePCBList generates with ones described ahead of time. Each line is one PCB:
+
+		<arrival> <role> <priority> <max_pc> <terminate> [<traps>=<pc>,<pc>,...]...
+
+	arrival is the iteration the PCB is admitted at, and lines must come in arrival
+	order. role is comp, io, producer, consumer or shared. A producer and a consumer,
+	or two shared PCBs, must be on consecutive lines with the same arrival, and become
+	a pair with their own Mutexes. The optional trap lists are io1, io2, lock1, lock2,
+	unlock1, unlock2, wait and signal, up to TRAP_COUNT PCs each, and any list a PCB's
+	role needs but doesn't give is filled in the way makePCBList does it. Blank lines
+	and lines starting with # are skipped.
+
+	Only the next record is ever held in memory, so a file can have any number of
+	arrivals.
+*/
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include "pcb.h"
+
+#define WORKLOAD_NONE ((unsigned int) -1) // the arrival reported once the file is used up
+
+
+/* The trap lists a workload line can give, in the order their names are parsed. */
+enum workload_traps {
+	WL_IO_1,
+	WL_IO_2,
+	WL_LOCK_R1,
+	WL_LOCK_R2,
+	WL_UNLOCK_R1,
+	WL_UNLOCK_R2,
+	WL_WAIT,
+	WL_SIGNAL,
+	WL_TRAP_KINDS
+};
+
+/* One PCB as the workload describes it. */
+typedef struct workload_pcb {
+	enum pcb_type role;
+	int isProducer;
+	unsigned int priority;
+	unsigned int max_pc;
+	unsigned int terminate;
+	unsigned int traps[WL_TRAP_KINDS][TRAP_COUNT];
+	unsigned int given; // bit i is set when the line gave trap list i
+} workload_pcb_s;
+
+/* One arrival: a single PCB, or both PCBs of a pair. */
+typedef struct workload_record {
+	unsigned int arrival;
+	int count;
+	workload_pcb_s pcbs[2];
+} workload_record_s;
+
+typedef workload_record_s * WorkloadRecord;
+
+typedef struct workload {
+	FILE * file;
+	char * path;
+	char * line; // getline's buffer
+	size_t lineSize;
+	unsigned long lineNumber;
+	long offset; // where the line after the pending record starts
+	workload_record_s pending; // the next record to be admitted
+	int hasPending;
+	int failed; // set by the first bad line, nothing more is read after it
+	unsigned long admitted; // records handed out so far
+} workload_s;
+
+typedef workload_s * Workload;
+
+
+/*
+ * Opens a workload file and reads its first record.
+ *
+ * Return: the workload, NULL if the file couldn't be opened.
+ */
+Workload wl_open (const char * path);
+
+/*
+ * Opens a workload file part way through: offset and lineNumber are where the line
+ * after the pending record starts, and pending is the record that was read before it.
+ *
+ * Return: the workload, NULL if the file couldn't be opened.
+ */
+Workload wl_open_at (const char * path, long offset, unsigned long lineNumber, WorkloadRecord pending);
+
+/*
+ * Reopens the workload's file so this process has its own file position, used by a
+ * child after a fork.
+ *
+ * Return: 1 on success, 0 if the file couldn't be opened again.
+ */
+int wl_reopen (Workload workload);
+
+void wl_close (Workload workload);
+
+/*
+ * Return: the arrival of the next record, WORKLOAD_NONE if there are no more.
+ */
+unsigned int wl_next_arrival (Workload workload);
+
+/*
+ * Hands out the next record if it has arrived by now, and reads the one after it.
+ *
+ * Return: 1 if a record was copied into record, 0 if the next one hasn't arrived or
+ * there are no more.
+ */
+int wl_take (Workload workload, unsigned int now, WorkloadRecord record);
+
+#endif